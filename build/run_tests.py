@@ -284,6 +284,8 @@ class TestHarness:
       cmdline.append('--fs-type=%s' % self.opts.fs_type)
     if self.opts.http_library is not None:
       cmdline.append('--http-library=%s' % self.opts.http_library)
+    if self.opts.http2 is not None:
+      cmdline.append('--http2')
     if self.opts.fsfs_sharding is not None:
       cmdline.append('--fsfs-sharding=%d' % self.opts.fsfs_sharding)
     if self.opts.fsfs_packing is not None:
@@ -1027,6 +1029,8 @@ def create_parser():
                     help='Run tests from all scripts together')
   parser.add_option('--http-library', action='store',
                     help="Make svn use this DAV library (neon or serf)")
+  parser.add_option('--http2', action='store_true',
+                    help='Make svn multiplex its requests over http/2')
   parser.add_option('--bin', action='store', dest='svn_bin',
                     help='Use the svn binaries installed in this path')
   parser.add_option('--fsfs-sharding', action='store', type='int',
@@ -30,6 +30,7 @@
 
 #include <apr_pools.h>
 #include <apr_hash.h>
+#include <apr_global_mutex.h>
 
 #include "svn_types.h"
 #include "svn_error.h"
@@ -270,6 +271,60 @@ svn_cache__make_memcache_from_config(svn_memcache_t **memcache_p,
                                      apr_pool_t *result_pool,
                                      apr_pool_t *scratch_pool);
 
+/**
+ * An opaque structure representing a file-backed store that outlives the
+ * process and may be shared between processes.
+ */
+typedef struct svn_cache__persistent_t svn_cache__persistent_t;
+
+/**
+ * Open the persistent store at @a path, creating it if necessary, and
+ * return it in @a *store.  The file will be @a size bytes large and
+ * memory-mapped into the process.  Within the same process, opening the
+ * same @a path with the same parameters again returns the same object.
+ *
+ * @a guard identifies the data set that may be stored, e.g. a repository
+ * UUID plus format number.  If the existing file had been created with a
+ * different @a guard or @a size, all its contents will be discarded.
+ *
+ * The file will be fully allocated on disk before being mapped.  If the
+ * caller lacks write access to @a path, an existing store with matching
+ * @a guard and @a size gets opened read-only; everything written to it
+ * will be ignored.  In all other cases, failure to open the store will
+ * be returned as an error.
+ *
+ * Entries are checksummed and replaced in FIFO order.  Corrupted or
+ * partially overwritten entries are reported as cache misses.  Use
+ * @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_cache__persistent_open(svn_cache__persistent_t **store,
+                           const char *path,
+                           apr_uint64_t size,
+                           const char *guard,
+                           apr_pool_t *scratch_pool);
+
+/**
+ * Creates a new cache in @a *cache_p that adds the persistent @a store
+ * as a second tier behind the existing cache @a front.  All writes go
+ * to both, lookups that miss @a front but hit @a store will be promoted
+ * to @a front.  @a serialize_func, @a deserialize_func, @a klen and
+ * @a prefix have the same meaning as for svn_cache__create_memcache();
+ * @a prefix must be unique within @a store.  Allocate the cache object
+ * in @a result_pool.
+ *
+ * Iterating the resulting cache is not supported.
+ */
+svn_error_t *
+svn_cache__create_persistent(svn_cache__t **cache_p,
+                             svn_cache__t *front,
+                             svn_cache__persistent_t *store,
+                             svn_cache__serialize_func_t serialize_func,
+                             svn_cache__deserialize_func_t deserialize_func,
+                             apr_ssize_t klen,
+                             const char *prefix,
+                             apr_pool_t *result_pool);
+
 /**
  * Creates a new membuffer cache object in @a *cache. It will contain
  * up to @a total_size bytes of data, using @a directory_size bytes
@@ -310,6 +365,72 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   svn_boolean_t allow_blocking_writes,
                                   apr_pool_t *result_pool);
 
+/**
+ * Callback type used with svn_cache__membuffer_cache_create_shared().
+ * It gets called with @a baton for every inter-process @a mutex of a
+ * newly created shared memory cache, before any child process gets
+ * forked.  Hosts use it to adjust the lock's permissions such that
+ * their (unprivileged) child processes can use it, e.g. through
+ * ap_unixd_set_global_mutex_perms().  @a pool may be used for temporary
+ * allocations.
+ */
+typedef svn_error_t *(*svn_cache__shared_lock_func_t)(
+  apr_global_mutex_t *mutex,
+  void *baton,
+  apr_pool_t *pool);
+
+/**
+ * Like svn_cache__membuffer_cache_create() but place the whole cache,
+ * i.e. its index and data buffers, into a shared memory segment.  All
+ * processes forked from the caller after this call will then share the
+ * same cache contents instead of each one holding its own copy.
+ *
+ * @a shm_file is the name of the shared memory file to use.  It may be
+ * @c NULL, in which case anonymous shared memory will be used if the
+ * platform supports it.  Unrelated processes cannot attach to the cache
+ * by that name, i.e. processes must inherit the cache through fork().
+ *
+ * Access to the cache segments will be serialized by a small set of
+ * process-wide locks shared by all segments.  Therefore, the resulting
+ * cache is always thread-safe and writes will always block until they
+ * get the respective lock.  If the lock mechanism needs lock files,
+ * their names will be derived from @a lock_file by appending a number.
+ * @a lock_file should therefore point into a directory that is private
+ * to the server, e.g. its run-time directory.  It may be @c NULL, in
+ * which case APR picks a default location.  Unless @a lock_func is
+ * @c NULL, it will be called with @a lock_baton for each of these locks.  Because
+ * key prefix indexes cannot be shared between processes, the full key
+ * will be stored with every entry.
+ *
+ * Every child process must call svn_cache__membuffer_cache_child_init()
+ * before accessing the cache.
+ *
+ * Process-private book-keeping data will be allocated in @a result_pool.
+ * The shared memory will be released when it gets cleaned up.
+ */
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         const char *shm_file,
+                                         const char *lock_file,
+                                         svn_cache__shared_lock_func_t lock_func,
+                                         void *lock_baton,
+                                         apr_pool_t *result_pool);
+
+/**
+ * Re-attach the current (child) process to the process-wide locks of the
+ * shared memory @a cache that it inherited from its parent process.
+ * Allocations will be made in @a pool, which must live as long as the
+ * child process accesses the cache.
+ *
+ * This is a no-op if @a cache is not a shared memory cache.
+ */
+svn_error_t *
+svn_cache__membuffer_cache_child_init(svn_membuffer_t *cache,
+                                      apr_pool_t *pool);
+
 /**
  * @defgroup Standard priority classes for #svn_cache__create_membuffer_cache.
  * @{
@@ -554,6 +675,30 @@ svn_cache__format_info(const svn_cache__info_t *info,
 struct svn_membuffer_t *
 svn_cache__get_global_membuffer_cache(void);
 
+/**
+ * Allocate the process-global (singleton) membuffer cache in shared
+ * memory, using the current cache config as well as @a shm_file,
+ * @a lock_file, @a lock_func and @a lock_baton as described for
+ * svn_cache__membuffer_cache_create_shared().  This must be called
+ * in the parent process of a pre-forking server before any child gets
+ * forked.  It has no effect if the global membuffer cache has already
+ * been created.
+ */
+svn_error_t *
+svn_cache__create_shared_global_membuffer_cache(
+  const char *shm_file,
+  const char *lock_file,
+  svn_cache__shared_lock_func_t lock_func,
+  void *lock_baton);
+
+/**
+ * To be called in every child process forked after
+ * svn_cache__create_shared_global_membuffer_cache() before accessing
+ * any repository.  @a pool must live as long as the child process.
+ */
+svn_error_t *
+svn_cache__global_membuffer_cache_child_init(apr_pool_t *pool);
+
 /**
  * Return total access and size stats over all membuffer caches as they
  * share the underlying data buffer.  The result will be allocated in POOL.
@@ -108,6 +108,26 @@ svn_txdelta__read_raw_window_len(apr_size_t *window_len,
                                  svn_stream_t *stream,
                                  apr_pool_t *pool);
 
+/** Like svn_txdelta_to_svndiff3() but encode and compress up to
+ * @a max_threads windows concurrently on a pool of worker threads.
+ * The windows will still be written to @a output in the order they
+ * were passed to @a *handler, i.e. the resulting svndiff data is
+ * identical to what svn_txdelta_to_svndiff3() produces.
+ *
+ * Since the windows must be copied, this is only useful for deltas that
+ * span multiple windows and use a compressing svndiff version.  If
+ * @a max_threads is 1 or less, @a svndiff_version is 0 or the platform
+ * does not support threads, this is the same as svn_txdelta_to_svndiff3().
+ */
+void
+svn_txdelta__to_svndiff_concurrent(svn_txdelta_window_handler_t *handler,
+                                   void **handler_baton,
+                                   svn_stream_t *output,
+                                   int svndiff_version,
+                                   int compression_level,
+                                   int max_threads,
+                                   apr_pool_t *pool);
+
 /* Return a debug editor that wraps @a wrapped_editor.
  *
  * The debug editor simply prints an indication of what callbacks are being
@@ -211,6 +211,16 @@ svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/** Return the warning callback and baton currently registered with @a fs
+ * in @a *warning and @a *warning_baton, respectively.  This allows other
+ * code to forward warnings, e.g. those collected from helper threads, to
+ * the same receiver.
+ */
+void
+svn_fs__get_warning_func(svn_fs_warning_callback_t *warning,
+                         void **warning_baton,
+                         svn_fs_t *fs);
+
 
 /** @} */
 
@@ -83,6 +83,22 @@ svn_ra__assert_capable_server(svn_ra_session_t *ra_session,
                               const char *path_or_url,
                               apr_pool_t *pool);
 
+/* Like svn_ra_stat(), but for all the relpaths in PATHS at once.  Set
+   *DIRENTS to a hash mapping each of PATHS that exists in REVISION to
+   its svn_dirent_t.  RA layers may send the requests for several paths
+   at once, saving the round trips.
+
+   Allocate *DIRENTS in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_ra__stat_many(svn_ra_session_t *session,
+                  apr_hash_t **dirents,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool);
+
+
 
 /*** Operational Locks ***/
 
@@ -127,6 +127,18 @@ svn_error_t *
 svn_ra_svn__set_capabilities(svn_ra_svn_conn_t *conn,
                              const svn_ra_svn__list_t *list);
 
+/** Flush all pending output on @a conn and compress all further data
+ * sent or received on it, as described for the compressed-stream
+ * capability.  The codec and compression level will adapt to the
+ * connection's throughput but never exceed the compression level
+ * @a conn has been created with.  Use @a pool for temporaries.
+ *
+ * Both sides must call this at the same point of the protocol exchange.
+ */
+svn_error_t *
+svn_ra_svn__enable_compression(svn_ra_svn_conn_t *conn,
+                               apr_pool_t *pool);
+
 /** Returns the preferred svndiff version to be used with connection @a conn.
  */
 int
@@ -275,6 +287,49 @@ svn_ra_svn__read_item(svn_ra_svn_conn_t *conn,
                       apr_pool_t *pool,
                       svn_ra_svn__item_t **item);
 
+/** Callbacks to be invoked by svn_ra_svn__receive_item() for the items
+ * found in the data stream.
+ *
+ * The @c data passed to the @c string and @c word callbacks points into
+ * the connection's read buffer wherever possible and is only valid until
+ * the callback returns.  It is not guaranteed to be NUL-terminated.
+ * Callbacks must not read from the connection themselves.
+ *
+ * Any of the callbacks may be @c NULL, in which case the respective kind
+ * of item is considered malformed data.
+ */
+typedef struct svn_ra_svn__item_receiver_t
+{
+  /** A number item with the given @a value. */
+  svn_error_t *(*number)(void *baton, apr_uint64_t value);
+
+  /** A string item of @a len bytes starting at @a data. */
+  svn_error_t *(*string)(void *baton, const char *data, apr_size_t len);
+
+  /** A word item of @a len bytes starting at @a data. */
+  svn_error_t *(*word)(void *baton, const char *data, apr_size_t len);
+
+  /** The opening paren of a list.  All sub-items will be reported before
+   * the matching call to @c end_list. */
+  svn_error_t *(*start_list)(void *baton);
+
+  /** The closing paren of a list. */
+  svn_error_t *(*end_list)(void *baton);
+} svn_ra_svn__item_receiver_t;
+
+/** Read an item from the network and report it and all its sub-items
+ * to @a receiver, passing @a receiver_baton to each callback.
+ *
+ * Unlike svn_ra_svn__read_item(), this does not construct an item tree
+ * and, for most items, does not copy the data.  Use @a scratch_pool for
+ * temporary allocations.
+ */
+svn_error_t *
+svn_ra_svn__receive_item(svn_ra_svn_conn_t *conn,
+                         const svn_ra_svn__item_receiver_t *receiver,
+                         void *receiver_baton,
+                         apr_pool_t *scratch_pool);
+
 /** Scan data on @a conn until we find something which looks like the
  * beginning of an svn server greeting (an open paren followed by a
  * whitespace character).  This function is appropriate for beginning
@@ -365,6 +420,28 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
                         svn_ra_svn_conn_t *conn,
                         apr_pool_t *pool);
 
+/** Read all data that is available on @a conn without waiting into its
+ * receive buffer.  Set @a *complete to TRUE if the buffer then contains
+ * a complete command, i.e. if that command can be processed without
+ * blocking, or if the command is too large to be buffered.  If the
+ * connection has been closed, set @a *terminated to TRUE.  Use @a pool
+ * for temporary allocations.
+ */
+svn_error_t *
+svn_ra_svn__buffer_command(svn_boolean_t *complete,
+                           svn_boolean_t *terminated,
+                           svn_ra_svn_conn_t *conn,
+                           apr_pool_t *pool);
+
+/** Make reads from @a conn fail if the peer does not send any data for
+ * @a timeout microseconds.  A negative @a timeout, the default, makes
+ * them wait indefinitely.  This is only supported for socket based
+ * connections and ignored for all others.
+ */
+void
+svn_ra_svn__set_read_timeout(svn_ra_svn_conn_t *conn,
+                             apr_interval_time_t timeout);
+
 /** Accept a single command from @a conn and handle them according
  * to @a cmd_hash.  Command handlers will be passed @a conn, @a pool,
  * the parameters of the command, and @a baton.  @a *terminate will be
@@ -773,6 +850,9 @@ svn_ra_svn__write_cmd_get_file(svn_ra_svn_conn_t *conn,
 /** Send a "update" command over connection @a conn.
  * Use @a pool for allocations.
  *
+ * If @a text_deltas is @c FALSE, ask the server to omit the file contents
+ * from the editor drive.
+ *
  * @see #svn_ra_do_update3 for a description.
  */
 svn_error_t *
@@ -783,7 +863,8 @@ svn_ra_svn__write_cmd_update(svn_ra_svn_conn_t *conn,
                              svn_boolean_t recurse,
                              svn_depth_t depth,
                              svn_boolean_t send_copyfrom_args,
-                             svn_boolean_t ignore_ancestry);
+                             svn_boolean_t ignore_ancestry,
+                             svn_boolean_t text_deltas);
 
 /** Send a "switch" command over connection @a conn.
  * Use @a pool for allocations.
@@ -0,0 +1,173 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_thread_jobs.h
+ * @brief Run jobs in worker threads and collect their results
+ */
+
+#ifndef SVN_THREAD_JOBS_H
+#define SVN_THREAD_JOBS_H
+
+#include <apr_pools.h>
+#include <apr_time.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+#include "private/svn_mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A bounded queue of jobs that get run by a pool of worker threads.
+ * The jobs may finish in any order but the thread that created the queue
+ * collects their results one by one, usually in the order they were
+ * queued.  This allows for processing the results just like a serial
+ * implementation would, e.g. to write them to a stream or to notify the
+ * user in order.
+ *
+ * Except where noted otherwise, only the creating thread may call the
+ * functions below.  If APR does not support threads, jobs will simply be
+ * run as part of svn_thread__jobs_push().
+ */
+typedef struct svn_thread__jobs_t svn_thread__jobs_t;
+
+/** Job function run by a worker thread.  @a baton is the job baton
+ * passed to svn_thread__jobs_push() and @a pool the job's root pool.
+ * As no other thread uses @a pool while the job is running, the function
+ * may allocate from it without further synchronization.  The error
+ * returned will be reported by svn_thread__jobs_pop().
+ */
+typedef svn_error_t *(*svn_thread__job_func_t)(void *baton,
+                                               apr_pool_t *pool);
+
+/** Create a new job queue in @a *jobs, allocated in @a result_pool.
+ *
+ * At most @a max_jobs jobs may be queued or waiting for their results
+ * to be collected at any given time.  They will be run by up to
+ * @a max_threads threads that get created upon the first call to
+ * svn_thread__jobs_push().  Idle threads terminate after @a idle_limit
+ * microseconds; 0 selects APR's default.  If @a in_order is set,
+ * svn_thread__jobs_pop() will return the jobs in the order that they
+ * were queued.  Otherwise, it returns them in the order they finish.
+ *
+ * @a cancel_func and @a cancel_baton may be @c NULL.  Otherwise,
+ * svn_thread__jobs_cancel_func() will call them from the worker threads,
+ * so they must be thread-safe.
+ *
+ * svn_thread__jobs_close() will be called when @a result_pool gets
+ * cleaned up.
+ */
+svn_error_t *
+svn_thread__jobs_create(svn_thread__jobs_t **jobs,
+                        int max_jobs,
+                        int max_threads,
+                        apr_interval_time_t idle_limit,
+                        svn_boolean_t in_order,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *result_pool);
+
+/** Return the number of jobs in @a jobs whose results have not been
+ * collected, yet.
+ */
+int
+svn_thread__jobs_count(svn_thread__jobs_t *jobs);
+
+/** Return TRUE if no more jobs may be pushed to @a jobs before one of them
+ * gets collected.
+ */
+svn_boolean_t
+svn_thread__jobs_full(svn_thread__jobs_t *jobs);
+
+/** Queue a new job in @a jobs, which must not be full, to call @a func
+ * with @a baton and @a pool in some worker thread.  @a pool must be a
+ * root pool, i.e. created by svn_pool_create(NULL), and @a jobs takes
+ * ownership of it until the job gets returned by svn_thread__jobs_pop().
+ * If this function fails, @a pool will have been destroyed.
+ *
+ * If the job cannot be handed to a worker thread, run it immediately.
+ */
+svn_error_t *
+svn_thread__jobs_push(svn_thread__jobs_t *jobs,
+                      svn_thread__job_func_t func,
+                      void *baton,
+                      apr_pool_t *pool);
+
+/** Remove the next finished job from @a jobs and return its baton in
+ * @a *baton and the error returned by its job function in @a *job_err.
+ * The caller takes ownership of both, i.e. must clear @a *job_err and
+ * destroy the job's pool.  Depending on how @a jobs was created, this is
+ * the oldest job or any one that has finished.
+ *
+ * If @a wait is set, block until such a job becomes available.
+ * Otherwise, set @a *baton to @c NULL if there is none.  The same
+ * happens if there are no jobs in @a jobs at all.
+ */
+svn_error_t *
+svn_thread__jobs_pop(void **baton,
+                     svn_error_t **job_err,
+                     svn_thread__jobs_t *jobs,
+                     svn_boolean_t wait);
+
+/** Make svn_thread__jobs_cancel_func() fail for all jobs in @a jobs.
+ * Use this to let the workers bail out early when their results will
+ * not be needed anymore.  This function is thread-safe.
+ */
+void
+svn_thread__jobs_abort(svn_thread__jobs_t *jobs);
+
+/** Return TRUE if svn_thread__jobs_abort() has been called for @a jobs.
+ * This function is thread-safe.
+ */
+svn_boolean_t
+svn_thread__jobs_aborted(svn_thread__jobs_t *jobs);
+
+/** Implements #svn_cancel_func_t for jobs.  @a baton is the
+ * #svn_thread__jobs_t.  Return #SVN_ERR_CANCELLED if the jobs have been
+ * aborted and call the cancellation function passed to
+ * svn_thread__jobs_create() otherwise.  This function is thread-safe.
+ */
+svn_error_t *
+svn_thread__jobs_cancel_func(void *baton);
+
+/** Return the mutex that @a jobs uses to synchronize with the worker
+ * threads.  Job functions may use it to guard data shared between them,
+ * e.g. a list of re-usable resources.  It must not be held when calling
+ * any of the functions above.
+ */
+svn_mutex__t *
+svn_thread__jobs_mutex(svn_thread__jobs_t *jobs);
+
+/** Abort all jobs in @a jobs, wait for the running ones to finish and
+ * release all jobs whose results have not been collected.  Stop all
+ * worker threads.  This is a no-op if it has been called before.
+ */
+void
+svn_thread__jobs_close(svn_thread__jobs_t *jobs);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_THREAD_JOBS_H */
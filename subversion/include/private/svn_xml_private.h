@@ -0,0 +1,107 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_xml_private.h
+ * @brief Buffered XML output
+ */
+
+#ifndef SVN_XML_PRIVATE_H
+#define SVN_XML_PRIVATE_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+#include "svn_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A writer for large XML documents such as server responses.  It
+ * collects the output in a buffer of its own, escapes strings directly
+ * into that buffer and hands the data to the underlying stream in large
+ * chunks.  That saves the per-call overhead of the stream and the
+ * temporary allocations of escaping every string separately.
+ *
+ * Call svn_xml__writer_flush() before writing anything to the underlying
+ * stream directly and once the document is complete.
+ */
+typedef struct svn_xml__writer_t svn_xml__writer_t;
+
+/** Return a writer that sends its output to @a out, allocated in
+ * @a pool.  @a out will not be closed by the writer.
+ */
+svn_xml__writer_t *
+svn_xml__writer_create(svn_stream_t *out,
+                       apr_pool_t *pool);
+
+/** Write an unspecified number of strings to @a xw, as is.  The list
+ * must be terminated by #SVN_VA_NULL.
+ */
+svn_error_t *
+svn_xml__writer_putstrs(svn_xml__writer_t *xw,
+                        ...) SVN_NEEDS_SENTINEL_NULL;
+
+/** Write data to @a xw, using @a fmt as the output format string.  The
+ * arguments are not escaped.
+ */
+svn_error_t *
+svn_xml__writer_printf(svn_xml__writer_t *xw,
+                       const char *fmt,
+                       ...)
+  __attribute__((format(printf, 2, 3)));
+
+/** Write @a len bytes from @a data to @a xw, escaped as XML character
+ * data.
+ */
+svn_error_t *
+svn_xml__writer_cdata(svn_xml__writer_t *xw,
+                      const char *data,
+                      apr_size_t len);
+
+/** Write the NUL-terminated string @a str to @a xw, escaped for use as
+ * the value of an XML attribute.
+ */
+svn_error_t *
+svn_xml__writer_attr(svn_xml__writer_t *xw,
+                     const char *str);
+
+/** Return a stream, allocated in @a pool, that writes its data to
+ * @a xw as is.  Closing it does not flush @a xw.  Use this to embed
+ * e.g. base64-encoded data in the document.
+ */
+svn_stream_t *
+svn_xml__writer_stream(svn_xml__writer_t *xw,
+                       apr_pool_t *pool);
+
+/** Write everything that @a xw buffered to its stream.
+ */
+svn_error_t *
+svn_xml__writer_flush(svn_xml__writer_t *xw);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_XML_PRIVATE_H */
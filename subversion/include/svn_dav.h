@@ -198,6 +198,21 @@ extern "C" {
  * @since New in 1.8.   */
 #define SVN_DAV_ALLOW_BULK_UPDATES "SVN-Allow-Bulk-Updates"
 
+/** This header is sent with an update REPORT request to ask for one
+ * partition of the file contents of the update instead of the report
+ * itself.  Its value is "INDEX COUNT REVISION": the server drives the
+ * report against REVISION and sends the text deltas of exactly those
+ * files whose editor relpath hashes (FNV-1a, 32 bits) to INDEX modulo
+ * COUNT, wrapped in an S:update-partition element.  Each S:txdelta
+ * element carries the file's "path" and, where available, its
+ * "base-checksum" and "sha1-checksum".
+ *
+ * Only servers that advertise #SVN_DAV_NS_DAV_SVN_UPDATE_PARTITIONS
+ * understand this header; mod_dav_svn does so only with
+ * "SVNAllowUpdatePartitions on".
+ * @since New in 1.15.  */
+#define SVN_DAV_UPDATE_PARTITION_HEADER "SVN-Update-Partition"
+
 /** Assuming the request target is a Subversion repository resource,
  * this header is returned in the OPTIONS response to indicate whether
  * the repository supports the merge tracking feature ("yes") or not
@@ -422,6 +437,15 @@ extern "C" {
 #define SVN_DAV_NS_DAV_SVN_PUT_RESULT_CHECKSUM\
             SVN_DAV_PROP_NS_DAV "svn/put-result-checksum"
 
+/** Presence of this in a DAV header in an OPTIONS response indicates
+ * that the transmitter (in this case, the server) knows how to handle
+ * update REPORTs carrying the #SVN_DAV_UPDATE_PARTITION_HEADER.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_DAV_NS_DAV_SVN_UPDATE_PARTITIONS\
+            SVN_DAV_PROP_NS_DAV "svn/update-partitions"
+
 /** @} */
 
 /** @} */
@@ -71,6 +71,11 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/** Server supports the "batch" command.  @since New in 1.15. */
+#define SVN_RA_SVN_CAP_BATCH "batch"
+/** Compress all data after the greeting, adapting the codec to the link.
+ * @since New in 1.15. */
+#define SVN_RA_SVN_CAP_COMPRESSED_STREAM "compressed-stream"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
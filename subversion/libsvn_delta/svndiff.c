@@ -35,6 +35,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_thread_jobs.h"
 
 static const char SVNDIFF_V0[] = { 'S', 'V', 'N', 0 };
 static const char SVNDIFF_V1[] = { 'S', 'V', 'N', 1 };
@@ -245,6 +246,32 @@ encode_window(svn_stringbuf_t **instructions_p,
   return SVN_NO_ERROR;
 }
 
+/* Write the HEADER, INSTRUCTIONS and NEWDATA of an encoded window, as
+   returned by encode_window(), to EB->OUTPUT. */
+static svn_error_t *
+write_encoded_window(struct encoder_baton *eb,
+                     const svn_stringbuf_t *header,
+                     const svn_stringbuf_t *instructions,
+                     const svn_string_t *newdata)
+{
+  apr_size_t len;
+
+  len = header->len;
+  SVN_ERR(svn_stream_write(eb->output, header->data, &len));
+  if (instructions->len > 0)
+    {
+      len = instructions->len;
+      SVN_ERR(svn_stream_write(eb->output, instructions->data, &len));
+    }
+  if (newdata->len > 0)
+    {
+      len = newdata->len;
+      SVN_ERR(svn_stream_write(eb->output, newdata->data, &len));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Note: When changing things here, check the related comment in
    the svn_txdelta_to_svndiff_stream() function.  */
 static svn_error_t *
@@ -285,21 +312,8 @@ window_handler(svn_txdelta_window_t *window, void *baton)
                         eb->version, eb->compression_level,
                         eb->scratch_pool));
 
-  /* Write out the window.  */
-  len = header->len;
-  SVN_ERR(svn_stream_write(eb->output, header->data, &len));
-  if (instructions->len > 0)
-    {
-      len = instructions->len;
-      SVN_ERR(svn_stream_write(eb->output, instructions->data, &len));
-    }
-  if (newdata->len > 0)
-    {
-      len = newdata->len;
-      SVN_ERR(svn_stream_write(eb->output, newdata->data, &len));
-    }
-
-  return SVN_NO_ERROR;
+  return svn_error_trace(write_encoded_window(eb, header, instructions,
+                                              newdata));
 }
 
 void
@@ -323,6 +337,173 @@ svn_txdelta_to_svndiff3(svn_txdelta_window_handler_t *handler,
   *handler_baton = eb;
 }
 
+#if APR_HAS_THREADS
+
+/* Number of microseconds that an unused encoder thread remains in the
+ * pool before being terminated.  Windows arrive back-to-back, so this
+ * only needs to bridge the gaps between them. */
+#define THREADPOOL_THREAD_IDLE_LIMIT 100000
+
+/* A single window being encoded by one of the worker threads. */
+typedef struct encoder_job_t
+{
+  /* Private root pool of this job. */
+  apr_pool_t *pool;
+
+  /* Copy of the window to encode, allocated in POOL. */
+  svn_txdelta_window_t *window;
+
+  /* Results of encode_window(), allocated in POOL. */
+  svn_stringbuf_t *instructions;
+  svn_stringbuf_t *header;
+  const svn_string_t *newdata;
+
+  /* The serial encoder providing the encoding parameters. */
+  struct encoder_baton *eb;
+} encoder_job_t;
+
+/* Baton of the concurrent svndiff encoder. */
+typedef struct concurrent_encoder_baton
+{
+  /* The serial encoder.  Used for the actual output and the final
+   * NULL window. */
+  struct encoder_baton *eb;
+
+  /* Windows being encoded, in output order.  The first window gets
+   * encoded inline, so deltas with only one window never spawn a
+   * thread. */
+  svn_thread__jobs_t *jobs;
+} concurrent_encoder_baton;
+
+/* Implements svn_thread__job_func_t:  Encode the encoder_job_t BATON. */
+static svn_error_t *
+encoder_job(void *baton,
+            apr_pool_t *pool)
+{
+  encoder_job_t *job = baton;
+
+  return svn_error_trace(encode_window(&job->instructions, &job->header,
+                                       &job->newdata, job->window,
+                                       job->eb->version,
+                                       job->eb->compression_level, pool));
+}
+
+/* Wait for the oldest window in CEB to be encoded, write it to the output
+ * stream and remove it from CEB. */
+static svn_error_t *
+flush_oldest_job(concurrent_encoder_baton *ceb)
+{
+  encoder_job_t *job;
+  svn_error_t *err;
+
+  SVN_ERR(svn_thread__jobs_pop((void **)&job, &err, ceb->jobs, TRUE));
+  if (!err)
+    {
+      /* Make sure we write the header.  */
+      if (!ceb->eb->header_done)
+        {
+          apr_size_t len = SVNDIFF_HEADER_SIZE;
+          err = svn_stream_write(ceb->eb->output,
+                                 get_svndiff_header(ceb->eb->version), &len);
+          ceb->eb->header_done = TRUE;
+        }
+
+      if (!err)
+        err = write_encoded_window(ceb->eb, job->header, job->instructions,
+                                   job->newdata);
+    }
+
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_txdelta_window_handler_t for the concurrent encoder. */
+static svn_error_t *
+concurrent_window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  concurrent_encoder_baton *ceb = baton;
+  encoder_job_t *job;
+  apr_pool_t *job_pool;
+
+  if (window == NULL)
+    {
+      /* Write all pending windows in order, then let the serial encoder
+       * finish the stream. */
+      while (svn_thread__jobs_count(ceb->jobs))
+        SVN_ERR(flush_oldest_job(ceb));
+
+      svn_thread__jobs_close(ceb->jobs);
+
+      return svn_error_trace(window_handler(NULL, ceb->eb));
+    }
+
+  /* Most deltas consist of a single window.  Encode the first one right
+   * here, so those don't pay for creating threads and copying windows.
+   * Nothing is in flight before the first window, so it still gets
+   * written in order. */
+  if (!ceb->eb->header_done)
+    return svn_error_trace(window_handler(window, ceb->eb));
+
+  /* Limit the number of windows in flight. */
+  if (svn_thread__jobs_full(ceb->jobs))
+    SVN_ERR(flush_oldest_job(ceb));
+
+  /* The caller may reuse WINDOW's memory as soon as we return. */
+  job_pool = svn_pool_create(NULL);
+  job = apr_pcalloc(job_pool, sizeof(*job));
+  job->pool = job_pool;
+  job->window = svn_txdelta_window_dup(window, job->pool);
+  job->eb = ceb->eb;
+
+  return svn_error_trace(svn_thread__jobs_push(ceb->jobs, encoder_job, job,
+                                               job_pool));
+}
+
+#endif /* APR_HAS_THREADS */
+
+void
+svn_txdelta__to_svndiff_concurrent(svn_txdelta_window_handler_t *handler,
+                                   void **handler_baton,
+                                   svn_stream_t *output,
+                                   int svndiff_version,
+                                   int compression_level,
+                                   int max_threads,
+                                   apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  concurrent_encoder_baton *ceb;
+  svn_error_t *err;
+#endif
+
+  /* The serial encoder does all the work in the simple cases. */
+  svn_txdelta_to_svndiff3(handler, handler_baton, output, svndiff_version,
+                          compression_level, pool);
+
+#if APR_HAS_THREADS
+
+  /* Without compression, there is nothing worth offloading. */
+  if (max_threads <= 1 || svndiff_version == 0)
+    return;
+
+  ceb = apr_pcalloc(pool, sizeof(*ceb));
+  ceb->eb = *handler_baton;
+
+  err = svn_thread__jobs_create(&ceb->jobs, max_threads, max_threads,
+                                THREADPOOL_THREAD_IDLE_LIMIT, TRUE,
+                                NULL, NULL, pool);
+  if (!err)
+    {
+      *handler = concurrent_window_handler;
+      *handler_baton = ceb;
+    }
+
+  /* Otherwise, simply fall back to the serial encoder. */
+  svn_error_clear(err);
+
+#endif
+}
+
 void
 svn_txdelta_to_svndiff2(svn_txdelta_window_handler_t *handler,
                         void **handler_baton,
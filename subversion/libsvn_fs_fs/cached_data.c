@@ -57,6 +57,14 @@ block_read(void **result,
            apr_pool_t *scratch_pool);
 
 
+/* Upper limit for the total number of bytes that we ask the OS to read
+ * ahead for a delta chain when reconstructing a fulltext.  It gets split
+ * evenly between the reps of the chain, so we mainly prefetch the first
+ * windows of each rep.  Windows further into the reps will be fetched by
+ * the OS' sequential read-ahead anyway - if the reader wants them at all.
+ */
+#define MAX_PREFETCH_CHAIN_SIZE (2 * 1024 * 1024)
+
 /* Define this to enable access logging via dbg_log_access
 #define SVN_FS_FS__LOG_ACCESS
  */
@@ -193,21 +201,6 @@ dbg_log_access(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* Convenience wrapper around svn_io_file_aligned_seek, taking filesystem
-   FS instead of a block size. */
-static svn_error_t *
-aligned_seek(svn_fs_t *fs,
-             apr_file_t *file,
-             apr_off_t *buffer_start,
-             apr_off_t offset,
-             apr_pool_t *pool)
-{
-  fs_fs_data_t *ffd = fs->fsap_data;
-  return svn_error_trace(svn_io_file_aligned_seek(file, ffd->block_size,
-                                                  buffer_start, offset,
-                                                  pool));
-}
-
 /* Open the revision file for revision REV in filesystem FS and store
    the newly opened file in FILE.  Seek to location OFFSET before
    returning.  Perform temporary allocations in POOL. */
@@ -227,7 +220,7 @@ open_and_seek_revision(svn_fs_fs__revision_file_t **file,
   SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, rev, NULL, item,
                                  pool));
 
-  SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, pool));
+  SVN_ERR(svn_fs_fs__rev_file_aligned_seek(rev_file, NULL, offset, pool));
 
   *file = rev_file;
 
@@ -249,7 +242,7 @@ open_and_seek_transaction(svn_fs_fs__revision_file_t **file,
 
   SVN_ERR(svn_fs_fs__item_offset(&offset, fs, NULL, SVN_INVALID_REVNUM,
                                  &rep->txn_id, rep->item_index, pool));
-  SVN_ERR(aligned_seek(fs, (*file)->file, NULL, offset, pool));
+  SVN_ERR(svn_fs_fs__rev_file_aligned_seek(*file, NULL, offset, pool));
 
   return SVN_NO_ERROR;
 }
@@ -368,7 +361,8 @@ svn_fs_fs__fixup_expanded_size(svn_fs_t *fs,
    * out.  So, let's just look at the representation header. */
   SVN_ERR(open_and_seek_revision(&revision_file, fs, rep->revision,
                                  rep->item_index, scratch_pool));
-  SVN_ERR(svn_fs_fs__read_rep_header(&rep_header, revision_file->stream,
+  SVN_ERR(svn_fs_fs__read_rep_header(&rep_header,
+                                     svn_fs_fs__rev_file_stream(revision_file),
                                      scratch_pool, scratch_pool));
   SVN_ERR(svn_fs_fs__close_revision_file(revision_file));
 
@@ -485,7 +479,7 @@ get_node_revision_body(node_revision_t **noderev_p,
         {
           /* physical addressing mode reading, parsing and caching */
           SVN_ERR(svn_fs_fs__read_noderev(noderev_p,
-                                          revision_file->stream,
+                                    svn_fs_fs__rev_file_stream(revision_file),
                                           result_pool,
                                           scratch_pool));
           SVN_ERR(fixup_node_revision(fs, *noderev_p, scratch_pool));
@@ -547,9 +541,9 @@ get_fs_id_at_offset(svn_fs_id_t **id_p,
 {
   node_revision_t *noderev;
 
-  SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, pool));
+  SVN_ERR(svn_fs_fs__rev_file_aligned_seek(rev_file, NULL, offset, pool));
   SVN_ERR(svn_fs_fs__read_noderev(&noderev,
-                                  rev_file->stream,
+                                  svn_fs_fs__rev_file_stream(rev_file),
                                   pool, pool));
 
   /* noderev->id is const, get rid of that */
@@ -616,7 +610,10 @@ get_root_changes_offset(apr_off_t *root_offset,
 
   /* We will assume that the last line containing the two offsets
      will never be longer than 64 characters. */
-  SVN_ERR(svn_io_file_seek(rev_file->file, seek_relative, &end, pool));
+  if (rev_file->mapped_data && seek_relative == APR_END)
+    end = rev_file->mapped_size;
+  else
+    SVN_ERR(svn_io_file_seek(rev_file->file, seek_relative, &end, pool));
 
   if (end < sizeof(buffer))
     {
@@ -630,9 +627,8 @@ get_root_changes_offset(apr_off_t *root_offset,
     }
 
   /* Read in this last block, from which we will identify the last line. */
-  SVN_ERR(aligned_seek(fs, rev_file->file, NULL, start, pool));
-  SVN_ERR(svn_io_file_read_full2(rev_file->file, buffer, len, NULL, NULL,
-                                 pool));
+  SVN_ERR(svn_fs_fs__rev_file_aligned_seek(rev_file, NULL, start, pool));
+  SVN_ERR(svn_fs_fs__rev_file_read(rev_file, buffer, len, pool));
 
   /* Parse the last line. */
   trailer = svn_stringbuf_ncreate(buffer, len, pool);
@@ -746,29 +742,34 @@ typedef struct rep_state_t
   int chunk_index;  /* number of the window to read */
 } rep_state_t;
 
-/* Simple wrapper around svn_io_file_get_offset to simplify callers. */
+/* Simple wrapper around svn_fs_fs__rev_file_offset to simplify callers. */
 static svn_error_t *
 get_file_offset(apr_off_t *offset,
                 rep_state_t *rs,
                 apr_pool_t *pool)
 {
-  return svn_error_trace(svn_io_file_get_offset(offset,
-                                                rs->sfile->rfile->file,
-                                                pool));
+  return svn_error_trace(svn_fs_fs__rev_file_offset(offset, rs->sfile->rfile,
+                                                   pool));
+}
+
+/* Simple wrapper around svn_fs_fs__rev_file_stream to simplify callers. */
+static svn_stream_t *
+rs_stream(rep_state_t *rs)
+{
+  return svn_fs_fs__rev_file_stream(rs->sfile->rfile);
 }
 
-/* Simple wrapper around svn_io_file_aligned_seek to simplify callers. */
+/* Simple wrapper around svn_fs_fs__rev_file_aligned_seek to simplify
+   callers. */
 static svn_error_t *
 rs_aligned_seek(rep_state_t *rs,
                 apr_off_t *buffer_start,
                 apr_off_t offset,
                 apr_pool_t *pool)
 {
-  fs_fs_data_t *ffd = rs->sfile->fs->fsap_data;
-  return svn_error_trace(svn_io_file_aligned_seek(rs->sfile->rfile->file,
-                                                  ffd->block_size,
-                                                  buffer_start, offset,
-                                                  pool));
+  return svn_error_trace(svn_fs_fs__rev_file_aligned_seek(rs->sfile->rfile,
+                                                          buffer_start,
+                                                          offset, pool));
 }
 
 /* Open FILE->FILE and FILE->STREAM if they haven't been opened, yet. */
@@ -809,8 +810,8 @@ auto_read_diff_version(rep_state_t *rs, apr_pool_t *pool)
     {
       char buf[4];
       SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, pool));
-      SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
-                                     sizeof(buf), NULL, NULL, pool));
+      SVN_ERR(svn_fs_fs__rev_file_read(rs->sfile->rfile, buf, sizeof(buf),
+                                       pool));
 
       /* ### Layering violation */
       if (! ((buf[0] == 'S') && (buf[1] == 'V') && (buf[2] == 'N')))
@@ -939,7 +940,7 @@ create_rep_state_body(rep_state_t **rep_state,
                                                result_pool));
         }
 
-      SVN_ERR(svn_fs_fs__read_rep_header(&rh, rs->sfile->rfile->stream,
+      SVN_ERR(svn_fs_fs__read_rep_header(&rh, rs_stream(rs),
                                          result_pool, scratch_pool));
       SVN_ERR(get_file_offset(&rs->start, rs, result_pool));
 
@@ -1422,6 +1423,35 @@ set_cached_combined_window(svn_stringbuf_t *window,
   return SVN_NO_ERROR;
 }
 
+/* Ask the OS to read the data of all representations in LIST as well as
+ * SRC_STATE, unless that is NULL, ahead.  Reconstructing the fulltext will
+ * read windows from all of them in turn, which would otherwise be a
+ * sequence of dependent, random reads on cold caches.  In total, request
+ * no more than MAX_PREFETCH_CHAIN_SIZE bytes.
+ *
+ * Reps whose rev file has not been opened or whose start offset is still
+ * unknown are skipped.  Their headers came from cache, i.e. they have
+ * been read recently and are likely in the OS file cache already.
+ */
+static void
+prefetch_rep_list(apr_array_header_t *list,
+                  rep_state_t *src_state)
+{
+  apr_off_t limit = MAX_PREFETCH_CHAIN_SIZE / (list->nelts + 1);
+  int i;
+
+  for (i = 0; i <= list->nelts; ++i)
+    {
+      rep_state_t *rs = i < list->nelts
+                      ? APR_ARRAY_IDX(list, i, rep_state_t *)
+                      : src_state;
+
+      if (rs && rs->sfile->rfile && rs->start >= 0)
+        svn_fs_fs__rev_file_prefetch(rs->sfile->rfile, rs->start,
+                                     MIN(rs->size, limit));
+    }
+}
+
 /* Build an array of rep_state structures in *LIST giving the delta
    reps from first_rep to a plain-text or self-compressed rep.  Set
    *SRC_STATE to the plain-text rep we find at the end of the chain,
@@ -1430,7 +1460,8 @@ set_cached_combined_window(svn_stringbuf_t *window,
    ID, and representation REP.
    Also, set *WINDOW_P to the base window content for *LIST, if it
    could be found in cache. Otherwise, *LIST will contain the base
-   representation for the whole delta chain. */
+   representation for the whole delta chain.
+   If enabled for FS, ask the OS to read all reps of the chain ahead. */
 static svn_error_t *
 build_rep_list(apr_array_header_t **list,
                svn_stringbuf_t **window_p,
@@ -1439,6 +1470,7 @@ build_rep_list(apr_array_header_t **list,
                representation_t *first_rep,
                apr_pool_t *pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
   representation_t rep;
   rep_state_t *rs = NULL;
   svn_fs_fs__rep_header_t *rep_header;
@@ -1501,6 +1533,12 @@ build_rep_list(apr_array_header_t **list,
     }
   svn_pool_destroy(iterpool);
 
+  /* A single rep will simply be read sequentially.  Also, a base window
+     taken from cache has no data on disk to prefetch. */
+  if (ffd->prefetch_delta_chains
+      && (*list)->nelts + (*src_state && !is_cached ? 1 : 0) > 1)
+    prefetch_rep_list(*list, is_cached ? NULL : *src_state);
+
   return SVN_NO_ERROR;
 }
 
@@ -1602,8 +1640,8 @@ read_delta_window(svn_txdelta_window_t **nwin, int this_chunk,
   while (rs->chunk_index < this_chunk)
     {
       svn_pool_clear(iterpool);
-      SVN_ERR(svn_txdelta_skip_svndiff_window(rs->sfile->rfile->file,
-                                              rs->ver, iterpool));
+      SVN_ERR(svn_fs_fs__rev_file_skip_svndiff_window(rs->sfile->rfile,
+                                                      rs->ver, iterpool));
       rs->chunk_index++;
       SVN_ERR(get_file_offset(&start_offset, rs, iterpool));
       rs->current = start_offset - rs->start;
@@ -1616,7 +1654,7 @@ read_delta_window(svn_txdelta_window_t **nwin, int this_chunk,
   svn_pool_destroy(iterpool);
 
   /* Actually read the next window. */
-  SVN_ERR(svn_txdelta_read_svndiff_window(nwin, rs->sfile->rfile->stream,
+  SVN_ERR(svn_txdelta_read_svndiff_window(nwin, rs_stream(rs),
                                           rs->ver, result_pool));
   SVN_ERR(get_file_offset(&end_offset, rs, scratch_pool));
   rs->current = end_offset - rs->start;
@@ -1651,8 +1689,8 @@ read_plain_window(svn_stringbuf_t **nwin, rep_state_t *rs,
 
   /* Read the plain data. */
   *nwin = svn_stringbuf_create_ensure(size, result_pool);
-  SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, (*nwin)->data, size,
-                                 NULL, NULL, result_pool));
+  SVN_ERR(svn_fs_fs__rev_file_read(rs->sfile->rfile, (*nwin)->data, size,
+                                   result_pool));
   (*nwin)->data[size] = 0;
 
   /* Update RS. */
@@ -1840,8 +1878,8 @@ get_contents_from_windows(struct rep_read_baton *rb,
 
           offset = rs->start + rs->current;
           SVN_ERR(rs_aligned_seek(rs, NULL, offset, rb->pool));
-          SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, cur,
-                                         copy_len, NULL, NULL, rb->pool));
+          SVN_ERR(svn_fs_fs__rev_file_read(rs->sfile->rfile, cur, copy_len,
+                                           rb->pool));
         }
 
       rs->current += copy_len;
@@ -2269,6 +2307,7 @@ svn_fs_fs__get_contents_from_file(svn_stream_t **contents_p,
 {
   struct rep_read_baton *rb;
   pair_cache_key_t fulltext_cache_key = { SVN_INVALID_REVNUM, 0 };
+  fs_fs_data_t *ffd = fs->fsap_data;
   rep_state_t *rs = apr_pcalloc(pool, sizeof(*rs));
   svn_fs_fs__rep_header_t *rh;
 
@@ -2292,12 +2331,14 @@ svn_fs_fs__get_contents_from_file(svn_stream_t **contents_p,
   rs->sfile->fs = fs;
   rs->sfile->rfile = apr_pcalloc(pool, sizeof(*rs->sfile->rfile));
   rs->sfile->rfile->start_revision = SVN_INVALID_REVNUM;
+  rs->sfile->rfile->block_size = ffd->block_size;
   rs->sfile->rfile->file = file;
   rs->sfile->rfile->stream = svn_stream_from_aprfile2(file, TRUE, pool);
 
   /* Read the rep header. */
-  SVN_ERR(aligned_seek(fs, file, NULL, offset, pool));
-  SVN_ERR(svn_fs_fs__read_rep_header(&rh, rs->sfile->rfile->stream,
+  SVN_ERR(svn_fs_fs__rev_file_aligned_seek(rs->sfile->rfile, NULL, offset,
+                                           pool));
+  SVN_ERR(svn_fs_fs__read_rep_header(&rh, rs_stream(rs),
                                      pool, pool));
   SVN_ERR(get_file_offset(&rs->start, rs, pool));
   rs->header_size = rh->header_size;
@@ -3142,20 +3183,22 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
             }
 
           /* Actual reading and parsing are the same, though. */
-          SVN_ERR(aligned_seek(context->fs, context->revision_file->file,
-                               NULL, changes_offset + context->next_offset,
-                               scratch_pool));
+          SVN_ERR(svn_fs_fs__rev_file_aligned_seek(context->revision_file,
+                                                   NULL,
+                                                   changes_offset
+                                                     + context->next_offset,
+                                                   scratch_pool));
 
           SVN_ERR(svn_fs_fs__read_changes(changes,
-                                          context->revision_file->stream,
+                        svn_fs_fs__rev_file_stream(context->revision_file),
                                           SVN_FS_FS__CHANGES_BLOCK_SIZE,
                                           result_pool, scratch_pool));
 
           /* Construct the info object for the entries block we just read. */
           changes_list = apr_pcalloc(scratch_pool, sizeof(*changes_list));
-          SVN_ERR(svn_io_file_get_offset(&changes_list->end_offset,
-                                         context->revision_file->file,
-                                         scratch_pool));
+          SVN_ERR(svn_fs_fs__rev_file_offset(&changes_list->end_offset,
+                                             context->revision_file,
+                                             scratch_pool));
           changes_list->end_offset -= changes_offset;
           changes_list->start_offset = context->next_offset;
           changes_list->count = (*changes)->nelts;
@@ -3331,15 +3374,14 @@ cache_windows(svn_fs_t *fs,
 
           /* navigate to the current window */
           SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
-          SVN_ERR(svn_txdelta__read_raw_window_len(&window_len,
-                                                   rs->sfile->rfile->stream,
+          SVN_ERR(svn_txdelta__read_raw_window_len(&window_len, rs_stream(rs),
                                                    iterpool));
 
           /* Read the raw window. */
           buf = apr_palloc(iterpool, window_len + 1);
           SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
-          SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
-                                         window_len, NULL, NULL, iterpool));
+          SVN_ERR(svn_fs_fs__rev_file_read(rs->sfile->rfile, buf, window_len,
+                                           iterpool));
           buf[window_len] = 0;
 
           /* update relative offset in representation */
@@ -3415,12 +3457,13 @@ block_read_windows(svn_fs_fs__rep_header_t *rep_header,
       /* for larger reps, the header may have crossed a block boundary.
        * make sure we still read blocks properly aligned, i.e. don't use
        * plain seek here. */
-      SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, scratch_pool));
+      SVN_ERR(svn_fs_fs__rev_file_aligned_seek(rev_file, NULL, offset,
+                                               scratch_pool));
 
       plaintext = svn_stringbuf_create_ensure(rs.size, result_pool);
-      SVN_ERR(svn_io_file_read_full2(rev_file->file, plaintext->data,
-                                     rs.size, &plaintext->len, NULL,
-                                     result_pool));
+      SVN_ERR(svn_fs_fs__rev_file_read(rev_file, plaintext->data, rs.size,
+                                       result_pool));
+      plaintext->len = rs.size;
       plaintext->data[plaintext->len] = 0;
       rs.current += rs.size;
 
@@ -3488,7 +3531,8 @@ block_read_contents(svn_fs_t *fs,
   header_key.revision = (apr_int32_t)entry->item.revision;
   header_key.second = entry->item.number;
 
-  SVN_ERR(read_rep_header(&rep_header, fs, rev_file->stream, &header_key,
+  SVN_ERR(read_rep_header(&rep_header, fs,
+                          svn_fs_fs__rev_file_stream(rev_file), &header_key,
                           scratch_pool, scratch_pool));
   SVN_ERR(block_read_windows(rep_header, fs, rev_file, entry, max_offset,
                              scratch_pool, scratch_pool));
@@ -3515,8 +3559,7 @@ read_item(svn_stream_t **stream,
   svn_stringbuf_t *text = svn_stringbuf_create_ensure(entry->size, pool);
   text->len = entry->size;
   text->data[text->len] = 0;
-  SVN_ERR(svn_io_file_read_full2(rev_file->file, text->data, text->len,
-                                 NULL, NULL, pool));
+  SVN_ERR(svn_fs_fs__rev_file_read(rev_file, text->data, text->len, pool));
 
   /* Return (construct, calculate) stream and checksum. */
   *stream = svn_stream_from_stringbuf(text, pool);
@@ -3718,8 +3761,8 @@ block_read(void **result,
                                           ffd->block_size, scratch_pool,
                                           scratch_pool));
 
-      SVN_ERR(aligned_seek(fs, revision_file->file, &block_start, offset,
-                           iterpool));
+      SVN_ERR(svn_fs_fs__rev_file_aligned_seek(revision_file, &block_start,
+                                               offset, iterpool));
 
       /* read all items from the block */
       for (i = 0; i < entries->nelts; ++i)
@@ -3751,8 +3794,8 @@ block_read(void **result,
                             && entry->size < ffd->block_size))
             {
               void *item = NULL;
-              SVN_ERR(svn_io_file_seek(revision_file->file, APR_SET,
-                                       &entry->offset, iterpool));
+              SVN_ERR(svn_fs_fs__rev_file_seek(revision_file, entry->offset,
+                                               iterpool));
               switch (entry->type)
                 {
                   case SVN_FS_FS__ITEM_TYPE_FILE_REP:
@@ -30,11 +30,13 @@
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_config.h"
+#include "svn_dirent_uri.h"
 #include "svn_cache_config.h"
 
 #include "svn_private_config.h"
 #include "svn_hash.h"
 #include "svn_pools.h"
+#include "svn_version.h"
 
 #include "private/svn_debug.h"
 #include "private/svn_subr_private.h"
@@ -232,6 +234,37 @@ dump_global_cache_statistics(void *baton_void)
   return APR_SUCCESS;
 }
 
+static apr_status_t
+dump_dag_cache_statistics(void *baton_void)
+{
+  fs_fs_data_t *ffd = baton_void;
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  svn_cache__info_t info;
+  svn_string_t *text_stats;
+  apr_array_header_t *lines;
+  int i;
+
+  svn_fs_fs__get_dag_cache_info(&info, ffd->dag_node_cache);
+  if (info.gets > 0 || info.sets > 0)
+    {
+      text_stats = svn_cache__format_info(&info, TRUE, pool);
+      lines = svn_cstring_split(text_stats->data, "\n", FALSE, pool);
+
+      for (i = 0; i < lines->nelts; ++i)
+        {
+          const char *line = APR_ARRAY_IDX(lines, i, const char *);
+#ifdef SVN_DEBUG
+          SVN_DBG(("%s\n", line));
+#endif
+        }
+    }
+
+  svn_pool_destroy(pool);
+
+  return APR_SUCCESS;
+}
+
 #endif /* SVN_DEBUG_CACHE_DUMP_STATS */
 
 /* This function sets / registers the required callbacks for a given
@@ -346,6 +379,92 @@ create_cache(svn_cache__t **cache_p,
   return SVN_NO_ERROR;
 }
 
+/* If FS has been configured to use a persistent cache tier and
+ * HAS_NAMESPACE is FALSE, open the respective store and return it in
+ * *STORE.  Set *STORE to NULL otherwise.  The tier is optional, so any
+ * failure to open the store, e.g. due to missing write permissions,
+ * simply disables it.  Use POOL for temporary allocations.
+ */
+static void
+open_persistent_store(svn_cache__persistent_t **store,
+                      svn_fs_t *fs,
+                      svn_boolean_t has_namespace,
+                      apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *guard;
+  svn_error_t *err;
+
+  *store = NULL;
+
+  /* Contents of namespaced caches is meant to be short-lived. */
+  if (ffd->persistent_cache_size == 0 || has_namespace)
+    return;
+
+  /* Without an instance ID, we can't tell a restored or replaced
+   * repository from the original one and might serve stale data. */
+  if (ffd->format < SVN_FS_FS__MIN_INSTANCE_ID_FORMAT)
+    return;
+
+  /* Anything that might invalidate the stored data must be part of the
+   * guard: the repository identity, the on-disk format and the layout
+   * of the serialized objects.  The latter are raw memory images, i.e.
+   * they also depend on the pointer size and byte order of the build as
+   * well as on the Subversion release that wrote them.  Servers of
+   * different builds sharing the repository will reset the store and
+   * never accept each other's entries. */
+  guard = apr_psprintf(pool, "%s:%s:%d:%d:%s:%d:%s",
+                       fs->uuid, ffd->instance_id, ffd->format,
+                       SVN_FS_FS__SERIALIZER_VERSION, SVN_VER_NUMBER,
+                       (int)sizeof(void *),
+                       APR_IS_BIGENDIAN ? "be" : "le");
+  err = svn_cache__persistent_open(store,
+                                   svn_dirent_join(fs->path,
+                                                   PATH_PERSISTENT_CACHE,
+                                                   pool),
+                                   ffd->persistent_cache_size, guard, pool);
+
+  /* This may be called while the FS is still being opened, i.e. before
+   * the user had a chance to install a warning handler.  Don't report
+   * anything as the default handler would abort the process. */
+  if (err)
+    {
+      svn_error_clear(err);
+      *store = NULL;
+    }
+}
+
+/* If both, *CACHE_P and STORE are not NULL, replace *CACHE_P with a cache
+ * that uses STORE as its second tier.  SERIALIZER, DESERIALIZER and KLEN
+ * must match those used for *CACHE_P.  PREFIX identifies the cache within
+ * STORE.  Error handling follows the same rules as in create_cache().
+ * Allocate the result in RESULT_POOL.
+ */
+static svn_error_t *
+add_persistent_tier(svn_cache__t **cache_p,
+                    svn_cache__persistent_t *store,
+                    svn_cache__serialize_func_t serializer,
+                    svn_cache__deserialize_func_t deserializer,
+                    apr_ssize_t klen,
+                    const char *prefix,
+                    svn_fs_t *fs,
+                    svn_boolean_t no_handler,
+                    apr_pool_t *result_pool)
+{
+  if (*cache_p == NULL || store == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_cache__create_persistent(cache_p, *cache_p, store,
+                                       serializer, deserializer, klen,
+                                       prefix, result_pool));
+  SVN_ERR(init_callbacks(*cache_p, fs,
+                         no_handler ? NULL
+                                    : warn_and_continue_on_cache_errors,
+                         result_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__initialize_caches(svn_fs_t *fs,
                              apr_pool_t *pool)
@@ -357,6 +476,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                                    ":",
                                    SVN_VA_NULL);
   svn_membuffer_t *membuffer;
+  svn_cache__persistent_t *store;
   svn_boolean_t no_handler = ffd->fail_stop;
   svn_boolean_t cache_txdeltas;
   svn_boolean_t cache_fulltexts;
@@ -376,6 +496,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   has_namespace = strlen(cache_namespace) > 0;
 
   membuffer = svn_cache__get_global_membuffer_cache();
+  open_persistent_store(&store, fs, has_namespace, pool);
 
   /* General rules for assigning cache priorities:
    *
@@ -438,6 +559,11 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_fs__create_dag_cache(fs->pool);
 
+#ifdef SVN_DEBUG_CACHE_DUMP_STATS
+  apr_pool_cleanup_register(fs->pool, ffd, dump_dag_cache_statistics,
+                            apr_pool_cleanup_null);
+#endif
+
   /* Very rough estimate: 1K per directory. */
   SVN_ERR(create_cache(&(ffd->dir_cache),
                        NULL,
@@ -452,6 +578,11 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_tier(&(ffd->dir_cache), store,
+                              svn_fs_fs__serialize_dir_entries,
+                              svn_fs_fs__deserialize_dir_entries,
+                              sizeof(pair_cache_key_t), "DIR",
+                              fs, no_handler, fs->pool));
 
   /* 8 kBytes per entry (1000 revs / shared, one file offset per rev).
      Covering about 8 pack files gives us an "o.k." hit rate. */
@@ -484,6 +615,11 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_tier(&(ffd->node_revision_cache), store,
+                              svn_fs_fs__serialize_node_revision,
+                              svn_fs_fs__deserialize_node_revision,
+                              sizeof(pair_cache_key_t), "NODEREVS",
+                              fs, no_handler, fs->pool));
 
   /* initialize representation header cache, if caching has been enabled */
   SVN_ERR(create_cache(&(ffd->rep_header_cache),
@@ -546,6 +682,10 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+      SVN_ERR(add_persistent_tier(&(ffd->fulltext_cache), store,
+                                  NULL, NULL,
+                                  sizeof(pair_cache_key_t), "TEXT",
+                                  fs, no_handler, fs->pool));
 
       SVN_ERR(create_cache(&(ffd->mergeinfo_cache),
                            NULL,
@@ -654,6 +794,11 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+      SVN_ERR(add_persistent_tier(&(ffd->combined_window_cache), store,
+                                  NULL, NULL,
+                                  sizeof(window_cache_key_t),
+                                  "COMBINED_WINDOW",
+                                  fs, no_handler, fs->pool));
     }
   else
     {
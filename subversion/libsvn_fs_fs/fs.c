@@ -48,6 +48,7 @@
 #include "svn_private_config.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fs_fs_private.h"
+#include "private/svn_io_private.h"
 
 #include "../libsvn_fs/fs-loader.h"
 
@@ -124,6 +125,10 @@ fs_serialized_init(svn_fs_t *fs, apr_pool_t *common_pool, apr_pool_t *pool)
          transaction list and free transaction pointer. */
       SVN_ERR(svn_mutex__init(&ffsd->txn_list_lock, TRUE, common_pool));
 
+      /* The rep-cache filter may be used by several threads at once. */
+      SVN_ERR(svn_mutex__init(&ffsd->rep_cache_filter_lock, TRUE,
+                              common_pool));
+
       key = apr_pstrdup(common_pool, key);
       status = apr_pool_userdata_set(ffsd, key, NULL, common_pool);
       if (status)
@@ -319,6 +324,7 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           SVN_ERR(svn_fs_fs__build_rep_cache(fs,
                                              input->start_rev,
                                              input->end_rev,
+                                             input->jobs,
                                              input->progress_func,
                                              input->progress_baton,
                                              cancel_func,
@@ -446,6 +452,36 @@ fs_open(svn_fs_t *fs,
 
 
 
+svn_error_t *
+svn_fs_fs__open_sibling(svn_fs_t **sibling_p,
+                        svn_fs_t *fs,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_data_t *sibling_ffd;
+  svn_fs_t *sibling = apr_pcalloc(result_pool, sizeof(*sibling));
+
+  sibling->pool = result_pool;
+  sibling->warning = fs->warning;
+  sibling->warning_baton = fs->warning_baton;
+  sibling->config = fs->config ? apr_hash_copy(result_pool, fs->config)
+                               : NULL;
+
+  SVN_ERR(initialize_fs_struct(sibling));
+  SVN_ERR(svn_fs_fs__open(sibling, fs->path, scratch_pool));
+  SVN_ERR(svn_fs_fs__initialize_caches(sibling, scratch_pool));
+
+  /* Same UUID and instance ID, thus the same shared data. */
+  sibling_ffd = sibling->fsap_data;
+  sibling_ffd->shared = ffd->shared;
+
+  *sibling_p = sibling;
+  return SVN_NO_ERROR;
+}
+
+
+
 /* This implements the fs_library_vtable_t.open_for_recovery() API. */
 static svn_error_t *
 fs_open_for_recovery(svn_fs_t *fs,
@@ -705,6 +741,8 @@ svn_fs_fs__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(fs_version(), checklist, svn_ver_equal));
 
+  SVN_ERR(svn_io__batch_fsync_init(common_pool));
+
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
 }
@@ -78,6 +78,7 @@ extern "C" {
                                                     to-log index */
 /* If you change this, look at tests/svn_test_fs.c(maybe_install_fsfs_conf) */
 #define PATH_CONFIG           "fsfs.conf"        /* Configuration */
+#define PATH_PERSISTENT_CACHE "persistent-cache" /* On-disk cache tier */
 
 /* Names of special files and file extensions for transactions */
 #define PATH_CHANGES       "changes"       /* Records changes made so far */
@@ -100,8 +101,10 @@ extern "C" {
 /* Names of sections and options in fsfs.conf. */
 #define CONFIG_SECTION_CACHES            "caches"
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
+#define CONFIG_OPTION_PERSISTENT_CACHE_SIZE "persistent-cache-size"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
+#define CONFIG_OPTION_REP_CACHE_FILTER   "rep-cache-filter"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
 #define CONFIG_OPTION_ENABLE_DIR_DELTIFICATION   "enable-dir-deltification"
 #define CONFIG_OPTION_ENABLE_PROPS_DELTIFICATION "enable-props-deltification"
@@ -115,10 +118,15 @@ extern "C" {
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_OPTION_PACK_THREADS       "pack-threads"
+#define CONFIG_OPTION_HOTCOPY_THREADS    "hotcopy-threads"
+#define CONFIG_OPTION_MMAP_PACK_FILES    "mmap-pack-files"
+#define CONFIG_OPTION_PREFETCH_DELTA_CHAINS "prefetch-delta-chains"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 #define CONFIG_OPTION_VERIFY_BEFORE_COMMIT "verify-before-commit"
 #define CONFIG_OPTION_COMPRESSION        "compression"
+#define CONFIG_OPTION_COMPRESSION_THREADS "compression-threads"
 
 /* The format number of this filesystem.
    This is independent of the repository format number, and
@@ -239,6 +247,13 @@ typedef struct fs_fs_shared_txn_data_t
   apr_pool_t *pool;
 } fs_fs_shared_txn_data_t;
 
+/* In-memory filter of the keys in the rep-cache database. */
+typedef struct fs_fs_rep_cache_filter_t fs_fs_rep_cache_filter_t;
+
+/* Changes to the rep-cache made while a new filter is being built. */
+typedef struct fs_fs_rep_cache_filter_updates_t
+  fs_fs_rep_cache_filter_updates_t;
+
 /* Private FSFS-specific data shared between all svn_fs_t objects that
    relate to a particular filesystem, as identified by filesystem UUID.
    Objects of this type are allocated in the common pool. */
@@ -275,6 +290,18 @@ typedef struct fs_fs_shared_data_t
      txn-current file. */
   svn_mutex__t *txn_current_lock;
 
+  /* Filter telling which SHA1 keys are definitely not in the rep-cache,
+     or NULL if it has not been built, yet.  All access is synchronised
+     under REP_CACHE_FILTER_LOCK, which is independent of the locks
+     above.  The filter lives in its own root pool.
+
+     A new filter gets built without holding the lock.  Meanwhile,
+     REP_CACHE_FILTER_UPDATES collects the changes that the new filter
+     will have to catch up with; it is NULL if no build is in progress. */
+  fs_fs_rep_cache_filter_t *rep_cache_filter;
+  fs_fs_rep_cache_filter_updates_t *rep_cache_filter_updates;
+  svn_mutex__t *rep_cache_filter_lock;
+
   /* The common pool, under which this object is allocated, subpools
      of which are used to allocate the transaction objects. */
   apr_pool_t *common_pool;
@@ -283,6 +310,9 @@ typedef struct fs_fs_shared_data_t
 /* Data structure for the 1st level DAG node cache. */
 typedef struct fs_fs_dag_cache_t fs_fs_dag_cache_t;
 
+/* Memory mappings of pack files, kept for re-use across revision files. */
+typedef struct fs_fs_pack_mappings_t fs_fs_pack_mappings_t;
+
 /* Key type for all caches that use revision + offset / counter as key.
 
    Note: Cache keys should be 16 bytes for best performance and there
@@ -360,6 +390,9 @@ typedef struct fs_fs_data_t
      e.g. memcached may be ignored as caching is an optional feature. */
   svn_boolean_t fail_stop;
 
+  /* Size of the on-disk cache tier in bytes.  0 disables it. */
+  apr_uint64_t persistent_cache_size;
+
   /* A cache of revision root IDs, mapping from (svn_revnum_t *) to
      (svn_fs_id_t *).  (Not threadsafe.) */
   svn_cache__t *rev_root_id_cache;
@@ -465,6 +498,10 @@ typedef struct fs_fs_data_t
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
+  /* Whether REP_CACHE_DB has the table recording the youngest fully
+     indexed revision.  Only valid once REP_CACHE_DB has been set. */
+  svn_boolean_t rep_cache_has_built_rev;
+
   /* The oldest revision not in a pack file.  It also applies to revprops
    * if revprop packing has been enabled by the FSFS format version. */
   svn_revnum_t min_unpacked_rev;
@@ -473,6 +510,10 @@ typedef struct fs_fs_data_t
    * and allowed by the configuration. */
   svn_boolean_t rep_sharing_allowed;
 
+  /* Whether to consult an in-memory filter before looking up keys in the
+   * rep-cache database. */
+  svn_boolean_t use_rep_cache_filter;
+
   /* File size limit in bytes up to which multiple revprops shall be packed
    * into a single file. */
   apr_int64_t revprop_pack_size;
@@ -499,6 +540,30 @@ typedef struct fs_fs_data_t
   /* Compression level (currently, only used with compression_type_zlib). */
   int delta_compression_level;
 
+  /* Maximum number of delta windows to compress concurrently when writing
+     a single representation.  1 disables concurrent compression. */
+  int delta_compression_threads;
+
+  /* Maximum number of shards to pack concurrently.  1 packs them one
+     after another. */
+  int pack_threads;
+
+  /* Maximum number of shards to copy concurrently when this repository
+     is the source of a hotcopy.  1 copies them one after another. */
+  int hotcopy_threads;
+
+  /* Read pack files through a read-only memory mapping instead of
+     buffered file I/O. */
+  svn_boolean_t mmap_pack_files;
+
+  /* The pack files currently mapped into memory for this filesystem
+     object.  NULL until the first one gets mapped. */
+  fs_fs_pack_mappings_t *pack_mappings;
+
+  /* Ask the OS to read all representations of a delta chain ahead
+     before reconstructing a fulltext from them. */
+  svn_boolean_t prefetch_delta_chains;
+
   /* Pack after every commit. */
   svn_boolean_t pack_after_commit;
 
@@ -46,8 +46,10 @@
 
 #include "private/svn_fs_util.h"
 #include "private/svn_io_private.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_jobs.h"
 #include "../libsvn_fs/fs-loader.h"
 
 /* The default maximum number of files per directory to store in the
@@ -748,6 +750,7 @@ read_config(fs_fs_data_t *ffd,
             apr_pool_t *scratch_pool)
 {
   svn_config_t *config;
+  apr_int64_t hotcopy_threads;
 
   SVN_ERR(svn_config_read3(&config,
                            svn_dirent_join(fs_path, PATH_CONFIG, scratch_pool),
@@ -755,11 +758,19 @@ read_config(fs_fs_data_t *ffd,
 
   /* Initialize ffd->rep_sharing_allowed. */
   if (ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT)
-    SVN_ERR(svn_config_get_bool(config, &ffd->rep_sharing_allowed,
-                                CONFIG_SECTION_REP_SHARING,
-                                CONFIG_OPTION_ENABLE_REP_SHARING, TRUE));
+    {
+      SVN_ERR(svn_config_get_bool(config, &ffd->rep_sharing_allowed,
+                                  CONFIG_SECTION_REP_SHARING,
+                                  CONFIG_OPTION_ENABLE_REP_SHARING, TRUE));
+      SVN_ERR(svn_config_get_bool(config, &ffd->use_rep_cache_filter,
+                                  CONFIG_SECTION_REP_SHARING,
+                                  CONFIG_OPTION_REP_CACHE_FILTER, FALSE));
+    }
   else
-    ffd->rep_sharing_allowed = FALSE;
+    {
+      ffd->rep_sharing_allowed = FALSE;
+      ffd->use_rep_cache_filter = FALSE;
+    }
 
   /* Initialize deltification settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
@@ -851,16 +862,37 @@ read_config(fs_fs_data_t *ffd,
 
   if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
     {
+      apr_int64_t pack_threads;
+
       SVN_ERR(svn_config_get_bool(config, &ffd->pack_after_commit,
                                   CONFIG_SECTION_DEBUG,
                                   CONFIG_OPTION_PACK_AFTER_COMMIT,
                                   FALSE));
+      SVN_ERR(svn_config_get_int64(config, &pack_threads,
+                                   CONFIG_SECTION_IO,
+                                   CONFIG_OPTION_PACK_THREADS, 1));
+      ffd->pack_threads = (int)MIN(MAX(1, pack_threads), 64);
+      SVN_ERR(svn_config_get_bool(config, &ffd->mmap_pack_files,
+                                  CONFIG_SECTION_IO,
+                                  CONFIG_OPTION_MMAP_PACK_FILES,
+                                  FALSE));
     }
   else
     {
       ffd->pack_after_commit = FALSE;
+      ffd->pack_threads = 1;
+      ffd->mmap_pack_files = FALSE;
     }
 
+  SVN_ERR(svn_config_get_int64(config, &hotcopy_threads,
+                               CONFIG_SECTION_IO,
+                               CONFIG_OPTION_HOTCOPY_THREADS, 1));
+  ffd->hotcopy_threads = (int)MIN(MAX(1, hotcopy_threads), 64);
+  SVN_ERR(svn_config_get_bool(config, &ffd->prefetch_delta_chains,
+                              CONFIG_SECTION_IO,
+                              CONFIG_OPTION_PREFETCH_DELTA_CHAINS,
+                              TRUE));
+
   /* Initialize compression settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
@@ -926,6 +958,21 @@ read_config(fs_fs_data_t *ffd,
       ffd->delta_compression_level = SVN_DELTA_COMPRESSION_LEVEL_NONE;
     }
 
+  /* Concurrent compression only makes a difference with compression. */
+  if (ffd->delta_compression_type != compression_type_none)
+    {
+      apr_int64_t compression_threads;
+      SVN_ERR(svn_config_get_int64(config, &compression_threads,
+                                   CONFIG_SECTION_DELTIFICATION,
+                                   CONFIG_OPTION_COMPRESSION_THREADS, 1));
+      ffd->delta_compression_threads
+        = (int)MIN(MAX(1, compression_threads), 64);
+    }
+  else
+    {
+      ffd->delta_compression_threads = 1;
+    }
+
 #ifdef SVN_DEBUG
   SVN_ERR(svn_config_get_bool(config, &ffd->verify_before_commit,
                               CONFIG_SECTION_DEBUG,
@@ -946,6 +993,17 @@ read_config(fs_fs_data_t *ffd,
                               CONFIG_SECTION_CACHES, CONFIG_OPTION_FAIL_STOP,
                               FALSE));
 
+  {
+    apr_int64_t persistent_cache_size;
+    SVN_ERR(svn_config_get_int64(config, &persistent_cache_size,
+                                 CONFIG_SECTION_CACHES,
+                                 CONFIG_OPTION_PERSISTENT_CACHE_SIZE, 0));
+    ffd->persistent_cache_size
+      = persistent_cache_size > 0
+      ? (apr_uint64_t)MIN(persistent_cache_size, 0x100000) * 0x100000
+      : 0;
+  }
+
   return SVN_NO_ERROR;
 }
 
@@ -979,6 +1037,17 @@ write_config(svn_fs_t *fs,
 "### Subversion never ignore cache errors, uncomment this line."             NL
 "# " CONFIG_OPTION_FAIL_STOP " = true"                                       NL
 ""                                                                           NL
+"### A persistent cache tier keeps expensive-to-reconstruct data, i.e."      NL
+"### fulltexts, combined delta windows, directories and node revisions,"     NL
+"### in a memory-mapped file in the db directory.  Its contents survive"     NL
+"### server restarts and are shared by all processes accessing this"         NL
+"### repository.  Set the size of that file in MB to enable the feature."    NL
+"### Processes that may not write to that file only read from it.  The"     NL
+"### file gets fully allocated upon creation.  Repositories with formats"    NL
+"### older than 7 will not use this feature."                                NL
+"### persistent-cache-size is 0 (disabled) by default."                      NL
+"# " CONFIG_OPTION_PERSISTENT_CACHE_SIZE " = 0"                              NL
+""                                                                           NL
 "[" CONFIG_SECTION_REP_SHARING "]"                                           NL
 "### To conserve space, the filesystem can optionally avoid storing"         NL
 "### duplicate representations.  This comes at a slight cost in"             NL
@@ -994,6 +1063,22 @@ write_config(svn_fs_t *fs,
 "### 'svnadmin verify' will check the rep-cache regardless of this setting." NL
 "### rep-sharing is enabled by default."                                     NL
 "# " CONFIG_OPTION_ENABLE_REP_SHARING " = true"                              NL
+"###"                                                                        NL
+"### Every new representation is looked up in the rep-cache database.  For"  NL
+"### very large databases, these lookups become a significant part of the"  NL
+"### commit time.  Enabling the following option makes the server keep a"   NL
+"### compact in-memory filter of all keys in the database, which answers"    NL
+"### most lookups for new contents without touching the database.  The"      NL
+"### filter takes 2.5 to 5 bytes per entry but at least 128 kBytes.  It is"  NL
+"### shared by all threads of a process and is built by reading the whole"   NL
+"### database when it is first needed.  Once it has filled up, one thread"   NL
+"### builds a new filter while the others keep using the old one.  Commits"  NL
+"### made by other processes are picked up from the database as soon as"     NL
+"### the filter gets used again, or by rebuilding the filter if there are"   NL
+"### more than 1000 of them.  This works best with long-running, threaded"   NL
+"### servers."                                                               NL
+"### rep-cache-filter is disabled by default."                               NL
+"# " CONFIG_OPTION_REP_CACHE_FILTER " = false"                               NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DELTIFICATION "]"                                         NL
 "### To conserve space, the filesystem stores data as differences against"   NL
@@ -1080,6 +1165,17 @@ write_config(svn_fs_t *fs,
 "### still be used (and it will result in zlib compression with the"         NL
 "### corresponding compression level)."                                      NL
 "###   " CONFIG_OPTION_COMPRESSION_LEVEL " = 0 ... 9 (default is 5)"         NL
+"###"                                                                        NL
+"### Large files are stored as a sequence of delta windows of about 100 kB"  NL
+"### each.  This setting allows up to the given number of windows to be"     NL
+"### compressed concurrently on separate threads while the file is being"    NL
+"### written.  The stored data is the same as with serial compression."      NL
+"### Higher values speed up commits of large files on multi-core servers"    NL
+"### at the expense of additional CPU load and memory usage per commit."     NL
+"### Values up to 64 are supported.  It has no effect if compression is"     NL
+"### disabled or if Subversion has been built without thread support."       NL
+"### compression-threads is 1 (concurrent compression disabled) by default." NL
+"# " CONFIG_OPTION_COMPRESSION_THREADS " = 1"                                NL
 ""                                                                           NL
 "[" CONFIG_SECTION_PACKED_REVPROPS "]"                                       NL
 "### This parameter controls the size (in kBytes) of packed revprop files."  NL
@@ -1148,6 +1244,45 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+"###"                                                                        NL
+"### Packing a shard is largely independent from packing other shards."      NL
+"### Set this to a value larger than 1 to pack several shards concurrently"  NL
+"### when running 'svnadmin pack', e.g. after upgrading to a format 7"       NL
+"### repository.  The memory used for reordering items is shared between"    NL
+"### these threads.  Revision properties and the switch-over to the"         NL
+"### packed shards are still processed one shard at a time and in order."    NL
+"### pack-threads is 1 (concurrent packing disabled) by default."            NL
+"# " CONFIG_OPTION_PACK_THREADS " = 1"                                       NL
+"###"                                                                        NL
+"### 'svnadmin hotcopy' may copy several shards of a sharded repository"     NL
+"### concurrently.  This is worthwhile on storage that performs well with"   NL
+"### parallel I/O.  The 'current' file of the hotcopy is still updated in"   NL
+"### revision order such that an interrupted hotcopy can be resumed."        NL
+"### This setting is taken from the hotcopy source.  hotcopy-threads is"     NL
+"### 1 (concurrent copying disabled) by default."                            NL
+"# " CONFIG_OPTION_HOTCOPY_THREADS " = 1"                                    NL
+"###"                                                                        NL
+"### Pack files never change once they have been written.  Enabling this"    NL
+"### option lets readers map them into memory instead of using buffered"     NL
+"### file I/O, which saves a copy of every block read and lets concurrent"   NL
+"### readers share the OS file cache pages directly.  Each open"             NL
+"### filesystem keeps up to 64 pack files mapped for re-use.  On 32 bit"     NL
+"### systems, only pack files up to 256 MB and no more than 512 MB in"       NL
+"### total will be mapped.  If a mapping cannot be created, the file will"   NL
+"### be read as usual."                                                      NL
+"### mmap-pack-files is false by default."                                   NL
+"# " CONFIG_OPTION_MMAP_PACK_FILES " = false"                                NL
+"###"                                                                        NL
+"### Reconstructing a file's contents reads delta windows from every"        NL
+"### representation in its delta chain in turn.  With cold caches, these"   NL
+"### are many dependent random reads.  When this option is enabled, the OS"  NL
+"### is asked to read the start of all representations of the chain in"      NL
+"### the background as soon as the chain is known, such that the reads may"  NL
+"### overlap.  At most 2 MB are requested per chain.  This helps most"       NL
+"### with spinning disks and network storage.  It has no effect on"          NL
+"### platforms that don't support read-ahead hints."                         NL
+"### prefetch-delta-chains is true by default."                              NL
+"# " CONFIG_OPTION_PREFETCH_DELTA_CHAINS " = true"                           NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DEBUG "]"                                                 NL
 "###"                                                                        NL
@@ -2368,15 +2503,16 @@ ensure_representation_sha1(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* Recursively index (in the rep-cache) the filesystem node with the
- * given ID, located in revision REV and its matching REV_FILE (if the
- * node ID cannot be found in this revision, do nothing).
- * Compute the SHA1 checksum of the node's representation and add
- * a corresponding entry to the repository's rep-cache.
+/* Recursively collect the representations to add to the rep-cache for
+ * the filesystem node with the given ID, located in revision REV and its
+ * matching REV_FILE (if the node ID cannot be found in this revision, do
+ * nothing).  Compute the SHA1 checksum of the node's representation and
+ * append a copy of it to REPS, allocated in the pool of REPS.
  * If the node represents a directory this function will recurse and
  * index all children of this directory as well. */
 static svn_error_t *
-reindex_node(svn_fs_t *fs,
+reindex_node(apr_array_header_t *reps,
+             svn_fs_t *fs,
              const svn_fs_id_t *id,
              svn_revnum_t rev,
              svn_fs_fs__revision_file_t *rev_file,
@@ -2427,7 +2563,7 @@ reindex_node(svn_fs_t *fs,
 
               dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
 
-              SVN_ERR(reindex_node(fs, dirent->id, rev, rev_file,
+              SVN_ERR(reindex_node(reps, fs, dirent->id, rev, rev_file,
                                    cancel_func, cancel_baton, iterpool));
             }
           svn_pool_destroy(iterpool);
@@ -2438,22 +2574,334 @@ reindex_node(svn_fs_t *fs,
       noderev->kind == svn_node_file)
     {
       SVN_ERR(ensure_representation_sha1(fs, noderev->data_rep, pool));
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, noderev->data_rep, pool));
+      APR_ARRAY_PUSH(reps, representation_t *)
+        = svn_fs_fs__rep_copy(noderev->data_rep, reps->pool);
     }
 
   if (noderev->prop_rep && noderev->prop_rep->revision == rev)
     {
       SVN_ERR(ensure_representation_sha1(fs, noderev->prop_rep, pool));
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, noderev->prop_rep, pool));
+      APR_ARRAY_PUSH(reps, representation_t *)
+        = svn_fs_fs__rep_copy(noderev->prop_rep, reps->pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Number of revisions whose representations get collected by a single
+ * job and added to the rep-cache in a single SQLite transaction. */
+#define BUILD_REP_CACHE_BATCH_SIZE 64
+
+/* Append the representations of revisions START_REV through END_REV in
+ * FS that shall be added to the rep-cache to REPS.  Allocate them in the
+ * pool of REPS.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+collect_rep_references(apr_array_header_t *reps,
+                       svn_fs_t *fs,
+                       svn_revnum_t start_rev,
+                       svn_revnum_t end_rev,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_revnum_t rev;
+
+  for (rev = start_rev; rev <= end_rev; rev++)
+    {
+      svn_fs_id_t *root_id;
+      svn_fs_fs__revision_file_t *file;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&file, fs, rev,
+                                               iterpool, iterpool));
+      SVN_ERR(svn_fs_fs__rev_get_root(&root_id, fs, rev, iterpool, iterpool));
+      SVN_ERR(reindex_node(reps, fs, root_id, rev, file,
+                           cancel_func, cancel_baton, iterpool));
+      SVN_ERR(svn_fs_fs__close_revision_file(file));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Add REPS, collected from revisions START_REV through END_REV in FS, to
+ * the rep-cache.  *BUILT_REV is the youngest revision up to which the
+ * rep-cache is known to be complete; advance it if this range continues
+ * the complete part.  Indicate progress via the optional PROGRESS_FUNC
+ * callback using PROGRESS_BATON.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+store_rep_references(svn_fs_t *fs,
+                     apr_array_header_t *reps,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     svn_revnum_t *built_rev,
+                     svn_fs_progress_notify_func_t progress_func,
+                     void *progress_baton,
+                     apr_pool_t *scratch_pool)
+{
+  svn_revnum_t new_built_rev = SVN_INVALID_REVNUM;
+  svn_revnum_t rev;
+
+  if (start_rev <= *built_rev + 1 && end_rev > *built_rev)
+    new_built_rev = end_rev;
+
+  SVN_ERR(svn_fs_fs__set_rep_references(fs, reps, new_built_rev,
+                                        scratch_pool));
+  if (SVN_IS_VALID_REVNUM(new_built_rev))
+    *built_rev = new_built_rev;
+
+  if (progress_func)
+    for (rev = start_rev; rev <= end_rev; rev++)
+      progress_func(rev, progress_baton, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+struct build_jobs_baton_t;
+
+/* The representations of a range of revisions, collected by one of the
+ * worker threads. */
+typedef struct build_job_t
+{
+  /* Private root pool of this job. */
+  apr_pool_t *pool;
+
+  /* The revisions to process. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* The representation_t * collected, allocated in POOL. */
+  apr_array_header_t *reps;
+
+  /* The context that this job belongs to. */
+  struct build_jobs_baton_t *jb;
+} build_job_t;
+
+/* A filesystem object for exclusive use by a single worker thread.
+ * Instances get re-used by later jobs. */
+typedef struct build_fs_t
+{
+  /* Root pool owning this structure and FS. */
+  apr_pool_t *pool;
+
+  /* The filesystem object.  NULL until opened by the first job. */
+  svn_fs_t *fs;
+
+  /* Next unused instance. */
+  struct build_fs_t *next;
+} build_fs_t;
+
+/* Context of a concurrent build-repcache run. */
+typedef struct build_jobs_baton_t
+{
+  /* The filesystem being indexed.  Only used to create siblings from. */
+  svn_fs_t *fs;
+
+  /* Jobs in revision order. */
+  svn_thread__jobs_t *jobs;
+
+  /* Filesystem objects not currently used by any job.
+   * Protected by the mutex of JOBS. */
+  build_fs_t *idle_fs;
+} build_jobs_baton_t;
+
+/* Return BFS to the unused filesystem objects in JB. */
+static svn_error_t *
+release_build_fs(build_jobs_baton_t *jb,
+                 build_fs_t *bfs)
+{
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(jb->jobs);
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  bfs->next = jb->idle_fs;
+  jb->idle_fs = bfs;
+
+  return svn_error_trace(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+}
+
+/* Implements svn_thread__job_func_t:  Collect the representations of the
+ * revisions given by the build_job_t BATON using a filesystem object of
+ * its own. */
+static svn_error_t *
+build_job(void *baton,
+          apr_pool_t *pool)
+{
+  build_job_t *job = baton;
+  build_jobs_baton_t *jb = job->jb;
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(jb->jobs);
+  build_fs_t *bfs;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  bfs = jb->idle_fs;
+  if (bfs)
+    jb->idle_fs = bfs->next;
+  SVN_ERR(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+
+  if (!bfs)
+    {
+      apr_pool_t *bfs_pool = svn_pool_create(NULL);
+      bfs = apr_pcalloc(bfs_pool, sizeof(*bfs));
+      bfs->pool = bfs_pool;
     }
 
+  if (!bfs->fs)
+    {
+      err = svn_fs_fs__open_sibling(&bfs->fs, jb->fs, bfs->pool, pool);
+      if (err)
+        bfs->fs = NULL;
+    }
+
+  if (!err)
+    err = collect_rep_references(job->reps, bfs->fs, job->start_rev,
+                                 job->end_rev, svn_thread__jobs_cancel_func,
+                                 jb->jobs, pool);
+
+  /* Let the next job use BFS. */
+  return svn_error_compose_create(err, release_build_fs(jb, bfs));
+}
+
+/* Queue revisions START_REV through END_REV for collection in JB. */
+static svn_error_t *
+push_build_job(build_jobs_baton_t *jb,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev)
+{
+  apr_pool_t *job_pool = svn_pool_create(NULL);
+  build_job_t *job = apr_pcalloc(job_pool, sizeof(*job));
+
+  job->pool = job_pool;
+  job->start_rev = start_rev;
+  job->end_rev = end_rev;
+  job->reps = apr_array_make(job_pool, 64, sizeof(representation_t *));
+  job->jb = jb;
+
+  return svn_error_trace(svn_thread__jobs_push(jb->jobs, build_job, job,
+                                               job_pool));
+}
+
+/* Wait for the oldest job in JB to complete and add its representations
+ * to the rep-cache of JB->FS, just like the serial code would.  Remove
+ * the job from JB.  BUILT_REV, PROGRESS_FUNC and PROGRESS_BATON are as
+ * for store_rep_references().  Use POOL for temporaries. */
+static svn_error_t *
+finalize_oldest_build_job(build_jobs_baton_t *jb,
+                          svn_revnum_t *built_rev,
+                          svn_fs_progress_notify_func_t progress_func,
+                          void *progress_baton,
+                          apr_pool_t *pool)
+{
+  build_job_t *job;
+  svn_error_t *err;
+
+  SVN_ERR(svn_thread__jobs_pop((void **)&job, &err, jb->jobs, TRUE));
+
+  if (!err)
+    err = store_rep_references(jb->fs, job->reps, job->start_rev,
+                               job->end_rev, built_rev, progress_func,
+                               progress_baton, pool);
+
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Add the representations of revisions START_REV through END_REV in
+ * JB->FS to its rep-cache, collecting them concurrently as far as JB
+ * allows.  BUILT_REV, PROGRESS_FUNC and PROGRESS_BATON are as for
+ * store_rep_references().  Use POOL for temporaries. */
+static svn_error_t *
+run_build_jobs(build_jobs_baton_t *jb,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               svn_revnum_t *built_rev,
+               svn_fs_progress_notify_func_t progress_func,
+               void *progress_baton,
+               apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t rev;
+
+  for (rev = start_rev; rev <= end_rev; rev += BUILD_REP_CACHE_BATCH_SIZE)
+    {
+      svn_pool_clear(iterpool);
+
+      if (svn_thread__jobs_full(jb->jobs))
+        SVN_ERR(finalize_oldest_build_job(jb, built_rev, progress_func,
+                                          progress_baton, iterpool));
+
+      SVN_ERR(svn_thread__jobs_cancel_func(jb->jobs));
+      SVN_ERR(push_build_job(jb, rev,
+                             MIN(end_rev,
+                                 rev + BUILD_REP_CACHE_BATCH_SIZE - 1)));
+    }
+
+  while (svn_thread__jobs_count(jb->jobs))
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(finalize_oldest_build_job(jb, built_rev, progress_func,
+                                        progress_baton, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
   return SVN_NO_ERROR;
 }
 
+/* Like the serial part of svn_fs_fs__build_rep_cache() but collect the
+ * representations in up to THREAD_COUNT threads.  The rep-cache itself
+ * is only ever written to by the calling thread. */
+static svn_error_t *
+build_rep_cache_concurrently(svn_fs_t *fs,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             int thread_count,
+                             svn_revnum_t *built_rev,
+                             svn_fs_progress_notify_func_t progress_func,
+                             void *progress_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *pool)
+{
+  build_jobs_baton_t *jb = apr_pcalloc(pool, sizeof(*jb));
+  svn_error_t *err;
+
+  jb->fs = fs;
+
+  /* Allow for some read-ahead while the main thread inserts the
+   * results but limit the memory used by finished jobs. */
+  SVN_ERR(svn_thread__jobs_create(&jb->jobs, 2 * thread_count,
+                                  thread_count, 0, TRUE, cancel_func,
+                                  cancel_baton, pool));
+
+  err = run_build_jobs(jb, start_rev, end_rev, built_rev,
+                       progress_func, progress_baton, pool);
+
+  /* Don't waste time on revisions that we won't store. */
+  svn_thread__jobs_close(jb->jobs);
+
+  while (jb->idle_fs)
+    {
+      build_fs_t *bfs = jb->idle_fs;
+      jb->idle_fs = bfs->next;
+      svn_pool_destroy(bfs->pool);
+    }
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
 svn_error_t *
 svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                            svn_revnum_t start_rev,
                            svn_revnum_t end_rev,
+                           int jobs,
                            svn_fs_progress_notify_func_t progress_func,
                            void *progress_baton,
                            svn_cancel_func_t cancel_func,
@@ -2462,6 +2910,8 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *iterpool;
+  svn_revnum_t built_rev;
+  svn_revnum_t youngest;
   svn_revnum_t rev;
 
   if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
@@ -2478,13 +2928,23 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                               _("Filesystem does not allow rep-sharing."));
     }
 
+  if (!ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
+
+  /* The record may be ahead of HEAD if an older release removed
+   * revisions from the rep-cache, e.g. during recovery. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, pool));
+  SVN_ERR(svn_fs_fs__get_rep_cache_built_rev(&built_rev, fs, pool));
+  built_rev = MIN(built_rev, youngest);
+
   /* Do not build rep-cache for revision zero to match
-   * svn_fs_fs__create() behavior. */
+   * svn_fs_fs__create() behavior.  Skip whatever previous runs already
+   * processed. */
   if (start_rev == SVN_INVALID_REVNUM)
-    start_rev = 1;
+    start_rev = built_rev + 1;
 
   if (end_rev == SVN_INVALID_REVNUM)
-    SVN_ERR(svn_fs_fs__youngest_rev(&end_rev, fs, pool));
+    end_rev = youngest;
 
   /* Do nothing for empty FS. */
   if (start_rev > end_rev)
@@ -2492,30 +2952,33 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
       return SVN_NO_ERROR;
     }
 
-  if (!ffd->rep_cache_db)
-    SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
+#if APR_HAS_THREADS
+  if (jobs > 1 && end_rev - start_rev >= BUILD_REP_CACHE_BATCH_SIZE)
+    return svn_error_trace(build_rep_cache_concurrently(fs, start_rev,
+                                                        end_rev, jobs,
+                                                        &built_rev,
+                                                        progress_func,
+                                                        progress_baton,
+                                                        cancel_func,
+                                                        cancel_baton,
+                                                        pool));
+#endif
 
   iterpool = svn_pool_create(pool);
-  for (rev = start_rev; rev <= end_rev; rev++)
+  for (rev = start_rev; rev <= end_rev; rev += BUILD_REP_CACHE_BATCH_SIZE)
     {
-      svn_fs_id_t *root_id;
-      svn_fs_fs__revision_file_t *file;
-      svn_error_t *err;
+      svn_revnum_t batch_end = MIN(end_rev,
+                                   rev + BUILD_REP_CACHE_BATCH_SIZE - 1);
+      apr_array_header_t *reps;
 
       svn_pool_clear(iterpool);
 
-      if (progress_func)
-        progress_func(rev, progress_baton, iterpool);
-
-      SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&file, fs, rev,
-                                               iterpool, iterpool));
-      SVN_ERR(svn_fs_fs__rev_get_root(&root_id, fs, rev, iterpool, iterpool));
-
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = reindex_node(fs, root_id, rev, file, cancel_func, cancel_baton, iterpool);
-      SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
-
-      SVN_ERR(svn_fs_fs__close_revision_file(file));
+      reps = apr_array_make(iterpool, 64, sizeof(representation_t *));
+      SVN_ERR(collect_rep_references(reps, fs, rev, batch_end,
+                                     cancel_func, cancel_baton, iterpool));
+      SVN_ERR(store_rep_references(fs, reps, rev, batch_end, &built_rev,
+                                   progress_func, progress_baton,
+                                   iterpool));
     }
 
   svn_pool_destroy(iterpool);
@@ -48,6 +48,16 @@ svn_error_t *svn_fs_fs__initialize_shared_data(svn_fs_t *fs,
                                                apr_pool_t *pool,
                                                apr_pool_t *common_pool);
 
+/* Open another filesystem object for the same repository as the already
+   open FS and return it in *SIBLING_P.  The new object shares FS's
+   process-wide data but has its own caches and file handles, i.e. it may
+   be used by a different thread than FS.  Allocate it in RESULT_POOL and
+   use SCRATCH_POOL for temporary allocations. */
+svn_error_t *svn_fs_fs__open_sibling(svn_fs_t **sibling_p,
+                                     svn_fs_t *fs,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool);
+
 /* Upgrade the fsfs filesystem FS.  Indicate progress via the optional
  * NOTIFY_FUNC callback using NOTIFY_BATON.  The optional CANCEL_FUNC
  * will periodically be called with CANCEL_BATON to allow for preemption.
@@ -358,17 +368,24 @@ svn_fs_fs__revision_size(apr_off_t *rev_size,
 
 /* Add missing entries to the rep-cache on the filesystem FS. Process data
  * in revisions START_REV through END_REV inclusive. If START_REV is
- * SVN_INVALID_REVNUM, start at revision 1; if END_REV is SVN_INVALID_REVNUM,
- * end at the head revision. If the rep-cache does not exist, then create it.
+ * SVN_INVALID_REVNUM, start after the youngest revision up to which
+ * previous runs processed all revisions (i.e. at revision 1 for the first
+ * run); if END_REV is SVN_INVALID_REVNUM, end at the head revision. If the
+ * rep-cache does not exist, then create it.
+ *
+ * If JOBS is larger than 1, read the revisions in up to that many threads.
+ * The entries get added in batches of several revisions each.
  *
  * Indicate progress via the optional PROGRESS_FUNC callback using
  * PROGRESS_BATON. The optional CANCEL_FUNC will periodically be called with
- * CANCEL_BATON to allow cancellation. Use POOL for temporary allocations.
+ * CANCEL_BATON to allow cancellation; it must be thread-safe if JOBS is
+ * larger than 1. Use POOL for temporary allocations.
  */
 svn_error_t *
 svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                            svn_revnum_t start_rev,
                            svn_revnum_t end_rev,
+                           int jobs,
                            svn_fs_progress_notify_func_t progress_func,
                            void *progress_baton,
                            svn_cancel_func_t cancel_func,
@@ -22,6 +22,9 @@
 #include "svn_pools.h"
 #include "svn_path.h"
 #include "svn_dirent_uri.h"
+#include "svn_sorts.h"
+
+#include "private/svn_thread_jobs.h"
 
 #include "fs_fs.h"
 #include "hotcopy.h"
@@ -279,15 +282,16 @@ hotcopy_copy_shard_file(svn_boolean_t *skipped_p,
 
 /* Copy a packed shard containing revision REV, and which contains
  * MAX_FILES_PER_DIR revisions, from SRC_FS to DST_FS.
- * Update *DST_MIN_UNPACKED_REV in case the shard is new in DST_FS.
  * Do not re-copy data which already exists in DST_FS.
  * Set *SKIPPED_P to FALSE only if at least one part of the shard
  * was copied, do not change the value in *SKIPPED_P otherwise.
  * SKIPPED_P may be NULL if not required.
+ *
+ * This only copies files and does not modify the state of either FS
+ * object, so it may be called for different shards concurrently.
  * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
 hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
-                          svn_revnum_t *dst_min_unpacked_rev,
                           svn_fs_t *src_fs,
                           svn_fs_t *dst_fs,
                           svn_revnum_t rev,
@@ -357,15 +361,6 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
                                               scratch_pool));
     }
 
-  /* If necessary, update the min-unpacked rev file in the hotcopy. */
-  if (*dst_min_unpacked_rev < rev + max_files_per_dir)
-    {
-      *dst_min_unpacked_rev = rev + max_files_per_dir;
-      SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
-                                                *dst_min_unpacked_rev,
-                                                scratch_pool));
-    }
-
   return SVN_NO_ERROR;
 }
 
@@ -532,6 +527,410 @@ remove_folder(const char *path,
   return svn_error_trace(err);
 }
 
+/* Make the packed shard containing revision REV, and which contains
+ * MAX_FILES_PER_DIR revisions, visible in DST_FS after it has been copied
+ * by hotcopy_copy_packed_shard().  All shards before it must have been
+ * completed already.  DST_YOUNGEST is the youngest revision in DST_FS
+ * before the hotcopy and SKIPPED is the flag returned by the copy.
+ * Update *DST_MIN_UNPACKED_REV in case the shard is new in DST_FS.
+ * For INCREMENTAL hotcopies, remove the non-packed files of that shard.
+ * Indicate progress via the optional NOTIFY_FUNC callback using
+ * NOTIFY_BATON.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+hotcopy_checkpoint_packed_shard(svn_revnum_t *dst_min_unpacked_rev,
+                                svn_fs_t *dst_fs,
+                                svn_revnum_t rev,
+                                int max_files_per_dir,
+                                svn_revnum_t dst_youngest,
+                                svn_boolean_t skipped,
+                                svn_boolean_t incremental,
+                                svn_fs_hotcopy_notify_t notify_func,
+                                void* notify_baton,
+                                svn_cancel_func_t cancel_func,
+                                void* cancel_baton,
+                                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *dst_ffd = dst_fs->fsap_data;
+  svn_revnum_t pack_end_rev;
+
+  /* If necessary, update the min-unpacked rev file in the hotcopy. */
+  if (*dst_min_unpacked_rev < rev + max_files_per_dir)
+    {
+      *dst_min_unpacked_rev = rev + max_files_per_dir;
+      SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
+                                                *dst_min_unpacked_rev,
+                                                scratch_pool));
+    }
+
+  pack_end_rev = rev + max_files_per_dir - 1;
+
+  /* Whenever this pack did not previously exist in the destination,
+   * update 'current' to the most recent packed rev (so readers can see
+   * new revisions which arrived in this pack). */
+  if (pack_end_rev > dst_youngest)
+    {
+      SVN_ERR(svn_fs_fs__write_current(dst_fs, pack_end_rev, 0, 0,
+                                       scratch_pool));
+    }
+
+  /* When notifying about packed shards, make things simpler by either
+   * reporting a full revision range, i.e [pack start, pack end] or
+   * reporting nothing. There is one case when this approach might not
+   * be exact (incremental hotcopy with a pack replacing last unpacked
+   * revisions), but generally this is good enough. */
+  if (notify_func && !skipped)
+    notify_func(notify_baton, rev, pack_end_rev, scratch_pool);
+
+  /* Remove revision files which are now packed. */
+  if (incremental)
+    {
+      SVN_ERR(hotcopy_remove_rev_files(dst_fs, rev,
+                                       rev + max_files_per_dir,
+                                       max_files_per_dir, scratch_pool));
+      if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+        SVN_ERR(hotcopy_remove_revprop_files(dst_fs, rev,
+                                             rev + max_files_per_dir,
+                                             max_files_per_dir,
+                                             scratch_pool));
+    }
+
+  /* Now that all revisions have moved into the pack, the original
+   * rev dir can be removed. */
+  SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(dst_fs, rev, scratch_pool),
+                        cancel_func, cancel_baton, scratch_pool));
+  if (rev > 0 && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+    SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(dst_fs, rev,
+                                                         scratch_pool),
+                          cancel_func, cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy the non-packed revision and revprop files of revision REV from
+ * SRC_REVS_DIR and SRC_REVPROPS_DIR to DST_REVS_DIR and DST_REVPROPS_DIR,
+ * respectively.  Assume a sharding layout based on MAX_FILES_PER_DIR.
+ * Set *SKIPPED_P to FALSE only if any file was copied, do not change the
+ * value in *SKIPPED_P otherwise.
+ *
+ * Like hotcopy_copy_packed_shard(), this may be called concurrently for
+ * revisions in different shards.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+hotcopy_copy_rev(svn_boolean_t *skipped_p,
+                 const char *src_revs_dir,
+                 const char *dst_revs_dir,
+                 const char *src_revprops_dir,
+                 const char *dst_revprops_dir,
+                 svn_revnum_t rev,
+                 int max_files_per_dir,
+                 apr_pool_t *scratch_pool)
+{
+  /* Copying non-packed revisions is racy in case the source repository is
+   * being packed concurrently with this hotcopy operation. The race can
+   * happen with FS formats prior to SVN_FS_FS__MIN_PACK_LOCK_FORMAT that
+   * support packed revisions. With the pack lock, however, the race is
+   * impossible, because hotcopy and pack operations block each other.
+   *
+   * We assume that all revisions coming after 'min-unpacked-rev' really
+   * are unpacked and that's not necessarily true with concurrent packing.
+   * Don't try to be smart in this edge case, because handling it properly
+   * might require copying *everything* from the start. Just abort the
+   * hotcopy with an ENOENT (revision file moved to a pack, so it is no
+   * longer where we expect it to be). */
+
+  /* Copy the rev file. */
+  SVN_ERR(hotcopy_copy_shard_file(skipped_p,
+                                  src_revs_dir, dst_revs_dir, rev,
+                                  max_files_per_dir,
+                                  scratch_pool));
+  /* Copy the revprop file. */
+  SVN_ERR(hotcopy_copy_shard_file(skipped_p,
+                                  src_revprops_dir, dst_revprops_dir,
+                                  rev, max_files_per_dir,
+                                  scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Make the non-packed revision REV visible in DST_FS after it has been
+ * copied by hotcopy_copy_rev().  All previous revisions must have been
+ * completed already.  DST_YOUNGEST, MAX_FILES_PER_DIR, SKIPPED,
+ * NOTIFY_FUNC and NOTIFY_BATON are as for
+ * hotcopy_checkpoint_packed_shard().  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+hotcopy_checkpoint_rev(svn_fs_t *dst_fs,
+                       svn_revnum_t rev,
+                       int max_files_per_dir,
+                       svn_revnum_t dst_youngest,
+                       svn_boolean_t skipped,
+                       svn_fs_hotcopy_notify_t notify_func,
+                       void* notify_baton,
+                       apr_pool_t *scratch_pool)
+{
+  /* Whenever this revision did not previously exist in the destination,
+   * checkpoint the progress via 'current' (do that once per full shard
+   * in order not to slow things down). */
+  if (rev > dst_youngest)
+    {
+      if (max_files_per_dir && (rev % max_files_per_dir == 0))
+        {
+          SVN_ERR(svn_fs_fs__write_current(dst_fs, rev, 0, 0,
+                                           scratch_pool));
+        }
+    }
+
+  if (notify_func && !skipped)
+    notify_func(notify_baton, rev, rev, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+struct hotcopy_jobs_baton_t;
+
+/* A range of revisions within one shard to be copied by one of the
+ * worker threads. */
+typedef struct hotcopy_job_t
+{
+  /* Private root pool of this job. */
+  apr_pool_t *pool;
+
+  /* The revision range [START_REV, END_REV).  If PACKED is set, this is
+   * a whole packed shard. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+  svn_boolean_t packed;
+
+  /* The SKIPPED_P results for each revision in the range.  Packed shards
+   * only use the first element. */
+  svn_boolean_t *skipped;
+
+  /* The context that this job belongs to. */
+  struct hotcopy_jobs_baton_t *jb;
+} hotcopy_job_t;
+
+/* Context of a concurrent hotcopy_revisions() run. */
+typedef struct hotcopy_jobs_baton_t
+{
+  /* Parameters as passed to hotcopy_revisions(). */
+  svn_fs_t *src_fs;
+  svn_fs_t *dst_fs;
+  svn_revnum_t dst_youngest;
+  svn_boolean_t incremental;
+  const char *src_revs_dir;
+  const char *dst_revs_dir;
+  const char *src_revprops_dir;
+  const char *dst_revprops_dir;
+  svn_fs_hotcopy_notify_t notify_func;
+  void* notify_baton;
+  svn_cancel_func_t cancel_func;
+  void* cancel_baton;
+  int max_files_per_dir;
+
+  /* Current value of 'min-unpacked-rev' in DST_FS. */
+  svn_revnum_t dst_min_unpacked_rev;
+
+  /* Jobs in revision order.  The workers only check for them being
+   * aborted; CANCEL_FUNC gets called from the main thread. */
+  svn_thread__jobs_t *jobs;
+} hotcopy_jobs_baton_t;
+
+/* Implements svn_thread__job_func_t:  Copy the files of the hotcopy_job_t
+ * BATON. */
+static svn_error_t *
+hotcopy_job(void *baton,
+            apr_pool_t *pool)
+{
+  hotcopy_job_t *job = baton;
+  hotcopy_jobs_baton_t *jb = job->jb;
+  apr_pool_t *iterpool;
+  svn_revnum_t rev;
+
+  SVN_ERR(svn_thread__jobs_cancel_func(jb->jobs));
+  if (job->packed)
+    return svn_error_trace(hotcopy_copy_packed_shard(&job->skipped[0],
+                                                     jb->src_fs, jb->dst_fs,
+                                                     job->start_rev,
+                                                     jb->max_files_per_dir,
+                                                     pool));
+
+  iterpool = svn_pool_create(pool);
+  for (rev = job->start_rev; rev < job->end_rev; ++rev)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_thread__jobs_cancel_func(jb->jobs));
+      SVN_ERR(hotcopy_copy_rev(&job->skipped[rev - job->start_rev],
+                               jb->src_revs_dir, jb->dst_revs_dir,
+                               jb->src_revprops_dir, jb->dst_revprops_dir,
+                               rev, jb->max_files_per_dir, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Queue the copy of revisions [START_REV, END_REV) in JB.  If PACKED is
+ * set, this is the packed shard starting at START_REV. */
+static svn_error_t *
+push_hotcopy_job(hotcopy_jobs_baton_t *jb,
+                 svn_revnum_t start_rev,
+                 svn_revnum_t end_rev,
+                 svn_boolean_t packed)
+{
+  apr_pool_t *job_pool = svn_pool_create(NULL);
+  hotcopy_job_t *job = apr_pcalloc(job_pool, sizeof(*job));
+  svn_revnum_t i;
+
+  job->pool = job_pool;
+  job->start_rev = start_rev;
+  job->end_rev = end_rev;
+  job->packed = packed;
+  job->jb = jb;
+  job->skipped = apr_palloc(job_pool,
+                            (end_rev - start_rev) * sizeof(*job->skipped));
+  for (i = 0; i < end_rev - start_rev; ++i)
+    job->skipped[i] = TRUE;
+
+  return svn_error_trace(svn_thread__jobs_push(jb->jobs, hotcopy_job, job,
+                                               job_pool));
+}
+
+/* Wait for the oldest job in JB to be completed and checkpoint its
+ * revisions in the destination, just like the serial code in
+ * hotcopy_revisions() would.  Remove the job from JB.  Use SCRATCH_POOL
+ * for temporary allocations. */
+static svn_error_t *
+finalize_oldest_hotcopy_job(hotcopy_jobs_baton_t *jb,
+                            apr_pool_t *scratch_pool)
+{
+  hotcopy_job_t *job;
+  svn_error_t *err;
+  svn_revnum_t rev;
+
+  if (jb->cancel_func)
+    SVN_ERR(jb->cancel_func(jb->cancel_baton));
+
+  SVN_ERR(svn_thread__jobs_pop((void **)&job, &err, jb->jobs, TRUE));
+
+  if (err)
+    ;
+  else if (job->packed)
+    err = hotcopy_checkpoint_packed_shard(&jb->dst_min_unpacked_rev,
+                                          jb->dst_fs, job->start_rev,
+                                          jb->max_files_per_dir,
+                                          jb->dst_youngest,
+                                          job->skipped[0], jb->incremental,
+                                          jb->notify_func, jb->notify_baton,
+                                          jb->cancel_func, jb->cancel_baton,
+                                          scratch_pool);
+  else
+    for (rev = job->start_rev; !err && rev < job->end_rev; ++rev)
+      err = hotcopy_checkpoint_rev(jb->dst_fs, rev, jb->max_files_per_dir,
+                                   jb->dst_youngest,
+                                   job->skipped[rev - job->start_rev],
+                                   jb->notify_func, jb->notify_baton,
+                                   scratch_pool);
+
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Copy all packed shards before SRC_MIN_UNPACKED_REV and all non-packed
+ * revisions up to SRC_YOUNGEST as described by JB.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+run_hotcopy_jobs(hotcopy_jobs_baton_t *jb,
+                 svn_revnum_t src_min_unpacked_rev,
+                 svn_revnum_t src_youngest,
+                 apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_revnum_t rev;
+
+  for (rev = 0; rev <= src_youngest; )
+    {
+      svn_boolean_t packed = rev < src_min_unpacked_rev;
+      svn_revnum_t end_rev = MIN(src_youngest + 1,
+                                 rev - rev % jb->max_files_per_dir
+                                     + jb->max_files_per_dir);
+
+      svn_pool_clear(iterpool);
+      if (svn_thread__jobs_full(jb->jobs))
+        SVN_ERR(finalize_oldest_hotcopy_job(jb, iterpool));
+
+      SVN_ERR(push_hotcopy_job(jb, rev, end_rev, packed));
+      rev = end_rev;
+    }
+
+  while (svn_thread__jobs_count(jb->jobs))
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(finalize_oldest_hotcopy_job(jb, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Like the copying part of hotcopy_revisions() but copy up to
+ * THREAD_COUNT shards concurrently.  DST_MIN_UNPACKED_REV and
+ * SRC_MIN_UNPACKED_REV are the respective 'min-unpacked-rev' values;
+ * the remaining parameters are as for hotcopy_revisions().  The
+ * destination will be updated in revision order. */
+static svn_error_t *
+hotcopy_revisions_concurrently(svn_fs_t *src_fs,
+                               svn_fs_t *dst_fs,
+                               svn_revnum_t src_youngest,
+                               svn_revnum_t dst_youngest,
+                               svn_revnum_t src_min_unpacked_rev,
+                               svn_revnum_t dst_min_unpacked_rev,
+                               svn_boolean_t incremental,
+                               const char *src_revs_dir,
+                               const char *dst_revs_dir,
+                               const char *src_revprops_dir,
+                               const char *dst_revprops_dir,
+                               svn_fs_hotcopy_notify_t notify_func,
+                               void* notify_baton,
+                               svn_cancel_func_t cancel_func,
+                               void* cancel_baton,
+                               int thread_count,
+                               apr_pool_t *pool)
+{
+  fs_fs_data_t *src_ffd = src_fs->fsap_data;
+  hotcopy_jobs_baton_t *jb = apr_pcalloc(pool, sizeof(*jb));
+  svn_error_t *err;
+
+  jb->src_fs = src_fs;
+  jb->dst_fs = dst_fs;
+  jb->dst_youngest = dst_youngest;
+  jb->incremental = incremental;
+  jb->src_revs_dir = src_revs_dir;
+  jb->dst_revs_dir = dst_revs_dir;
+  jb->src_revprops_dir = src_revprops_dir;
+  jb->dst_revprops_dir = dst_revprops_dir;
+  jb->notify_func = notify_func;
+  jb->notify_baton = notify_baton;
+  jb->cancel_func = cancel_func;
+  jb->cancel_baton = cancel_baton;
+  jb->max_files_per_dir = src_ffd->max_files_per_dir;
+  jb->dst_min_unpacked_rev = dst_min_unpacked_rev;
+
+  /* Allow the workers to run ahead of the in-order checkpoints a bit. */
+  SVN_ERR(svn_thread__jobs_create(&jb->jobs, 2 * thread_count, thread_count,
+                                  0, TRUE, NULL, NULL, pool));
+
+  err = run_hotcopy_jobs(jb, src_min_unpacked_rev, src_youngest, pool);
+  svn_thread__jobs_close(jb->jobs);
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Copy the revision and revprop files (possibly sharded / packed) from
  * SRC_FS to DST_FS.  Do not re-copy data which already exists in DST_FS.
  * When copying packed or unpacked shards, checkpoint the result in DST_FS
@@ -557,7 +956,6 @@ hotcopy_revisions(svn_fs_t *src_fs,
                   apr_pool_t *pool)
 {
   fs_fs_data_t *src_ffd = src_fs->fsap_data;
-  fs_fs_data_t *dst_ffd = dst_fs->fsap_data;
   int max_files_per_dir = src_ffd->max_files_per_dir;
   svn_revnum_t src_min_unpacked_rev;
   svn_revnum_t dst_min_unpacked_rev;
@@ -600,12 +998,23 @@ hotcopy_revisions(svn_fs_t *src_fs,
    * Copy the necessary rev files.
    */
 
+#if APR_HAS_THREADS
+  if (src_ffd->hotcopy_threads > 1 && max_files_per_dir)
+    return svn_error_trace(hotcopy_revisions_concurrently(
+                             src_fs, dst_fs, src_youngest, dst_youngest,
+                             src_min_unpacked_rev, dst_min_unpacked_rev,
+                             incremental, src_revs_dir, dst_revs_dir,
+                             src_revprops_dir, dst_revprops_dir,
+                             notify_func, notify_baton,
+                             cancel_func, cancel_baton,
+                             src_ffd->hotcopy_threads, pool));
+#endif
+
   iterpool = svn_pool_create(pool);
   /* First, copy packed shards. */
   for (rev = 0; rev < src_min_unpacked_rev; rev += max_files_per_dir)
     {
       svn_boolean_t skipped = TRUE;
-      svn_revnum_t pack_end_rev;
 
       svn_pool_clear(iterpool);
 
@@ -613,51 +1022,16 @@ hotcopy_revisions(svn_fs_t *src_fs,
         SVN_ERR(cancel_func(cancel_baton));
 
       /* Copy the packed shard. */
-      SVN_ERR(hotcopy_copy_packed_shard(&skipped, &dst_min_unpacked_rev,
-                                        src_fs, dst_fs,
+      SVN_ERR(hotcopy_copy_packed_shard(&skipped, src_fs, dst_fs,
                                         rev, max_files_per_dir,
                                         iterpool));
-
-      pack_end_rev = rev + max_files_per_dir - 1;
-
-      /* Whenever this pack did not previously exist in the destination,
-       * update 'current' to the most recent packed rev (so readers can see
-       * new revisions which arrived in this pack). */
-      if (pack_end_rev > dst_youngest)
-        {
-          SVN_ERR(svn_fs_fs__write_current(dst_fs, pack_end_rev, 0, 0,
-                                           iterpool));
-        }
-
-      /* When notifying about packed shards, make things simpler by either
-       * reporting a full revision range, i.e [pack start, pack end] or
-       * reporting nothing. There is one case when this approach might not
-       * be exact (incremental hotcopy with a pack replacing last unpacked
-       * revisions), but generally this is good enough. */
-      if (notify_func && !skipped)
-        notify_func(notify_baton, rev, pack_end_rev, iterpool);
-
-      /* Remove revision files which are now packed. */
-      if (incremental)
-        {
-          SVN_ERR(hotcopy_remove_rev_files(dst_fs, rev,
-                                           rev + max_files_per_dir,
-                                           max_files_per_dir, iterpool));
-          if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
-            SVN_ERR(hotcopy_remove_revprop_files(dst_fs, rev,
-                                                 rev + max_files_per_dir,
-                                                 max_files_per_dir,
-                                                 iterpool));
-        }
-
-      /* Now that all revisions have moved into the pack, the original
-       * rev dir can be removed. */
-      SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(dst_fs, rev, iterpool),
-                            cancel_func, cancel_baton, iterpool));
-      if (rev > 0 && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
-        SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(dst_fs, rev,
-                                                             iterpool),
-                              cancel_func, cancel_baton, iterpool));
+      SVN_ERR(hotcopy_checkpoint_packed_shard(&dst_min_unpacked_rev, dst_fs,
+                                              rev, max_files_per_dir,
+                                              dst_youngest, skipped,
+                                              incremental,
+                                              notify_func, notify_baton,
+                                              cancel_func, cancel_baton,
+                                              iterpool));
     }
 
   if (cancel_func)
@@ -677,44 +1051,12 @@ hotcopy_revisions(svn_fs_t *src_fs,
       if (cancel_func)
         SVN_ERR(cancel_func(cancel_baton));
 
-      /* Copying non-packed revisions is racy in case the source repository is
-       * being packed concurrently with this hotcopy operation. The race can
-       * happen with FS formats prior to SVN_FS_FS__MIN_PACK_LOCK_FORMAT that
-       * support packed revisions. With the pack lock, however, the race is
-       * impossible, because hotcopy and pack operations block each other.
-       *
-       * We assume that all revisions coming after 'min-unpacked-rev' really
-       * are unpacked and that's not necessarily true with concurrent packing.
-       * Don't try to be smart in this edge case, because handling it properly
-       * might require copying *everything* from the start. Just abort the
-       * hotcopy with an ENOENT (revision file moved to a pack, so it is no
-       * longer where we expect it to be). */
-
-      /* Copy the rev file. */
-      SVN_ERR(hotcopy_copy_shard_file(&skipped,
-                                      src_revs_dir, dst_revs_dir, rev,
-                                      max_files_per_dir,
-                                      iterpool));
-      /* Copy the revprop file. */
-      SVN_ERR(hotcopy_copy_shard_file(&skipped,
-                                      src_revprops_dir, dst_revprops_dir,
-                                      rev, max_files_per_dir,
-                                      iterpool));
-
-      /* Whenever this revision did not previously exist in the destination,
-       * checkpoint the progress via 'current' (do that once per full shard
-       * in order not to slow things down). */
-      if (rev > dst_youngest)
-        {
-          if (max_files_per_dir && (rev % max_files_per_dir == 0))
-            {
-              SVN_ERR(svn_fs_fs__write_current(dst_fs, rev, 0, 0,
-                                               iterpool));
-            }
-        }
-
-      if (notify_func && !skipped)
-        notify_func(notify_baton, rev, rev, iterpool);
+      SVN_ERR(hotcopy_copy_rev(&skipped, src_revs_dir, dst_revs_dir,
+                               src_revprops_dir, dst_revprops_dir,
+                               rev, max_files_per_dir, iterpool));
+      SVN_ERR(hotcopy_checkpoint_rev(dst_fs, rev, max_files_per_dir,
+                                     dst_youngest, skipped,
+                                     notify_func, notify_baton, iterpool));
     }
   svn_pool_destroy(iterpool);
 
@@ -30,6 +30,8 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_jobs.h"
 
 #include "fs_fs.h"
 #include "pack.h"
@@ -1957,6 +1959,56 @@ synced_pack_shard(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Set *REV_PACK_FILE_DIR and *REV_SHARD_PATH to the paths of the packed
+ * and non-packed SHARD within REVS_DIR, respectively.  Allocate them in
+ * RESULT_POOL.
+ */
+static void
+get_rev_shard_paths(const char **rev_pack_file_dir,
+                    const char **rev_shard_path,
+                    const char *revs_dir,
+                    apr_int64_t shard,
+                    apr_pool_t *result_pool)
+{
+  *rev_pack_file_dir = svn_dirent_join(revs_dir,
+                  apr_psprintf(result_pool,
+                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
+                               shard),
+                  result_pool);
+  *rev_shard_path = svn_dirent_join(revs_dir,
+                                    apr_psprintf(result_pool,
+                                                 "%" APR_INT64_T_FMT,
+                                                 shard),
+                                    result_pool);
+}
+
+/* Switch the shard described by BATON over to its already packed
+ * revision data, packing its revprops along the way, and notify the
+ * caller that the shard has been completed.
+ */
+static svn_error_t *
+finalize_shard(struct pack_baton *baton,
+               apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
+
+  /* For newer repo formats, we only acquired the pack lock so far.
+     Before modifying the repo state by switching over to the packed
+     data, we need to acquire the global (write) lock. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
+    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
+                                       pool));
+  else
+    SVN_ERR(synced_pack_shard(baton, pool));
+
+  /* Notify caller we're starting to pack this shard. */
+  if (baton->notify_func)
+    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
+                               svn_fs_pack_notify_end, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Pack the shard described by BATON.
  *
  * If for some reason we detect a partial packing already performed,
@@ -1975,16 +2027,8 @@ pack_shard(struct pack_baton *baton,
                                svn_fs_pack_notify_start, pool));
 
   /* Some useful paths. */
-  rev_pack_file_dir = svn_dirent_join(baton->revs_dir,
-                  apr_psprintf(pool,
-                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
-                               baton->shard),
-                  pool);
-  baton->rev_shard_path = svn_dirent_join(baton->revs_dir,
-                                          apr_psprintf(pool,
-                                                       "%" APR_INT64_T_FMT,
-                                                       baton->shard),
-                                          pool);
+  get_rev_shard_paths(&rev_pack_file_dir, &baton->rev_shard_path,
+                      baton->revs_dir, baton->shard, pool);
 
   /* pack the revision content */
   SVN_ERR(pack_rev_shard(baton->fs, rev_pack_file_dir, baton->rev_shard_path,
@@ -1992,23 +2036,248 @@ pack_shard(struct pack_baton *baton,
                          baton->max_mem, ffd->flush_to_disk,
                          baton->cancel_func, baton->cancel_baton, pool));
 
-  /* For newer repo formats, we only acquired the pack lock so far.
-     Before modifying the repo state by switching over to the packed
-     data, we need to acquire the global (write) lock. */
-  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
-    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
-                                       pool));
-  else
-    SVN_ERR(synced_pack_shard(baton, pool));
+  return svn_error_trace(finalize_shard(baton, pool));
+}
 
-  /* Notify caller we're starting to pack this shard. */
-  if (baton->notify_func)
-    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
-                               svn_fs_pack_notify_end, pool));
+#if APR_HAS_THREADS
+
+struct pack_jobs_baton_t;
+
+/* The revision contents of a single shard being packed by one of the
+ * worker threads. */
+typedef struct pack_job_t
+{
+  /* Private root pool of this job. */
+  apr_pool_t *pool;
+
+  /* The shard to pack and its paths, allocated in POOL. */
+  apr_int64_t shard;
+  const char *rev_pack_file_dir;
+  const char *rev_shard_path;
+
+  /* The context that this job belongs to. */
+  struct pack_jobs_baton_t *jb;
+} pack_job_t;
+
+/* A filesystem object for exclusive use by a single worker thread.
+ * Instances get re-used by later jobs. */
+typedef struct pack_fs_t
+{
+  /* Root pool owning this structure and FS. */
+  apr_pool_t *pool;
+
+  /* The filesystem object.  NULL until opened by the first job. */
+  svn_fs_t *fs;
+
+  /* Next unused instance. */
+  struct pack_fs_t *next;
+} pack_fs_t;
+
+/* Context of a concurrent pack run. */
+typedef struct pack_jobs_baton_t
+{
+  /* The filesystem being packed.  Only used to create siblings from. */
+  svn_fs_t *fs;
+
+  /* Memory limit for each individual job. */
+  apr_size_t max_mem;
+
+  /* Shards in pack order. */
+  svn_thread__jobs_t *jobs;
+
+  /* Filesystem objects not currently used by any job.
+   * Protected by the mutex of JOBS. */
+  pack_fs_t *idle_fs;
+} pack_jobs_baton_t;
+
+/* Return PFS to the unused filesystem objects in JB. */
+static svn_error_t *
+release_pack_fs(pack_jobs_baton_t *jb,
+                pack_fs_t *pfs)
+{
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(jb->jobs);
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  pfs->next = jb->idle_fs;
+  jb->idle_fs = pfs;
+
+  return svn_error_trace(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+}
+
+/* Implements svn_thread__job_func_t:  Pack the revision contents of the
+ * shard given by the pack_job_t BATON using a filesystem object of its
+ * own. */
+static svn_error_t *
+pack_job(void *baton,
+         apr_pool_t *pool)
+{
+  pack_job_t *job = baton;
+  pack_jobs_baton_t *jb = job->jb;
+  fs_fs_data_t *ffd = jb->fs->fsap_data;
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(jb->jobs);
+  pack_fs_t *pfs;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  pfs = jb->idle_fs;
+  if (pfs)
+    jb->idle_fs = pfs->next;
+  SVN_ERR(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+
+  if (!pfs)
+    {
+      apr_pool_t *pfs_pool = svn_pool_create(NULL);
+      pfs = apr_pcalloc(pfs_pool, sizeof(*pfs));
+      pfs->pool = pfs_pool;
+    }
+
+  if (!pfs->fs)
+    {
+      err = svn_fs_fs__open_sibling(&pfs->fs, jb->fs, pfs->pool, pool);
+      if (err)
+        pfs->fs = NULL;
+    }
+
+  if (!err)
+    err = pack_rev_shard(pfs->fs, job->rev_pack_file_dir, job->rev_shard_path,
+                         job->shard, ffd->max_files_per_dir, jb->max_mem,
+                         ffd->flush_to_disk, svn_thread__jobs_cancel_func,
+                         jb->jobs, pool);
+
+  /* Let the next job use PFS. */
+  return svn_error_compose_create(err, release_pack_fs(jb, pfs));
+}
+
+/* Queue the revision contents of the shard PB->SHARD for packing in JB.
+ */
+static svn_error_t *
+push_pack_job(pack_jobs_baton_t *jb,
+              struct pack_baton *pb)
+{
+  apr_pool_t *job_pool = svn_pool_create(NULL);
+  pack_job_t *job = apr_pcalloc(job_pool, sizeof(*job));
+
+  job->pool = job_pool;
+  job->shard = pb->shard;
+  job->jb = jb;
+  get_rev_shard_paths(&job->rev_pack_file_dir, &job->rev_shard_path,
+                      pb->revs_dir, pb->shard, job_pool);
+
+  return svn_error_trace(svn_thread__jobs_push(jb->jobs, pack_job, job,
+                                               job_pool));
+}
+
+/* Wait for the oldest shard in JB to be packed and switch the repository
+ * over to it, just like pack_shard() would.  PB provides the context.
+ * Remove the job from JB.  Use POOL for temporaries. */
+static svn_error_t *
+finalize_oldest_pack_job(pack_jobs_baton_t *jb,
+                         struct pack_baton *pb,
+                         apr_pool_t *pool)
+{
+  pack_job_t *job;
+  svn_error_t *err;
+
+  SVN_ERR(svn_thread__jobs_pop((void **)&job, &err, jb->jobs, TRUE));
+
+  /* Keep the notifications in the same order as for a serial pack. */
+  pb->shard = job->shard;
+  if (pb->notify_func)
+    err = svn_error_compose_create(err,
+                                   pb->notify_func(pb->notify_baton,
+                                                   pb->shard,
+                                                   svn_fs_pack_notify_start,
+                                                   pool));
+
+  if (!err)
+    {
+      pb->rev_shard_path = apr_pstrdup(pool, job->rev_shard_path);
+      err = finalize_shard(pb, pool);
+    }
+
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Pack all shards from FIRST_SHARD up to but not including END_SHARD as
+ * described by PB, packing the revision contents of as many shards
+ * concurrently as JB allows.  Use POOL for temporaries. */
+static svn_error_t *
+run_pack_jobs(pack_jobs_baton_t *jb,
+              struct pack_baton *pb,
+              apr_int64_t first_shard,
+              apr_int64_t end_shard,
+              apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_int64_t shard;
+
+  for (shard = first_shard; shard < end_shard; ++shard)
+    {
+      svn_pool_clear(iterpool);
+
+      if (svn_thread__jobs_full(jb->jobs))
+        SVN_ERR(finalize_oldest_pack_job(jb, pb, iterpool));
+
+      SVN_ERR(svn_thread__jobs_cancel_func(jb->jobs));
+
+      pb->shard = shard;
+      SVN_ERR(push_pack_job(jb, pb));
+    }
+
+  while (svn_thread__jobs_count(jb->jobs))
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(finalize_oldest_pack_job(jb, pb, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
 }
 
+/* Pack all shards from FIRST_SHARD up to but not including END_SHARD as
+ * described by PB, using up to THREAD_COUNT threads for the revision
+ * contents.  Use POOL for temporaries. */
+static svn_error_t *
+pack_shards_concurrently(struct pack_baton *pb,
+                         apr_int64_t first_shard,
+                         apr_int64_t end_shard,
+                         int thread_count,
+                         apr_pool_t *pool)
+{
+  pack_jobs_baton_t *jb = apr_pcalloc(pool, sizeof(*jb));
+  svn_error_t *err;
+
+  jb->fs = pb->fs;
+
+  /* Keep the total memory usage within the limit set for serial packs. */
+  jb->max_mem = pb->max_mem / thread_count;
+
+  /* Only the shards being worked on get queued.  This limits the number
+   * of incomplete pack directories left behind upon interruption. */
+  SVN_ERR(svn_thread__jobs_create(&jb->jobs, thread_count, thread_count,
+                                  0, TRUE, pb->cancel_func,
+                                  pb->cancel_baton, pool));
+
+  err = run_pack_jobs(jb, pb, first_shard, end_shard, pool);
+
+  /* Don't waste time on shards that we won't switch over to. */
+  svn_thread__jobs_close(jb->jobs);
+
+  while (jb->idle_fs)
+    {
+      pack_fs_t *pfs = jb->idle_fs;
+      jb->idle_fs = pfs->next;
+      svn_pool_destroy(pfs->pool);
+    }
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2080,6 +2349,20 @@ pack_body(void *baton,
     pb->revsprops_dir = svn_dirent_join(pb->fs->path, PATH_REVPROPS_DIR,
                                         pool);
 
+#if APR_HAS_THREADS
+  if (   ffd->pack_threads > 1
+      && ffd->min_unpacked_rev / ffd->max_files_per_dir + 1 < completed_shards)
+    {
+      apr_int64_t first_shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
+      int thread_count = (int)MIN(ffd->pack_threads,
+                                  completed_shards - first_shard);
+
+      return svn_error_trace(pack_shards_concurrently(pb, first_shard,
+                                                      completed_shards,
+                                                      thread_count, pool));
+    }
+#endif
+
   iterpool = svn_pool_create(pool);
   for (pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
        pb->shard < completed_shards;
@@ -70,6 +70,16 @@ SELECT hash, revision, offset, size, expanded_size
 FROM rep_cache
 WHERE revision >= ?1 AND revision <= ?2
 
+-- STMT_COUNT_REPS
+/* Works for both V1 and V2 schemas. */
+SELECT COUNT(*)
+FROM rep_cache
+
+-- STMT_GET_ALL_HASHES
+/* Works for both V1 and V2 schemas. */
+SELECT hash
+FROM rep_cache
+
 -- STMT_GET_MAX_REV
 /* Works for both V1 and V2 schemas. */
 SELECT MAX(revision)
@@ -80,6 +90,44 @@ FROM rep_cache
 DELETE FROM rep_cache
 WHERE revision > ?1
 
+-- STMT_UPGRADE_TO_V3
+/* Add a table recording the youngest revision up to which all revisions
+   have been indexed by 'svnadmin build-repcache'.  Applies to both V1 and
+   V2 schemas; releases that don't know about the table simply ignore it.
+   Concurrent openers may race to upgrade, hence IF NOT EXISTS. */
+CREATE TABLE IF NOT EXISTS built_rev (
+  id INTEGER NOT NULL PRIMARY KEY,
+  revision INTEGER NOT NULL
+  );
+
+PRAGMA USER_VERSION = 3;
+
+-- STMT_UPGRADE_TO_V4
+/* Index the revisions, so that the in-memory filter of the keys can pick
+   up the reps added by other processes without a full table scan.
+   Applies to V3 databases, which may still use either the V1 or the V2
+   rep_cache table; older releases simply ignore the index. */
+CREATE INDEX IF NOT EXISTS I_REVISION ON rep_cache (revision);
+
+PRAGMA USER_VERSION = 4;
+
+-- STMT_GET_BUILT_REV
+/* Requires the V3 schema. */
+SELECT revision
+FROM built_rev
+WHERE id = 0
+
+-- STMT_SET_BUILT_REV
+/* Requires the V3 schema. */
+INSERT OR REPLACE INTO built_rev (id, revision)
+VALUES (0, ?1)
+
+-- STMT_LIMIT_BUILT_REV
+/* Requires the V3 schema. */
+UPDATE built_rev
+SET revision = ?1
+WHERE revision > ?1
+
 /* An INSERT takes an SQLite reserved lock that prevents other writes
    but doesn't block reads.  The incomplete transaction means that no
    permanent change is made to the database and the transaction is
@@ -31,11 +31,17 @@
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_path.h"
+#include "svn_sorts.h"
 
+#include "private/svn_mutex.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_sqlite.h"
 
 #include "rep-cache-db.h"
 
+/* A few magic values */
+#define REP_CACHE_SCHEMA_FORMAT   4
+
 REP_CACHE_DB_SQL_DECLARE_STATEMENTS(statements);
 
 
@@ -48,6 +54,492 @@ path_rep_cache_db(const char *fs_path,
   return svn_dirent_join(fs_path, REP_CACHE_DB_NAME, result_pool);
 }
 
+
+/** In-memory filter of rep-cache keys. **/
+
+/* The filter is a Bloom filter over the SHA1 digests in the rep-cache.
+   With this many bits per key and this many bits set / tested per key,
+   less than 1% of the lookups for keys not in the database will have to
+   consult it nonetheless. */
+#define FILTER_BITS_PER_KEY 10
+#define FILTER_HASH_COUNT 7
+
+/* Minimum number of keys to size a new filter for. */
+#define FILTER_MIN_CAPACITY 0x10000
+
+/* Rebuild the filter instead of reading the keys of the revisions that
+   it does not cover once there are that many of them. */
+#define FILTER_MAX_LAG 1000
+
+struct fs_fs_rep_cache_filter_t
+{
+  /* Root pool owning this structure and BITS. */
+  apr_pool_t *pool;
+
+  /* The bit array and its number of bits minus 1 (a power of two). */
+  unsigned char *bits;
+  apr_uint64_t bit_mask;
+
+  /* Number of keys added and number of keys that BITS has been sized for.
+     Lookups become less selective if COUNT exceeds CAPACITY. */
+  apr_uint64_t count;
+  apr_uint64_t capacity;
+
+  /* The keys of all reps from revisions up to and including this one
+     have been added to the filter. */
+  svn_revnum_t covered_rev;
+
+  /* Whether some thread is reading the keys of the revisions after
+     COVERED_REV from the database, see sync_filter(). */
+  svn_boolean_t syncing;
+};
+
+/* Set *H1 and *H2 to the base values from which all bit positions for
+   the SHA1 DIGEST will be derived by double hashing.  SHA1 is evenly
+   distributed already, so we simply take its first 16 bytes. */
+static void
+filter_hashes(apr_uint64_t *h1,
+              apr_uint64_t *h2,
+              const unsigned char *digest)
+{
+  memcpy(h1, digest, sizeof(*h1));
+  memcpy(h2, digest + sizeof(*h1), sizeof(*h2));
+
+  /* Make sure all FILTER_HASH_COUNT positions differ. */
+  *h2 |= 1;
+}
+
+/* Add the SHA1 DIGEST to FILTER. */
+static void
+filter_add(fs_fs_rep_cache_filter_t *filter,
+           const unsigned char *digest)
+{
+  apr_uint64_t h1, h2;
+  int i;
+
+  filter_hashes(&h1, &h2, digest);
+  for (i = 0; i < FILTER_HASH_COUNT; ++i)
+    {
+      apr_uint64_t bit = (h1 + i * h2) & filter->bit_mask;
+      filter->bits[bit / 8] |= (unsigned char)(1 << (bit % 8));
+    }
+
+  ++filter->count;
+}
+
+/* Return FALSE if the SHA1 DIGEST has definitely not been added to
+   FILTER and TRUE if it might have been. */
+static svn_boolean_t
+filter_may_contain(const fs_fs_rep_cache_filter_t *filter,
+                   const unsigned char *digest)
+{
+  apr_uint64_t h1, h2;
+  int i;
+
+  filter_hashes(&h1, &h2, digest);
+  for (i = 0; i < FILTER_HASH_COUNT; ++i)
+    {
+      apr_uint64_t bit = (h1 + i * h2) & filter->bit_mask;
+      if ((filter->bits[bit / 8] & (1 << (bit % 8))) == 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Read all keys from the rep-cache database of FS and return a filter
+   for them in *FILTER_P.  The filter will be allocated in its own root
+   pool.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+build_filter(fs_fs_rep_cache_filter_t **filter_p,
+             svn_fs_t *fs,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_revnum_t youngest;
+  apr_uint64_t capacity;
+  apr_uint64_t bit_count;
+  apr_pool_t *pool;
+  apr_pool_t *iterpool;
+  svn_error_t *err;
+  int iterations = 0;
+
+  /* All reps of revisions up to YOUNGEST will be in the database.
+     Commits of other processes may still be about to add theirs, which
+     only means that we might miss the chance to share those. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_COUNT_REPS));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  capacity = svn_sqlite__column_int64(stmt, 0);
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Leave room for the database to double in size before we need to
+     rebuild the filter. */
+  capacity = MAX(2 * capacity, FILTER_MIN_CAPACITY);
+  for (bit_count = 8; bit_count < capacity * FILTER_BITS_PER_KEY; )
+    bit_count *= 2;
+
+  pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  filter = apr_pcalloc(pool, sizeof(*filter));
+  filter->pool = pool;
+  filter->bits = apr_pcalloc(pool, (apr_size_t)(bit_count / 8));
+  filter->bit_mask = bit_count - 1;
+  filter->capacity = bit_count / FILTER_BITS_PER_KEY;
+  filter->covered_rev = youngest;
+
+  iterpool = svn_pool_create(scratch_pool);
+  err = svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                  STMT_GET_ALL_HASHES);
+  if (!err)
+    {
+      err = svn_sqlite__step(&have_row, stmt);
+      while (!err && have_row)
+        {
+          svn_checksum_t *checksum;
+
+          /* Clear ITERPOOL occasionally. */
+          if (iterations++ % 1024 == 0)
+            svn_pool_clear(iterpool);
+
+          err = svn_checksum_parse_hex(&checksum, svn_checksum_sha1,
+                                       svn_sqlite__column_text(stmt, 0,
+                                                               iterpool),
+                                       iterpool);
+          if (!err && checksum)
+            filter_add(filter, checksum->digest);
+
+          if (!err)
+            err = svn_sqlite__step(&have_row, stmt);
+        }
+
+      err = svn_error_compose_create(err, svn_sqlite__reset(stmt));
+    }
+  svn_pool_destroy(iterpool);
+
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  *filter_p = filter;
+
+  return SVN_NO_ERROR;
+}
+
+struct fs_fs_rep_cache_filter_updates_t
+{
+  /* Root pool owning this structure and the arrays. */
+  apr_pool_t *pool;
+
+  /* SHA1 digests of the keys added to the rep-cache database, each
+     APR_SHA1_DIGESTSIZE bytes. */
+  apr_array_header_t *digests;
+
+  /* The svn_revnum_t passed to svn_fs_fs__rep_cache_filter_add_revision(),
+     in the order of the calls. */
+  apr_array_header_t *revisions;
+};
+
+/* Set *MAY_EXIST to FALSE if the rep-cache filter of FS shows that the
+   SHA1 DIGEST is not in the rep-cache database and to TRUE otherwise.
+
+   Set *REBUILD to TRUE if the caller shall build a new filter and
+   install it with install_filter().  In that case, the rep-cache filter
+   updates of FS will have been started.  Otherwise, set it to FALSE.
+
+   If the filter does not cover the youngest revision of FS, e.g. because
+   other processes committed it, set *SYNC_REV to the youngest revision
+   that it covers and the caller shall catch up using sync_filter().
+   Otherwise, set it to SVN_INVALID_REVNUM.
+
+   The caller must hold the rep-cache filter lock. */
+static svn_error_t *
+filter_check(svn_boolean_t *may_exist,
+             svn_boolean_t *rebuild,
+             svn_revnum_t *sync_rev,
+             svn_fs_t *fs,
+             const unsigned char *digest)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter = ffd->shared->rep_cache_filter;
+
+  /* A filter that became too full or too old still gives correct answers,
+     so keep using it until its replacement is ready.  Only one thread
+     builds a new filter at a time. */
+  *rebuild = FALSE;
+  if (   (   !filter
+          || filter->count > filter->capacity
+          || ffd->youngest_rev_cache > filter->covered_rev + FILTER_MAX_LAG)
+      && !ffd->shared->rep_cache_filter_updates)
+    {
+      fs_fs_rep_cache_filter_updates_t *updates;
+      apr_pool_t *pool;
+
+      pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+      updates = apr_pcalloc(pool, sizeof(*updates));
+      updates->pool = pool;
+      updates->digests = apr_array_make(pool, 16, APR_SHA1_DIGESTSIZE);
+      updates->revisions = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+
+      ffd->shared->rep_cache_filter_updates = updates;
+      *rebuild = TRUE;
+    }
+
+  /* Revisions committed by other processes are not covered by the filter.
+     Only the database can tell whether they added DIGEST.  One thread
+     reads their keys while the others consult the database directly. */
+  *sync_rev = SVN_INVALID_REVNUM;
+  if (!filter || ffd->youngest_rev_cache > filter->covered_rev)
+    {
+      *may_exist = TRUE;
+      if (filter && !*rebuild && !filter->syncing)
+        {
+          filter->syncing = TRUE;
+          *sync_rev = filter->covered_rev;
+        }
+    }
+  else
+    *may_exist = filter_may_contain(filter, digest);
+
+  return SVN_NO_ERROR;
+}
+
+/* Make FILTER, created by build_filter(), the rep-cache filter of FS and
+   apply the updates that have been collected while building it.  If
+   FILTER is NULL, simply stop collecting updates.  The caller must hold
+   the rep-cache filter lock. */
+static svn_error_t *
+install_filter(svn_fs_t *fs,
+               fs_fs_rep_cache_filter_t *filter)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_updates_t *updates
+    = ffd->shared->rep_cache_filter_updates;
+  int i;
+
+  if (filter)
+    {
+      for (i = 0; i < updates->digests->nelts; ++i)
+        filter_add(filter, (const unsigned char *)updates->digests->elts
+                           + i * APR_SHA1_DIGESTSIZE);
+
+      for (i = 0; i < updates->revisions->nelts; ++i)
+        if (APR_ARRAY_IDX(updates->revisions, i, svn_revnum_t)
+            == filter->covered_rev + 1)
+          ++filter->covered_rev;
+
+      if (ffd->shared->rep_cache_filter)
+        svn_pool_destroy(ffd->shared->rep_cache_filter->pool);
+
+      ffd->shared->rep_cache_filter = filter;
+    }
+
+  svn_pool_destroy(updates->pool);
+  ffd->shared->rep_cache_filter_updates = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Build a new rep-cache filter for FS and install it.  This must follow
+   a filter_check() that requested the rebuild.  Use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+rebuild_filter(svn_fs_t *fs,
+               apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter;
+  svn_error_t *err;
+
+  /* Reading the whole database takes a while.  Don't block the other
+     threads' lookups and commits while we do that. */
+  err = build_filter(&filter, fs, scratch_pool);
+  if (err)
+    filter = NULL;
+
+  /* Install it or, upon failure, allow for the next attempt. */
+  SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                       svn_error_compose_create(err,
+                                                install_filter(fs, filter)));
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the SHA1 DIGEST to the rep-cache filter of FS, if that exists,
+   and to the filter updates, if a new filter is being built.  The caller
+   must hold the rep-cache filter lock. */
+static svn_error_t *
+filter_add_key(svn_fs_t *fs,
+               const unsigned char *digest)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_updates_t *updates
+    = ffd->shared->rep_cache_filter_updates;
+
+  if (ffd->shared->rep_cache_filter)
+    filter_add(ffd->shared->rep_cache_filter, digest);
+
+  if (updates)
+    memcpy(apr_array_push(updates->digests), digest, APR_SHA1_DIGESTSIZE);
+
+  return SVN_NO_ERROR;
+}
+
+/* Let the rep-cache filter of FS, if that exists, cover REVISION as well
+   if it covers all revisions before it.  Record REVISION in the filter
+   updates, if a new filter is being built.  The caller must hold the
+   rep-cache filter lock. */
+static svn_error_t *
+filter_add_revision(svn_fs_t *fs,
+                    svn_revnum_t revision)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter = ffd->shared->rep_cache_filter;
+  fs_fs_rep_cache_filter_updates_t *updates
+    = ffd->shared->rep_cache_filter_updates;
+
+  if (filter && filter->covered_rev + 1 == revision)
+    filter->covered_rev = revision;
+
+  if (updates)
+    APR_ARRAY_PUSH(updates->revisions, svn_revnum_t) = revision;
+
+  return SVN_NO_ERROR;
+}
+
+/* Append the SHA1 digests, APR_SHA1_DIGESTSIZE bytes each, of the keys
+   that revisions START_REV to END_REV added to the rep-cache database of
+   FS to DIGESTS.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_keys(apr_array_header_t *digests,
+          svn_fs_t *fs,
+          svn_revnum_t start_rev,
+          svn_revnum_t end_rev,
+          apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int iterations = 0;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_REPS_FOR_RANGE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "rr", start_rev, end_rev));
+
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (!err && have_row)
+    {
+      svn_checksum_t *checksum;
+
+      /* Clear ITERPOOL occasionally. */
+      if (iterations++ % 1024 == 0)
+        svn_pool_clear(iterpool);
+
+      err = svn_checksum_parse_hex(&checksum, svn_checksum_sha1,
+                                   svn_sqlite__column_text(stmt, 0,
+                                                           iterpool),
+                                   iterpool);
+      if (!err && checksum)
+        memcpy(apr_array_push(digests), checksum->digest,
+               APR_SHA1_DIGESTSIZE);
+
+      if (!err)
+        err = svn_sqlite__step(&have_row, stmt);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_compose_create(err, svn_sqlite__reset(stmt));
+}
+
+/* Add the SHA1 DIGESTS read by sync_filter() to the rep-cache filter of
+   FS and let it cover all revisions up to END_REV, if it covered START_REV
+   before.  If DIGESTS is NULL, simply allow for the next attempt.  Then,
+   set *MAY_EXIST for DIGEST as filter_check() would.  The caller must hold
+   the rep-cache filter lock. */
+static svn_error_t *
+install_keys(svn_boolean_t *may_exist,
+             svn_fs_t *fs,
+             apr_array_header_t *digests,
+             svn_revnum_t start_rev,
+             svn_revnum_t end_rev,
+             const unsigned char *digest)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter = ffd->shared->rep_cache_filter;
+  int i;
+
+  /* The filter may have been rebuilt in the meantime.  The keys don't
+     hurt in that case and the new filter's COVERED_REV tells whether they
+     close the gap to END_REV.  Keys that this process added already will
+     simply be counted twice. */
+  if (digests)
+    for (i = 0; i < digests->nelts; ++i)
+      SVN_ERR(filter_add_key(fs, (const unsigned char *)digests->elts
+                                 + i * APR_SHA1_DIGESTSIZE));
+
+  if (filter)
+    {
+      if (   digests
+          && filter->covered_rev + 1 >= start_rev
+          && filter->covered_rev < end_rev)
+        filter->covered_rev = end_rev;
+
+      filter->syncing = FALSE;
+    }
+
+  *may_exist = (   !filter
+                || ffd->youngest_rev_cache > filter->covered_rev
+                || filter_may_contain(filter, digest));
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the keys of the revisions after SYNC_REV up to the youngest
+   revision of FS from the database and add them to the rep-cache filter
+   of FS.  This must follow a filter_check() that requested the sync.
+   Set *MAY_EXIST for DIGEST as filter_check() would.  Use SCRATCH_POOL
+   for temporary allocations. */
+static svn_error_t *
+sync_filter(svn_boolean_t *may_exist,
+            svn_fs_t *fs,
+            svn_revnum_t sync_rev,
+            const unsigned char *digest,
+            apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_revnum_t youngest = ffd->youngest_rev_cache;
+  apr_array_header_t *digests;
+  svn_error_t *err;
+
+  /* As with building the filter, don't block the other threads while
+     we query the database.  Keys that a concurrent commit has yet to add
+     will be missed, which only costs us the chance to share them. */
+  digests = apr_array_make(scratch_pool, 16, APR_SHA1_DIGESTSIZE);
+  err = read_keys(digests, fs, sync_rev + 1, youngest, scratch_pool);
+  if (err)
+    digests = NULL;
+
+  SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                       svn_error_compose_create(err,
+                                                install_keys(may_exist, fs,
+                                                             digests,
+                                                             sync_rev + 1,
+                                                             youngest,
+                                                             digest)));
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /** Library-private API's. **/
 
@@ -112,6 +604,34 @@ open_rep_cache(void *baton,
       SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(sdb, stmt), sdb);
     }
 
+  /* Add the built_rev table to V1 and V2 databases and the revision
+     index to all older ones.  A read-only database simply won't tell
+     which revisions have been indexed and won't be searched as fast. */
+  if (version < REP_CACHE_SCHEMA_FORMAT)
+    {
+      svn_error_t *err = SVN_NO_ERROR;
+
+      if (version < 3)
+        err = svn_sqlite__exec_statements(sdb, STMT_UPGRADE_TO_V3);
+      if (!err)
+        err = svn_sqlite__exec_statements(sdb, STMT_UPGRADE_TO_V4);
+
+      if (err && svn_error_find_cause(err, SVN_ERR_SQLITE_READONLY))
+        {
+          svn_error_clear(err);
+          ffd->rep_cache_has_built_rev = (version >= 3);
+        }
+      else
+        {
+          SVN_SQLITE__ERR_CLOSE(err, sdb);
+          ffd->rep_cache_has_built_rev = TRUE;
+        }
+    }
+  else
+    {
+      ffd->rep_cache_has_built_rev = TRUE;
+    }
+
   /* This is used as a flag that the database is available so don't
      set it earlier. */
   ffd->rep_cache_db = sdb;
@@ -281,6 +801,30 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
+  /* Most new contents have never been seen before.  Try to tell that
+     without asking the database. */
+  if (ffd->use_rep_cache_filter)
+    {
+      svn_boolean_t may_exist;
+      svn_boolean_t rebuild;
+      svn_revnum_t sync_rev;
+
+      SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                           filter_check(&may_exist, &rebuild, &sync_rev, fs,
+                                        checksum->digest));
+      if (rebuild)
+        SVN_ERR(rebuild_filter(fs, pool));
+      else if (SVN_IS_VALID_REVNUM(sync_rev))
+        SVN_ERR(sync_filter(&may_exist, fs, sync_rev, checksum->digest,
+                            pool));
+
+      if (!may_exist)
+        {
+          *rep_p = NULL;
+          return SVN_NO_ERROR;
+        }
+    }
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_GET_REP));
   SVN_ERR(svn_sqlite__bindf(stmt, "s",
                             svn_checksum_to_cstring(checksum, pool)));
@@ -352,6 +896,134 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
 
   SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
+  if (ffd->use_rep_cache_filter)
+    SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                         filter_add_key(fs, rep->sha1_digest));
+
+  return SVN_NO_ERROR;
+}
+
+/* Sort callback for svn_sort__array ordering representation_t * by
+   their SHA1 digests, i.e. by their keys in the rep-cache. */
+static int
+compare_rep_sha1(const void *lhs,
+                 const void *rhs)
+{
+  const representation_t *lhs_rep = *(const representation_t * const *)lhs;
+  const representation_t *rhs_rep = *(const representation_t * const *)rhs;
+
+  return memcmp(lhs_rep->sha1_digest, rhs_rep->sha1_digest,
+                sizeof(lhs_rep->sha1_digest));
+}
+
+/* Baton type for set_rep_references_body(). */
+typedef struct set_rep_references_baton_t
+{
+  svn_fs_t *fs;
+  const apr_array_header_t *reps;
+  svn_revnum_t built_rev;
+} set_rep_references_baton_t;
+
+/* Implements svn_sqlite__transaction_callback_t for
+   svn_fs_fs__set_rep_references(). */
+static svn_error_t *
+set_rep_references_body(void *baton,
+                        svn_sqlite__db_t *db,
+                        apr_pool_t *scratch_pool)
+{
+  set_rep_references_baton_t *b = baton;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < b->reps->nelts; ++i)
+    {
+      representation_t *rep = APR_ARRAY_IDX(b->reps, i, representation_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__set_rep_reference(b->fs, rep, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  if (SVN_IS_VALID_REVNUM(b->built_rev))
+    {
+      fs_fs_data_t *ffd = b->fs->fsap_data;
+      svn_sqlite__stmt_t *stmt;
+
+      /* Only read-only databases lack the table. */
+      SVN_ERR_ASSERT(ffd->rep_cache_has_built_rev);
+      SVN_ERR(svn_sqlite__get_statement(&stmt, db, STMT_SET_BUILT_REV));
+      SVN_ERR(svn_sqlite__bindf(stmt, "r", b->built_rev));
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              apr_array_header_t *reps,
+                              svn_revnum_t built_rev,
+                              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  set_rep_references_baton_t baton;
+
+  SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
+  if (! ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, scratch_pool));
+
+  /* Inserting in key order keeps the B-tree updates local. */
+  svn_sort__array(reps, compare_rep_sha1);
+
+  baton.fs = fs;
+  baton.reps = reps;
+  baton.built_rev = built_rev;
+
+  SVN_ERR(svn_sqlite__with_transaction(ffd->rep_cache_db,
+                                       set_rep_references_body, &baton,
+                                       scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__get_rep_cache_built_rev(svn_revnum_t *built_rev,
+                                   svn_fs_t *fs,
+                                   apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR_ASSERT(ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT);
+  if (! ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, scratch_pool));
+
+  /* Revision 0 never has rep-cache entries. */
+  *built_rev = 0;
+  if (!ffd->rep_cache_has_built_rev)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_BUILT_REV));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    *built_rev = svn_sqlite__column_revnum(stmt, 0);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_fs_fs__rep_cache_filter_add_revision(svn_fs_t *fs,
+                                         svn_revnum_t revision)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->use_rep_cache_filter)
+    SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                         filter_add_revision(fs, revision));
+
   return SVN_NO_ERROR;
 }
 
@@ -373,6 +1045,15 @@ svn_fs_fs__del_rep_reference(svn_fs_t *fs,
   SVN_ERR(svn_sqlite__bindf(stmt, "r", youngest));
   SVN_ERR(svn_sqlite__step_done(stmt));
 
+  /* Revisions after YOUNGEST will need to be indexed again. */
+  if (ffd->rep_cache_has_built_rev)
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                        STMT_LIMIT_BUILT_REV));
+      SVN_ERR(svn_sqlite__bindf(stmt, "r", youngest));
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
   return SVN_NO_ERROR;
 }
 
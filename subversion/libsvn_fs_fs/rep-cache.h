@@ -83,8 +83,35 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                              representation_t *rep,
                              apr_pool_t *pool);
 
+/* Add all representation_t * in REPS to the rep-cache of FS within a
+   single SQLite transaction, re-ordering REPS by key on the way.  If
+   BUILT_REV is a valid revision, record it in the same transaction as
+   the youngest revision up to which the rep-cache has been built.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              apr_array_header_t *reps,
+                              svn_revnum_t built_rev,
+                              apr_pool_t *scratch_pool);
+
+/* Set *BUILT_REV to the youngest revision up to which all revisions of FS
+   have been added to its rep-cache by svn_fs_fs__set_rep_references().
+   Set it to 0 if there is no such record.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_fs_fs__get_rep_cache_built_rev(svn_revnum_t *built_rev,
+                                   svn_fs_t *fs,
+                                   apr_pool_t *scratch_pool);
+
+/* Tell the in-memory filter of the rep-cache of FS, if any, that all
+   new representations of REVISION have been added to the rep-cache. */
+svn_error_t *
+svn_fs_fs__rep_cache_filter_add_revision(svn_fs_t *fs,
+                                         svn_revnum_t revision);
+
 /* Delete from the cache all reps corresponding to revisions younger
-   than YOUNGEST. */
+   than YOUNGEST.  Lower the recorded youngest fully indexed revision
+   to YOUNGEST as well. */
 svn_error_t *
 svn_fs_fs__del_rep_reference(svn_fs_t *fs,
                              svn_revnum_t youngest,
@@ -26,11 +26,69 @@
 #include "low_level.h"
 #include "util.h"
 
+#include <apr_mmap.h>
+
 #include "../libsvn_fs/fs-loader.h"
 
+#include "svn_sorts.h"
+
 #include "private/svn_io_private.h"
+#include "private/svn_delta_private.h"
 #include "svn_private_config.h"
 
+/* Largest pack file that we will map into memory on systems with a small
+ * address space. */
+#define MAX_MAPPED_SIZE_32BIT (256 * 1024 * 1024)
+
+/* Upper limit to the total size of all pack files mapped by a single FS
+ * on systems with a small address space. */
+#define MAX_MAPPED_TOTAL_32BIT (512 * 1024 * 1024)
+
+/* Maximum number of pack files that a single FS keeps mapped. */
+#define MAX_PACK_MAPPINGS 64
+
+/* A pack file mapped into memory.  Pack files never change, so the
+ * mapping stays valid for as long as the FS is open and all revision
+ * files of that FS that read from the same pack file share it. */
+typedef struct fs_fs_pack_mapping_t
+{
+  /* First revision in the pack file. */
+  svn_revnum_t start_revision;
+
+  /* Contents of the pack file. */
+  const char *data;
+  apr_size_t size;
+
+  /* Number of revision files currently reading from DATA.  The mapping
+   * may only be removed while this is 0. */
+  int users;
+
+  /* Set when the owning FS has been closed while there were still USERS.
+   * The last of them removes the mapping. */
+  svn_boolean_t orphaned;
+
+  /* Value of the owner's USE_COUNTER when this mapping was used last. */
+  apr_uint64_t last_use;
+
+  /* Root pool owning this structure and the mapping.  Destroying it
+   * removes the mapping. */
+  apr_pool_t *pool;
+} fs_fs_pack_mapping_t;
+
+/* All pack files mapped by a single FS. */
+struct fs_fs_pack_mappings_t
+{
+  /* COUNT mappings in no particular order. */
+  fs_fs_pack_mapping_t *mappings[MAX_PACK_MAPPINGS];
+  int count;
+
+  /* Sum of the sizes of all MAPPINGS. */
+  apr_uint64_t total_size;
+
+  /* Incremented for every use of a mapping. */
+  apr_uint64_t use_counter;
+};
+
 /* Initialize the *FILE structure for REVISION in filesystem FS.  Set its
  * pool member to the provided POOL. */
 static void
@@ -46,6 +104,11 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
 
   file->file = NULL;
   file->stream = NULL;
+  file->mapped_data = NULL;
+  file->mapped_size = 0;
+  file->mapped_pos = 0;
+  file->mapped_stream = NULL;
+  file->mapping = NULL;
   file->p2l_stream = NULL;
   file->l2p_stream = NULL;
   file->block_size = ffd->block_size;
@@ -120,6 +183,269 @@ auto_make_writable(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_read_fn_t for the stream on the memory mapped contents
+ * of the svn_fs_fs__revision_file_t in BATON.  Reads never go short
+ * except at the end of the data. */
+static svn_error_t *
+mapped_read_handler(void *baton,
+                    char *buffer,
+                    apr_size_t *len)
+{
+  svn_fs_fs__revision_file_t *file = baton;
+  apr_size_t available = file->mapped_pos < file->mapped_size
+                       ? file->mapped_size - file->mapped_pos
+                       : 0;
+
+  *len = MIN(*len, available);
+  memcpy(buffer, file->mapped_data + file->mapped_pos, *len);
+  file->mapped_pos += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_stream_skip_fn_t for the stream on the memory mapped
+ * contents of the svn_fs_fs__revision_file_t in BATON. */
+static svn_error_t *
+mapped_skip_handler(void *baton,
+                    apr_size_t len)
+{
+  svn_fs_fs__revision_file_t *file = baton;
+  file->mapped_pos += len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_stream_readline_fn_t for the stream on the memory mapped
+ * contents of the svn_fs_fs__revision_file_t in BATON.  Scans the mapped
+ * data directly instead of reading it byte-by-byte. */
+static svn_error_t *
+mapped_readline_handler(void *baton,
+                        svn_stringbuf_t **stringbuf,
+                        const char *eol,
+                        svn_boolean_t *eof,
+                        apr_pool_t *pool)
+{
+  svn_fs_fs__revision_file_t *file = baton;
+  apr_size_t eol_len = strlen(eol);
+  const char *start = file->mapped_data + file->mapped_pos;
+  const char *end = file->mapped_data + file->mapped_size;
+  const char *line_end = start;
+
+  if (file->mapped_pos >= file->mapped_size)
+    {
+      *stringbuf = svn_stringbuf_create_empty(pool);
+      *eof = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  while (TRUE)
+    {
+      line_end = memchr(line_end, eol[0], end - line_end);
+      if (line_end == NULL || end - line_end < (apr_ssize_t)eol_len)
+        {
+          /* No EOL before the end of the data. */
+          *stringbuf = svn_stringbuf_ncreate(start, end - start, pool);
+          file->mapped_pos = file->mapped_size;
+          *eof = TRUE;
+          return SVN_NO_ERROR;
+        }
+
+      if (memcmp(line_end, eol, eol_len) == 0)
+        break;
+
+      ++line_end;
+    }
+
+  *stringbuf = svn_stringbuf_ncreate(start, line_end - start, pool);
+  file->mapped_pos = line_end + eol_len - file->mapped_data;
+  *eof = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_MMAP
+
+/* Remove the least recently used mapping from MAPPINGS that is currently
+ * not in use.  Return FALSE if there is no such mapping. */
+static svn_boolean_t
+drop_idle_mapping(fs_fs_pack_mappings_t *mappings)
+{
+  int i;
+  int victim = -1;
+
+  for (i = 0; i < mappings->count; ++i)
+    if (   mappings->mappings[i]->users == 0
+        && (   victim < 0
+            || mappings->mappings[i]->last_use
+                 < mappings->mappings[victim]->last_use))
+      victim = i;
+
+  if (victim < 0)
+    return FALSE;
+
+  mappings->total_size -= mappings->mappings[victim]->size;
+  svn_pool_destroy(mappings->mappings[victim]->pool);
+  mappings->mappings[victim] = mappings->mappings[--mappings->count];
+
+  return TRUE;
+}
+
+/* Return the mapping of the pack file opened in FILE in *MAPPING.
+ * Re-use an existing mapping in MAPPINGS or create a new one.  Set
+ * *MAPPING to NULL if the file cannot or should not be mapped. */
+static void
+get_pack_mapping(fs_fs_pack_mapping_t **mapping,
+                 fs_fs_pack_mappings_t *mappings,
+                 svn_fs_fs__revision_file_t *file)
+{
+  fs_fs_pack_mapping_t *result;
+  apr_pool_t *pool;
+  apr_finfo_t finfo;
+  apr_mmap_t *mmap;
+  int i;
+
+  *mapping = NULL;
+
+  for (i = 0; i < mappings->count; ++i)
+    if (mappings->mappings[i]->start_revision == file->start_revision)
+      {
+        *mapping = mappings->mappings[i];
+        return;
+      }
+
+  if (apr_file_info_get(&finfo, APR_FINFO_SIZE, file->file))
+    return;
+
+  /* Empty files cannot be mapped and anything beyond the address space
+   * (or a good part of it for 32 bit systems) should not. */
+  if (finfo.size <= 0 || (apr_size_t)finfo.size != finfo.size)
+    return;
+  if (sizeof(apr_size_t) < 8 && finfo.size > MAX_MAPPED_SIZE_32BIT)
+    return;
+
+  /* Make room. */
+  while (   mappings->count == MAX_PACK_MAPPINGS
+         || (   sizeof(apr_size_t) < 8
+             && mappings->total_size + finfo.size > MAX_MAPPED_TOTAL_32BIT))
+    if (!drop_idle_mapping(mappings))
+      return;
+
+  /* The mapping remains valid after FILE got closed.  Revision files may
+   * outlive the FS, so don't tie the mapping to the FS pool. */
+  pool = svn_pool_create(NULL);
+  if (apr_mmap_create(&mmap, file->file, 0, (apr_size_t)finfo.size,
+                      APR_MMAP_READ, pool))
+    {
+      svn_pool_destroy(pool);
+      return;
+    }
+
+  result = apr_pcalloc(pool, sizeof(*result));
+  result->start_revision = file->start_revision;
+  result->data = mmap->mm;
+  result->size = mmap->size;
+  result->pool = pool;
+
+  mappings->mappings[mappings->count++] = result;
+  mappings->total_size += result->size;
+
+  *mapping = result;
+}
+
+/* Implements apr_pool_cleanup_t.  Stop the svn_fs_fs__revision_file_t
+ * in DATA from using its pack file mapping. */
+static apr_status_t
+release_pack_mapping(void *data)
+{
+  svn_fs_fs__revision_file_t *file = data;
+
+  if (file->mapping)
+    {
+      if (--file->mapping->users == 0 && file->mapping->orphaned)
+        svn_pool_destroy(file->mapping->pool);
+      file->mapping = NULL;
+    }
+
+  file->mapped_data = NULL;
+  file->mapped_size = 0;
+  file->mapped_pos = 0;
+  file->mapped_stream = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* Implements apr_pool_cleanup_t.  Remove all mappings in the
+ * fs_fs_pack_mappings_t in DATA that are not in use and let the last
+ * user remove the others. */
+static apr_status_t
+close_pack_mappings(void *data)
+{
+  fs_fs_pack_mappings_t *mappings = data;
+  int i;
+
+  for (i = 0; i < mappings->count; ++i)
+    if (mappings->mappings[i]->users)
+      mappings->mappings[i]->orphaned = TRUE;
+    else
+      svn_pool_destroy(mappings->mappings[i]->pool);
+
+  mappings->count = 0;
+  mappings->total_size = 0;
+
+  return APR_SUCCESS;
+}
+
+#endif
+
+/* If FS has been configured to do so, let FILE read the contents of the
+ * pack file already opened in it from a memory mapping.  Mappings are
+ * kept by FS and re-used by all revision files reading from the same
+ * pack file.  Fail silently and keep using the buffered file if that is
+ * not possible.  Allocate the stream in RESULT_POOL. */
+static void
+auto_map_pack_file(svn_fs_fs__revision_file_t *file,
+                   svn_fs_t *fs,
+                   apr_pool_t *result_pool)
+{
+#if APR_HAS_MMAP
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_pack_mapping_t *mapping;
+
+  if (!ffd->mmap_pack_files || !file->is_packed)
+    return;
+
+  if (!ffd->pack_mappings)
+    {
+      ffd->pack_mappings = apr_pcalloc(fs->pool,
+                                       sizeof(*ffd->pack_mappings));
+      apr_pool_cleanup_register(fs->pool, ffd->pack_mappings,
+                                close_pack_mappings, apr_pool_cleanup_null);
+    }
+
+  get_pack_mapping(&mapping, ffd->pack_mappings, file);
+  if (!mapping)
+    return;
+
+  mapping->users++;
+  mapping->last_use = ++ffd->pack_mappings->use_counter;
+
+  file->mapping = mapping;
+  file->mapped_data = mapping->data;
+  file->mapped_size = mapping->size;
+  file->mapped_pos = 0;
+
+  file->mapped_stream = svn_stream_create(file, result_pool);
+  svn_stream_set_read2(file->mapped_stream, mapped_read_handler,
+                       mapped_read_handler);
+  svn_stream_set_skip(file->mapped_stream, mapped_skip_handler);
+  svn_stream_set_readline(file->mapped_stream, mapped_readline_handler);
+
+  /* Revision files often don't get closed explicitly. */
+  apr_pool_cleanup_register(result_pool, file, release_pack_mapping,
+                            apr_pool_cleanup_null);
+#endif
+}
+
 /* Core implementation of svn_fs_fs__open_pack_or_rev_file working on an
  * existing, initialized FILE structure.  If WRITABLE is TRUE, give write
  * access to the file - temporarily resetting the r/o state if necessary.
@@ -160,6 +486,11 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
                                                   result_pool);
           file->is_packed = svn_fs_fs__is_packed_rev(fs, rev);
 
+          /* Pack files are immutable, i.e. we may map them as long as
+           * we don't intend to modify them. */
+          if (!writable)
+            auto_map_pack_file(file, fs, result_pool);
+
           return SVN_NO_ERROR;
         }
 
@@ -237,22 +568,26 @@ svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
       svn_stringbuf_t *footer;
 
       /* Determine file size. */
-      SVN_ERR(svn_io_file_seek(file->file, APR_END, &filesize, file->pool));
+      if (file->mapped_data)
+        filesize = file->mapped_size;
+      else
+        SVN_ERR(svn_io_file_seek(file->file, APR_END, &filesize,
+                                 file->pool));
 
       /* Read last byte (containing the length of the footer). */
-      SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
-                                       filesize - 1, file->pool));
-      SVN_ERR(svn_io_file_read_full2(file->file, &footer_length,
-                                     sizeof(footer_length), NULL, NULL,
-                                     file->pool));
+      SVN_ERR(svn_fs_fs__rev_file_aligned_seek(file, NULL, filesize - 1,
+                                               file->pool));
+      SVN_ERR(svn_fs_fs__rev_file_read(file, &footer_length,
+                                       sizeof(footer_length), file->pool));
 
       /* Read footer. */
       footer = svn_stringbuf_create_ensure(footer_length, file->pool);
-      SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
-                                       filesize - 1 - footer_length,
+      SVN_ERR(svn_fs_fs__rev_file_aligned_seek(file, NULL,
+                                               filesize - 1 - footer_length,
+                                               file->pool));
+      SVN_ERR(svn_fs_fs__rev_file_read(file, footer->data, footer_length,
                                        file->pool));
-      SVN_ERR(svn_io_file_read_full2(file->file, footer->data, footer_length,
-                                     &footer->len, NULL, file->pool));
+      footer->len = footer_length;
       footer->data[footer->len] = '\0';
 
       /* Extract index locations. */
@@ -267,6 +602,133 @@ svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__rev_file_aligned_seek(svn_fs_fs__revision_file_t *file,
+                                 apr_off_t *buffer_start,
+                                 apr_off_t offset,
+                                 apr_pool_t *scratch_pool)
+{
+  if (file->mapped_data)
+    {
+      /* There are no buffers to align to but callers may still use
+       * BUFFER_START to detect data that will be read "for free". */
+      if (buffer_start)
+        *buffer_start = file->block_size
+                      ? offset - offset % file->block_size
+                      : offset;
+
+      SVN_ERR(svn_fs_fs__rev_file_seek(file, offset, scratch_pool));
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_io_file_aligned_seek(file->file,
+                                                  file->block_size,
+                                                  buffer_start, offset,
+                                                  scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__rev_file_seek(svn_fs_fs__revision_file_t *file,
+                         apr_off_t offset,
+                         apr_pool_t *scratch_pool)
+{
+  if (file->mapped_data)
+    {
+      if (offset < 0 || (apr_uint64_t)offset > file->mapped_size)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Offset %s beyond the end of the pack "
+                                   "file for revision %ld"),
+                                 apr_off_t_toa(scratch_pool, offset),
+                                 file->start_revision);
+
+      file->mapped_pos = (apr_size_t)offset;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_io_file_seek(file->file, APR_SET, &offset,
+                                          scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__rev_file_offset(apr_off_t *offset,
+                           svn_fs_fs__revision_file_t *file,
+                           apr_pool_t *scratch_pool)
+{
+  if (file->mapped_data)
+    {
+      *offset = file->mapped_pos;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_io_file_get_offset(offset, file->file,
+                                                scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__rev_file_read(svn_fs_fs__revision_file_t *file,
+                         void *buf,
+                         apr_size_t len,
+                         apr_pool_t *scratch_pool)
+{
+  if (file->mapped_data)
+    {
+      if (   file->mapped_pos > file->mapped_size
+          || file->mapped_size - file->mapped_pos < len)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Unexpected end of the pack file for "
+                                   "revision %ld"),
+                                 file->start_revision);
+
+      memcpy(buf, file->mapped_data + file->mapped_pos, len);
+      file->mapped_pos += len;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_io_file_read_full2(file->file, buf, len,
+                                                NULL, NULL, scratch_pool));
+}
+
+svn_stream_t *
+svn_fs_fs__rev_file_stream(svn_fs_fs__revision_file_t *file)
+{
+  return file->mapped_stream ? file->mapped_stream : file->stream;
+}
+
+svn_error_t *
+svn_fs_fs__rev_file_skip_svndiff_window(svn_fs_fs__revision_file_t *file,
+                                        int version,
+                                        apr_pool_t *scratch_pool)
+{
+  if (file->mapped_data)
+    {
+      /* The raw window length includes the header that we are about to
+       * parse. */
+      apr_size_t start = file->mapped_pos;
+      apr_size_t window_len;
+
+      SVN_ERR(svn_txdelta__read_raw_window_len(&window_len,
+                                               file->mapped_stream,
+                                               scratch_pool));
+      file->mapped_pos = start + window_len;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_txdelta_skip_svndiff_window(file->file,
+                                                         version,
+                                                         scratch_pool));
+}
+
+void
+svn_fs_fs__rev_file_prefetch(svn_fs_fs__revision_file_t *file,
+                             apr_off_t offset,
+                             apr_off_t length)
+{
+  /* Even when the file is memory mapped, the hint populates the same
+   * OS file cache pages that back the mapping. */
+  if (file->file)
+    svn_io__file_prefetch(file->file, offset, length);
+}
+
 svn_error_t *
 svn_fs_fs__open_proto_rev_file(svn_fs_fs__revision_file_t **file,
                                svn_fs_t *fs,
@@ -298,6 +760,12 @@ svn_fs_fs__close_revision_file(svn_fs_fs__revision_file_t *file)
   if (file->file)
     SVN_ERR(svn_io_file_close(file->file, file->pool));
 
+#if APR_HAS_MMAP
+  /* The mapping itself stays with the FS for re-use. */
+  if (file->mapping)
+    apr_pool_cleanup_run(file->pool, file, release_pack_mapping);
+#endif
+
   file->file = NULL;
   file->stream = NULL;
   file->l2p_stream = NULL;
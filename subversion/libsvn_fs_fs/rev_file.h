@@ -57,6 +57,25 @@ typedef struct svn_fs_fs__revision_file_t
   /* stream based on FILE and not NULL exactly when FILE is not NULL */
   svn_stream_t *stream;
 
+  /* Contents of the whole pack file if it has been mapped into memory.
+   * NULL otherwise.  Use the svn_fs_fs__rev_file_* access functions below
+   * to read from whichever of MAPPED_DATA and FILE is in use. */
+  const char *mapped_data;
+
+  /* Size of MAPPED_DATA in bytes.  0 if not mapped. */
+  apr_size_t mapped_size;
+
+  /* Current read position within MAPPED_DATA. */
+  apr_size_t mapped_pos;
+
+  /* Stream reading from MAPPED_DATA at MAPPED_POS.  NULL if not mapped. */
+  svn_stream_t *mapped_stream;
+
+  /* The mapping of the pack file that backs MAPPED_DATA.  It is owned by
+   * the FS and shared with other revision files reading the same pack
+   * file.  NULL if not mapped. */
+  struct fs_fs_pack_mapping_t *mapping;
+
   /* the opened P2L index stream or NULL.  Always NULL for txns. */
   svn_fs_fs__packed_number_stream_t *p2l_stream;
 
@@ -128,6 +147,64 @@ svn_fs_fs__open_pack_or_rev_file_writable(svn_fs_fs__revision_file_t **file,
 svn_error_t *
 svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file);
 
+/* Set the read position in FILE to OFFSET.  If BUFFER_START is not NULL,
+ * it will be set to the start of the block containing OFFSET, like
+ * svn_io_file_aligned_seek does.  Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_fs__rev_file_aligned_seek(svn_fs_fs__revision_file_t *file,
+                                 apr_off_t *buffer_start,
+                                 apr_off_t offset,
+                                 apr_pool_t *scratch_pool);
+
+/* Set the read position in FILE to OFFSET without any block alignment.
+ * Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_fs__rev_file_seek(svn_fs_fs__revision_file_t *file,
+                         apr_off_t offset,
+                         apr_pool_t *scratch_pool);
+
+/* Return the current read position in FILE in *OFFSET.
+ * Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_fs__rev_file_offset(apr_off_t *offset,
+                           svn_fs_fs__revision_file_t *file,
+                           apr_pool_t *scratch_pool);
+
+/* Read exactly LEN bytes from the current position in FILE into BUF.
+ * Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_fs__rev_file_read(svn_fs_fs__revision_file_t *file,
+                         void *buf,
+                         apr_size_t len,
+                         apr_pool_t *scratch_pool);
+
+/* Return the stream to read the contents of FILE from its current
+ * position.  This is either FILE->STREAM or the stream on the memory
+ * mapped contents.
+ */
+svn_stream_t *
+svn_fs_fs__rev_file_stream(svn_fs_fs__revision_file_t *file);
+
+/* Skip the svndiff window of format VERSION at the current position in
+ * FILE.  Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_fs__rev_file_skip_svndiff_window(svn_fs_fs__revision_file_t *file,
+                                        int version,
+                                        apr_pool_t *scratch_pool);
+
+/* Hint the OS to fetch the LENGTH bytes at OFFSET in FILE from disk in
+ * the background, because we are going to read them soon.
+ */
+void
+svn_fs_fs__rev_file_prefetch(svn_fs_fs__revision_file_t *file,
+                             apr_off_t offset,
+                             apr_off_t length);
+
 /* Open the proto-rev file of transaction TXN_ID in FS and return it in *FILE.
  * Allocate *FILE in RESULT_POOL use and SCRATCH_POOL for temporaries.. */
 svn_error_t *
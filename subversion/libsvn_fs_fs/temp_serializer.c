@@ -144,6 +144,21 @@ serialize_representation(svn_temp_serializer__context_t *context,
                                 sizeof(**representation));
 }
 
+/* Directories with at least this many entries get a hash index for
+ * name lookups.  For smaller ones, the binary search is fast enough. */
+#define DIR_INDEX_THRESHOLD 128
+
+/* A slot in the open-addressing hash index of a serialized directory. */
+typedef struct dir_index_slot_t
+{
+  /* Hash value of the entry name. */
+  apr_uint32_t hash;
+
+  /* Position of the entry in the entries array plus 1.
+   * 0 for unused slots. */
+  apr_uint32_t pos;
+} dir_index_slot_t;
+
 /* auxiliary structure representing the content of a directory array */
 typedef struct dir_data_t
 {
@@ -173,8 +188,58 @@ typedef struct dir_data_t
   /* size of the serialized entries and don't be too wasteful
    * (needed since the entries are no longer in sequence) */
   apr_uint32_t *lengths;
+
+  /* hash index over the entry names with INDEX_MASK + 1 slots.
+   * NULL for small directories and once entries have been modified
+   * in-place, i.e. the positions in the index are no longer valid. */
+  dir_index_slot_t *index;
+  apr_uint32_t index_mask;
 } dir_data_t;
 
+/* Return the hash value used in the directory index for NAME. */
+static apr_uint32_t
+hash_dir_entry_name(const char *name)
+{
+  return svn__fnv1a_32(name, strlen(name));
+}
+
+/* Set DIR_DATA->INDEX and DIR_DATA->INDEX_MASK for the DIR_DATA->COUNT
+ * (not yet serialized) entries in DIR_DATA->ENTRIES.  Leave the index
+ * empty for small directories.  Allocate it in POOL.
+ */
+static void
+build_dir_index(dir_data_t *dir_data,
+                apr_pool_t *pool)
+{
+  apr_size_t slot_count = 2;
+  int i;
+
+  dir_data->index = NULL;
+  dir_data->index_mask = 0;
+  if (dir_data->count < DIR_INDEX_THRESHOLD)
+    return;
+
+  /* Use the smallest power of two that keeps the fill rate at or below
+   * 75%.  With 8 bytes per slot, that is 11 to 22 bytes per entry. */
+  while (slot_count * 3 < 4 * (apr_size_t)dir_data->count)
+    slot_count *= 2;
+
+  dir_data->index = apr_pcalloc(pool, slot_count * sizeof(*dir_data->index));
+  dir_data->index_mask = (apr_uint32_t)(slot_count - 1);
+
+  for (i = 0; i < dir_data->count; ++i)
+    {
+      apr_uint32_t hash = hash_dir_entry_name(dir_data->entries[i]->name);
+      apr_uint32_t slot = hash & dir_data->index_mask;
+
+      while (dir_data->index[slot].pos)
+        slot = (slot + 1) & dir_data->index_mask;
+
+      dir_data->index[slot].hash = hash;
+      dir_data->index[slot].pos = (apr_uint32_t)i + 1;
+    }
+}
+
 /* Utility function to serialize the *ENTRY_P into a the given
  * serialization CONTEXT. Return the serialized size of the
  * dir entry in *LENGTH.
@@ -217,6 +282,7 @@ serialize_dir(svn_fs_fs__dir_data_t *dir, apr_pool_t *pool)
   apr_size_t total_count = count + over_provision;
   apr_size_t entries_len = total_count * sizeof(*dir_data.entries);
   apr_size_t lengths_len = total_count * sizeof(*dir_data.lengths);
+  apr_size_t index_len;
 
   /* copy the hash entries to an auxiliary struct of known layout */
   dir_data.count = count;
@@ -229,11 +295,17 @@ serialize_dir(svn_fs_fs__dir_data_t *dir, apr_pool_t *pool)
   for (i = 0; i < count; ++i)
     dir_data.entries[i] = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
 
+  build_dir_index(&dir_data, pool);
+  index_len = dir_data.index
+            ? (dir_data.index_mask + 1) * sizeof(*dir_data.index)
+            : 0;
+
   /* Serialize that aux. structure into a new one. Also, provide a good
    * estimate for the size of the buffer that we will need. */
   context = svn_temp_serializer__init(&dir_data,
                                       sizeof(dir_data),
-                                      50 + count * 200 + entries_len,
+                                      50 + count * 200 + entries_len
+                                         + index_len,
                                       pool);
 
   /* serialize entries references */
@@ -253,6 +325,12 @@ serialize_dir(svn_fs_fs__dir_data_t *dir, apr_pool_t *pool)
   svn_temp_serializer__push(context,
                             (const void * const *)&dir_data.lengths,
                             lengths_len);
+  svn_temp_serializer__pop(context);
+
+  /* serialize the name index */
+  svn_temp_serializer__add_leaf(context,
+                                (const void * const *)&dir_data.index,
+                                index_len);
 
   return context;
 }
@@ -881,6 +959,15 @@ svn_fs_fs__extract_dir_filesize(void **out,
   return SVN_NO_ERROR;
 }
 
+svn_boolean_t
+svn_fs_fs__dir_entries_indexed(const void *data)
+{
+  const dir_data_t *dir_data = data;
+
+  /* In serialized form, the pointer is an offset that is 0 for NULL. */
+  return dir_data->index != NULL;
+}
+
 /* Utility function that returns the lowest index of the first entry in
  * *ENTRIES that points to a dir entry with a name equal or larger than NAME.
  * If an exact match has been found, *FOUND will be set to TRUE. COUNT is
@@ -927,6 +1014,47 @@ find_entry(svn_fs_dirent_t **entries,
   return lower;
 }
 
+/* Like find_entry() but use the hash index of the serialized DIR_DATA,
+ * which must exist.  Set *FOUND accordingly.  The result is only valid
+ * if an exact match has been found.
+ */
+static apr_size_t
+find_indexed_entry(const dir_data_t *dir_data,
+                   svn_fs_dirent_t **entries,
+                   const char *name,
+                   svn_boolean_t *found)
+{
+  const dir_index_slot_t *index =
+      svn_temp_deserializer__ptr(dir_data,
+                                 (const void *const *)&dir_data->index);
+  apr_uint32_t hash = hash_dir_entry_name(name);
+  apr_uint32_t slot;
+
+  /* Only entries with matching hash values need a string compare. */
+  for (slot = hash & dir_data->index_mask;
+       index[slot].pos;
+       slot = (slot + 1) & dir_data->index_mask)
+    if (index[slot].hash == hash)
+      {
+        apr_size_t pos = index[slot].pos - 1;
+        const svn_fs_dirent_t *entry =
+            svn_temp_deserializer__ptr(entries,
+                                       (const void *const *)&entries[pos]);
+        const char* entry_name =
+            svn_temp_deserializer__ptr(entry,
+                                       (const void *const *)&entry->name);
+
+        if (strcmp(entry_name, name) == 0)
+          {
+            *found = TRUE;
+            return pos;
+          }
+      }
+
+  *found = FALSE;
+  return 0;
+}
+
 svn_error_t *
 svn_fs_fs__extract_dir_entry(void **out,
                              const void *data,
@@ -946,8 +1074,14 @@ svn_fs_fs__extract_dir_entry(void **out,
   const apr_uint32_t *lengths =
     svn_temp_deserializer__ptr(data, (const void *const *)&dir_data->lengths);
 
-  /* binary search for the desired entry by name */
-  apr_size_t pos = find_entry((svn_fs_dirent_t **)entries,
+  /* use the index, if available, or do a binary search for the desired
+   * entry by name */
+  apr_size_t pos = dir_data->index
+                 ? find_indexed_entry(dir_data,
+                                      (svn_fs_dirent_t **)entries,
+                                      entry_baton->name,
+                                      &found)
+                 : find_entry((svn_fs_dirent_t **)entries,
                               entry_baton->name,
                               dir_data->count,
                               &found);
@@ -981,6 +1115,18 @@ svn_fs_fs__extract_dir_entry(void **out,
   return SVN_NO_ERROR;
 }
 
+/* Utility function for svn_fs_fs__replace_dir_entry that disables the
+ * hash index of the serialized DIR_DATA after entry positions changed.
+ * Rather than updating the index, lookups fall back to binary search until
+ * the next re-pack rebuilds it.
+ */
+static void
+drop_dir_index(dir_data_t *dir_data)
+{
+  dir_data->index = NULL;
+  dir_data->index_mask = 0;
+}
+
 /* Utility function for svn_fs_fs__replace_dir_entry that implements the
  * modification as a simply deserialize / modify / serialize sequence.
  */
@@ -1078,6 +1224,7 @@ svn_fs_fs__replace_dir_entry(void **data,
           memmove(&lengths[pos],
                   &lengths[pos + 1],
                   sizeof(lengths[pos]) * (dir_data->count - pos));
+          drop_dir_index(dir_data);
 
           dir_data->count--;
           dir_data->over_provision++;
@@ -1103,6 +1250,7 @@ svn_fs_fs__replace_dir_entry(void **data,
       memmove(&lengths[pos + 1],
               &lengths[pos],
               sizeof(lengths[pos]) * (dir_data->count - pos));
+      drop_dir_index(dir_data);
 
       dir_data->count++;
       dir_data->over_provision--;
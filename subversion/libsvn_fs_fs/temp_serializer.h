@@ -25,6 +25,11 @@
 
 #include "fs.h"
 
+/* Version of the serialized data layouts defined by this module.  Bump it
+ * whenever one of them changes, so that data persisted by older code will
+ * not be used. */
+#define SVN_FS_FS__SERIALIZER_VERSION 2
+
 /**
  * Prepend the @a number to the @a string in a space efficient way such that
  * no other (number,string) combination can produce the same result.
@@ -265,6 +270,14 @@ svn_fs_fs__extract_dir_filesize(void **out,
                                 void *baton,
                                 apr_pool_t *pool);
 
+/**
+ * Return TRUE if the serialized directory in @a data carries a hash index
+ * for name lookups.  Only large directories do and only until entries
+ * get added or removed in place.  For testing purposes.
+ */
+svn_boolean_t
+svn_fs_fs__dir_entries_indexed(const void *data);
+
 /**
  * Describes the entry to be found in a directory: Identifies the entry
  * by @a name and requires the directory file size to be @a filesize.
@@ -43,8 +43,10 @@
 #include "lock.h"
 #include "rep-cache.h"
 
+#include "private/svn_delta_private.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
+#include "private/svn_io_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
@@ -2184,8 +2186,10 @@ txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
       svndiff_version = 0;
     }
 
-  svn_txdelta_to_svndiff3(handler, handler_baton, output, svndiff_version,
-                          ffd->delta_compression_level, pool);
+  svn_txdelta__to_svndiff_concurrent(handler, handler_baton, output,
+                                     svndiff_version,
+                                     ffd->delta_compression_level,
+                                     ffd->delta_compression_threads, pool);
 }
 
 /* Get a rep_write_baton and store it in *WB_P for the representation
@@ -3593,13 +3597,14 @@ verify_locks(svn_fs_t *fs,
 }
 
 /* Writes final revision properties to file PATH applying permissions
-   from file PERMS_REFERENCE. This involves setting svn:date and
-   removing any temporary properties associated with the commit flags. */
+   from file PERMS_REFERENCE and schedule the necessary fsyncs in BATCH.
+   This involves setting svn:date and removing any temporary properties
+   associated with the commit flags. */
 static svn_error_t *
 write_final_revprop(const char *path,
                     const char *perms_reference,
                     svn_fs_txn_t *txn,
-                    svn_boolean_t flush_to_disk,
+                    svn_io__batch_fsync_t *batch,
                     apr_pool_t *pool)
 {
   apr_hash_t *txnprops;
@@ -3629,25 +3634,78 @@ write_final_revprop(const char *path,
       svn_hash_sets(txnprops, SVN_PROP_REVISION_DATE, &date);
     }
 
-  /* Create new revprops file. Tell OS to truncate existing file,
-     since  file may already exists from failed transaction. */
-  SVN_ERR(svn_io_file_open(&revprop_file, path,
-                           APR_WRITE | APR_CREATE | APR_TRUNCATE
-                           | APR_BUFFERED, APR_OS_DEFAULT, pool));
+  /* Create new revprops file. Truncate any existing file, since it may
+     already exist from a failed transaction.  BATCH owns the handle. */
+  SVN_ERR(svn_io__batch_fsync_open_file(&revprop_file, batch, path,
+                                        pool));
+  SVN_ERR(svn_io_file_trunc(revprop_file, 0, pool));
+
+  /* The file may be left over from a failed commit, i.e. its directory
+     entry may never have been synced.  Always make the new revision's
+     revprops as durable as its rev file. */
+  SVN_ERR(svn_io__batch_fsync_new_path(batch, path, pool));
 
   stream = svn_stream_from_aprfile2(revprop_file, TRUE, pool);
   SVN_ERR(svn_hash_write2(txnprops, stream, SVN_HASH_TERMINATOR, pool));
   SVN_ERR(svn_stream_close(stream));
 
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(revprop_file, pool));
-  SVN_ERR(svn_io_file_close(revprop_file, pool));
+  /* Make the contents visible to readers such as verify_before_commit().
+     The fsync will be done by BATCH. */
+  SVN_ERR(svn_io_file_flush(revprop_file, pool));
 
   SVN_ERR(svn_io_copy_perms(perms_reference, path, pool));
 
   return SVN_NO_ERROR;
 }
 
+/* Move the prototype revision file PROTO_FILENAME of FS into its final
+   location REV_FILENAME, applying permissions from PERMS_REFERENCE.
+   Schedule the necessary fsyncs in BATCH.  Use POOL for temporaries. */
+static svn_error_t *
+move_final_rev_into_place(svn_fs_t *fs,
+                          const char *proto_filename,
+                          const char *rev_filename,
+                          const char *perms_reference,
+                          svn_io__batch_fsync_t *batch,
+                          apr_pool_t *pool)
+{
+  /* The final rev file will be read-only.  So, schedule the fsync for its
+   * contents while it is still writable.  The handle will remain valid
+   * across the rename.  On POSIX, the fsync for the new directory entry
+   * can then be batched as well.
+   *
+   * Other platforms may not support renaming open files and use their
+   * own "fsyncing move" API calls.  Only a few files would be involved,
+   * so we simply keep the immediate fsyncs there. */
+#if defined(SVN_ON_POSIX)
+  apr_file_t *file;
+
+  SVN_ERR(svn_io__batch_fsync_open_file(&file, batch, proto_filename,
+                                        pool));
+  SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
+                                     perms_reference, FALSE, pool));
+  SVN_ERR(svn_io__batch_fsync_new_path(batch, rev_filename, pool));
+#else
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->flush_to_disk)
+    {
+      apr_file_t *file;
+
+      SVN_ERR(svn_io_file_open(&file, proto_filename, APR_WRITE,
+                               APR_OS_DEFAULT, pool));
+      SVN_ERR(svn_io_file_flush_to_disk(file, pool));
+      SVN_ERR(svn_io_file_close(file, pool));
+    }
+
+  SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
+                                     perms_reference, ffd->flush_to_disk,
+                                     pool));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__add_index_data(svn_fs_t *fs,
                           apr_file_t *file,
@@ -3753,6 +3811,7 @@ commit_body(void *baton, apr_pool_t *pool)
   apr_off_t initial_offset, changed_path_offset;
   const svn_fs_fs__id_part_t *txn_id = svn_fs_fs__txn_get_id(cb->txn);
   apr_hash_t *changed_paths;
+  svn_io__batch_fsync_t *batch;
   apr_array_header_t *directory_ids = apr_array_make(pool, 4,
                                                      sizeof(pair_cache_key_t));
 
@@ -3799,6 +3858,10 @@ commit_body(void *baton, apr_pool_t *pool)
   /* We are going to be one better than this puny old revision. */
   new_rev = old_rev + 1;
 
+  /* Collect all files and directories that need to be flushed to disk
+     before we may bump 'current' and fsync them all at once. */
+  SVN_ERR(svn_io__batch_fsync_create(&batch, ffd->flush_to_disk, pool));
+
   /* Get a write handle on the proto revision file. */
   SVN_ERR(get_writable_proto_rev(&proto_file, &proto_file_lockcookie,
                                  cb->fs, txn_id, pool));
@@ -3837,8 +3900,6 @@ commit_body(void *baton, apr_pool_t *pool)
                                      NULL, pool));
     }
 
-  if (ffd->flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(proto_file, pool));
   SVN_ERR(svn_io_file_close(proto_file, pool));
 
   /* We don't unlock the prototype revision file immediately to avoid a
@@ -3863,6 +3924,7 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVS_DIR,
                                                     pool),
                                     new_dir, pool));
+          SVN_ERR(svn_io__batch_fsync_new_path(batch, new_dir, pool));
         }
 
       /* Create the revprops shard. */
@@ -3879,6 +3941,7 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVPROPS_DIR,
                                                     pool),
                                     new_dir, pool));
+          SVN_ERR(svn_io__batch_fsync_new_path(batch, new_dir, pool));
         }
     }
 
@@ -3890,9 +3953,8 @@ commit_body(void *baton, apr_pool_t *pool)
   old_rev_filename = svn_fs_fs__path_rev_absolute(cb->fs, old_rev, pool);
   rev_filename = svn_fs_fs__path_rev(cb->fs, new_rev, pool);
   proto_filename = svn_fs_fs__path_txn_proto_rev(cb->fs, txn_id, pool);
-  SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
-                                     old_rev_filename, ffd->flush_to_disk,
-                                     pool));
+  SVN_ERR(move_final_rev_into_place(cb->fs, proto_filename, rev_filename,
+                                    old_rev_filename, batch, pool));
 
   /* Now that we've moved the prototype revision file out of the way,
      we can unlock it (since further attempts to write to the file
@@ -3904,7 +3966,7 @@ commit_body(void *baton, apr_pool_t *pool)
   SVN_ERR_ASSERT(! svn_fs_fs__is_packed_revprop(cb->fs, new_rev));
   revprop_filename = svn_fs_fs__path_revprops(cb->fs, new_rev, pool);
   SVN_ERR(write_final_revprop(revprop_filename, old_rev_filename,
-                              cb->txn, ffd->flush_to_disk, pool));
+                              cb->txn, batch, pool));
 
   /* Run paranoia checks. */
   if (ffd->verify_before_commit)
@@ -3912,6 +3974,11 @@ commit_body(void *baton, apr_pool_t *pool)
       SVN_ERR(verify_before_commit(cb->fs, new_rev, pool));
     }
 
+  /* Flush the revision data, the revprops and any new directories to
+     disk concurrently.  This must complete before 'current' makes the
+     new revision visible. */
+  SVN_ERR(svn_io__batch_fsync_run(batch, pool));
+
   /* Update the 'current' file. */
   SVN_ERR(write_final_current(cb->fs, txn_id, new_rev, start_node_id,
                               start_copy_id, pool));
@@ -4014,6 +4081,8 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
         }
       else if (err)
         return svn_error_trace(err);
+
+      SVN_ERR(svn_fs_fs__rep_cache_filter_add_revision(fs, *new_rev_p));
     }
 
   return SVN_NO_ERROR;
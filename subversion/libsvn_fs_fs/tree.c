@@ -146,18 +146,26 @@ typedef struct cache_entry_t
   dag_node_t *node;
 } cache_entry_t;
 
-/* Number of entries in the cache.  Keep this low to keep pressure on the
+/* Number of buckets in the cache.  Each bucket holds BUCKET_SIZE entries,
+   ordered from most to least recently used, i.e. the cache is
+   BUCKET_SIZE-way set-associative.  Keep this low to keep pressure on the
    CPU caches low as well.  A binary value is most efficient.  If we walk
    a directory tree, we want enough entries to store nodes for all files
-   without overwriting the nodes for the parent folder.  That way, there
-   will be no unnecessary misses (except for a few random ones caused by
-   hash collision).
+   without overwriting the nodes for the parent folder.  Deep paths in
+   large trees hash into the same bucket often enough that a single entry
+   per bucket would make them evict each other constantly.
 
    The actual number of instances may be higher but entries that got
    overwritten are no longer visible.
  */
 enum { BUCKET_COUNT = 256 };
 
+/* Number of entries per bucket. */
+enum { BUCKET_SIZE = 4 };
+
+/* Total number of entries in the cache. */
+enum { ENTRY_COUNT = BUCKET_COUNT * BUCKET_SIZE };
+
 /* The actual cache structure.  All nodes will be allocated in POOL.
    When the number of INSERTIONS (i.e. objects created form that pool)
    exceeds a certain threshold, the pool will be cleared and the cache
@@ -165,8 +173,9 @@ enum { BUCKET_COUNT = 256 };
  */
 struct fs_fs_dag_cache_t
 {
-  /* fixed number of (possibly empty) cache entries */
-  cache_entry_t buckets[BUCKET_COUNT];
+  /* fixed number of (possibly empty) cache entries.  Bucket I consists
+     of the BUCKET_SIZE entries starting at I * BUCKET_SIZE. */
+  cache_entry_t entries[ENTRY_COUNT];
 
   /* pool used for all node allocation */
   apr_pool_t *pool;
@@ -178,12 +187,17 @@ struct fs_fs_dag_cache_t
      Thus, remember the last hit location for optimistic lookup. */
   apr_size_t last_hit;
 
-  /* Position of the last bucket hit that actually had a DAG node in it.
-     LAST_HIT may refer to a bucket that matches path@rev but has not
-     its NODE element set, yet.
+  /* Position of the last entry hit that actually had a DAG node in it.
+     LAST_HIT may refer to an entry that does not match path@rev, e.g.
+     after a failed lookup.
      This value is a mere hint for optimistic lookup and any value is
-     valid (as long as it is < BUCKET_COUNT). */
+     valid (as long as it is < ENTRY_COUNT). */
   apr_size_t last_non_empty;
+
+  /* Access statistics since the creation of the cache. */
+  apr_uint64_t gets;
+  apr_uint64_t hits;
+  apr_uint64_t sets;
 };
 
 fs_fs_dag_cache_t*
@@ -195,16 +209,44 @@ svn_fs_fs__create_dag_cache(apr_pool_t *pool)
   return result;
 }
 
+void
+svn_fs_fs__get_dag_cache_info(svn_cache__info_t *info,
+                              fs_fs_dag_cache_t *cache)
+{
+  apr_size_t i;
+
+  memset(info, 0, sizeof(*info));
+  info->id = "DAG node 1st level cache";
+  info->gets = cache->gets;
+  info->hits = cache->hits;
+  info->sets = cache->sets;
+  info->total_entries = ENTRY_COUNT;
+  info->total_size = sizeof(*cache);
+
+  for (i = 0; i < BUCKET_COUNT; ++i)
+    {
+      apr_size_t k;
+      apr_size_t used = 0;
+
+      for (k = 0; k < BUCKET_SIZE; ++k)
+        if (cache->entries[i * BUCKET_SIZE + k].node)
+          ++used;
+
+      info->used_entries += used;
+      info->histogram[used]++;
+    }
+}
+
 /* Clears the CACHE at regular intervals (destroying all cached nodes)
  */
 static void
 auto_clear_dag_cache(fs_fs_dag_cache_t* cache)
 {
-  if (cache->insertions > BUCKET_COUNT)
+  if (cache->insertions > ENTRY_COUNT)
     {
       svn_pool_clear(cache->pool);
 
-      memset(cache->buckets, 0, sizeof(cache->buckets));
+      memset(cache->entries, 0, sizeof(cache->entries));
       cache->insertions = 0;
     }
 }
@@ -271,6 +313,52 @@ hash_func(svn_revnum_t revision,
   return hash_value;
 }
 
+/* Return the index of the first entry of the bucket in which the entry
+ * with HASH_VALUE would be stored.
+ */
+static apr_size_t
+bucket_start(apr_uint32_t hash_value)
+{
+  apr_size_t bucket_index = hash_value + (hash_value >> 16);
+  bucket_index = (bucket_index + (bucket_index >> 8)) % BUCKET_COUNT;
+
+  return bucket_index * BUCKET_SIZE;
+}
+
+/* Return TRUE, if ENTRY is in use and matches HASH_VALUE, REVISION and
+ * PATH of PATH_LEN chars.
+ */
+static svn_boolean_t
+entry_matches(const cache_entry_t *entry,
+              apr_uint32_t hash_value,
+              svn_revnum_t revision,
+              const char *path,
+              apr_size_t path_len)
+{
+  return entry->node
+      && (entry->hash_value == hash_value)
+      && (entry->revision == revision)
+      && (entry->path_len == path_len)
+      && !memcmp(entry->path, path, path_len);
+}
+
+/* Make the entry at index FIRST + OFFSET the first one in the bucket
+ * starting at FIRST in CACHE, moving the ones before it back by one.
+ */
+static void
+move_to_front(fs_fs_dag_cache_t *cache,
+              apr_size_t first,
+              apr_size_t offset)
+{
+  if (offset > 0)
+    {
+      cache_entry_t entry = cache->entries[first + offset];
+      memmove(&cache->entries[first + 1], &cache->entries[first],
+              offset * sizeof(entry));
+      cache->entries[first] = entry;
+    }
+}
+
 /* For the given REVISION and PATH, return the respective node found in
  * CACHE.  If there is none, return NULL.
  */
@@ -279,53 +367,50 @@ cache_lookup( fs_fs_dag_cache_t *cache
             , svn_revnum_t revision
             , const char *path)
 {
-  apr_size_t bucket_index;
+  apr_size_t first;
+  apr_size_t i;
   apr_size_t path_len = strlen(path);
   apr_uint32_t hash_value;
 
-  /* optimistic lookup: hit the same bucket again? */
-  cache_entry_t *result = &cache->buckets[cache->last_hit];
-  if (   (result->revision == revision)
+  /* optimistic lookup: hit the same entry again? */
+  cache_entry_t *result = &cache->entries[cache->last_hit];
+  ++cache->gets;
+  if (   result->node
+      && (result->revision == revision)
       && (result->path_len == path_len)
       && !memcmp(result->path, path, path_len))
     {
       /* Remember the position of the last node we found in this cache. */
-      if (result->node)
-        cache->last_non_empty = cache->last_hit;
+      cache->last_non_empty = cache->last_hit;
+      ++cache->hits;
 
       return result->node;
     }
 
   /* need to do a full lookup. */
   hash_value = hash_func(revision, path, path_len);
+  first = bucket_start(hash_value);
 
-  bucket_index = hash_value + (hash_value >> 16);
-  bucket_index = (bucket_index + (bucket_index >> 8)) % BUCKET_COUNT;
-
-  /* access the corresponding bucket and remember its location */
-  result = &cache->buckets[bucket_index];
-  cache->last_hit = bucket_index;
-
-  /* if it is *NOT* a match,  clear the bucket, expect the caller to fill
-     in the node and count it as an insertion */
-  if (   (result->hash_value != hash_value)
-      || (result->revision != revision)
-      || (result->path_len != path_len)
-      || memcmp(result->path, path, path_len))
-    {
-      return NULL;
-    }
-  else if (result->node)
-    {
-      /* This bucket is valid & has a suitable DAG node in it.
-         Remember its location. */
-      cache->last_non_empty = bucket_index;
-    }
+  for (i = 0; i < BUCKET_SIZE; ++i)
+    if (entry_matches(&cache->entries[first + i], hash_value, revision,
+                      path, path_len))
+      {
+        /* This entry is valid & has a suitable DAG node in it.
+           Keep it in front of the bucket and remember its location. */
+        move_to_front(cache, first, i);
+        cache->last_hit = first;
+        cache->last_non_empty = first;
+        ++cache->hits;
+
+        return cache->entries[first].node;
+      }
 
-  return result->node;
+  return NULL;
 }
 
 /* Store a copy of NODE in CACHE, taking  REVISION and PATH as key.
+ * This replaces the least recently used entry of the respective bucket
+ * unless there is already an entry for that key.
  * This function will clean the cache at regular intervals.
  */
 static void
@@ -334,25 +419,29 @@ cache_insert(fs_fs_dag_cache_t *cache,
              const char *path,
              dag_node_t *node)
 {
-  apr_size_t bucket_index;
+  apr_size_t first;
+  apr_size_t i;
   apr_size_t path_len = strlen(path);
   apr_uint32_t hash_value;
   cache_entry_t *entry;
 
   auto_clear_dag_cache(cache);
 
-  /* calculate the bucket index to use */
+  /* calculate the bucket to use */
   hash_value = hash_func(revision, path, path_len);
+  first = bucket_start(hash_value);
 
-  bucket_index = hash_value + (hash_value >> 16);
-  bucket_index = (bucket_index + (bucket_index >> 8)) % BUCKET_COUNT;
+  /* Overwrite an existing entry for the same key or the LRU one. */
+  for (i = 0; i < BUCKET_SIZE - 1; ++i)
+    if (entry_matches(&cache->entries[first + i], hash_value, revision,
+                      path, path_len))
+      break;
 
-  /* access the corresponding bucket and remember its location */
-  entry = &cache->buckets[bucket_index];
-  cache->last_hit = bucket_index;
+  move_to_front(cache, first, i);
+  entry = &cache->entries[first];
+  cache->last_hit = first;
 
-  /* if it is *NOT* a match,  clear the bucket, expect the caller to fill
-     in the node and count it as an insertion */
+  /* fill in the new key, re-using the old path buffer if possible */
   entry->hash_value = hash_value;
   entry->revision = revision;
   if (entry->path_len < path_len)
@@ -362,6 +451,7 @@ cache_insert(fs_fs_dag_cache_t *cache,
 
   entry->node = svn_fs_fs__dag_dup(node, cache->pool);
   cache->insertions++;
+  cache->sets++;
 }
 
 /* Optimistic lookup using the last seen non-empty location in CACHE.
@@ -373,7 +463,7 @@ cache_lookup_last_path(fs_fs_dag_cache_t *cache,
                        const char *path,
                        apr_size_t path_len)
 {
-  cache_entry_t *result = &cache->buckets[cache->last_non_empty];
+  cache_entry_t *result = &cache->entries[cache->last_non_empty];
   assert(strlen(path) == path_len);
 
   if (   result->node
@@ -36,6 +36,12 @@ extern "C" {
 fs_fs_dag_cache_t*
 svn_fs_fs__create_dag_cache(apr_pool_t *pool);
 
+/* Fill INFO with the access statistics and fill level of the DAG node
+   1st level CACHE.  INFO->ID will be a static string. */
+void
+svn_fs_fs__get_dag_cache_info(svn_cache__info_t *info,
+                              fs_fs_dag_cache_t *cache);
+
 /* Set *ROOT_P to the root directory of revision REV in filesystem FS.
    Allocate the structure in POOL. */
 svn_error_t *svn_fs_fs__revision_root(svn_fs_root_t **root_p, svn_fs_t *fs,
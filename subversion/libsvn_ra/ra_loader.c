@@ -944,6 +944,46 @@ svn_error_t *svn_ra_stat(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra__stat_many(svn_ra_session_t *session,
+                  apr_hash_t **dirents,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR_ASSERT(svn_relpath_is_canonical(APR_ARRAY_IDX(paths, i,
+                                                          const char *)));
+
+  if (session->vtable->stat_many)
+    return svn_error_trace(session->vtable->stat_many(session, dirents,
+                                                      paths, revision,
+                                                      result_pool,
+                                                      scratch_pool));
+
+  /* Fall back to one request per path. */
+  *dirents = apr_hash_make(result_pool);
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_dirent_t *dirent;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_stat(session, path, revision, &dirent, iterpool));
+      if (dirent)
+        svn_hash_sets(*dirents, apr_pstrdup(result_pool, path),
+                      svn_dirent_dup(dirent, result_pool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_get_uuid2(svn_ra_session_t *session,
                               const char **uuid,
                               apr_pool_t *pool)
@@ -344,6 +344,13 @@ typedef struct svn_ra__vtable_t {
                        svn_ra_dirent_receiver_t receiver,
                        void *receiver_baton,
                        apr_pool_t *scratch_pool);
+  /* See svn_ra__stat_many().  May be NULL. */
+  svn_error_t *(*stat_many)(svn_ra_session_t *session,
+                            apr_hash_t **dirents,
+                            const apr_array_header_t *paths,
+                            svn_revnum_t revision,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
 
   /* Experimental support below here */
 
@@ -350,6 +350,8 @@ svn_ra_serf__get_file_revs(svn_ra_session_t *ra_session,
   svn_ra_serf__xml_context_t *xmlctx;
   const char *req_url;
   svn_revnum_t peg_rev;
+  svn_stream_t *cache_stream = NULL;
+  svn_error_t *err;
 
   blame_ctx = apr_pcalloc(pool, sizeof(*blame_ctx));
   blame_ctx->pool = pool;
@@ -379,6 +381,55 @@ svn_ra_serf__get_file_revs(svn_ra_session_t *ra_session,
                                            blame_cdata,
                                            blame_ctx,
                                            pool);
+
+  /* The report for a fixed revision range never changes, except for
+     revprops edited later on, so we may have it on disk already. */
+  if (session->diskcache && session->uuid
+      && SVN_IS_VALID_REVNUM(start) && SVN_IS_VALID_REVNUM(end))
+    {
+      const char *relpath;
+
+      /* Make sure the user may read PATH@PEG_REV at all.  As a side
+         effect, this authenticates the session, so that we know whose
+         cache entry to use below.  The report also depends on the
+         user's access to other paths, e.g. to copy sources, so entries
+         are per user.  Authz changes after an entry has been written
+         are not reflected, though. */
+      SVN_ERR(svn_ra_serf__check_read_access(
+                          session,
+                          svn_path_url_add_component2(req_url, path, pool),
+                          pool));
+
+      SVN_ERR(svn_ra_serf__get_relative_path(
+                          &relpath,
+                          svn_path_url_add_component2(
+                                          session->session_url.path,
+                                          path, pool),
+                          session, pool));
+
+      SVN_ERR(svn_ra_serf__diskcache_open_file_revs(
+                          &cache_stream, session->diskcache, session->uuid,
+                          relpath, start, end, include_merged_revisions,
+                          session->auth_username, pool, pool));
+      if (cache_stream)
+        {
+          SVN_ERR(svn_ra_serf__xml_parse_stream(xmlctx, cache_stream, pool));
+          return svn_error_trace(svn_stream_close(cache_stream));
+        }
+
+      /* Keep a copy of the response for the next time.  The cache is
+         only an optimization, so don't fail on it. */
+      err = svn_ra_serf__diskcache_file_revs_writer(
+                          &cache_stream, session->diskcache, session->uuid,
+                          relpath, start, end, include_merged_revisions,
+                          session->auth_username, pool);
+      if (err)
+        {
+          svn_error_clear(err);
+          cache_stream = NULL;
+        }
+    }
+
   handler = svn_ra_serf__create_expat_handler(session, xmlctx, NULL, pool);
 
   handler->method = "REPORT";
@@ -390,10 +441,17 @@ svn_ra_serf__get_file_revs(svn_ra_session_t *ra_session,
   handler->header_delegate = setup_headers;
   handler->header_delegate_baton = blame_ctx;
 
+  if (cache_stream)
+    svn_ra_serf__expat_handler_copy_body(handler, cache_stream);
+
   SVN_ERR(svn_ra_serf__context_run_one(handler, pool));
 
   if (handler->sline.code != 200)
     return svn_error_trace(svn_ra_serf__unexpected_status(handler));
 
+  /* Only a complete response gets into the cache. */
+  if (cache_stream)
+    svn_error_clear(svn_stream_close(cache_stream));
+
   return SVN_NO_ERROR;
 }
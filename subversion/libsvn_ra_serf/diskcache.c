@@ -0,0 +1,769 @@
+/*
+ * diskcache.c: persistent cache of immutable DAV resources.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_pools.h>
+#include <apr_time.h>
+
+#include "svn_hash.h"
+#include "svn_dirent_uri.h"
+#include "svn_types.h"
+#include "svn_pools.h"
+#include "svn_io.h"
+#include "svn_checksum.h"
+#include "svn_path.h"
+
+#include "private/svn_sorts_private.h"
+
+#include "diskcache.h"
+
+/* Each entry is a file in the cache directory, named after the SHA-1 of
+ * its key.  It starts with a header of two lines, the key itself and the
+ * hex SHA-1 of the data that follows:
+ *
+ *   text 1234 UUID trunk/README\n
+ *   6d2a8f...\n
+ *   DATA
+ *
+ * The key line guards against hash collisions.  New entries are written
+ * to a temporary file in the "tmp" subdirectory and renamed into place
+ * once complete.  Temporary files of entries that could not be completed
+ * get removed right away, or when the pool of the writer gets cleaned up
+ * if it was never closed.
+ */
+
+/* When the cache grows above its limit, remove entries until it is
+   at this percentage of the limit, so that we don't have to clean up
+   after every single new entry. */
+#define DISKCACHE_LOW_WATER_PERCENT 75
+
+/* The length of a hex SHA-1 and thus the name of an entry file. */
+#define DISKCACHE_NAME_LEN 40
+
+/* Module-private structure used to hold the cache. */
+struct svn_ra_serf__diskcache_t
+{
+  /* The directory that holds the entries. */
+  const char *dir;
+
+  /* The directory that holds entries that are still being written. */
+  const char *tmp_dir;
+
+  /* The maximum sum of all entry sizes. */
+  apr_int64_t max_size;
+
+  /* Our (estimated) sum of all entry sizes, or -1 if we didn't look at
+     the directory yet. */
+  apr_int64_t total_size;
+
+  /* Did we make sure that DIR and TMP_DIR exist? */
+  svn_boolean_t dirs_created;
+
+  apr_pool_t *pool;
+};
+
+/* Baton for the stream returned by svn_ra_serf__diskcache_contents_writer. */
+typedef struct writer_baton_t
+{
+  svn_ra_serf__diskcache_t *cache;
+
+  /* Where to put the entry once complete. */
+  const char *path;
+
+  /* The temporary file and its path.  FILE is NULL once the entry has
+     been completed or discarded. */
+  apr_file_t *file;
+  const char *tmp_path;
+
+  /* Offset of the checksum in the header. */
+  apr_off_t checksum_offset;
+
+  /* Running checksum of the data and the checksum it should match. */
+  svn_checksum_ctx_t *checksum_ctx;
+  const svn_checksum_t *expected;
+
+  /* Size of the entry, including the header. */
+  apr_int64_t size;
+
+  apr_pool_t *pool;
+} writer_baton_t;
+
+/* An entry we found in the cache directory. */
+typedef struct dir_entry_t
+{
+  const char *name;
+  apr_int64_t size;
+  apr_time_t mtime;
+} dir_entry_t;
+
+
+
+/* Set *PATH to the entry file for the resource described by KIND, UUID,
+ * REVISION and RELPATH in CACHE and *KEY to its key.  Allocate both in
+ * POOL.
+ */
+static void
+entry_path(const char **path,
+           const char **key,
+           svn_ra_serf__diskcache_t *cache,
+           const char *kind,
+           const char *uuid,
+           svn_revnum_t revision,
+           const char *relpath,
+           apr_pool_t *pool)
+{
+  svn_checksum_t *name;
+
+  *key = apr_psprintf(pool, "%s %ld %s %s", kind, revision, uuid, relpath);
+
+  /* This can't fail for SHA-1. */
+  svn_error_clear(svn_checksum(&name, svn_checksum_sha1, *key, strlen(*key),
+                               pool));
+  *path = svn_dirent_join(cache->dir, svn_checksum_to_cstring(name, pool),
+                          pool);
+}
+
+/* Remove the entry at PATH, ignoring all errors.  Another process may
+   be doing the same. */
+static void
+drop_entry(const char *path,
+           apr_pool_t *scratch_pool)
+{
+  svn_error_clear(svn_io_remove_file2(path, TRUE, scratch_pool));
+}
+
+/* Close and remove the temporary file of the entry being written via WB,
+   ignoring all errors.  Later writes to WB will be ignored. */
+static void
+discard_entry(writer_baton_t *wb,
+              apr_pool_t *scratch_pool)
+{
+  if (wb->file)
+    {
+      svn_error_clear(svn_io_file_close(wb->file, scratch_pool));
+      wb->file = NULL;
+      drop_entry(wb->tmp_path, scratch_pool);
+    }
+}
+
+/* Pool cleanup function removing the temporary file of the writer_baton_t
+   DATA if the entry has neither been completed nor discarded. */
+static apr_status_t
+abandon_entry(void *data)
+{
+  writer_baton_t *wb = data;
+
+  discard_entry(wb, wb->pool);
+
+  return APR_SUCCESS;
+}
+
+/* Open the entry file at PATH for reading and check its header against
+ * KEY.  On success, set *STREAM to read the data that follows the header
+ * and *CHECKSUM to its expected SHA-1.  If there is no valid entry, set
+ * *STREAM to NULL.  Allocate the results in RESULT_POOL.
+ */
+static svn_error_t *
+open_entry(svn_stream_t **stream,
+           svn_checksum_t **checksum,
+           const char *path,
+           const char *key,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *line;
+  svn_boolean_t eof;
+  svn_error_t *err;
+
+  *stream = NULL;
+
+  /* A missing or unreadable entry is just a cache miss. */
+  err = svn_stream_open_readonly(stream, path, result_pool, scratch_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      *stream = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_stream_readline(*stream, &line, "\n", &eof, scratch_pool));
+  if (!eof && strcmp(line->data, key) == 0)
+    {
+      SVN_ERR(svn_stream_readline(*stream, &line, "\n", &eof, scratch_pool));
+      err = svn_checksum_parse_hex(checksum, svn_checksum_sha1, line->data,
+                                   result_pool);
+      if (!eof && !err && *checksum)
+        return SVN_NO_ERROR;
+
+      svn_error_clear(err);
+    }
+
+  /* A hash collision, or a broken entry.  Either way, it's not ours. */
+  SVN_ERR(svn_stream_close(*stream));
+  *stream = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the rest of STREAM and set *MATCHES to whether its SHA-1 is
+ * CHECKSUM.  Then rewind STREAM to where it was.
+ */
+static svn_error_t *
+verify_data(svn_boolean_t *matches,
+            svn_stream_t *stream,
+            const svn_checksum_t *checksum,
+            apr_pool_t *scratch_pool)
+{
+  svn_checksum_ctx_t *ctx = svn_checksum_ctx_create(svn_checksum_sha1,
+                                                    scratch_pool);
+  svn_checksum_t *actual;
+  svn_stream_mark_t *mark;
+  char *buffer = apr_palloc(scratch_pool, SVN__STREAM_CHUNK_SIZE);
+  apr_size_t len;
+
+  SVN_ERR(svn_stream_mark(stream, &mark, scratch_pool));
+
+  do
+    {
+      len = SVN__STREAM_CHUNK_SIZE;
+      SVN_ERR(svn_stream_read_full(stream, buffer, &len));
+      SVN_ERR(svn_checksum_update(ctx, buffer, len));
+    }
+  while (len == SVN__STREAM_CHUNK_SIZE);
+
+  SVN_ERR(svn_checksum_final(&actual, ctx, scratch_pool));
+  *matches = svn_checksum_match(actual, checksum);
+
+  return svn_error_trace(svn_stream_seek(stream, mark));
+}
+
+/* Note that we just used the entry at PATH, so that it is the last to be
+   removed when the cache gets full. */
+static void
+touch_entry(const char *path,
+            apr_pool_t *scratch_pool)
+{
+  svn_error_clear(svn_io_set_file_affected_time(apr_time_now(), path,
+                                                scratch_pool));
+}
+
+/* Like open_entry() but also verify the data against the checksum in the
+ * header.  Drop the entry if that fails.  On success, mark the entry as
+ * used.
+ */
+static svn_error_t *
+open_verified_entry(svn_stream_t **stream,
+                    const char *path,
+                    const char *key,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+  svn_boolean_t matches;
+
+  SVN_ERR(open_entry(stream, &checksum, path, key, result_pool,
+                     scratch_pool));
+  if (!*stream)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(verify_data(&matches, *stream, checksum, scratch_pool));
+  if (!matches)
+    {
+      SVN_ERR(svn_stream_close(*stream));
+      *stream = NULL;
+      drop_entry(path, scratch_pool);
+
+      return SVN_NO_ERROR;
+    }
+
+  touch_entry(path, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Create the directories of CACHE, if we didn't do so already. */
+static svn_error_t *
+ensure_dirs(svn_ra_serf__diskcache_t *cache,
+            apr_pool_t *scratch_pool)
+{
+  if (cache->dirs_created)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_make_dir_recursively(cache->tmp_dir, scratch_pool));
+  cache->dirs_created = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the entries of CACHE as an array of dir_entry_t * and set
+ * *TOTAL_SIZE to the sum of their sizes.  Allocate everything in POOL.
+ */
+static svn_error_t *
+read_entries(apr_array_header_t **entries,
+             apr_int64_t *total_size,
+             svn_ra_serf__diskcache_t *cache,
+             apr_pool_t *pool)
+{
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache->dir, FALSE, pool, pool));
+
+  *entries = apr_array_make(pool, apr_hash_count(dirents),
+                            sizeof(dir_entry_t *));
+  *total_size = 0;
+
+  for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+      dir_entry_t *entry;
+
+      if (dirent->kind != svn_node_file
+          || strlen(name) != DISKCACHE_NAME_LEN)
+        continue;
+
+      entry = apr_palloc(pool, sizeof(*entry));
+      entry->name = name;
+      entry->size = dirent->filesize;
+      entry->mtime = dirent->mtime;
+      APR_ARRAY_PUSH(*entries, dir_entry_t *) = entry;
+
+      *total_size += dirent->filesize;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Sort dir_entry_t * by ascending modification time. */
+static int
+compare_entry_mtime(const void *a,
+                    const void *b)
+{
+  const dir_entry_t *entry_a = *(const dir_entry_t * const *)a;
+  const dir_entry_t *entry_b = *(const dir_entry_t * const *)b;
+
+  if (entry_a->mtime < entry_b->mtime)
+    return -1;
+
+  return entry_a->mtime > entry_b->mtime ? 1 : 0;
+}
+
+/* Remove the least recently used entries of CACHE until it is below its
+ * low water mark.
+ */
+static svn_error_t *
+shrink_cache(svn_ra_serf__diskcache_t *cache,
+             apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *entries;
+  apr_int64_t low_water = cache->max_size / 100
+                            * DISKCACHE_LOW_WATER_PERCENT;
+  apr_pool_t *iterpool;
+  int i;
+
+  /* Other processes may have added or removed entries, so look at what's
+     really there. */
+  SVN_ERR(read_entries(&entries, &cache->total_size, cache, scratch_pool));
+  svn_sort__array(entries, compare_entry_mtime);
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < entries->nelts && cache->total_size > low_water; i++)
+    {
+      const dir_entry_t *entry = APR_ARRAY_IDX(entries, i, dir_entry_t *);
+
+      svn_pool_clear(iterpool);
+      drop_entry(svn_dirent_join(cache->dir, entry->name, iterpool),
+                 iterpool);
+      cache->total_size -= entry->size;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Account for a new entry of SIZE bytes in CACHE. */
+static svn_error_t *
+add_entry_size(svn_ra_serf__diskcache_t *cache,
+               apr_int64_t size,
+               apr_pool_t *scratch_pool)
+{
+  if (cache->total_size < 0)
+    {
+      apr_array_header_t *entries;
+
+      /* This includes the new entry already. */
+      SVN_ERR(read_entries(&entries, &cache->total_size, cache,
+                           scratch_pool));
+    }
+  else
+    cache->total_size += size;
+
+  if (cache->total_size > cache->max_size)
+    SVN_ERR(shrink_cache(cache, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Open a temporary file in CACHE, write the header for KEY with a
+ * placeholder checksum to it and initialize WB accordingly.
+ */
+static svn_error_t *
+start_entry(writer_baton_t *wb,
+            const char *key,
+            apr_pool_t *scratch_pool)
+{
+  const char *header;
+  apr_size_t len;
+  svn_error_t *err;
+
+  SVN_ERR(ensure_dirs(wb->cache, scratch_pool));
+  SVN_ERR(svn_io_open_unique_file3(&wb->file, &wb->tmp_path,
+                                   wb->cache->tmp_dir,
+                                   svn_io_file_del_none,
+                                   wb->pool, scratch_pool));
+  apr_pool_cleanup_register(wb->pool, wb, abandon_entry,
+                            apr_pool_cleanup_null);
+
+  header = apr_psprintf(scratch_pool, "%s\n%*s\n", key,
+                        DISKCACHE_NAME_LEN, "");
+  len = strlen(header);
+  err = svn_io_file_write_full(wb->file, header, len, NULL, scratch_pool);
+  if (err)
+    {
+      discard_entry(wb, scratch_pool);
+      return svn_error_trace(err);
+    }
+
+  wb->checksum_offset = len - DISKCACHE_NAME_LEN - 1;
+  wb->checksum_ctx = svn_checksum_ctx_create(svn_checksum_sha1, wb->pool);
+  wb->size = len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Fill in the checksum of the entry written via WB and move it into
+ * place, unless it doesn't match what we expected.
+ */
+static svn_error_t *
+finish_entry(writer_baton_t *wb,
+             apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+  const char *hex;
+  svn_error_t *err;
+
+  /* Nothing to do if writing the data failed. */
+  if (!wb->file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_checksum_final(&checksum, wb->checksum_ctx, scratch_pool));
+  if (wb->expected && !svn_checksum_match(checksum, wb->expected))
+    {
+      discard_entry(wb, scratch_pool);
+      return SVN_NO_ERROR;
+    }
+
+  hex = svn_checksum_to_cstring_display(checksum, scratch_pool);
+  err = svn_io_file_seek(wb->file, APR_SET, &wb->checksum_offset,
+                         scratch_pool);
+  if (!err)
+    err = svn_io_file_write_full(wb->file, hex, DISKCACHE_NAME_LEN, NULL,
+                                 scratch_pool);
+  if (err)
+    {
+      discard_entry(wb, scratch_pool);
+      return svn_error_trace(err);
+    }
+
+  err = svn_io_file_close(wb->file, scratch_pool);
+  wb->file = NULL;
+  if (!err)
+    err = svn_io_file_rename2(wb->tmp_path, wb->path, FALSE, scratch_pool);
+  if (err)
+    {
+      drop_entry(wb->tmp_path, scratch_pool);
+      return svn_error_trace(err);
+    }
+
+  return svn_error_trace(add_entry_size(wb->cache, wb->size, scratch_pool));
+}
+
+/* Implements svn_write_fn_t for the entry writers.  The cache is only an
+ * optimization, so rather than failing the caller's operation, discard
+ * the entry if we can't write it. */
+static svn_error_t *
+write_handler_entry(void *baton,
+                    const char *data,
+                    apr_size_t *len)
+{
+  writer_baton_t *wb = baton;
+  svn_error_t *err;
+
+  if (!wb->file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_checksum_update(wb->checksum_ctx, data, *len));
+  err = svn_io_file_write_full(wb->file, data, *len, NULL, wb->pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      discard_entry(wb, wb->pool);
+    }
+  else
+    wb->size += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t for the entry writers. */
+static svn_error_t *
+close_handler_entry(void *baton)
+{
+  writer_baton_t *wb = baton;
+
+  return svn_error_trace(finish_entry(wb, wb->pool));
+}
+
+
+
+/* Set *STREAM to a writer for the entry described by KIND, UUID, REVISION
+ * and RELPATH in CACHE, as documented for
+ * svn_ra_serf__diskcache_contents_writer().  Allocate it in RESULT_POOL.
+ */
+static svn_error_t *
+create_writer(svn_stream_t **stream,
+              svn_ra_serf__diskcache_t *cache,
+              const char *kind,
+              const char *uuid,
+              svn_revnum_t revision,
+              const char *relpath,
+              const svn_checksum_t *sha1_checksum,
+              apr_pool_t *result_pool)
+{
+  writer_baton_t *wb = apr_pcalloc(result_pool, sizeof(*wb));
+  const char *key;
+
+  wb->cache = cache;
+  wb->pool = result_pool;
+  wb->expected = sha1_checksum;
+
+  entry_path(&wb->path, &key, cache, kind, uuid, revision, relpath,
+             result_pool);
+  SVN_ERR(start_entry(wb, key, result_pool));
+
+  *stream = svn_stream_create(wb, result_pool);
+  svn_stream_set_write(*stream, write_handler_entry);
+  svn_stream_set_close(*stream, close_handler_entry);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the entry kind for file-revs reports from START (which becomes
+ * the entry's revision) up to END for USERNAME, allocated in POOL.  The
+ * user name gets URI-encoded so that it cannot be confused with the
+ * other parts of the key.
+ */
+static const char *
+file_revs_kind(svn_revnum_t end,
+               svn_boolean_t include_merged_revisions,
+               const char *username,
+               apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "file-revs %ld %d %s", end,
+                      include_merged_revisions ? 1 : 0,
+                      svn_path_uri_encode(username ? username : "", pool));
+}
+
+
+svn_error_t *
+svn_ra_serf__diskcache_create(svn_ra_serf__diskcache_t **cache_p,
+                              const char *dir,
+                              apr_int64_t max_size,
+                              apr_pool_t *pool)
+{
+  svn_ra_serf__diskcache_t *cache = apr_pcalloc(pool, sizeof(*cache));
+
+  cache->dir = apr_pstrdup(pool, dir);
+  cache->tmp_dir = svn_dirent_join(cache->dir, "tmp", pool);
+  cache->max_size = max_size;
+  cache->total_size = -1;
+  cache->pool = pool;
+
+  *cache_p = cache;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__diskcache_open_contents(svn_stream_t **stream,
+                                     svn_ra_serf__diskcache_t *cache,
+                                     const char *uuid,
+                                     svn_revnum_t revision,
+                                     const char *relpath,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool)
+{
+  const char *path;
+  const char *key;
+
+  entry_path(&path, &key, cache, "text", uuid, revision, relpath,
+             scratch_pool);
+
+  return svn_error_trace(open_verified_entry(stream, path, key,
+                                             result_pool, scratch_pool));
+}
+
+svn_error_t *
+svn_ra_serf__diskcache_contents_writer(svn_stream_t **stream,
+                                       svn_ra_serf__diskcache_t *cache,
+                                       const char *uuid,
+                                       svn_revnum_t revision,
+                                       const char *relpath,
+                                       const svn_checksum_t *sha1_checksum,
+                                       apr_pool_t *result_pool)
+{
+  return svn_error_trace(create_writer(stream, cache, "text", uuid,
+                                       revision, relpath, sha1_checksum,
+                                       result_pool));
+}
+
+svn_error_t *
+svn_ra_serf__diskcache_get_props(apr_hash_t **props_p,
+                                 svn_ra_serf__diskcache_t *cache,
+                                 const char *uuid,
+                                 svn_revnum_t revision,
+                                 const char *relpath,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  const char *path;
+  const char *key;
+  svn_stream_t *stream;
+  svn_checksum_t *checksum;
+  svn_checksum_t *actual;
+  svn_stringbuf_t *data;
+  apr_hash_t *props;
+
+  *props_p = NULL;
+
+  entry_path(&path, &key, cache, "props", uuid, revision, relpath,
+             scratch_pool);
+  SVN_ERR(open_entry(&stream, &checksum, path, key, scratch_pool,
+                     scratch_pool));
+  if (!stream)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_stringbuf_from_stream(&data, stream, 0, scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_checksum(&actual, svn_checksum_sha1, data->data, data->len,
+                       scratch_pool));
+  if (!svn_checksum_match(actual, checksum))
+    {
+      drop_entry(path, scratch_pool);
+      return SVN_NO_ERROR;
+    }
+
+  props = apr_hash_make(result_pool);
+  SVN_ERR(svn_hash_read2(props, svn_stream_from_stringbuf(data, scratch_pool),
+                         SVN_HASH_TERMINATOR, result_pool));
+  touch_entry(path, scratch_pool);
+  *props_p = props;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__diskcache_set_props(svn_ra_serf__diskcache_t *cache,
+                                 const char *uuid,
+                                 svn_revnum_t revision,
+                                 const char *relpath,
+                                 apr_hash_t *props,
+                                 apr_pool_t *scratch_pool)
+{
+  writer_baton_t *wb = apr_pcalloc(scratch_pool, sizeof(*wb));
+  svn_stringbuf_t *data = svn_stringbuf_create_empty(scratch_pool);
+  const char *key;
+  apr_size_t len;
+
+  SVN_ERR(svn_hash_write2(props, svn_stream_from_stringbuf(data,
+                                                           scratch_pool),
+                          SVN_HASH_TERMINATOR, scratch_pool));
+
+  wb->cache = cache;
+  wb->pool = scratch_pool;
+
+  entry_path(&wb->path, &key, cache, "props", uuid, revision, relpath,
+             scratch_pool);
+  SVN_ERR(start_entry(wb, key, scratch_pool));
+
+  len = data->len;
+  SVN_ERR(write_handler_entry(wb, data->data, &len));
+
+  return svn_error_trace(finish_entry(wb, scratch_pool));
+}
+
+svn_error_t *
+svn_ra_serf__diskcache_open_file_revs(svn_stream_t **stream,
+                                      svn_ra_serf__diskcache_t *cache,
+                                      const char *uuid,
+                                      const char *relpath,
+                                      svn_revnum_t start,
+                                      svn_revnum_t end,
+                                      svn_boolean_t include_merged_revisions,
+                                      const char *username,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool)
+{
+  const char *path;
+  const char *key;
+
+  entry_path(&path, &key, cache,
+             file_revs_kind(end, include_merged_revisions, username,
+                            scratch_pool),
+             uuid, start, relpath, scratch_pool);
+
+  return svn_error_trace(open_verified_entry(stream, path, key,
+                                             result_pool, scratch_pool));
+}
+
+svn_error_t *
+svn_ra_serf__diskcache_file_revs_writer(svn_stream_t **stream,
+                                        svn_ra_serf__diskcache_t *cache,
+                                        const char *uuid,
+                                        const char *relpath,
+                                        svn_revnum_t start,
+                                        svn_revnum_t end,
+                                        svn_boolean_t include_merged_revisions,
+                                        const char *username,
+                                        apr_pool_t *result_pool)
+{
+  return svn_error_trace(create_writer(stream, cache,
+                                       file_revs_kind(end,
+                                                      include_merged_revisions,
+                                                      username, result_pool),
+                                       uuid, start, relpath, NULL,
+                                       result_pool));
+}
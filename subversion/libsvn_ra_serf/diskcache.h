@@ -0,0 +1,154 @@
+/*
+ * diskcache.h: persistent cache of immutable DAV resources.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_RA_SERF_DISKCACHE_H
+#define SVN_LIBSVN_RA_SERF_DISKCACHE_H
+
+#include <apr_pools.h>
+#include <apr_hash.h>
+
+#include "svn_types.h"
+#include "svn_io.h"
+#include "svn_checksum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* On-disk cache of the file contents and node properties of PATH@REV
+ * resources, which never change once committed, as well as of blame
+ * (file-revs) reports.  Entries are keyed by repository UUID, revision
+ * and repository relpath and carry a SHA-1 checksum of their data, which
+ * is verified on every read.  Entries that fail verification are
+ * dropped.
+ *
+ * The cache directory may be shared by several processes.  Entries are
+ * only ever added by atomic renames, and the total size is kept below
+ * a configured limit by removing the least recently used entries.
+ */
+typedef struct svn_ra_serf__diskcache_t svn_ra_serf__diskcache_t;
+
+/* Set *CACHE_P to a new cache instance that stores its entries in
+ * directory DIR, using at most MAX_SIZE bytes.  DIR doesn't have to
+ * exist yet.  Allocate the cache in POOL.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_create(svn_ra_serf__diskcache_t **cache_p,
+                              const char *dir,
+                              apr_int64_t max_size,
+                              apr_pool_t *pool);
+
+/* If CACHE holds the contents of RELPATH@REVISION in the repository
+ * with UUID, set *STREAM to a readable stream of them, allocated in
+ * RESULT_POOL.  Otherwise set *STREAM to NULL.  Use SCRATCH_POOL for
+ * temporary allocations.
+ *
+ * The cache does not know who may read the entry; callers must check
+ * that the user still has access to it before passing the data on.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_open_contents(svn_stream_t **stream,
+                                     svn_ra_serf__diskcache_t *cache,
+                                     const char *uuid,
+                                     svn_revnum_t revision,
+                                     const char *relpath,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool);
+
+/* Set *STREAM to a writable stream that stores the contents of
+ * RELPATH@REVISION in the repository with UUID in CACHE once it is
+ * closed.  If SHA1_CHECKSUM is not NULL, the entry is only added if the
+ * data written matches it.  If the stream is not closed, nothing is
+ * added.  Allocate the stream in RESULT_POOL.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_contents_writer(svn_stream_t **stream,
+                                       svn_ra_serf__diskcache_t *cache,
+                                       const char *uuid,
+                                       svn_revnum_t revision,
+                                       const char *relpath,
+                                       const svn_checksum_t *sha1_checksum,
+                                       apr_pool_t *result_pool);
+
+/* Set *PROPS_P to the properties of RELPATH@REVISION in the repository
+ * with UUID that CACHE holds, or to NULL if it doesn't.  Allocate the
+ * hash in RESULT_POOL and use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_get_props(apr_hash_t **props_p,
+                                 svn_ra_serf__diskcache_t *cache,
+                                 const char *uuid,
+                                 svn_revnum_t revision,
+                                 const char *relpath,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
+/* Store PROPS (const char * -> svn_string_t *) as the properties of
+ * RELPATH@REVISION in the repository with UUID in CACHE.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_set_props(svn_ra_serf__diskcache_t *cache,
+                                 const char *uuid,
+                                 svn_revnum_t revision,
+                                 const char *relpath,
+                                 apr_hash_t *props,
+                                 apr_pool_t *scratch_pool);
+
+/* If CACHE holds the file-revs REPORT response body for RELPATH from
+ * START to END with INCLUDE_MERGED_REVISIONS in the repository with UUID,
+ * as seen by USERNAME (NULL for anonymous access), set *STREAM to a
+ * readable stream of it, allocated in RESULT_POOL.  Otherwise set
+ * *STREAM to NULL.  Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_open_file_revs(svn_stream_t **stream,
+                                      svn_ra_serf__diskcache_t *cache,
+                                      const char *uuid,
+                                      const char *relpath,
+                                      svn_revnum_t start,
+                                      svn_revnum_t end,
+                                      svn_boolean_t include_merged_revisions,
+                                      const char *username,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
+
+/* Like svn_ra_serf__diskcache_contents_writer() but for the entry that
+ * svn_ra_serf__diskcache_open_file_revs() would return for the same
+ * parameters.
+ */
+svn_error_t *
+svn_ra_serf__diskcache_file_revs_writer(svn_stream_t **stream,
+                                        svn_ra_serf__diskcache_t *cache,
+                                        const char *uuid,
+                                        const char *relpath,
+                                        svn_revnum_t start,
+                                        svn_revnum_t end,
+                                        svn_boolean_t include_merged_revisions,
+                                        const char *username,
+                                        apr_pool_t *result_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_RA_SERF_DISKCACHE_H*/
@@ -187,6 +187,64 @@ try_get_wc_contents(svn_boolean_t *found_p,
   return SVN_NO_ERROR;
 }
 
+/* Helper svn_ra_serf__get_file(). Looks up the file contents (if
+ * WANT_CONTENTS is set) and properties (if PROPS is not NULL) of
+ * RELPATH@REVISION in the session's disk cache.
+ *
+ * Sets *FOUND_P to TRUE if everything that was asked for was found, in
+ * which case *PROPS is set and *CONTENTS is a stream of the file contents
+ * (or NULL if not WANT_CONTENTS).  Nothing is passed on to the caller
+ * yet, so that the caller can verify that the user may read the file.
+ *
+ * Allocates *PROPS and *CONTENTS in RESULT_POOL and performs temporary
+ * allocations in SCRATCH_POOL.
+ */
+static svn_error_t *
+try_get_cached(svn_boolean_t *found_p,
+               svn_stream_t **contents,
+               svn_ra_serf__session_t *session,
+               const char *relpath,
+               svn_revnum_t revision,
+               svn_boolean_t want_contents,
+               apr_hash_t **props,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  apr_hash_t *cached_props = NULL;
+
+  *found_p = FALSE;
+  *contents = NULL;
+
+  if (props)
+    {
+      SVN_ERR(svn_ra_serf__diskcache_get_props(&cached_props,
+                                               session->diskcache,
+                                               session->uuid, revision,
+                                               relpath, result_pool,
+                                               scratch_pool));
+      if (!cached_props)
+        return SVN_NO_ERROR;
+    }
+
+  if (want_contents)
+    {
+      SVN_ERR(svn_ra_serf__diskcache_open_contents(contents,
+                                                   session->diskcache,
+                                                   session->uuid, revision,
+                                                   relpath, result_pool,
+                                                   scratch_pool));
+      if (!*contents)
+        return SVN_NO_ERROR;
+    }
+
+  if (props)
+    *props = cached_props;
+
+  *found_p = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 /* -----------------------------------------------------------------------
    svn_ra_get_file() specific */
 
@@ -329,12 +387,20 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
   svn_ra_serf__handler_t *propfind_handler;
   apr_pool_t *scratch_pool = svn_pool_create(result_pool);
   struct file_prop_baton_t fb;
+  const char *cache_relpath = NULL;
+  svn_revnum_t cache_rev = revision;
 
   /* Fetch properties. */
 
   fetch_url = svn_path_url_add_component2(session->session_url.path, path,
                                           scratch_pool);
 
+  /* PATH@REVISION never changes, so we may have it on disk already. */
+  if (session->diskcache && session->uuid && (stream || props)
+      && SVN_IS_VALID_REVNUM(revision))
+    SVN_ERR(svn_ra_serf__get_relative_path(&cache_relpath, fetch_url,
+                                           session, scratch_pool));
+
   /* The simple case is if we want HEAD - then a GET on the fetch_url is fine.
    *
    * Otherwise, we need to get the baseline version for this particular
@@ -348,12 +414,38 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
                                           scratch_pool, scratch_pool));
       revision = SVN_INVALID_REVNUM;
     }
+
+  if (cache_relpath)
+    {
+      svn_boolean_t found;
+      svn_stream_t *contents;
+
+      SVN_ERR(try_get_cached(&found, &contents, session, cache_relpath,
+                             cache_rev, stream != NULL, props,
+                             result_pool, scratch_pool));
+      if (found)
+        {
+          /* The cache may be shared with other users.  Only hand out
+             the data if the server still lets this one read it. */
+          SVN_ERR(svn_ra_serf__check_read_access(session, fetch_url,
+                                                 scratch_pool));
+
+          if (contents)
+            SVN_ERR(svn_stream_copy3(contents,
+                                     svn_stream_disown(stream, scratch_pool),
+                                     NULL, NULL, scratch_pool));
+
+          svn_pool_destroy(scratch_pool);
+          return SVN_NO_ERROR;
+        }
+    }
   /* REVISION is always SVN_INVALID_REVNUM  */
   SVN_ERR_ASSERT(!SVN_IS_VALID_REVNUM(revision));
 
   if (props)
       which_props = all_props;
-  else if (stream && session->wc_callbacks->get_wc_contents)
+  else if (stream && (session->wc_callbacks->get_wc_contents
+                      || cache_relpath))
       which_props = type_and_checksum_props;
   else
       which_props = check_path_props;
@@ -379,7 +471,18 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
     }
 
   if (props)
-    *props = fb.props;
+    {
+      *props = fb.props;
+
+      /* The cache is only an optimization, so don't fail on it. */
+      if (cache_relpath)
+        svn_error_clear(svn_ra_serf__diskcache_set_props(session->diskcache,
+                                                         session->uuid,
+                                                         cache_rev,
+                                                         cache_relpath,
+                                                         fb.props,
+                                                         scratch_pool));
+    }
 
   if (stream)
     {
@@ -392,12 +495,42 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
         {
           stream_ctx_t *stream_ctx;
           svn_ra_serf__handler_t *handler;
+          svn_stream_t *cache_stream = NULL;
 
           /* Create the fetch context. */
           stream_ctx = apr_pcalloc(scratch_pool, sizeof(*stream_ctx));
           stream_ctx->result_stream = stream;
           stream_ctx->session = session;
 
+          /* Keep a copy of what we receive for the next time.  If the
+             server told us the checksum, the copy must match it. */
+          if (cache_relpath)
+            {
+              svn_checksum_t *sha1_checksum = NULL;
+              svn_error_t *err = SVN_NO_ERROR;
+
+              if (fb.sha1_checksum)
+                err = svn_checksum_parse_hex(&sha1_checksum,
+                                             svn_checksum_sha1,
+                                             fb.sha1_checksum, scratch_pool);
+              if (!err)
+                err = svn_ra_serf__diskcache_contents_writer(
+                                              &cache_stream,
+                                              session->diskcache,
+                                              session->uuid, cache_rev,
+                                              cache_relpath, sha1_checksum,
+                                              scratch_pool);
+              if (err)
+                {
+                  svn_error_clear(err);
+                  cache_stream = NULL;
+                }
+              else
+                stream_ctx->result_stream = svn_stream_tee(stream,
+                                                           cache_stream,
+                                                           scratch_pool);
+            }
+
           handler = svn_ra_serf__create_handler(session, scratch_pool);
 
           handler->method = "GET";
@@ -421,6 +554,10 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
 
           if (handler->sline.code != 200)
             return svn_error_trace(svn_ra_serf__unexpected_status(handler));
+
+          /* Only a complete response gets into the cache. */
+          if (cache_stream)
+            svn_error_clear(svn_stream_close(cache_stream));
         }
     }
 
@@ -251,6 +251,10 @@ capabilities_headers_iterator_callback(void *baton,
         {
           session->supports_put_result_checksum = TRUE;
         }
+      if (svn_cstring_match_list(SVN_DAV_NS_DAV_SVN_UPDATE_PARTITIONS, vals))
+        {
+          session->supports_update_partitions = TRUE;
+        }
     }
 
   /* SVN-specific headers -- if present, server supports HTTP protocol v2 */
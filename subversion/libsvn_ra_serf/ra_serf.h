@@ -42,6 +42,7 @@
 #include "private/svn_editor.h"
 
 #include "blncache.h"
+#include "diskcache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -144,6 +145,13 @@ struct svn_ra_serf__session_t {
      requests may come in any order */
   svn_boolean_t http20;
 
+  /* Whether to use http/2 when talking to the server: svn_tristate_true
+     to use it with prior knowledge for http:// URLs, svn_tristate_unknown
+     to offer it during the TLS handshake only, svn_tristate_false to never
+     use it.  Once we use http/2, all requests are multiplexed over a single
+     connection. */
+  svn_tristate_t use_http2;
+
   /* Should we use Transfer-Encoding: chunked for HTTP/1.1 servers. */
   svn_boolean_t using_chunked_requests;
 
@@ -158,6 +166,10 @@ struct svn_ra_serf__session_t {
   svn_auth_iterstate_t *auth_state;
   int auth_attempts;
 
+  /* User name of the last credentials we sent, or NULL if the server
+     never asked for any. */
+  const char *auth_username;
+
   /* Callback functions to get info from WC */
   const svn_ra_callbacks2_t *wc_callbacks;
   void *wc_callback_baton;
@@ -243,6 +255,11 @@ struct svn_ra_serf__session_t {
 
   svn_ra_serf__blncache_t *blncache;
 
+  /* Persistent cache of the contents and properties of PATH@REV
+     resources and of file-revs reports, or NULL if not configured
+     (see http-cache-dir). */
+  svn_ra_serf__diskcache_t *diskcache;
+
   /* Trisate flag that indicates user preference for using bulk updates
      (svn_tristate_true) with all the properties and content in the
      update-report response. If svn_tristate_false, request a skelta
@@ -273,6 +290,10 @@ struct svn_ra_serf__session_t {
    * to a successful PUT request. */
   svn_boolean_t supports_put_result_checksum;
 
+  /* Indicates whether the server can split the file contents of an
+   * update into partitions (see SVN_DAV_UPDATE_PARTITION_HEADER). */
+  svn_boolean_t supports_update_partitions;
+
   apr_interval_time_t conn_latency;
 };
 
@@ -715,6 +736,23 @@ svn_ra_serf__create_expat_handler(svn_ra_serf__session_t *session,
                                   const int *expected_status,
                                   apr_pool_t *result_pool);
 
+/* Make HANDLER, which must have been created by
+   svn_ra_serf__create_expat_handler(), write a copy of the response body
+   to STREAM before parsing it.  STREAM is not closed.  */
+void
+svn_ra_serf__expat_handler_copy_body(svn_ra_serf__handler_t *handler,
+                                     svn_stream_t *stream);
+
+/* Parse the XML document read from STREAM, e.g. a response body saved
+   by svn_ra_serf__expat_handler_copy_body(), with XMLCTX just as if it had
+   been received from the server.  svn_ra_serf__xml_context_done() gets
+   called for XMLCTX once the end of STREAM is reached.  STREAM is not
+   closed.  Use SCRATCH_POOL for temporary allocations.  */
+svn_error_t *
+svn_ra_serf__xml_parse_stream(svn_ra_serf__xml_context_t *xmlctx,
+                              svn_stream_t *stream,
+                              apr_pool_t *scratch_pool);
+
 
 /* Allocated within XES->STATE_POOL. Changes are not allowed (callers
    should make a deep copy if they need to make changes).
@@ -1185,6 +1223,17 @@ svn_ra_serf__get_stable_url(const char **stable_url,
                             apr_pool_t *scratch_pool);
 
 
+/* Send a HEAD request for URL and return an error unless the server
+   allows SESSION to read it.  Use this before handing out data that
+   was cached on behalf of another session.
+
+   All temporary allocations are performed in SCRATCH_POOL.  */
+svn_error_t *
+svn_ra_serf__check_read_access(svn_ra_serf__session_t *session,
+                               const char *url,
+                               apr_pool_t *scratch_pool);
+
+
 /** RA functions **/
 
 /* Implements svn_ra__vtable_t.reparent(). */
@@ -1631,6 +1680,11 @@ svn_ra_serf__request_body_create(apr_size_t in_memory_size,
 svn_stream_t *
 svn_ra_serf__request_body_get_stream(svn_ra_serf__request_body_t *body);
 
+/* Return TRUE if BODY is held in memory, which allows sending it with
+   several requests at the same time. */
+svn_boolean_t
+svn_ra_serf__request_body_in_memory(svn_ra_serf__request_body_t *body);
+
 /* Get a svn_ra_serf__request_body_delegate_t and baton for BODY. */
 void
 svn_ra_serf__request_body_get_delegate(svn_ra_serf__request_body_delegate_t *del,
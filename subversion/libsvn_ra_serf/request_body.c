@@ -212,6 +212,12 @@ svn_ra_serf__request_body_get_stream(svn_ra_serf__request_body_t *body)
   return body->stream;
 }
 
+svn_boolean_t
+svn_ra_serf__request_body_in_memory(svn_ra_serf__request_body_t *body)
+{
+  return body->file == NULL;
+}
+
 void
 svn_ra_serf__request_body_get_delegate(svn_ra_serf__request_body_delegate_t *del,
                                        void **baton,
@@ -164,6 +164,8 @@ load_config(svn_ra_serf__session_t *session,
   const char *exceptions;
   apr_port_t proxy_port;
   svn_tristate_t chunked_requests;
+  const char *cache_dir = NULL;
+  apr_int64_t cache_size;
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   apr_int64_t log_components;
   apr_int64_t log_level;
@@ -251,6 +253,20 @@ load_config(svn_ra_serf__session_t *session,
                                   SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                   "auto", svn_tristate_unknown));
 
+  /* Should we multiplex all requests over a single http/2 connection. */
+  SVN_ERR(svn_config_get_tristate(config, &session->use_http2,
+                                  SVN_CONFIG_SECTION_GLOBAL,
+                                  SVN_CONFIG_OPTION_HTTP_HTTP2,
+                                  "auto", svn_tristate_false));
+
+  /* Where to keep immutable resources across sessions, if anywhere. */
+  svn_config_get(config, &cache_dir, SVN_CONFIG_SECTION_GLOBAL,
+                 SVN_CONFIG_OPTION_HTTP_CACHE_DIR, NULL);
+  SVN_ERR(svn_config_get_int64(config, &cache_size,
+                               SVN_CONFIG_SECTION_GLOBAL,
+                               SVN_CONFIG_OPTION_HTTP_CACHE_SIZE,
+                               SVN_CONFIG_DEFAULT_OPTION_HTTP_CACHE_SIZE));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   SVN_ERR(svn_config_get_int64(config, &log_components,
                                SVN_CONFIG_SECTION_GLOBAL,
@@ -318,6 +334,20 @@ load_config(svn_ra_serf__session_t *session,
                                       SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                       "auto", chunked_requests));
 
+      /* Should we use http/2. */
+      SVN_ERR(svn_config_get_tristate(config, &session->use_http2,
+                                      server_group,
+                                      SVN_CONFIG_OPTION_HTTP_HTTP2,
+                                      "auto", session->use_http2));
+
+      /* Load the group cache settings. */
+      svn_config_get(config, &cache_dir, server_group,
+                     SVN_CONFIG_OPTION_HTTP_CACHE_DIR, cache_dir);
+      SVN_ERR(svn_config_get_int64(config, &cache_size,
+                                   server_group,
+                                   SVN_CONFIG_OPTION_HTTP_CACHE_SIZE,
+                                   cache_size));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
       SVN_ERR(svn_config_get_int64(config, &log_components,
                                    server_group,
@@ -357,6 +387,15 @@ load_config(svn_ra_serf__session_t *session,
   if (session->max_connections < 2)
     session->max_connections = 2;
 
+  /* The resource cache is opt-in. */
+  session->diskcache = NULL;
+  if (cache_dir && *cache_dir && cache_size > 0)
+    SVN_ERR(svn_ra_serf__diskcache_create(&session->diskcache,
+                                          svn_dirent_internal_style(
+                                                cache_dir, result_pool),
+                                          cache_size * 1024 * 1024,
+                                          result_pool));
+
   /* Parse the connection timeout value, if any. */
   session->timeout = apr_time_from_sec(DEFAULT_HTTP_TIMEOUT);
   if (timeout_str)
@@ -647,6 +686,7 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* using_compression */
   /* http10 */
   /* http20 */
+  /* use_http2 */
   /* using_chunked_requests */
   /* detect_chunking */
 
@@ -739,6 +779,8 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   SVN_ERR(svn_ra_serf__blncache_create(&new_sess->blncache,
                                        new_sess->pool));
 
+  /* diskcache is recreated by load_config() */
+
   if (new_sess->server_allows_bulk)
     new_sess->server_allows_bulk = apr_pstrdup(result_pool,
                                                new_sess->server_allows_bulk);
@@ -763,6 +805,7 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* supports_svndiff1 */
   /* supports_svndiff2 */
   /* supports_put_result_checksum */
+  /* supports_update_partitions */
   /* conn_latency */
 
   new_sess->context = serf_context_create(result_pool);
@@ -1068,6 +1111,7 @@ static const svn_ra__vtable_t serf_vtable = {
   svn_ra_serf__get_inherited_props,
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
+  NULL /* stat_many */,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -94,7 +94,11 @@ typedef enum report_state_e {
 
   VERSION_NAME,
   CREATIONDATE,
-  CREATOR_DISPLAYNAME
+  CREATOR_DISPLAYNAME,
+
+  /* States of a partition response. */
+  UPDATE_PARTITION,
+  PARTITION_TXDELTA
 } report_state_e;
 
 
@@ -238,6 +242,18 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
   { 0 }
 };
 
+/* The response to a partition request (see SVN_DAV_UPDATE_PARTITION_HEADER)
+   is a flat list of text deltas. */
+static const svn_ra_serf__xml_transition_t partition_ttable[] = {
+  { INITIAL, S_, "update-partition", UPDATE_PARTITION,
+    FALSE, { NULL }, TRUE },
+
+  { UPDATE_PARTITION, S_, "txdelta", PARTITION_TXDELTA,
+    FALSE, { "path", "?base-checksum", "?sha1-checksum", NULL }, TRUE },
+
+  { 0 }
+};
+
 /* While we process the REPORT response, we will queue up GET and PROPFIND
    requests. For a very large checkout, it is very easy to queue requests
    faster than they are resolved. Thus, we need to pause the XML processing
@@ -260,9 +276,22 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
 
 #define PARSE_CHUNK_SIZE 8000 /* Copied from xml.c ### Needs tuning */
 
+/* In skelta mode we may ask the server for the file contents of the update
+   in up to UPDATE_PARTITIONS_MAX additional REPORT responses, which we then
+   receive in parallel to the skelta REPORT.  Each of these partitions
+   carries the text deltas of the files whose paths hash to it.
+
+   Contents that arrive before the skelta REPORT reached their file are
+   buffered.  Once PARTITION_BUFFERED_TO_PAUSE deltas of a partition are
+   buffered, we stop parsing it until the REPORT catches up, unless a file
+   is still waiting for contents from that same partition. */
+#define UPDATE_PARTITIONS_MAX 4
+#define PARTITION_BUFFERED_TO_PAUSE 16
+
 /* Forward-declare our report context. */
 typedef struct report_context_t report_context_t;
 typedef struct body_create_baton_t body_create_baton_t;
+typedef struct partition_ctx_t partition_ctx_t;
 /*
  * This structure represents the information for a directory.
  */
@@ -354,6 +383,9 @@ typedef struct file_baton_t
 
   svn_stream_t *txdelta_stream;         /* Stream that feeds windows when
                                            written to within txdelta*/
+
+  /* Are we waiting for our contents from a partition response? */
+  svn_boolean_t from_partition;
 } file_baton_t;
 
 /*
@@ -390,6 +422,67 @@ typedef struct fetch_ctx_t {
 
 } fetch_ctx_t;
 
+/*
+ * The contents of a single file, as received (or still to be received)
+ * from a partition response.
+ */
+typedef struct partition_contents_t {
+  apr_pool_t *pool;
+
+  /* Editor relpath of the file; the key in the report's hash. */
+  const char *relpath;
+
+  /* The partition that carries these contents. */
+  partition_ctx_t *partition;
+
+  /* The file waiting for these contents, or NULL if the REPORT didn't
+     get that far yet. */
+  file_baton_t *file;
+
+  /* The decoded svndiff data, if we received it before FILE was known. */
+  svn_spillbuf_t *svndiff;
+
+  /* The base checksum the server sent with SVNDIFF, if any. */
+  const char *base_checksum;
+
+  /* Did we receive the whole delta? */
+  svn_boolean_t received;
+
+  /* Did the REPORT tell us that nobody needs these contents? */
+  svn_boolean_t discard;
+
+} partition_contents_t;
+
+/*
+ * This structure represents a single partition request.
+ */
+struct partition_ctx_t {
+  report_context_t *report;
+
+  /* The partition number, as sent to the server. */
+  int index;
+
+  /* The contents currently being received and the stream they go to. */
+  partition_contents_t *cur;
+  svn_stream_t *cur_stream;
+
+  /* Number of contents received or being received without a waiting
+     file. */
+  int num_buffered;
+
+  /* Number of files waiting for contents from this partition. */
+  int num_waiting;
+
+  /* Did we receive all data from the network? */
+  svn_boolean_t received;
+
+  /* Did we parse the whole response? */
+  svn_boolean_t done;
+
+  /* Delay baton used to spool the response while we don't parse it. */
+  struct update_delay_baton_t *delay;
+};
+
 /*
  * The master structure for a REPORT request and response.
  */
@@ -453,6 +546,18 @@ struct report_context_t {
 
   /* Did we close the root directory? */
   svn_boolean_t closed_root;
+
+  /* The partition requests that deliver the file contents in skelta mode,
+     or NUM_PARTITIONS = 0 if we only use GET requests.  The requests are
+     sent once PARTITION_REV is known from the REPORT response. */
+  int num_partitions;
+  partition_ctx_t **partitions;
+  svn_revnum_t partition_rev;
+  svn_boolean_t partitions_started;
+  int num_partitions_done;
+
+  /* const char * editor relpath -> partition_contents_t * */
+  apr_hash_t *partition_contents;
 };
 
 static svn_error_t *
@@ -548,6 +653,34 @@ create_file_baton(file_baton_t **new_file,
  *  opened. */
 #define REQS_PER_CONN 8
 
+/** This function creates a new connection for this serf session. */
+static svn_error_t *
+open_connection(svn_ra_serf__session_t *sess)
+{
+  int cur = sess->num_conns;
+  apr_status_t status;
+
+  sess->conns[cur] = apr_pcalloc(sess->pool, sizeof(*sess->conns[cur]));
+  sess->conns[cur]->bkt_alloc = serf_bucket_allocator_create(sess->pool,
+                                                             NULL, NULL);
+  sess->conns[cur]->last_status_code = -1;
+  sess->conns[cur]->session = sess;
+  status = serf_connection_create2(&sess->conns[cur]->conn,
+                                   sess->context,
+                                   sess->session_url,
+                                   svn_ra_serf__conn_setup,
+                                   sess->conns[cur],
+                                   svn_ra_serf__conn_closed,
+                                   sess->conns[cur],
+                                   sess->pool);
+  if (status)
+    return svn_ra_serf__wrap_err(status, NULL);
+
+  sess->num_conns++;
+
+  return SVN_NO_ERROR;
+}
+
 /** This function creates a new connection for this serf session, but only
  * if the number of NUM_ACTIVE_REQS > REQS_PER_CONN or if there currently is
  * only one main connection open.
@@ -555,31 +688,17 @@ create_file_baton(file_baton_t **new_file,
 static svn_error_t *
 open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
 {
+  /* With http/2 all requests are multiplexed over the first connection,
+   * each one in its own stream with its own flow control window. */
+  if (sess->http20)
+    return SVN_NO_ERROR;
+
   /* For each REQS_PER_CONN outstanding requests open a new connection, with
    * a minimum of 1 extra connection. */
   if (sess->num_conns == 1 ||
       ((num_active_reqs / REQS_PER_CONN) > sess->num_conns))
     {
-      int cur = sess->num_conns;
-      apr_status_t status;
-
-      sess->conns[cur] = apr_pcalloc(sess->pool, sizeof(*sess->conns[cur]));
-      sess->conns[cur]->bkt_alloc = serf_bucket_allocator_create(sess->pool,
-                                                                 NULL, NULL);
-      sess->conns[cur]->last_status_code = -1;
-      sess->conns[cur]->session = sess;
-      status = serf_connection_create2(&sess->conns[cur]->conn,
-                                       sess->context,
-                                       sess->session_url,
-                                       svn_ra_serf__conn_setup,
-                                       sess->conns[cur],
-                                       svn_ra_serf__conn_closed,
-                                       sess->conns[cur],
-                                       sess->pool);
-      if (status)
-        return svn_ra_serf__wrap_err(status, NULL);
-
-      sess->num_conns++;
+      SVN_ERR(open_connection(sess));
     }
 
   return SVN_NO_ERROR;
@@ -605,9 +724,16 @@ get_best_connection(report_context_t *ctx)
      ###
      ### See https://issues.apache.org/jira/browse/SVN-4116.
   */
-  if (ctx->report_received && (ctx->sess->max_connections > 2))
+  if ((ctx->report_received && (ctx->sess->max_connections > 2))
+      || ctx->sess->http20)
     first_conn = 0;
 
+  /* Without http/2 the partition requests keep the connections after the
+     first one busy until we received them.  See start_partitions(). */
+  if (ctx->partitions_started && !ctx->sess->http20
+      && ctx->num_partitions_done < ctx->num_partitions)
+    first_conn = ctx->num_partitions + 1;
+
   /* If there's only one available auxiliary connection to use, don't bother
      doing all the cur_conn math -- just return that one connection.  */
   if (ctx->sess->num_conns - first_conn == 1)
@@ -1205,6 +1331,367 @@ file_fetch_done(serf_request_t *request,
   return svn_error_trace(close_file(file, scratch_pool));
 }
 
+/* Issue a GET request on CONN for the contents of FILE. */
+static svn_error_t *
+fetch_file_contents(file_baton_t *file,
+                    svn_ra_serf__connection_t *conn,
+                    apr_pool_t *scratch_pool)
+{
+  report_context_t *ctx = file->parent_dir->ctx;
+  svn_ra_serf__handler_t *handler;
+  fetch_ctx_t *fetch_ctx;
+
+  SVN_ERR_ASSERT(file->url && file->repos_relpath);
+
+  fetch_ctx = apr_pcalloc(file->pool, sizeof(*fetch_ctx));
+  fetch_ctx->file = file;
+  fetch_ctx->session = ctx->sess;
+
+  /* Can we somehow get away with just obtaining a DIFF? */
+  if (SVN_RA_SERF__HAVE_HTTPV2_SUPPORT(ctx->sess))
+    {
+      /* If this file is switched vs the editor root we should provide
+         its real url instead of the one calculated from the session root.
+      */
+      if (SVN_IS_VALID_REVNUM(file->base_rev))
+        {
+          fetch_ctx->delta_base = apr_psprintf(file->pool, "%s/%ld/%s",
+                                               ctx->sess->rev_root_stub,
+                                               file->base_rev,
+                                               svn_path_uri_encode(
+                                                  file->repos_relpath,
+                                                  scratch_pool));
+        }
+      else if (file->copyfrom_path)
+        {
+          SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(file->copyfrom_rev));
+
+          fetch_ctx->delta_base = apr_psprintf(file->pool, "%s/%ld/%s",
+                                               ctx->sess->rev_root_stub,
+                                               file->copyfrom_rev,
+                                               svn_path_uri_encode(
+                                                  file->copyfrom_path+1,
+                                                  scratch_pool));
+        }
+    }
+  else if (ctx->sess->wc_callbacks->get_wc_prop)
+    {
+      /* If we have a WC, we might be able to dive all the way into the WC
+      * to get the previous URL so we can do a differential GET with the
+      * base URL.
+      */
+      const svn_string_t *value = NULL;
+      SVN_ERR(ctx->sess->wc_callbacks->get_wc_prop(
+                                        ctx->sess->wc_callback_baton,
+                                        file->relpath,
+                                        SVN_RA_SERF__WC_CHECKED_IN_URL,
+                                        &value, scratch_pool));
+
+      fetch_ctx->delta_base = value
+                                ? apr_pstrdup(file->pool, value->data)
+                                : NULL;
+    }
+
+  handler = svn_ra_serf__create_handler(ctx->sess, file->pool);
+
+  handler->method = "GET";
+  handler->path = file->url;
+
+  handler->conn = conn; /* Explicit scheduling */
+
+  handler->custom_accept_encoding = TRUE;
+  handler->no_dav_headers = TRUE;
+  handler->header_delegate = headers_fetch;
+  handler->header_delegate_baton = fetch_ctx;
+
+  handler->response_handler = handle_fetch;
+  handler->response_baton = fetch_ctx;
+
+  handler->response_error = cancel_fetch;
+  handler->response_error_baton = fetch_ctx;
+
+  handler->done_delegate = file_fetch_done;
+  handler->done_delegate_baton = fetch_ctx;
+
+  fetch_ctx->handler = handler;
+
+  svn_ra_serf__request_create(handler);
+
+  return SVN_NO_ERROR;
+}
+
+/** Routines for receiving file contents from partition responses */
+
+/* Return the partition of CTX that carries the contents of RELPATH.
+   This must match in_partition() in mod_dav_svn. */
+static partition_ctx_t *
+get_partition(report_context_t *ctx,
+              const char *relpath)
+{
+  apr_uint32_t hash = svn__fnv1a_32(relpath, strlen(relpath));
+
+  return ctx->partitions[hash % ctx->num_partitions];
+}
+
+/* Return the contents of RELPATH in CTX, creating an empty record if we
+   don't know about them yet. */
+static partition_contents_t *
+get_partition_contents(report_context_t *ctx,
+                       const char *relpath)
+{
+  partition_contents_t *contents;
+  apr_pool_t *pool;
+
+  contents = svn_hash_gets(ctx->partition_contents, relpath);
+  if (contents)
+    return contents;
+
+  pool = svn_pool_create(apr_hash_pool_get(ctx->partition_contents));
+  contents = apr_pcalloc(pool, sizeof(*contents));
+  contents->pool = pool;
+  contents->relpath = apr_pstrdup(pool, relpath);
+  contents->partition = get_partition(ctx, relpath);
+
+  svn_hash_sets(ctx->partition_contents, contents->relpath, contents);
+
+  return contents;
+}
+
+/* Forget about CONTENTS and release its memory. */
+static void
+remove_partition_contents(partition_contents_t *contents)
+{
+  report_context_t *ctx = contents->partition->report;
+
+  svn_hash_sets(ctx->partition_contents, contents->relpath, NULL);
+  svn_pool_destroy(contents->pool);
+}
+
+/* Feed the svndiff data buffered in CONTENTS to the delta handler of
+   FILE, including the final NULL window. */
+static svn_error_t *
+deliver_partition_contents(file_baton_t *file,
+                           partition_contents_t *contents,
+                           apr_pool_t *scratch_pool)
+{
+  svn_stream_t *stream;
+
+  stream = svn_txdelta_parse_svndiff(file->txdelta, file->txdelta_baton,
+                                     TRUE /* error early close*/,
+                                     scratch_pool);
+  while (TRUE)
+    {
+      const char *data;
+      apr_size_t len;
+
+      SVN_ERR(svn_spillbuf__read(&data, &len, contents->svndiff,
+                                 scratch_pool));
+      if (data == NULL)
+        break;
+
+      SVN_ERR(svn_stream_write(stream, data, &len));
+    }
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+/* The REPORT told us that the file at RELPATH doesn't need the contents
+   that its partition will send, so make sure we don't keep them. */
+static void
+discard_partition_contents(report_context_t *ctx,
+                           const char *relpath)
+{
+  partition_contents_t *contents;
+
+  contents = svn_hash_gets(ctx->partition_contents, relpath);
+  if (contents)
+    {
+      if (contents->svndiff)
+        contents->partition->num_buffered--;
+
+      if (contents->received)
+        remove_partition_contents(contents);
+      else
+        contents->discard = TRUE;
+    }
+  else if (! get_partition(ctx, relpath)->done)
+    {
+      contents = get_partition_contents(ctx, relpath);
+      contents->discard = TRUE;
+    }
+}
+
+/* Verify that the text delta with BASE_CHECKSUM (hex, may be NULL) that
+   a partition sent for FILE applies to the base that the REPORT told us
+   about, and thereby to the base we passed to apply_textdelta(). */
+static svn_error_t *
+check_partition_base(file_baton_t *file,
+                     const char *base_checksum,
+                     apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+
+  if (!base_checksum || !file->base_md5_checksum)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_checksum_parse_hex(&checksum, svn_checksum_md5, base_checksum,
+                                 scratch_pool));
+
+  if (!svn_checksum_match(checksum, file->base_md5_checksum))
+    return svn_error_trace(svn_checksum_mismatch_err(
+                              file->base_md5_checksum, checksum,
+                              scratch_pool,
+                              _("Base checksum mismatch for '%s' in update "
+                                "partition"),
+                              file->relpath));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *HAS_CONTENTS to TRUE if the working copy of CTX can provide the
+   contents with the hex SHA1_CHECKSUM itself, so that we don't have to
+   keep them when a partition sends them before the REPORT reaches their
+   file.  See the get_wc_contents() use in fetch_for_file(). */
+static svn_error_t *
+wc_has_contents(svn_boolean_t *has_contents,
+                report_context_t *ctx,
+                const char *sha1_checksum,
+                apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+  svn_stream_t *cached_contents = NULL;
+  svn_error_t *err;
+
+  *has_contents = FALSE;
+
+  if (!sha1_checksum || !ctx->sess->wc_callbacks->get_wc_contents)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_checksum_parse_hex(&checksum, svn_checksum_sha1, sha1_checksum,
+                                 scratch_pool));
+
+  err = ctx->sess->wc_callbacks->get_wc_contents(ctx->sess->wc_callback_baton,
+                                                 &cached_contents, checksum,
+                                                 scratch_pool);
+  if (err || !cached_contents)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  *has_contents = TRUE;
+
+  return svn_error_trace(svn_stream_close(cached_contents));
+}
+
+/* Take the contents of FILE from its partition if we received them
+   already, or arrange for them to be delivered once we do.  If the
+   partition is done without them, leave FILE->FETCH_FILE set. */
+static svn_error_t *
+fetch_from_partition(file_baton_t *file,
+                     apr_pool_t *scratch_pool)
+{
+  report_context_t *ctx = file->parent_dir->ctx;
+  partition_contents_t *contents;
+
+  contents = svn_hash_gets(ctx->partition_contents, file->relpath);
+  if (!contents)
+    {
+      if (get_partition(ctx, file->relpath)->done)
+        return SVN_NO_ERROR; /* We need a GET request */
+
+      contents = get_partition_contents(ctx, file->relpath);
+    }
+  else if (contents->discard)
+    {
+      /* We didn't keep them, because the working copy had them.  As it
+         couldn't provide them after all, use GET. */
+      if (contents->received)
+        remove_partition_contents(contents);
+
+      return SVN_NO_ERROR;
+    }
+  else if (contents->svndiff)
+    contents->partition->num_buffered--;
+
+  SVN_ERR(check_partition_base(file, contents->base_checksum, scratch_pool));
+
+  if (contents->received)
+    {
+      SVN_ERR(deliver_partition_contents(file, contents, scratch_pool));
+      remove_partition_contents(contents);
+      file->fetch_file = FALSE;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* This counts as an active fetch, to make sure the REPORT processing
+     waits for the partitions to catch up. */
+  contents->file = file;
+  contents->partition->num_waiting++;
+  file->from_partition = TRUE;
+  ctx->num_active_fetches++;
+
+  return SVN_NO_ERROR;
+}
+
+/* FILE received its contents from a partition.  Continue like
+   file_fetch_done() does. */
+static svn_error_t *
+partition_fetch_done(file_baton_t *file,
+                     apr_pool_t *scratch_pool)
+{
+  file->parent_dir->ctx->num_active_fetches--;
+
+  file->from_partition = FALSE;
+  file->fetch_file = FALSE;
+
+  if (file->fetch_props)
+    return SVN_NO_ERROR; /* Still processing PROPFIND request */
+
+  return svn_error_trace(close_file(file, scratch_pool));
+}
+
+/* PART will not deliver any more contents.  Fall back to GET requests
+   for the files that still wait for contents from it. */
+static svn_error_t *
+finish_partition(partition_ctx_t *part,
+                 apr_pool_t *scratch_pool)
+{
+  report_context_t *ctx = part->report;
+  apr_hash_index_t *hi;
+
+  part->done = TRUE;
+  ctx->num_partitions_done++;
+
+  for (hi = apr_hash_first(scratch_pool, ctx->partition_contents);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      partition_contents_t *contents = apr_hash_this_val(hi);
+      file_baton_t *file = contents->file;
+
+      if (contents->partition != part
+          || (contents->received && !contents->discard))
+        continue;
+
+      /* Removing the current entry is fine while iterating. */
+      remove_partition_contents(contents);
+
+      if (file)
+        {
+          part->num_waiting--;
+          file->from_partition = FALSE;
+
+          /* Still counted in NUM_ACTIVE_FETCHES. */
+          SVN_ERR(fetch_file_contents(file, get_best_connection(ctx),
+                                      scratch_pool));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Initiates additional requests needed for a file when not in "send-all" mode.
  */
 static svn_error_t *
@@ -1213,7 +1700,6 @@ fetch_for_file(file_baton_t *file,
 {
   report_context_t *ctx = file->parent_dir->ctx;
   svn_ra_serf__connection_t *conn;
-  svn_ra_serf__handler_t *handler;
 
   /* Open extra connections if we have enough requests to send. */
   if (ctx->sess->num_conns < ctx->sess->max_connections)
@@ -1266,89 +1752,15 @@ fetch_for_file(file_baton_t *file,
             }
         }
 
-      if (file->fetch_file)
-        {
-          fetch_ctx_t *fetch_ctx;
-
-          /* Let's fetch the file with a GET request... */
-          SVN_ERR_ASSERT(file->url && file->repos_relpath);
+      if (!file->fetch_file && ctx->partition_contents)
+        discard_partition_contents(ctx, file->relpath);
 
-          /* Otherwise, we use a GET request for the file's contents. */
-
-          fetch_ctx = apr_pcalloc(file->pool, sizeof(*fetch_ctx));
-          fetch_ctx->file = file;
-          fetch_ctx->session = ctx->sess;
-
-          /* Can we somehow get away with just obtaining a DIFF? */
-          if (SVN_RA_SERF__HAVE_HTTPV2_SUPPORT(ctx->sess))
-            {
-              /* If this file is switched vs the editor root we should provide
-                 its real url instead of the one calculated from the session root.
-              */
-              if (SVN_IS_VALID_REVNUM(file->base_rev))
-                {
-                  fetch_ctx->delta_base = apr_psprintf(file->pool, "%s/%ld/%s",
-                                                       ctx->sess->rev_root_stub,
-                                                       file->base_rev,
-                                                       svn_path_uri_encode(
-                                                          file->repos_relpath,
-                                                          scratch_pool));
-                }
-              else if (file->copyfrom_path)
-                {
-                  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(file->copyfrom_rev));
-
-                  fetch_ctx->delta_base = apr_psprintf(file->pool, "%s/%ld/%s",
-                                                       ctx->sess->rev_root_stub,
-                                                       file->copyfrom_rev,
-                                                       svn_path_uri_encode(
-                                                          file->copyfrom_path+1,
-                                                          scratch_pool));
-                }
-            }
-          else if (ctx->sess->wc_callbacks->get_wc_prop)
-            {
-              /* If we have a WC, we might be able to dive all the way into the WC
-              * to get the previous URL so we can do a differential GET with the
-              * base URL.
-              */
-              const svn_string_t *value = NULL;
-              SVN_ERR(ctx->sess->wc_callbacks->get_wc_prop(
-                                                ctx->sess->wc_callback_baton,
-                                                file->relpath,
-                                                SVN_RA_SERF__WC_CHECKED_IN_URL,
-                                                &value, scratch_pool));
-
-              fetch_ctx->delta_base = value
-                                        ? apr_pstrdup(file->pool, value->data)
-                                        : NULL;
-            }
-
-          handler = svn_ra_serf__create_handler(ctx->sess, file->pool);
-
-          handler->method = "GET";
-          handler->path = file->url;
-
-          handler->conn = conn; /* Explicit scheduling */
-
-          handler->custom_accept_encoding = TRUE;
-          handler->no_dav_headers = TRUE;
-          handler->header_delegate = headers_fetch;
-          handler->header_delegate_baton = fetch_ctx;
-
-          handler->response_handler = handle_fetch;
-          handler->response_baton = fetch_ctx;
-
-          handler->response_error = cancel_fetch;
-          handler->response_error_baton = fetch_ctx;
-
-          handler->done_delegate = file_fetch_done;
-          handler->done_delegate_baton = fetch_ctx;
-
-          fetch_ctx->handler = handler;
-
-          svn_ra_serf__request_create(handler);
+      if (file->fetch_file && ctx->partition_contents)
+        SVN_ERR(fetch_from_partition(file, scratch_pool));
 
+      if (file->fetch_file && !file->from_partition)
+        {
+          SVN_ERR(fetch_file_contents(file, conn, scratch_pool));
           ctx->num_active_fetches++;
         }
     }
@@ -1723,6 +2135,10 @@ update_closed(svn_ra_serf__xml_estate_t *xes,
           SVN_ERR(ctx->editor->set_target_revision(ctx->editor_baton,
                                                    (svn_revnum_t)rev,
                                                    scratch_pool));
+
+          /* Now we know which tree to ask the partitions for. */
+          if (ctx->num_partitions)
+            ctx->partition_rev = (svn_revnum_t)rev;
         }
         break;
 
@@ -2042,6 +2458,149 @@ update_cdata(svn_ra_serf__xml_estate_t *xes,
   return SVN_NO_ERROR;
 }
 
+/* Conforms to svn_ra_serf__xml_opened_t  */
+static svn_error_t *
+partition_opened(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int entered_state,
+                 const svn_ra_serf__dav_props_t *tag,
+                 apr_pool_t *scratch_pool)
+{
+  partition_ctx_t *part = baton;
+  partition_contents_t *contents;
+  apr_hash_t *attrs;
+  const char *relpath;
+  const char *base_checksum;
+  svn_boolean_t has_contents;
+
+  if (entered_state != PARTITION_TXDELTA)
+    return SVN_NO_ERROR;
+
+  attrs = svn_ra_serf__xml_gather_since(xes, PARTITION_TXDELTA);
+  relpath = svn_hash_gets(attrs, "path");
+  base_checksum = svn_hash_gets(attrs, "base-checksum");
+
+  contents = get_partition_contents(part->report, relpath);
+  if (contents->partition != part || contents->received)
+    return svn_error_createf(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                             _("Unexpected contents for '%s' in update "
+                               "partition %d"),
+                             relpath, part->index);
+
+  /* Don't buffer contents that the working copy can provide itself. */
+  if (!contents->discard && !contents->file)
+    {
+      SVN_ERR(wc_has_contents(&has_contents, part->report,
+                              svn_hash_gets(attrs, "sha1-checksum"),
+                              scratch_pool));
+      contents->discard = has_contents;
+    }
+
+  if (contents->discard)
+    {
+      part->cur_stream = NULL;
+    }
+  else if (contents->file)
+    {
+      /* The file is waiting already, so don't buffer anything. */
+      file_baton_t *file = contents->file;
+      svn_stream_t *decoder;
+
+      SVN_ERR(check_partition_base(file, base_checksum, scratch_pool));
+
+      decoder = svn_txdelta_parse_svndiff(file->txdelta,
+                                          file->txdelta_baton,
+                                          TRUE /* error early close*/,
+                                          file->pool);
+      part->cur_stream = svn_base64_decode(decoder, file->pool);
+    }
+  else
+    {
+      contents->base_checksum = apr_pstrdup(contents->pool, base_checksum);
+      contents->svndiff = svn_spillbuf__create(SPILLBUF_BLOCKSIZE,
+                                               SPILLBUF_MAXBUFFSIZE,
+                                               contents->pool);
+      part->cur_stream = svn_base64_decode(
+                            svn_stream__from_spillbuf(contents->svndiff,
+                                                      contents->pool),
+                            contents->pool);
+      part->num_buffered++;
+    }
+
+  part->cur = contents;
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_closed_t  */
+static svn_error_t *
+partition_closed(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int leaving_state,
+                 const svn_string_t *cdata,
+                 apr_hash_t *attrs,
+                 apr_pool_t *scratch_pool)
+{
+  partition_ctx_t *part = baton;
+
+  if (leaving_state == UPDATE_PARTITION)
+    {
+      SVN_ERR(finish_partition(part, scratch_pool));
+    }
+  else if (leaving_state == PARTITION_TXDELTA)
+    {
+      partition_contents_t *contents = part->cur;
+      file_baton_t *file = contents->file;
+
+      part->cur = NULL;
+
+      if (part->cur_stream)
+        {
+          SVN_ERR(svn_stream_close(part->cur_stream));
+          part->cur_stream = NULL;
+        }
+
+      contents->received = TRUE;
+
+      if (contents->discard)
+        {
+          remove_partition_contents(contents);
+        }
+      else if (file)
+        {
+          /* If the file showed up while we were buffering, hand over
+             the buffer now. */
+          if (contents->svndiff)
+            SVN_ERR(deliver_partition_contents(file, contents,
+                                               scratch_pool));
+
+          part->num_waiting--;
+          remove_partition_contents(contents);
+
+          SVN_ERR(partition_fetch_done(file, scratch_pool));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_cdata_t  */
+static svn_error_t *
+partition_cdata(svn_ra_serf__xml_estate_t *xes,
+                void *baton,
+                int current_state,
+                const char *data,
+                apr_size_t len,
+                apr_pool_t *scratch_pool)
+{
+  partition_ctx_t *part = baton;
+
+  if (current_state == PARTITION_TXDELTA && part->cur_stream)
+    SVN_ERR(svn_stream_write(part->cur_stream, data, &len));
+
+  return SVN_NO_ERROR;
+}
+
 
 /** Editor callbacks given to callers to create request body */
 
@@ -2177,11 +2736,25 @@ setup_update_report_headers(serf_bucket_t *headers,
 typedef struct update_delay_baton_t
 {
   report_context_t *report;
+  partition_ctx_t *partition;   /* NULL for the REPORT itself */
+  svn_boolean_t *received;      /* Flag to set when we got all data */
   svn_spillbuf_t *spillbuf;
   svn_ra_serf__response_handler_t inner_handler;
   void *inner_handler_baton;
 } update_delay_baton_t;
 
+/* Return TRUE if we should stop parsing the response of UDB for now. */
+static svn_boolean_t
+update_delay_paused(const update_delay_baton_t *udb)
+{
+  if (udb->partition)
+    return (udb->partition->num_buffered >= PARTITION_BUFFERED_TO_PAUSE
+            && udb->partition->num_waiting == 0);
+
+  return (udb->report->num_active_fetches + udb->report->num_active_propfinds)
+            >= REQUEST_COUNT_TO_RESUME;
+}
+
 /* Helper for update_delay_handler() and process_pending() to
    call UDB->INNER_HANDLER with buffer pointed by DATA. */
 static svn_error_t *
@@ -2250,8 +2823,7 @@ update_delay_handler(serf_request_t *request,
                                                     scratch_pool));
         }
 
-      while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+      while (! update_delay_paused(udb))
         {
           const char *data;
           apr_size_t len;
@@ -2262,7 +2834,7 @@ update_delay_handler(serf_request_t *request,
           if (SERF_BUCKET_READ_ERROR(status))
             return svn_ra_serf__wrap_err(status, NULL);
           else if (APR_STATUS_IS_EOF(status))
-            udb->report->report_received = at_eof = TRUE;
+            *udb->received = at_eof = TRUE;
 
           if (!iterpool)
             iterpool = svn_pool_create(scratch_pool);
@@ -2315,7 +2887,7 @@ update_delay_handler(serf_request_t *request,
   while (status == APR_SUCCESS);
 
   if (APR_STATUS_IS_EOF(status))
-    udb->report->report_received = TRUE;
+    *udb->received = TRUE;
 
   /* We handle feeding the data from the main context loop, which will be right
      after processing the pending data */
@@ -2334,8 +2906,7 @@ process_pending(update_delay_baton_t *udb,
   apr_pool_t *iterpool = NULL;
   serf_bucket_alloc_t *alloc = NULL;
 
-  while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+  while (! update_delay_paused(udb))
     {
       const char *data;
       apr_size_t len;
@@ -2352,7 +2923,7 @@ process_pending(update_delay_baton_t *udb,
 
       SVN_ERR(svn_spillbuf__read(&data, &len, udb->spillbuf, iterpool));
 
-      if (data == NULL && !udb->report->report_received)
+      if (data == NULL && !*udb->received)
         break;
       else if (data == NULL)
         at_eof = TRUE;
@@ -2384,6 +2955,91 @@ process_pending(update_delay_baton_t *udb,
   return SVN_NO_ERROR;
 }
 
+/* Serf callback to setup the headers of a partition request. */
+static svn_error_t *
+setup_partition_headers(serf_bucket_t *headers,
+                        void *baton,
+                        apr_pool_t *pool /* request pool */,
+                        apr_pool_t *scratch_pool)
+{
+  partition_ctx_t *part = baton;
+  report_context_t *report = part->report;
+
+  serf_bucket_headers_setn(headers, SVN_DAV_UPDATE_PARTITION_HEADER,
+                           apr_psprintf(pool, "%d %d %ld",
+                                        part->index, report->num_partitions,
+                                        report->partition_rev));
+  svn_ra_serf__setup_svndiff_accept_encoding(headers, report->sess);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the partition requests of CTX to REPORT_TARGET, using the same
+   request body as the REPORT.  Allocate the handlers in RESULT_POOL. */
+static svn_error_t *
+start_partitions(report_context_t *ctx,
+                 const char *report_target,
+                 apr_pool_t *result_pool)
+{
+  svn_ra_serf__session_t *sess = ctx->sess;
+  int i;
+
+  /* Without http/2 each partition gets a connection of its own, right
+     after the one of the REPORT, and at least one more connection is
+     left for GET and PROPFIND requests. */
+  if (! sess->http20)
+    {
+      while (sess->num_conns < ctx->num_partitions + 2)
+        SVN_ERR(open_connection(sess));
+
+      sess->cur_conn = ctx->num_partitions + 1;
+    }
+
+  for (i = 0; i < ctx->num_partitions; i++)
+    {
+      partition_ctx_t *part = ctx->partitions[i];
+      svn_ra_serf__xml_context_t *xmlctx;
+      svn_ra_serf__handler_t *handler;
+
+      xmlctx = svn_ra_serf__xml_context_create(partition_ttable,
+                                               partition_opened,
+                                               partition_closed,
+                                               partition_cdata,
+                                               part,
+                                               result_pool);
+      handler = svn_ra_serf__create_expat_handler(sess, xmlctx, NULL,
+                                                  result_pool);
+
+      svn_ra_serf__request_body_get_delegate(&handler->body_delegate,
+                                             &handler->body_delegate_baton,
+                                             ctx->body);
+      handler->method = "REPORT";
+      handler->path = report_target;
+      handler->body_type = "text/xml";
+      handler->custom_accept_encoding = TRUE;
+      handler->header_delegate = setup_partition_headers;
+      handler->header_delegate_baton = part;
+      handler->conn = sess->conns[sess->http20 ? 0 : i + 1];
+
+      /* Spool the response while it would only fill our buffers. */
+      part->delay = apr_pcalloc(result_pool, sizeof(*part->delay));
+      part->delay->report = ctx;
+      part->delay->partition = part;
+      part->delay->received = &part->received;
+      part->delay->inner_handler = handler->response_handler;
+      part->delay->inner_handler_baton = handler->response_baton;
+
+      handler->response_handler = update_delay_handler;
+      handler->response_baton = part->delay;
+
+      svn_ra_serf__request_create(handler);
+    }
+
+  ctx->partitions_started = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 /* Process the 'update' editor report */
 static svn_error_t *
 process_editor_report(report_context_t *ctx,
@@ -2399,6 +3055,7 @@ process_editor_report(report_context_t *ctx,
      out too many requests at once */
   ud = apr_pcalloc(scratch_pool, sizeof(*ud));
   ud->report = ctx;
+  ud->received = &ctx->report_received;
 
   ud->inner_handler = handler->response_handler;
   ud->inner_handler_baton = handler->response_baton;
@@ -2419,7 +3076,8 @@ process_editor_report(report_context_t *ctx,
   while (!handler->done
          || ctx->num_active_fetches
          || ctx->num_active_propfinds
-         || !ctx->done)
+         || !ctx->done
+         || ctx->num_partitions_done < ctx->num_partitions)
     {
       svn_error_t *err;
       int i;
@@ -2442,6 +3100,29 @@ process_editor_report(report_context_t *ctx,
       if (ud->spillbuf)
         SVN_ERR(process_pending(ud, iterpool));
 
+      if (ctx->partitions_started)
+        {
+          for (i = 0; i < ctx->num_partitions; i++)
+            {
+              update_delay_baton_t *pd = ctx->partitions[i]->delay;
+
+              if (pd->spillbuf)
+                SVN_ERR(process_pending(pd, iterpool));
+            }
+        }
+      else if (SVN_IS_VALID_REVNUM(ctx->partition_rev))
+        {
+          SVN_ERR(start_partitions(ctx, handler->path, scratch_pool));
+        }
+      else if (ctx->done)
+        {
+          /* No target revision, so no partitions.  This shouldn't happen,
+             but let's not wait for them forever. */
+          for (i = 0; i < ctx->num_partitions; i++)
+            if (! ctx->partitions[i]->done)
+              SVN_ERR(finish_partition(ctx->partitions[i], iterpool));
+        }
+
       /* Debugging purposes only! */
       for (i = 0; i < sess->num_conns; i++)
         {
@@ -2479,6 +3160,29 @@ finish_report(void *report_baton,
   SVN_ERR(svn_stream_write(report->body_template, buf->data, &buf->len));
   SVN_ERR(svn_stream_close(report->body_template));
 
+  /* The partition requests resend the REPORT body, which we only do when
+     it wasn't spooled to disk. */
+  if (report->num_partitions
+      && !svn_ra_serf__request_body_in_memory(report->body))
+    report->num_partitions = 0;
+
+  if (report->num_partitions)
+    {
+      int i;
+
+      report->partitions = apr_pcalloc(scratch_pool,
+                                       report->num_partitions
+                                         * sizeof(*report->partitions));
+      for (i = 0; i < report->num_partitions; i++)
+        {
+          report->partitions[i] = apr_pcalloc(scratch_pool,
+                                              sizeof(*report->partitions[i]));
+          report->partitions[i]->report = report;
+          report->partitions[i]->index = i;
+        }
+      report->partition_contents = apr_hash_make(scratch_pool);
+    }
+
   SVN_ERR(svn_ra_serf__report_resource(&report_target, sess,  scratch_pool));
 
   xmlctx = svn_ra_serf__xml_context_create(update_ttable,
@@ -2604,6 +3308,7 @@ make_update_reporter(svn_ra_session_t *ra_session,
   report->editor = update_editor;
   report->editor_baton = update_baton;
   report->done = FALSE;
+  report->partition_rev = SVN_INVALID_REVNUM;
 
   *reporter = &ra_serf_reporter;
   *report_baton = report;
@@ -2672,6 +3377,20 @@ make_update_reporter(svn_ra_session_t *ra_session,
         }
     }
 
+  /* Without a preference for bulk updates, let partition requests carry
+     the file contents when the server can send them. */
+  if (!use_bulk_updates
+      && sess->bulk_updates == svn_tristate_unknown
+      && text_deltas
+      && sess->supports_update_partitions
+      && sess->max_connections > 2)
+    {
+      if (sess->http20 || sess->max_connections - 2 > UPDATE_PARTITIONS_MAX)
+        report->num_partitions = UPDATE_PARTITIONS_MAX;
+      else
+        report->num_partitions = (int)sess->max_connections - 2;
+    }
+
   if (use_bulk_updates)
     {
       svn_xml_make_open_tag(&buf, scratch_pool, svn_xml_normal,
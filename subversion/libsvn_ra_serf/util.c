@@ -480,7 +480,21 @@ load_authorities(svn_ra_serf__connection_t *conn, const char *authorities,
   return SVN_NO_ERROR;
 }
 
-#if SERF_VERSION_AT_LEAST(1, 4, 0) && defined(SVN__SERF_TEST_HTTP2)
+#if SERF_VERSION_AT_LEAST(1, 4, 0)
+/* Make CONN use http/2 framing and tell the session about it. */
+static void
+conn_use_http2(svn_ra_serf__connection_t *conn)
+{
+  serf_connection_set_framing_type(conn->conn,
+                                   SERF_CONNECTION_FRAMING_TYPE_HTTP2);
+
+  /* Disable generating content-length headers. */
+  conn->session->http10 = FALSE;
+  conn->session->http20 = TRUE;
+  conn->session->using_chunked_requests = TRUE;
+  conn->session->detect_chunking = FALSE;
+}
+
 /* Implements serf_ssl_protocol_result_cb_t */
 static apr_status_t
 conn_negotiate_protocol(void *data,
@@ -490,15 +504,7 @@ conn_negotiate_protocol(void *data,
 
   if (!strcmp(protocol, "h2"))
     {
-      serf_connection_set_framing_type(
-            conn->conn,
-            SERF_CONNECTION_FRAMING_TYPE_HTTP2);
-
-      /* Disable generating content-length headers. */
-      conn->session->http10 = FALSE;
-      conn->session->http20 = TRUE;
-      conn->session->using_chunked_requests = TRUE;
-      conn->session->detect_chunking = FALSE;
+      conn_use_http2(conn);
     }
   else
     {
@@ -557,10 +563,14 @@ conn_setup(apr_socket_t *sock,
               SVN_ERR(load_authorities(conn, conn->session->ssl_authorities,
                                        conn->session->pool));
             }
-#if SERF_VERSION_AT_LEAST(1, 4, 0) && defined(SVN__SERF_TEST_HTTP2)
-          if (APR_SUCCESS ==
-                serf_ssl_negotiate_protocol(conn->ssl_context, "h2,http/1.1",
-                                            conn_negotiate_protocol, conn))
+#if SERF_VERSION_AT_LEAST(1, 4, 0)
+          /* Offer http/2 via ALPN.  Until the TLS handshake tells us
+             which protocol to use, no requests can be written. */
+          if (conn->session->use_http2 != svn_tristate_false
+              && APR_SUCCESS ==
+                   serf_ssl_negotiate_protocol(conn->ssl_context,
+                                               "h2,http/1.1",
+                                               conn_negotiate_protocol, conn))
             {
                 serf_connection_set_framing_type(
                             conn->conn,
@@ -577,6 +587,15 @@ conn_setup(apr_socket_t *sock,
                                                       conn->bkt_alloc);
         }
     }
+#if SERF_VERSION_AT_LEAST(1, 4, 0)
+  else if (conn->session->use_http2 == svn_tristate_true
+           && !conn->session->using_proxy)
+    {
+      /* Plain-text http/2 with prior knowledge ("h2c").  There is no
+         negotiation, so the server must support it. */
+      conn_use_http2(conn);
+    }
+#endif
 
   return SVN_NO_ERROR;
 }
@@ -1179,6 +1198,29 @@ svn_ra_serf__expect_empty_body(serf_request_t *request,
 }
 
 
+svn_error_t *
+svn_ra_serf__check_read_access(svn_ra_serf__session_t *session,
+                               const char *url,
+                               apr_pool_t *scratch_pool)
+{
+  svn_ra_serf__handler_t *handler;
+
+  handler = svn_ra_serf__create_handler(session, scratch_pool);
+  handler->method = "HEAD";
+  handler->path = url;
+  handler->response_handler = svn_ra_serf__expect_empty_body;
+  handler->response_baton = handler;
+  handler->no_dav_headers = TRUE;
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code != 200)
+    return svn_error_trace(svn_ra_serf__unexpected_status(handler));
+
+  return SVN_NO_ERROR;
+}
+
+
 apr_status_t
 svn_ra_serf__credentials_callback(char **username, char **password,
                                   serf_request_t *request, void *baton,
@@ -1236,6 +1278,10 @@ svn_ra_serf__credentials_callback(char **username, char **password,
       simple_creds = creds;
       *username = apr_pstrdup(pool, simple_creds->username);
       *password = apr_pstrdup(pool, simple_creds->password);
+
+      /* Remember who we are, e.g. to key per-user cache entries. */
+      session->auth_username = apr_pstrdup(session->pool,
+                                           simple_creds->username);
     }
   else
     {
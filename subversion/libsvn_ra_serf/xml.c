@@ -136,6 +136,9 @@ struct expat_ctx_t {
   svn_ra_serf__handler_t *handler;
   const int *expected_status;
 
+  /* If not NULL, the response body gets copied to this stream.  */
+  svn_stream_t *body_copy;
+
   /* Do not use this pool for allocation. It is merely recorded for running
      the cleanup handler.  */
   apr_pool_t *cleanup_pool;
@@ -986,6 +989,9 @@ expat_response_handler(serf_request_t *request,
       else if (APR_STATUS_IS_EOF(status))
         at_eof = TRUE;
 
+      if (ectx->body_copy && len)
+        SVN_ERR(svn_stream_write(ectx->body_copy, data, &len));
+
       SVN_ERR(parse_xml(ectx, data, len, at_eof /* isFinal */));
 
       /* The parsing went fine. What has the bucket told us?  */
@@ -1028,3 +1034,46 @@ svn_ra_serf__create_expat_handler(svn_ra_serf__session_t *session,
 
   return handler;
 }
+
+void
+svn_ra_serf__expat_handler_copy_body(svn_ra_serf__handler_t *handler,
+                                     svn_stream_t *stream)
+{
+  struct expat_ctx_t *ectx = handler->response_baton;
+
+  SVN_ERR_ASSERT_NO_RETURN(handler->response_handler
+                           == expat_response_handler);
+
+  ectx->body_copy = stream;
+}
+
+svn_error_t *
+svn_ra_serf__xml_parse_stream(svn_ra_serf__xml_context_t *xmlctx,
+                              svn_stream_t *stream,
+                              apr_pool_t *scratch_pool)
+{
+  struct expat_ctx_t *ectx;
+  char *buffer = apr_palloc(scratch_pool, PARSE_CHUNK_SIZE);
+
+  ectx = apr_pcalloc(scratch_pool, sizeof(*ectx));
+  ectx->xmlctx = xmlctx;
+  ectx->cleanup_pool = scratch_pool;
+  ectx->parser = svn_xml_make_parser(ectx, expat_start, expat_end,
+                                     expat_cdata, scratch_pool);
+
+  while (1)
+    {
+      apr_size_t len = PARSE_CHUNK_SIZE;
+      svn_boolean_t at_eof;
+
+      SVN_ERR(svn_stream_read_full(stream, buffer, &len));
+      at_eof = (len < PARSE_CHUNK_SIZE);
+
+      SVN_ERR(parse_xml(ectx, buffer, len, at_eof /* isFinal */));
+
+      if (at_eof)
+        break;
+    }
+
+  return svn_error_trace(svn_ra_serf__xml_context_done(xmlctx));
+}
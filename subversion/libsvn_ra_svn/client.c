@@ -47,6 +47,7 @@
 #include "svn_mergeinfo.h"
 #include "svn_version.h"
 #include "svn_ctype.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
 
@@ -239,6 +240,14 @@ svn_error_t *svn_ra_svn__auth_response(svn_ra_svn_conn_t *conn,
   return svn_error_trace(svn_ra_svn__write_tuple(conn, pool, "w(?c)", mech, mech_arg));
 }
 
+svn_error_t *
+svn_ra_svn__do_auth(svn_ra_svn__session_baton_t *sess,
+                    const svn_ra_svn__list_t *mechlist,
+                    const char *realm, apr_pool_t *pool)
+{
+  return svn_error_trace(DO_AUTH(sess, mechlist, realm, pool));
+}
+
 static svn_error_t *handle_auth_request(svn_ra_svn__session_baton_t *sess,
                                         apr_pool_t *pool)
 {
@@ -604,6 +613,44 @@ static apr_status_t close_tunnel_cleanup(void *baton)
   return APR_SUCCESS; /* ignored */
 }
 
+/* Set *MAX_CONNECTIONS to the "svn-max-connections" value from the
+   servers section of CONFIG, taking the server group recorded in
+   AUTH_BATON into account.  Without thread support, this is always 1. */
+static svn_error_t *
+get_max_connections(int *max_connections,
+                    apr_hash_t *config,
+                    svn_auth_baton_t *auth_baton)
+{
+  apr_int64_t value = SVN_CONFIG_DEFAULT_OPTION_SVN_MAX_CONNECTIONS;
+#if APR_HAS_THREADS
+  svn_config_t *cfg = config
+                    ? svn_hash_gets(config, SVN_CONFIG_CATEGORY_SERVERS)
+                    : NULL;
+  const char *server_group = auth_baton
+                    ? svn_auth_get_parameter(auth_baton,
+                                             SVN_AUTH_PARAM_SERVER_GROUP)
+                    : NULL;
+
+  SVN_ERR(svn_config_get_int64(cfg, &value, SVN_CONFIG_SECTION_GLOBAL,
+                               SVN_CONFIG_OPTION_SVN_MAX_CONNECTIONS,
+                               value));
+  if (server_group)
+    SVN_ERR(svn_config_get_int64(cfg, &value, server_group,
+                                 SVN_CONFIG_OPTION_SVN_MAX_CONNECTIONS,
+                                 value));
+
+  if (value > SVN_RA_SVN__MAX_CONNECTIONS_LIMIT)
+    value = SVN_RA_SVN__MAX_CONNECTIONS_LIMIT;
+  if (value < 1)
+    value = 1;
+#else
+  value = 1;
+#endif
+
+  *max_connections = (int)value;
+  return SVN_NO_ERROR;
+}
+
 /* Open a session to URL, returning it in *SESS_P, allocating it in POOL.
    URI is a parsed version of URL.  CALLBACKS and CALLBACKS_BATON
    are provided by the caller of ra_svn_open. If TUNNEL_NAME is not NULL,
@@ -631,6 +678,7 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
   const char *client_string = NULL;
   apr_pool_t *pool = result_pool;
   svn_ra_svn__parent_t *parent;
+  svn_boolean_t compress;
 
   parent = apr_pcalloc(pool, sizeof(*parent));
   parent->client_url = svn_stringbuf_create(url, pool);
@@ -655,6 +703,8 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
   else
     sess->config = NULL;
 
+  SVN_ERR(get_max_connections(&sess->max_connections, config, auth_baton));
+
   if (tunnel_name)
     {
       sess->realm_prefix = apr_psprintf(pool, "<svn+%s://%s:%d>",
@@ -747,7 +797,10 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
    * capability list, and the URL, and subsequently there is an auth
    * request. */
   /* Client-side capabilities list: */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
+  compress = svn_ra_svn_compression_level(conn) > 0
+          && svn_ra_svn_has_capability(conn,
+                                       SVN_RA_SVN_CAP_COMPRESSED_STREAM);
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww!",
                                   (apr_uint64_t) 2,
                                   SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                   SVN_RA_SVN_CAP_SVNDIFF1,
@@ -755,10 +808,19 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
                                   SVN_RA_SVN_CAP_ABSENT_ENTRIES,
                                   SVN_RA_SVN_CAP_DEPTH,
                                   SVN_RA_SVN_CAP_MERGEINFO,
-                                  SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                  SVN_RA_SVN_CAP_LOG_REVPROPS));
+  if (compress)
+    SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!w!",
+                                    SVN_RA_SVN_CAP_COMPRESSED_STREAM));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)cc(?c)",
                                   url,
                                   SVN_RA_SVN__DEFAULT_USERAGENT,
                                   client_string));
+
+  /* Everything after our response will be compressed, if both sides
+   * support that. */
+  if (compress)
+    SVN_ERR(svn_ra_svn__enable_compression(conn, pool));
   SVN_ERR(handle_auth_request(sess, pool));
 
   /* This is where the security layer would go into effect if we
@@ -908,6 +970,24 @@ static svn_error_t *ra_svn_open(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_svn__open_sibling(svn_ra_svn__session_baton_t **new_sess,
+                         svn_ra_svn__session_baton_t *sess,
+                         const char *url,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  apr_uri_t uri;
+
+  SVN_ERR(parse_url(url, &uri, result_pool));
+  SVN_ERR(open_session(new_sess, url, &uri, sess->tunnel_name,
+                       sess->tunnel_argv, sess->config, sess->callbacks,
+                       sess->callbacks_baton, sess->auth_baton,
+                       result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_dup_session(svn_ra_session_t *new_session,
                                        svn_ra_session_t *old_session,
                                        const char *new_session_url,
@@ -1436,6 +1516,63 @@ parse_iproplist(apr_array_header_t **inherited_props,
   return SVN_NO_ERROR;
 }
 
+/* Baton for the file contents receiver. */
+typedef struct file_contents_baton_t
+{
+  svn_stream_t *stream;
+  svn_checksum_ctx_t *checksum_ctx;
+
+  /* Set once the terminating empty string has been received. */
+  svn_boolean_t done;
+} file_contents_baton_t;
+
+/* Implements svn_ra_svn__item_receiver_t.string for file contents. */
+static svn_error_t *
+receive_file_chunk(void *baton,
+                   const char *data,
+                   apr_size_t len)
+{
+  file_contents_baton_t *b = baton;
+
+  if (len == 0)
+    {
+      b->done = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  if (b->checksum_ctx)
+    SVN_ERR(svn_checksum_update(b->checksum_ctx, data, len));
+
+  return svn_error_trace(svn_stream_write(b->stream, data, &len));
+}
+
+svn_error_t *
+svn_ra_svn__read_file_contents(svn_ra_svn_conn_t *conn,
+                               svn_stream_t *stream,
+                               svn_checksum_ctx_t *checksum_ctx,
+                               apr_pool_t *scratch_pool)
+{
+  static const svn_ra_svn__item_receiver_t receiver =
+    { NULL, receive_file_chunk, NULL, NULL, NULL };
+  file_contents_baton_t baton;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  baton.stream = stream;
+  baton.checksum_ctx = checksum_ctx;
+  baton.done = FALSE;
+
+  /* The chunks are handed to STREAM straight from the read buffer. */
+  do
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__receive_item(conn, &receiver, &baton, iterpool));
+    }
+  while (!baton.done);
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
                                     svn_revnum_t rev, svn_stream_t *stream,
                                     svn_revnum_t *fetched_rev,
@@ -1447,8 +1584,7 @@ static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
   svn_ra_svn__list_t *proplist;
   const char *expected_digest;
   svn_checksum_t *expected_checksum = NULL;
-  svn_checksum_ctx_t *checksum_ctx;
-  apr_pool_t *iterpool;
+  svn_checksum_ctx_t *checksum_ctx = NULL;
 
   path = reparent_path(session, path, pool);
   SVN_ERR(svn_ra_svn__write_cmd_get_file(conn, pool, path, rev,
@@ -1475,27 +1611,7 @@ static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
     }
 
   /* Read the file's contents. */
-  iterpool = svn_pool_create(pool);
-  while (1)
-    {
-      svn_ra_svn__item_t *item;
-
-      svn_pool_clear(iterpool);
-      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
-      if (item->kind != SVN_RA_SVN_STRING)
-        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
-                                _("Non-string as part of file contents"));
-      if (item->u.string.len == 0)
-        break;
-
-      if (expected_checksum)
-        SVN_ERR(svn_checksum_update(checksum_ctx, item->u.string.data,
-                                    item->u.string.len));
-
-      SVN_ERR(svn_stream_write(stream, item->u.string.data,
-                               &item->u.string.len));
-    }
-  svn_pool_destroy(iterpool);
+  SVN_ERR(svn_ra_svn__read_file_contents(conn, stream, checksum_ctx, pool));
 
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, ""));
 
@@ -1542,6 +1658,432 @@ send_dirent_fields(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Nesting level of the deepest list in the responses that we parse with
+ * svn_ra_svn__receive_item(). */
+#define RECEIVE_MAX_DEPTH 5
+
+/* Position of the item that svn_ra_svn__receive_item() reports next,
+ * within the response being received. */
+typedef struct receive_pos_t
+{
+  /* Number of lists enclosing the item; 0 is the top level. */
+  int depth;
+
+  /* Index of the item within its enclosing list, for each nesting level
+   * up to RECEIVE_MAX_DEPTH. */
+  int index[RECEIVE_MAX_DEPTH + 1];
+
+  /* If not 0, all items at this nesting level and below are contained in
+   * a list that the parser does not know and will be ignored. */
+  int ignore_depth;
+} receive_pos_t;
+
+/* Advance POS past an item that is not a list.  Return the index of that
+ * item within its enclosing list or -1 if it shall be ignored. */
+static int
+receive_pos_next(receive_pos_t *pos)
+{
+  if (pos->ignore_depth)
+    return -1;
+
+  return pos->index[pos->depth]++;
+}
+
+/* Let POS enter a list.  If KNOWN is not set, ignore the list's contents.
+ * Lists below RECEIVE_MAX_DEPTH must not be KNOWN. */
+static void
+receive_pos_enter(receive_pos_t *pos,
+                  svn_boolean_t known)
+{
+  ++pos->depth;
+  if (!known && !pos->ignore_depth)
+    pos->ignore_depth = pos->depth;
+
+  if (pos->depth <= RECEIVE_MAX_DEPTH)
+    pos->index[pos->depth] = 0;
+}
+
+/* Let POS leave the current list. */
+static void
+receive_pos_leave(receive_pos_t *pos)
+{
+  if (pos->ignore_depth == pos->depth)
+    pos->ignore_depth = 0;
+
+  --pos->depth;
+  if (pos->depth <= RECEIVE_MAX_DEPTH)
+    pos->index[pos->depth]++;
+}
+
+/* Set *ERR to a malformed data error, unless it already contains an
+ * error. */
+static void
+receive_malformed(svn_error_t **err)
+{
+  if (!*err)
+    *err = svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Malformed network data"));
+}
+
+/* Return TRUE if the word DATA of LEN bytes is WORD. */
+static svn_boolean_t
+word_is(const char *data,
+        apr_size_t len,
+        const char *word)
+{
+  return strlen(word) == len && memcmp(data, word, len) == 0;
+}
+
+/* Baton for receiving a get-dir response, i.e.
+ *
+ *   ( success ( rev:number props:proplist ( dirent:entry ... ) ) )
+ *
+ * or a failure, without building an item tree. */
+typedef struct get_dir_baton_t
+{
+  receive_pos_t pos;
+
+  /* Set once we received the status word of the response. */
+  svn_boolean_t have_status;
+  svn_boolean_t failure;
+
+  /* Bit mask of the parameters and of the fields of the current tuple
+   * that we received, in the order of their appearance. */
+  int params;
+  int fields;
+
+  /* The results.  PROPS and DIRENTS are NULL if not wanted. */
+  svn_revnum_t rev;
+  apr_hash_t *props;
+  apr_hash_t *dirents;
+
+  /* The property or directory entry currently being received. */
+  svn_string_t *prop_name;
+  svn_string_t *prop_value;
+  const char *name;
+  svn_dirent_t *dirent;
+
+  /* The error entry currently being received and the error chain that
+   * the server sent so far. */
+  apr_uint64_t apr_err;
+  const char *message;
+  const char *file;
+  apr_uint64_t line;
+  svn_error_t *server_err;
+
+  /* The first problem that we found with the response.  We keep reading
+   * until the end of the response to stay in sync with the server. */
+  svn_error_t *parse_err;
+
+  apr_pool_t *pool;
+} get_dir_baton_t;
+
+/* Return TRUE if the current tuple of B is a directory entry. */
+#define GET_DIR_IN_DIRENT(b) \
+  (!(b)->failure && (b)->pos.depth >= 4 && (b)->pos.index[2] == 2)
+
+/* Implements svn_ra_svn__item_receiver_t.number for get_dir_baton_t. */
+static svn_error_t *
+get_dir_number(void *baton,
+               apr_uint64_t value)
+{
+  get_dir_baton_t *b = baton;
+  int depth = b->pos.depth;
+  int index = receive_pos_next(&b->pos);
+
+  if (index < 0)
+    return SVN_NO_ERROR;
+
+  if (b->failure)
+    {
+      if (depth == 3 && index == 0)
+        {
+          b->apr_err = value;
+          b->fields |= 1;
+        }
+      else if (depth == 3 && index == 3)
+        {
+          b->line = value;
+          b->fields |= 8;
+        }
+    }
+  else if (depth == 2 && index == 0)
+    {
+      b->rev = (svn_revnum_t)value;
+      b->params |= 1;
+    }
+  else if (depth == 4 && GET_DIR_IN_DIRENT(b))
+    {
+      if (index == 2)
+        {
+          b->dirent->size = (svn_filesize_t)value;
+          b->fields |= 4;
+        }
+      else if (index == 4)
+        {
+          b->dirent->created_rev = (svn_revnum_t)value;
+          b->fields |= 16;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.string for get_dir_baton_t. */
+static svn_error_t *
+get_dir_string(void *baton,
+               const char *data,
+               apr_size_t len)
+{
+  get_dir_baton_t *b = baton;
+  int depth = b->pos.depth;
+  int index = receive_pos_next(&b->pos);
+
+  if (index < 0)
+    return SVN_NO_ERROR;
+
+  if (b->failure)
+    {
+      if (depth == 3 && index == 1)
+        {
+          b->message = apr_pstrmemdup(b->pool, data, len);
+          b->fields |= 2;
+        }
+      else if (depth == 3 && index == 2)
+        {
+          b->file = apr_pstrmemdup(b->pool, data, len);
+          b->fields |= 4;
+        }
+    }
+  else if (depth == 4 && b->pos.index[2] == 1)
+    {
+      if (index == 0)
+        {
+          b->prop_name = svn_string_ncreate(data, len, b->pool);
+          b->fields |= 1;
+        }
+      else if (index == 1)
+        {
+          b->prop_value = svn_string_ncreate(data, len, b->pool);
+          b->fields |= 2;
+        }
+    }
+  else if (depth == 4 && GET_DIR_IN_DIRENT(b) && index == 0)
+    {
+      b->name = apr_pstrmemdup(b->pool, data, len);
+      b->fields |= 1;
+    }
+  else if (depth == 5 && GET_DIR_IN_DIRENT(b) && index == 0)
+    {
+      if (b->pos.index[4] == 5)
+        {
+          /* A bad date fails the whole request, just like a malformed
+           * response does. */
+          svn_error_t *err
+            = svn_time_from_cstring(&b->dirent->time,
+                                    apr_pstrmemdup(b->pool, data, len),
+                                    b->pool);
+          if (b->parse_err)
+            svn_error_clear(err);
+          else
+            b->parse_err = err;
+        }
+      else if (b->pos.index[4] == 6)
+        {
+          b->dirent->last_author = apr_pstrmemdup(b->pool, data, len);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.word for get_dir_baton_t. */
+static svn_error_t *
+get_dir_word(void *baton,
+             const char *data,
+             apr_size_t len)
+{
+  get_dir_baton_t *b = baton;
+  int depth = b->pos.depth;
+  int index = receive_pos_next(&b->pos);
+
+  if (index < 0)
+    return SVN_NO_ERROR;
+
+  if (depth == 1 && index == 0)
+    {
+      b->have_status = TRUE;
+      if (word_is(data, len, "failure"))
+        b->failure = TRUE;
+      else if (!word_is(data, len, "success") && !b->parse_err)
+        b->parse_err
+          = svn_error_createf(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                              _("Unknown status '%s' in command response"),
+                              apr_pstrmemdup(b->pool, data, len));
+    }
+  else if (depth == 4 && GET_DIR_IN_DIRENT(b))
+    {
+      if (index == 1)
+        {
+          b->dirent->kind
+            = svn_node_kind_from_word(apr_pstrmemdup(b->pool, data, len));
+          b->fields |= 2;
+        }
+      else if (index == 3 && word_is(data, len, "true"))
+        {
+          b->dirent->has_props = TRUE;
+          b->fields |= 8;
+        }
+      else if (index == 3 && word_is(data, len, "false"))
+        {
+          b->dirent->has_props = FALSE;
+          b->fields |= 8;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.start_list for get_dir_baton_t. */
+static svn_error_t *
+get_dir_start_list(void *baton)
+{
+  get_dir_baton_t *b = baton;
+  int depth = b->pos.depth;
+  svn_boolean_t known = FALSE;
+
+  if (b->pos.ignore_depth)
+    {
+      receive_pos_enter(&b->pos, FALSE);
+      return SVN_NO_ERROR;
+    }
+
+  switch (depth)
+    {
+      case 0:
+        known = TRUE;
+        break;
+
+      case 1:
+        /* The parameters. */
+        known = b->have_status && b->pos.index[1] == 1;
+        break;
+
+      case 2:
+        /* Error entries or props and dirents. */
+        if (b->failure)
+          {
+            known = TRUE;
+            b->fields = 0;
+          }
+        else if (b->pos.index[2] == 1 || b->pos.index[2] == 2)
+          {
+            known = TRUE;
+            b->params |= b->pos.index[2] == 1 ? 2 : 4;
+          }
+        break;
+
+      case 3:
+        /* A property or a directory entry. */
+        if (!b->failure)
+          {
+            known = TRUE;
+            b->fields = 0;
+            if (b->pos.index[2] == 2)
+              {
+                b->dirent = svn_dirent_create(b->pool);
+                b->dirent->time = 0;
+              }
+          }
+        break;
+
+      case 4:
+        /* The optional date and author of a directory entry. */
+        known = GET_DIR_IN_DIRENT(b)
+             && (b->pos.index[4] == 5 || b->pos.index[4] == 6);
+        break;
+    }
+
+  receive_pos_enter(&b->pos, known);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.end_list for get_dir_baton_t. */
+static svn_error_t *
+get_dir_end_list(void *baton)
+{
+  get_dir_baton_t *b = baton;
+  int depth = b->pos.depth;
+
+  if (b->pos.ignore_depth)
+    {
+      receive_pos_leave(&b->pos);
+      return SVN_NO_ERROR;
+    }
+
+  if (depth == 3 && b->failure)
+    {
+      /* An error entry.  Like svn_ra_svn__handle_failure_status(), skip
+       * the links that only wrap the actual errors on the server side. */
+      if (b->fields != 15)
+        receive_malformed(&b->parse_err);
+      else if ((apr_status_t)b->apr_err != SVN_ERR_RA_SVN_CMD_ERR)
+        {
+          svn_error_t *err = svn_error_create((apr_status_t)b->apr_err,
+                                              NULL,
+                                              *b->message ? b->message
+                                                          : NULL);
+          err->file = apr_pstrdup(err->pool, b->file);
+          err->line = (long)b->line;
+
+          if (b->server_err)
+            svn_error_compose(b->server_err, err);
+          else
+            b->server_err = err;
+        }
+    }
+  else if (depth == 4 && b->pos.index[2] == 1)
+    {
+      if (b->fields != 3)
+        receive_malformed(&b->parse_err);
+      else if (b->props)
+        apr_hash_set(b->props, b->prop_name->data, b->prop_name->len,
+                     b->prop_value);
+    }
+  else if (depth == 4 && GET_DIR_IN_DIRENT(b))
+    {
+      /* Nothing to sanitize in the name.  Any multi-segment path is
+         simply illegal in the hash returned by svn_ra_get_dir2. */
+      if ((b->fields & 31) != 31)
+        receive_malformed(&b->parse_err);
+      else if (strchr(b->name, '/'))
+        {
+          if (!b->parse_err)
+            b->parse_err
+              = svn_error_createf(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                  _("Invalid directory entry name '%s'"),
+                                  b->name);
+        }
+      else if (b->dirents)
+        svn_hash_sets(b->dirents, b->name, b->dirent);
+    }
+  else if (depth == 2 && !b->failure)
+    {
+      if (b->params != 7)
+        receive_malformed(&b->parse_err);
+    }
+  else if (depth == 1)
+    {
+      if (!b->have_status || b->pos.index[1] < 2)
+        receive_malformed(&b->parse_err);
+    }
+
+  receive_pos_leave(&b->pos);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
                                    apr_hash_t **dirents,
                                    svn_revnum_t *fetched_rev,
@@ -1553,8 +2095,10 @@ static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
 {
   svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
-  svn_ra_svn__list_t *proplist, *dirlist;
-  int i;
+  static const svn_ra_svn__item_receiver_t receiver =
+    { get_dir_number, get_dir_string, get_dir_word,
+      get_dir_start_list, get_dir_end_list };
+  get_dir_baton_t b;
 
   path = reparent_path(session, path, pool);
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w(c(?r)bb(!", "get-dir", path,
@@ -1567,63 +2111,41 @@ static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)b)", FALSE));
 
   SVN_ERR(handle_auth_request(sess_baton, pool));
-  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "rll", &rev, &proplist,
-                                        &dirlist));
 
-  if (fetched_rev)
-    *fetched_rev = rev;
-  if (props)
-    SVN_ERR(svn_ra_svn__parse_proplist(proplist, pool, props));
+  /* The directory list may be huge.  Parse the response on the fly
+     instead of building an item tree for it first. */
+  memset(&b, 0, sizeof(b));
+  b.pool = pool;
+  b.props = props ? svn_hash__make(pool) : NULL;
+  b.dirents = dirents ? svn_hash__make(pool) : NULL;
+  SVN_ERR(svn_ra_svn__receive_item(conn, &receiver, &b, pool));
 
-  /* We're done if dirents aren't wanted. */
-  if (!dirents)
-    return SVN_NO_ERROR;
+  if (b.failure)
+    {
+      if (b.server_err)
+        {
+          svn_error_clear(b.parse_err);
+          return b.server_err;
+        }
 
-  /* Interpret the directory list. */
-  *dirents = svn_hash__make(pool);
-  for (i = 0; i < dirlist->nelts; i++)
+      if (!b.parse_err)
+        b.parse_err = svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                       _("Empty error list"));
+    }
+  else if (!b.have_status)
     {
-      const char *name, *kind, *cdate, *cauthor;
-      svn_boolean_t has_props;
-      svn_dirent_t *dirent;
-      apr_uint64_t size;
-      svn_revnum_t crev;
-      svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(dirlist, i);
+      receive_malformed(&b.parse_err);
+    }
 
-      if (elt->kind != SVN_RA_SVN_LIST)
-        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
-                                _("Dirlist element not a list"));
-      SVN_ERR(svn_ra_svn__parse_tuple(&elt->u.list, "cwnbr(?c)(?c)",
-                                      &name, &kind, &size, &has_props,
-                                      &crev, &cdate, &cauthor));
+  if (b.parse_err)
+    return svn_error_trace(b.parse_err);
 
-      /* Nothing to sanitize here.  Any multi-segment path is simply
-         illegal in the hash returned by svn_ra_get_dir2. */
-      if (strchr(name, '/'))
-        return svn_error_createf(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
-                                 _("Invalid directory entry name '%s'"),
-                                 name);
-
-      dirent = svn_dirent_create(pool);
-      dirent->kind = svn_node_kind_from_word(kind);
-      dirent->size = size;/* FIXME: svn_filesize_t */
-      dirent->has_props = has_props;
-      dirent->created_rev = crev;
-      /* NOTE: the tuple's format string says CDATE may be NULL. But this
-         function does not allow that. The server has always sent us some
-         random date, however, so this just happens to work. But let's
-         be wary of servers that are (improperly) fixed to send NULL.
-
-         Note: they should NOT be "fixed" to send NULL, as that would break
-         any older clients which received that NULL. But we may as well
-         be defensive against a malicious server.  */
-      if (cdate == NULL)
-        dirent->time = 0;
-      else
-        SVN_ERR(svn_time_from_cstring(&dirent->time, cdate, pool));
-      dirent->last_author = cauthor;
-      svn_hash_sets(*dirents, name, dirent);
-    }
+  if (fetched_rev)
+    *fetched_rev = b.rev;
+  if (props)
+    *props = b.props;
+  if (dirents)
+    *dirents = b.dirents;
 
   return SVN_NO_ERROR;
 }
@@ -1720,20 +2242,46 @@ static svn_error_t *ra_svn_update(svn_ra_session_t *session,
   svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
   svn_boolean_t recurse = DEPTH_TO_RECURSE(depth);
+  svn_boolean_t text_deltas = TRUE;
+#if APR_HAS_THREADS
+  void *fetch_baton = NULL;
+#endif
 
   /* Callbacks may assume that all data is relative the sessions's URL. */
   SVN_ERR(ensure_exact_server_parent(session, scratch_pool));
 
+#if APR_HAS_THREADS
+  /* Fetch the file contents over separate connections, if allowed to. */
+  if (sess_baton->max_connections > 1)
+    {
+      SVN_ERR(svn_ra_svn__get_fetch_editor(&update_editor, &update_baton,
+                                           sess_baton, rev, target,
+                                           update_editor, update_baton,
+                                           pool));
+      fetch_baton = update_baton;
+      text_deltas = FALSE;
+    }
+#endif
+
   /* Tell the server we want to start an update. */
   SVN_ERR(svn_ra_svn__write_cmd_update(conn, pool, rev, target, recurse,
                                        depth, send_copyfrom_args,
-                                       ignore_ancestry));
+                                       ignore_ancestry, text_deltas));
   SVN_ERR(handle_auth_request(sess_baton, pool));
 
   /* Fetch a reporter for the caller to drive.  The reporter will drive
    * update_editor upon finish_report(). */
   SVN_ERR(ra_svn_get_reporter(sess_baton, pool, update_editor, update_baton,
                               target, depth, reporter, report_baton));
+
+#if APR_HAS_THREADS
+  /* Let the fetching editor know about switched subtrees. */
+  if (fetch_baton)
+    SVN_ERR(svn_ra_svn__get_fetch_reporter(reporter, report_baton,
+                                           *reporter, *report_baton,
+                                           fetch_baton, pool));
+#endif
+
   return SVN_NO_ERROR;
 }
 
@@ -1840,6 +2388,340 @@ is_done_response(const svn_ra_svn__item_t *item)
 }
 
 
+/* Baton for receiving a log entry, i.e.
+ *
+ *   ( ( change:changed-path-entry ... ) rev:number
+ *     ( ?author:string ) ( ?date:string ) ( ?message:string )
+ *     ? has-children:bool invalid-revnum:bool
+ *     revprop-count:number rev-props:proplist ? subtractive-merge:bool )
+ *
+ * or the word "done" that ends the list of entries, without building an
+ * item tree. */
+typedef struct log_entry_baton_t
+{
+  receive_pos_t pos;
+
+  /* Set if we received the word "done" or some other item that is not
+   * a list, respectively. */
+  svn_boolean_t done;
+  svn_boolean_t not_list;
+
+  /* Bit masks of the mandatory parts of the entry and of the current
+   * changed-path entry or revprop, respectively, that we received. */
+  int fields;
+  int sub_fields;
+
+  /* The parts of the entry.  Optional parts that the server did not send
+   * are NULL or SVN_RA_SVN_UNSPECIFIED_NUMBER.  CPHASH is NULL if there
+   * are no changed paths and REVPROPS is NULL if the server did not send
+   * a revprop list. */
+  apr_hash_t *cphash;
+  svn_revnum_t rev;
+  svn_string_t *author;
+  svn_string_t *date;
+  svn_string_t *message;
+  apr_uint64_t has_children;
+  apr_uint64_t invalid_revnum;
+  apr_hash_t *revprops;
+  apr_uint64_t subtractive_merge;
+
+  /* The changed path or revprop currently being received. */
+  svn_string_t *cpath;
+  svn_log_changed_path2_t *change;
+  svn_string_t *prop_name;
+  svn_string_t *prop_value;
+
+  /* The first problem that we found with the entry. */
+  svn_error_t *parse_err;
+
+  apr_pool_t *pool;
+} log_entry_baton_t;
+
+/* Return the boolean word DATA of LEN bytes as TRUE or FALSE.  Return
+ * SVN_RA_SVN_UNSPECIFIED_NUMBER if it is neither. */
+static apr_uint64_t
+word_to_boolean(const char *data,
+                apr_size_t len)
+{
+  if (word_is(data, len, "true"))
+    return TRUE;
+  if (word_is(data, len, "false"))
+    return FALSE;
+
+  return SVN_RA_SVN_UNSPECIFIED_NUMBER;
+}
+
+/* Return TRUE if the current list of B at nesting level 2 and below
+ * belongs to the changed paths or the revprops, respectively. */
+#define LOG_IN_CHANGES(b) ((b)->pos.index[1] == 0)
+#define LOG_IN_REVPROPS(b) ((b)->pos.index[1] == 8)
+
+/* Implements svn_ra_svn__item_receiver_t.number for log_entry_baton_t. */
+static svn_error_t *
+log_entry_number(void *baton,
+                 apr_uint64_t value)
+{
+  log_entry_baton_t *b = baton;
+  int depth = b->pos.depth;
+  int index = receive_pos_next(&b->pos);
+
+  if (depth == 0)
+    b->not_list = TRUE;
+  else if (index < 0)
+    return SVN_NO_ERROR;
+  else if (depth == 1 && index == 1)
+    {
+      b->rev = (svn_revnum_t)value;
+      b->fields |= 2;
+    }
+  else if (depth == 4 && LOG_IN_CHANGES(b)
+           && b->pos.index[3] == 2 && index == 1)
+    {
+      b->change->copyfrom_rev = (svn_revnum_t)value;
+      b->sub_fields |= 8;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.string for log_entry_baton_t. */
+static svn_error_t *
+log_entry_string(void *baton,
+                 const char *data,
+                 apr_size_t len)
+{
+  log_entry_baton_t *b = baton;
+  int depth = b->pos.depth;
+  int index = receive_pos_next(&b->pos);
+
+  if (depth == 0)
+    b->not_list = TRUE;
+  else if (index < 0)
+    return SVN_NO_ERROR;
+  else if (depth == 2 && index == 0)
+    {
+      svn_string_t *str = svn_string_ncreate(data, len, b->pool);
+
+      switch (b->pos.index[1])
+        {
+          case 2: b->author = str; break;
+          case 3: b->date = str; break;
+          case 4: b->message = str; break;
+          default: break;
+        }
+    }
+  else if (depth == 3 && LOG_IN_CHANGES(b) && index == 0)
+    {
+      b->cpath = svn_string_ncreate(data, len, b->pool);
+      b->sub_fields |= 1;
+    }
+  else if (depth == 3 && LOG_IN_REVPROPS(b) && index == 0)
+    {
+      b->prop_name = svn_string_ncreate(data, len, b->pool);
+      b->sub_fields |= 1;
+    }
+  else if (depth == 3 && LOG_IN_REVPROPS(b) && index == 1)
+    {
+      b->prop_value = svn_string_ncreate(data, len, b->pool);
+      b->sub_fields |= 2;
+    }
+  else if (depth == 4 && LOG_IN_CHANGES(b) && index == 0)
+    {
+      const char *str = apr_pstrmemdup(b->pool, data, len);
+
+      if (b->pos.index[3] == 2)
+        {
+          b->change->copyfrom_path = str;
+          b->sub_fields |= 4;
+        }
+      else if (b->pos.index[3] == 3)
+        {
+          b->change->node_kind = svn_node_kind_from_word(str);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.word for log_entry_baton_t. */
+static svn_error_t *
+log_entry_word(void *baton,
+               const char *data,
+               apr_size_t len)
+{
+  log_entry_baton_t *b = baton;
+  int depth = b->pos.depth;
+  int index = receive_pos_next(&b->pos);
+
+  if (depth == 0)
+    {
+      if (word_is(data, len, "done"))
+        b->done = TRUE;
+      else
+        b->not_list = TRUE;
+    }
+  else if (index < 0)
+    return SVN_NO_ERROR;
+  else if (depth == 1)
+    {
+      switch (index)
+        {
+          case 5:
+            b->has_children = word_to_boolean(data, len);
+            break;
+          case 6:
+            b->invalid_revnum = word_to_boolean(data, len);
+            break;
+          case 9:
+            b->subtractive_merge = word_to_boolean(data, len);
+            break;
+          default:
+            break;
+        }
+    }
+  else if (depth == 3 && LOG_IN_CHANGES(b) && index == 1 && len > 0)
+    {
+      b->change->action = *data;
+      b->sub_fields |= 2;
+    }
+  else if (depth == 4 && LOG_IN_CHANGES(b) && b->pos.index[3] == 3)
+    {
+      if (index == 1)
+        b->change->text_modified
+          = optbool_to_tristate(word_to_boolean(data, len));
+      else if (index == 2)
+        b->change->props_modified
+          = optbool_to_tristate(word_to_boolean(data, len));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.start_list for log_entry_baton_t.
+ */
+static svn_error_t *
+log_entry_start_list(void *baton)
+{
+  log_entry_baton_t *b = baton;
+  int depth = b->pos.depth;
+  svn_boolean_t known = FALSE;
+
+  if (b->pos.ignore_depth)
+    {
+      receive_pos_enter(&b->pos, FALSE);
+      return SVN_NO_ERROR;
+    }
+
+  switch (depth)
+    {
+      case 0:
+        known = TRUE;
+        break;
+
+      case 1:
+        /* Changed paths, author, date, message or revprops. */
+        switch (b->pos.index[1])
+          {
+            case 0: b->fields |= 1; known = TRUE; break;
+            case 2: b->fields |= 4; known = TRUE; break;
+            case 3: b->fields |= 8; known = TRUE; break;
+            case 4: b->fields |= 16; known = TRUE; break;
+            case 8:
+              b->revprops = svn_hash__make(b->pool);
+              known = TRUE;
+              break;
+            default:
+              break;
+          }
+        break;
+
+      case 2:
+        /* A changed-path entry or a revprop. */
+        if (LOG_IN_CHANGES(b) || LOG_IN_REVPROPS(b))
+          {
+            known = TRUE;
+            b->sub_fields = 0;
+          }
+        if (LOG_IN_CHANGES(b))
+          b->change = svn_log_changed_path2_create(b->pool);
+        break;
+
+      case 3:
+        /* Copy source and modifications of a changed path. */
+        known = LOG_IN_CHANGES(b)
+             && (b->pos.index[3] == 2 || b->pos.index[3] == 3);
+        break;
+    }
+
+  receive_pos_enter(&b->pos, known);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_svn__item_receiver_t.end_list for log_entry_baton_t. */
+static svn_error_t *
+log_entry_end_list(void *baton)
+{
+  log_entry_baton_t *b = baton;
+  int depth = b->pos.depth;
+
+  if (b->pos.ignore_depth)
+    {
+      receive_pos_leave(&b->pos);
+      return SVN_NO_ERROR;
+    }
+
+  if (depth == 4 && LOG_IN_CHANGES(b) && b->pos.index[3] == 2)
+    {
+      /* The copy source is either empty or complete. */
+      if (b->pos.index[4] != 0 && (b->sub_fields & 12) != 12)
+        receive_malformed(&b->parse_err);
+    }
+  else if (depth == 3 && LOG_IN_CHANGES(b))
+    {
+      svn_log_changed_path2_t *change = b->change;
+
+      if ((b->sub_fields & 3) != 3 || b->pos.index[3] < 3)
+        {
+          receive_malformed(&b->parse_err);
+        }
+      else
+        {
+          if (!svn_fspath__is_canonical(b->cpath->data))
+            {
+              b->cpath->data = svn_fspath__canonicalize(b->cpath->data,
+                                                        b->pool);
+              b->cpath->len = strlen(b->cpath->data);
+            }
+          if (change->copyfrom_path
+              && !svn_fspath__is_canonical(change->copyfrom_path))
+            change->copyfrom_path
+              = svn_fspath__canonicalize(change->copyfrom_path, b->pool);
+
+          if (!b->cphash)
+            b->cphash = svn_hash__make(b->pool);
+          apr_hash_set(b->cphash, b->cpath->data, b->cpath->len, change);
+        }
+    }
+  else if (depth == 3 && LOG_IN_REVPROPS(b))
+    {
+      if (b->sub_fields != 3)
+        receive_malformed(&b->parse_err);
+      else
+        apr_hash_set(b->revprops, b->prop_name->data, b->prop_name->len,
+                     b->prop_value);
+    }
+  else if (depth == 1)
+    {
+      if (b->fields != 31)
+        receive_malformed(&b->parse_err);
+    }
+
+  receive_pos_leave(&b->pos);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 perform_ra_svn_log(svn_error_t **outer_error,
                    svn_ra_session_t *session,
@@ -1912,37 +2794,41 @@ perform_ra_svn_log(svn_error_t **outer_error,
 
   SVN_ERR(handle_auth_request(sess_baton, pool));
 
-  /* Read the log messages. */
+  /* Read the log messages.  Parse each entry on the fly instead of
+     building an item tree for it first. */
   iterpool = svn_pool_create(pool);
   while (1)
     {
-      apr_uint64_t has_children_param, invalid_revnum_param;
-      apr_uint64_t has_subtractive_merge_param;
-      svn_string_t *author, *date, *message;
-      svn_ra_svn__list_t *cplist, *rplist;
+      static const svn_ra_svn__item_receiver_t entry_receiver =
+        { log_entry_number, log_entry_string, log_entry_word,
+          log_entry_start_list, log_entry_end_list };
+      log_entry_baton_t b;
       svn_log_entry_t *log_entry;
       svn_boolean_t has_children;
       svn_boolean_t subtractive_merge = FALSE;
-      apr_uint64_t revprop_count;
-      svn_ra_svn__item_t *item;
       apr_hash_t *cphash;
       svn_revnum_t rev;
 
       svn_pool_clear(iterpool);
-      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
-      if (is_done_response(item))
+      memset(&b, 0, sizeof(b));
+      b.pool = iterpool;
+      b.has_children = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+      b.invalid_revnum = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+      b.subtractive_merge = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+      SVN_ERR(svn_ra_svn__receive_item(conn, &entry_receiver, &b,
+                                       iterpool));
+      if (b.done)
         break;
-      if (item->kind != SVN_RA_SVN_LIST)
-        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
-                                _("Log entry not a list"));
-      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list,
-                                      "lr(?s)(?s)(?s)?BBnl?B",
-                                      &cplist, &rev, &author, &date,
-                                      &message, &has_children_param,
-                                      &invalid_revnum_param,
-                                      &revprop_count, &rplist,
-                                      &has_subtractive_merge_param));
-      if (want_custom_revprops && rplist == NULL)
+      if (b.not_list)
+        {
+          svn_error_clear(b.parse_err);
+          return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                  _("Log entry not a list"));
+        }
+      if (b.parse_err)
+        return svn_error_trace(b.parse_err);
+
+      if (want_custom_revprops && b.revprops == NULL)
         {
           /* Caller asked for custom revprops, but server is too old. */
           return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
@@ -1950,63 +2836,25 @@ perform_ra_svn_log(svn_error_t **outer_error,
                                     " via log"));
         }
 
-      if (has_children_param == SVN_RA_SVN_UNSPECIFIED_NUMBER)
+      if (b.has_children == SVN_RA_SVN_UNSPECIFIED_NUMBER)
         has_children = FALSE;
       else
-        has_children = (svn_boolean_t) has_children_param;
+        has_children = (svn_boolean_t) b.has_children;
 
-      if (has_subtractive_merge_param == SVN_RA_SVN_UNSPECIFIED_NUMBER)
+      if (b.subtractive_merge == SVN_RA_SVN_UNSPECIFIED_NUMBER)
         subtractive_merge = FALSE;
       else
-        subtractive_merge = (svn_boolean_t) has_subtractive_merge_param;
+        subtractive_merge = (svn_boolean_t) b.subtractive_merge;
 
       /* Because the svn protocol won't let us send an invalid revnum, we have
          to recover that fact using the extra parameter. */
-      if (invalid_revnum_param != SVN_RA_SVN_UNSPECIFIED_NUMBER
-            && invalid_revnum_param)
+      rev = b.rev;
+      if (b.invalid_revnum != SVN_RA_SVN_UNSPECIFIED_NUMBER
+            && b.invalid_revnum)
         rev = SVN_INVALID_REVNUM;
 
-      if (cplist->nelts > 0)
-        {
-          /* Interpret the changed-paths list. */
-          cphash = svn_hash__make(iterpool);
-          for (i = 0; i < cplist->nelts; i++)
-            {
-              svn_log_changed_path2_t *change;
-              svn_string_t *cpath;
-              const char *copy_path, *action, *kind_str;
-              apr_uint64_t text_mods, prop_mods;
-              svn_revnum_t copy_rev;
-              svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(cplist, i);
-
-              if (elt->kind != SVN_RA_SVN_LIST)
-                return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
-                                        _("Changed-path entry not a list"));
-              SVN_ERR(svn_ra_svn__read_data_log_changed_entry(&elt->u.list,
-                                              &cpath, &action, &copy_path,
-                                              &copy_rev, &kind_str,
-                                              &text_mods, &prop_mods));
-
-              if (!svn_fspath__is_canonical(cpath->data))
-                {
-                  cpath->data = svn_fspath__canonicalize(cpath->data, iterpool);
-                  cpath->len = strlen(cpath->data);
-                }
-              if (copy_path && !svn_fspath__is_canonical(copy_path))
-                copy_path = svn_fspath__canonicalize(copy_path, iterpool);
-
-              change = svn_log_changed_path2_create(iterpool);
-              change->action = *action;
-              change->copyfrom_path = copy_path;
-              change->copyfrom_rev = copy_rev;
-              change->node_kind = svn_node_kind_from_word(kind_str);
-              change->text_modified = optbool_to_tristate(text_mods);
-              change->props_modified = optbool_to_tristate(prop_mods);
-              apr_hash_set(cphash, cpath->data, cpath->len, change);
-            }
-        }
-      else
-        cphash = NULL;
+      /* The changed paths have already been interpreted by the parser. */
+      cphash = b.cphash;
 
       /* Invoke RECEIVER
           - Except if the server sends more than a >= 1 limit top level items
@@ -2023,21 +2871,19 @@ perform_ra_svn_log(svn_error_t **outer_error,
           log_entry->revision = rev;
           log_entry->has_children = has_children;
           log_entry->subtractive_merge = subtractive_merge;
-          if (rplist)
-            SVN_ERR(svn_ra_svn__parse_proplist(rplist, iterpool,
-                                               &log_entry->revprops));
+          log_entry->revprops = b.revprops;
           if (log_entry->revprops == NULL)
             log_entry->revprops = svn_hash__make(iterpool);
 
-          if (author && want_author)
+          if (b.author && want_author)
             svn_hash_sets(log_entry->revprops,
-                          SVN_PROP_REVISION_AUTHOR, author);
-          if (date && want_date)
+                          SVN_PROP_REVISION_AUTHOR, b.author);
+          if (b.date && want_date)
             svn_hash_sets(log_entry->revprops,
-                          SVN_PROP_REVISION_DATE, date);
-          if (message && want_message)
+                          SVN_PROP_REVISION_DATE, b.date);
+          if (b.message && want_message)
             svn_hash_sets(log_entry->revprops,
-                          SVN_PROP_REVISION_LOG, message);
+                          SVN_PROP_REVISION_LOG, b.message);
 
           err = receiver(receiver_baton, log_entry, iterpool);
           if (svn_error_find_cause(err, SVN_ERR_CEASE_INVOCATION))
@@ -2136,21 +2982,13 @@ static svn_error_t *handle_unsupported_cmd(svn_error_t *err,
 }
 
 
-static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
-                                const char *path, svn_revnum_t rev,
-                                svn_dirent_t **dirent, apr_pool_t *pool)
+/* Convert LIST, received in response to a "stat" command, into *DIRENT
+ * allocated in POOL.  LIST may be NULL, in which case *DIRENT will be
+ * NULL as well. */
+static svn_error_t *parse_stat_response(svn_dirent_t **dirent,
+                                        svn_ra_svn__list_t *list,
+                                        apr_pool_t *pool)
 {
-  svn_ra_svn__session_baton_t *sess_baton = session->priv;
-  svn_ra_svn_conn_t *conn = sess_baton->conn;
-  svn_ra_svn__list_t *list = NULL;
-  svn_dirent_t *the_dirent;
-
-  path = reparent_path(session, path, pool);
-  SVN_ERR(svn_ra_svn__write_cmd_stat(conn, pool, path, rev));
-  SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess_baton, pool),
-                                 N_("'stat' not implemented")));
-  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "(?l)", &list));
-
   if (! list)
     {
       *dirent = NULL;
@@ -2161,6 +2999,7 @@ static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
       svn_boolean_t has_props;
       svn_revnum_t crev;
       apr_uint64_t size;
+      svn_dirent_t *the_dirent;
 
       SVN_ERR(svn_ra_svn__parse_tuple(list, "wnbr(?c)(?c)",
                                       &kind, &size, &has_props,
@@ -2180,6 +3019,140 @@ static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
+                                const char *path, svn_revnum_t rev,
+                                svn_dirent_t **dirent, apr_pool_t *pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  svn_ra_svn__list_t *list = NULL;
+
+  path = reparent_path(session, path, pool);
+  SVN_ERR(svn_ra_svn__write_cmd_stat(conn, pool, path, rev));
+  SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess_baton, pool),
+                                 N_("'stat' not implemented")));
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "(?l)", &list));
+
+  return svn_error_trace(parse_stat_response(dirent, list, pool));
+}
+
+/* Maximum number of commands that we put into a single batch.  This
+ * limits the size of the request the server has to buffer. */
+#define MAX_BATCH_SIZE 256
+
+/* Read the next response to a batched command from CONN and return its
+ * parameters in *PARAMS.  If the server reported a failure, return it
+ * in *FAILURE; otherwise set that to NULL.  Only errors that leave the
+ * connection in an undefined state are returned directly.  Allocate
+ * the results in POOL. */
+static svn_error_t *read_batch_response(svn_ra_svn__list_t **params,
+                                        svn_error_t **failure,
+                                        svn_ra_svn_conn_t *conn,
+                                        apr_pool_t *pool)
+{
+  const char *status;
+
+  *failure = NULL;
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "wl", &status, params));
+  if (strcmp(status, "failure") == 0)
+    *failure = svn_ra_svn__handle_failure_status(*params);
+  else if (strcmp(status, "success") != 0)
+    return svn_error_createf(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                             _("Unknown status '%s' in command response"),
+                             status);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *ra_svn_stat_many(svn_ra_session_t *session,
+                                     apr_hash_t **dirents,
+                                     const apr_array_header_t *paths,
+                                     svn_revnum_t rev,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int first, i;
+
+  *dirents = apr_hash_make(result_pool);
+  for (first = 0; first < paths->nelts; first += MAX_BATCH_SIZE)
+    {
+      int end = MIN(paths->nelts, first + MAX_BATCH_SIZE);
+      svn_pool_clear(iterpool);
+
+      /* Older servers need one round trip per path. */
+      if (! svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_BATCH))
+        {
+          for (i = first; i < end; i++)
+            {
+              const char *path = APR_ARRAY_IDX(paths, i, const char *);
+              svn_dirent_t *dirent;
+
+              SVN_ERR(ra_svn_stat(session, path, rev, &dirent, iterpool));
+              if (dirent)
+                svn_hash_sets(*dirents, apr_pstrdup(result_pool, path),
+                              svn_dirent_dup(dirent, result_pool));
+            }
+
+          continue;
+        }
+
+      /* Send all stat requests at once ... */
+      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "w(!", "batch"));
+      for (i = first; i < end; i++)
+        {
+          const char *path = APR_ARRAY_IDX(paths, i, const char *);
+          SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "!(w(c(?r)))!",
+                                          "stat",
+                                          reparent_path(session, path,
+                                                        iterpool),
+                                          rev));
+        }
+      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "!))"));
+      SVN_ERR(handle_auth_request(sess_baton, iterpool));
+
+      /* ... and process the responses in the same order.  Each of them
+       * is preceded by an auth request, unless that already failed.
+       * Keep reading after failures so we stay in sync with the server. */
+      for (i = first; i < end; i++)
+        {
+          const char *path = APR_ARRAY_IDX(paths, i, const char *);
+          svn_ra_svn__list_t *params, *list;
+          svn_error_t *failure;
+          svn_dirent_t *dirent;
+
+          SVN_ERR(read_batch_response(&params, &failure, conn, iterpool));
+          if (!failure)
+            SVN_ERR(read_batch_response(&params, &failure, conn, iterpool));
+
+          if (failure)
+            {
+              if (err)
+                svn_error_clear(failure);
+              else
+                err = failure;
+
+              continue;
+            }
+
+          SVN_ERR(svn_ra_svn__parse_tuple(params, "(?l)", &list));
+          SVN_ERR(parse_stat_response(&dirent, list, result_pool));
+          if (dirent)
+            svn_hash_sets(*dirents, apr_pstrdup(result_pool, path), dirent);
+        }
+
+      SVN_ERR(svn_ra_svn__read_cmd_response(conn, iterpool, ""));
+      if (err)
+        break;
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
 
 static svn_error_t *ra_svn_get_locations(svn_ra_session_t *session,
                                          apr_hash_t **locations,
@@ -3298,6 +4271,7 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   ra_svn_get_inherited_props,
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
+  ra_svn_stat_many,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -0,0 +1,1043 @@
+/*
+ * fetch.c :  Fetching file contents concurrently to an update editor drive
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+#include <apr_general.h>
+#include <apr_strings.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "svn_hash.h"
+#include "svn_path.h"
+#include "svn_dirent_uri.h"
+#include "svn_checksum.h"
+#include "svn_delta.h"
+#include "svn_ra_svn.h"
+
+#include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_thread_jobs.h"
+
+#include "svn_private_config.h"
+
+#include "ra_svn.h"
+
+#if APR_HAS_THREADS
+
+#include <apr_thread_cond.h>
+
+/* The update editor drive sent by the server contains the tree structure,
+ * the properties and the checksums but not the file contents.  Whenever
+ * the drive closes a file without contents, we keep the file open and let
+ * a worker thread fetch its contents with "get-file" over a connection of
+ * its own.  Finished files get delivered to the wrapped editor from the
+ * main thread, either while the drive continues or once it completes.
+ *
+ * The wrapped editor will therefore see apply_textdelta and close_file
+ * calls after the parent directories have been closed, as permitted by
+ * the editor rules.  It never gets called from any other thread.
+ *
+ * Subtrees that the reporter linked to other URLs (switched paths) get
+ * fetched from those URLs.  The additional connections are therefore
+ * opened at the common ancestor of the session URL and all link URLs.
+ */
+
+/* Contents of a fetched file up to this size are kept in memory.  Larger
+ * files get spilled to a temporary file. */
+#define FETCH_MEMORY_SIZE (1024 * 1024)
+
+/* Number of files per connection that may be fetched but not yet be
+ * delivered to the wrapped editor. */
+#define JOBS_PER_CONNECTION 16
+
+typedef struct edit_baton_t edit_baton_t;
+
+/* An additional connection to the repository. */
+typedef struct fetch_session_t
+{
+  /* Root pool owning this structure and SESS. */
+  apr_pool_t *pool;
+
+  /* The session.  Used by at most one thread at any given time. */
+  svn_ra_svn__session_baton_t *sess;
+
+  /* Next idle connection. */
+  struct fetch_session_t *next;
+} fetch_session_t;
+
+/* A file being passed to the wrapped editor. */
+typedef struct file_baton_t
+{
+  edit_baton_t *eb;
+
+  /* Pool owning this structure.  Unlike the pool provided by the driver,
+   * it stays valid until we close the wrapped file. */
+  apr_pool_t *pool;
+
+  /* The wrapped file baton. */
+  void *wrapped_baton;
+
+  /* Path of the file relative to the session URL. */
+  const char *path;
+
+  /* Checksums passed to apply_textdelta and close_file, respectively. */
+  const char *base_checksum;
+  const char *text_checksum;
+
+  /* Wrapped delta window handler, once we pass text deltas through. */
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  /* Set if the server omitted the contents of this file. */
+  svn_boolean_t fetch_contents;
+} file_baton_t;
+
+/* A file whose contents get fetched by one of the worker threads. */
+typedef struct fetch_job_t
+{
+  /* Private root pool of this job. */
+  apr_pool_t *pool;
+
+  /* What to fetch.  PATH is relative to the FETCH_URL of the edit. */
+  const char *path;
+  svn_revnum_t revision;
+
+  /* The contents received so far. */
+  svn_spillbuf_t *contents;
+
+  /* If the server requested authentication, the connection waiting for
+   * our response, as well as the parameters of the auth request.  The
+   * worker leaves the authentication to the main thread. */
+  fetch_session_t *auth_session;
+  svn_ra_svn__list_t *mechlist;
+  const char *realm;
+
+  /* The file to deliver the contents to.  Only used by the main thread. */
+  file_baton_t *fb;
+
+  /* The edit that this job belongs to. */
+  edit_baton_t *eb;
+} fetch_job_t;
+
+/* A directory being passed to the wrapped editor. */
+typedef struct dir_baton_t
+{
+  edit_baton_t *eb;
+  void *wrapped_baton;
+} dir_baton_t;
+
+struct edit_baton_t
+{
+  /* The editor/baton we're wrapping. */
+  const svn_delta_editor_t *wrapped_editor;
+  void *wrapped_edit_baton;
+
+  /* The pool this editor has been allocated in. */
+  apr_pool_t *pool;
+
+  /* The session driving this edit and the revision to fetch from. */
+  svn_ra_svn__session_baton_t *sess;
+  svn_revnum_t revision;
+
+  /* Target of the update.  Reported paths are relative to it. */
+  const char *target;
+
+  /* URLs of the switched subtrees, keyed by their path relative to the
+   * session URL. */
+  apr_hash_t *links;
+
+  /* URL that the additional connections have been opened at. */
+  const char *fetch_url;
+
+  /* Files queued for fetching or not yet delivered.  They get delivered
+   * in the order they finish.  NULL until we need to fetch the first
+   * file. */
+  svn_thread__jobs_t *jobs;
+
+  /* Pools of all additional connections that we opened.  Their number is
+   * SESSION_COUNT. */
+  apr_pool_t *session_pools[SVN_RA_SVN__MAX_CONNECTIONS_LIMIT];
+  int session_count;
+
+  /* Connections not currently used by any worker.  Protected by the
+   * mutex of JOBS. */
+  fetch_session_t *idle_sessions;
+
+  /* Signalled whenever a connection becomes idle. */
+  apr_thread_cond_t *session_cond;
+};
+
+
+/*** Worker threads ***/
+
+/* Send the "get-file" request for JOB over FS and read the server's auth
+ * request.  Stash FS in JOB if we need to authenticate. */
+static svn_error_t *
+request_contents(fetch_job_t *job,
+                 fetch_session_t *fs)
+{
+  svn_ra_svn_conn_t *conn = fs->sess->conn;
+
+  SVN_ERR(svn_ra_svn__write_cmd_get_file(conn, job->pool, job->path,
+                                         job->revision, FALSE, TRUE));
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, job->pool, "lc",
+                                        &job->mechlist, &job->realm));
+  if (job->mechlist->nelts > 0)
+    job->auth_session = fs;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t.  Append the data to the spill buffer of the
+ * fetch_job_t BATON unless the edit has been aborted. */
+static svn_error_t *
+write_contents(void *baton,
+               const char *data,
+               apr_size_t *len)
+{
+  fetch_job_t *job = baton;
+
+  if (svn_thread__jobs_aborted(job->eb->jobs))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  return svn_error_trace(svn_spillbuf__write(job->contents, data, *len,
+                                             job->pool));
+}
+
+/* Read the "get-file" response for JOB from SESS into JOB->CONTENTS and
+ * verify its checksum.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+read_contents(fetch_job_t *job,
+              svn_ra_svn__session_baton_t *sess,
+              apr_pool_t *scratch_pool)
+{
+  svn_ra_svn_conn_t *conn = sess->conn;
+  const char *expected_digest;
+  svn_revnum_t rev;
+  svn_ra_svn__list_t *proplist;
+  svn_checksum_t *expected_checksum = NULL;
+  svn_checksum_ctx_t *checksum_ctx = NULL;
+  svn_stream_t *stream;
+
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, "(?c)rl",
+                                        &expected_digest,
+                                        &rev, &proplist));
+  if (expected_digest)
+    {
+      SVN_ERR(svn_checksum_parse_hex(&expected_checksum, svn_checksum_md5,
+                                     expected_digest, scratch_pool));
+      checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, scratch_pool);
+    }
+
+  job->contents = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                       FETCH_MEMORY_SIZE, job->pool);
+
+  stream = svn_stream_create(job, scratch_pool);
+  svn_stream_set_write(stream, write_contents);
+  SVN_ERR(svn_ra_svn__read_file_contents(conn, stream, checksum_ctx,
+                                         scratch_pool));
+
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+
+  if (checksum_ctx)
+    {
+      svn_checksum_t *checksum;
+
+      SVN_ERR(svn_checksum_final(&checksum, checksum_ctx, scratch_pool));
+      if (!svn_checksum_match(checksum, expected_checksum))
+        return svn_checksum_mismatch_err(expected_checksum, checksum,
+                                         scratch_pool,
+                                         _("Checksum mismatch for '%s'"),
+                                         job->path);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Make the connection FS available to the workers of EB again. */
+static svn_error_t *
+release_session(edit_baton_t *eb,
+                fetch_session_t *fs)
+{
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(eb->jobs);
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  fs->next = eb->idle_sessions;
+  eb->idle_sessions = fs;
+  apr_thread_cond_broadcast(eb->session_cond);
+
+  return svn_error_trace(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+}
+
+/* Implements svn_thread__job_func_t:  Fetch the contents of the file
+ * given by the fetch_job_t BATON over an idle connection. */
+static svn_error_t *
+fetch_job(void *baton,
+          apr_pool_t *pool)
+{
+  fetch_job_t *job = baton;
+  edit_baton_t *eb = job->eb;
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(eb->jobs);
+  fetch_session_t *fs;
+
+  /* There are as many connections as threads, but the main thread may
+     still be using one to authenticate. */
+  SVN_ERR(svn_mutex__lock(mutex));
+  while (!eb->idle_sessions && !svn_thread__jobs_aborted(eb->jobs))
+    {
+      apr_status_t status = apr_thread_cond_wait(eb->session_cond,
+                                                 svn_mutex__get(mutex));
+      if (status)
+        return svn_error_trace(
+                 svn_mutex__unlock(mutex,
+                                   svn_error_wrap_apr(status,
+                                      _("Can't wait for condition variable"))));
+    }
+
+  fs = eb->idle_sessions;
+  if (fs)
+    eb->idle_sessions = fs->next;
+  SVN_ERR(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+
+  if (!fs)
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  /* A connection that failed may be out of sync, so don't re-use it. */
+  SVN_ERR(request_contents(job, fs));
+  if (job->auth_session)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_contents(job, fs->sess, pool));
+
+  return svn_error_trace(release_session(eb, fs));
+}
+
+
+/*** Job management in the main thread ***/
+
+/* Stop all worker threads of the edit baton BATON and release all jobs and
+ * connections that it still holds.  Implements apr_pool_cleanup_t. */
+static apr_status_t
+cleanup_fetching(void *baton)
+{
+  edit_baton_t *eb = baton;
+  int i;
+
+  if (!eb->jobs)
+    return APR_SUCCESS;
+
+  /* Wake up the workers waiting for a connection and wait for all running
+     jobs to finish before we release the connections. */
+  svn_thread__jobs_abort(eb->jobs);
+  if (!svn_mutex__lock(svn_thread__jobs_mutex(eb->jobs)))
+    {
+      apr_thread_cond_broadcast(eb->session_cond);
+      svn_error_clear(svn_mutex__unlock(svn_thread__jobs_mutex(eb->jobs),
+                                        SVN_NO_ERROR));
+    }
+  svn_thread__jobs_close(eb->jobs);
+
+  for (i = 0; i < eb->session_count; ++i)
+    svn_pool_destroy(eb->session_pools[i]);
+  eb->session_count = 0;
+  eb->idle_sessions = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* Open the additional connections for EB and prepare its worker threads.
+ * Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+start_fetching(edit_baton_t *eb,
+               apr_pool_t *scratch_pool)
+{
+  int count = eb->sess->max_connections - 1;
+  apr_hash_index_t *hi;
+  apr_status_t status;
+  int i;
+
+  /* The reporter is done by now, so we know all switched subtrees. */
+  eb->fetch_url = eb->sess->parent->client_url->data;
+  for (hi = apr_hash_first(scratch_pool, eb->links); hi;
+       hi = apr_hash_next(hi))
+    eb->fetch_url = svn_uri_get_longest_ancestor(eb->fetch_url,
+                                                 apr_hash_this_val(hi),
+                                                 eb->pool);
+
+  if (*eb->fetch_url == '\0')
+    return svn_error_createf(SVN_ERR_RA_ILLEGAL_URL, NULL,
+                             _("Switched paths of '%s' are not located "
+                               "on the same server"),
+                             eb->sess->parent->client_url->data);
+
+  status = apr_thread_cond_create(&eb->session_cond, eb->pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create condition variable"));
+
+  /* Finished jobs don't hold a connection, so deliver them in whatever
+     order they finish.  Register our cleanup after the queue's own, so
+     it gets to wake up the workers before the queue waits for them. */
+  SVN_ERR(svn_thread__jobs_create(&eb->jobs, count * JOBS_PER_CONNECTION,
+                                  count, 0, FALSE, NULL, NULL, eb->pool));
+  apr_pool_cleanup_register(eb->pool, eb, cleanup_fetching,
+                            apr_pool_cleanup_null);
+
+  /* Open all connections up-front in this thread.  This may prompt for
+     credentials. */
+  for (i = 0; i < count; ++i)
+    {
+      apr_pool_t *pool = svn_pool_create(NULL);
+      fetch_session_t *fs = apr_pcalloc(pool, sizeof(*fs));
+      svn_ra_callbacks2_t *callbacks;
+
+      fs->pool = pool;
+      eb->session_pools[eb->session_count++] = pool;
+      SVN_ERR(svn_ra_svn__open_sibling(&fs->sess, eb->sess, eb->fetch_url,
+                                       pool, scratch_pool));
+
+      /* The workers must not call back into the client.  They check for
+         the jobs being aborted instead. */
+      callbacks = apr_pmemdup(pool, fs->sess->callbacks, sizeof(*callbacks));
+      callbacks->progress_func = NULL;
+      callbacks->cancel_func = NULL;
+      fs->sess->callbacks = callbacks;
+
+      fs->next = eb->idle_sessions;
+      eb->idle_sessions = fs;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Respond to the auth request that the worker of JOB received, read the
+ * file contents and make the connection available to the workers again.
+ * Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+authenticate_job(fetch_job_t *job,
+                 apr_pool_t *scratch_pool)
+{
+  fetch_session_t *fs = job->auth_session;
+
+  SVN_ERR(svn_ra_svn__do_auth(fs->sess, job->mechlist, job->realm,
+                              scratch_pool));
+  SVN_ERR(read_contents(job, fs->sess, scratch_pool));
+
+  /* Let the workers use this connection again. */
+  return svn_error_trace(release_session(job->eb, fs));
+}
+
+/* Send the contents fetched by JOB to the wrapped editor and close the
+ * file.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+deliver_contents(fetch_job_t *job,
+                 apr_pool_t *scratch_pool)
+{
+  file_baton_t *fb = job->fb;
+  edit_baton_t *eb = fb->eb;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  if (job->auth_session)
+    SVN_ERR(authenticate_job(job, scratch_pool));
+
+  /* A delta without source data applies to any base text. */
+  SVN_ERR(eb->wrapped_editor->apply_textdelta(fb->wrapped_baton,
+                                              fb->base_checksum, fb->pool,
+                                              &handler, &handler_baton));
+  SVN_ERR(svn_txdelta_send_stream(svn_stream__from_spillbuf(job->contents,
+                                                            scratch_pool),
+                                  handler, handler_baton, NULL,
+                                  scratch_pool));
+  SVN_ERR(eb->wrapped_editor->close_file(fb->wrapped_baton,
+                                         fb->text_checksum, scratch_pool));
+  svn_pool_destroy(fb->pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Deliver the contents of one fetched file in EB to the wrapped editor.
+ * If WAIT is set, block until one of the jobs has finished.  Otherwise,
+ * return immediately if none has.  Set *DELIVERED accordingly.
+ * Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+deliver_job(svn_boolean_t *delivered,
+            edit_baton_t *eb,
+            svn_boolean_t wait,
+            apr_pool_t *scratch_pool)
+{
+  fetch_job_t *job;
+  svn_error_t *err;
+
+  SVN_ERR(svn_thread__jobs_pop((void **)&job, &err, eb->jobs, wait));
+
+  *delivered = (job != NULL);
+  if (!job)
+    return SVN_NO_ERROR;
+
+  if (!err)
+    err = deliver_contents(job, scratch_pool);
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Deliver the contents of all files in EB that have already been fetched.
+ * Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+deliver_finished_jobs(edit_baton_t *eb,
+                      apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  svn_boolean_t delivered = TRUE;
+
+  if (!eb->jobs || !svn_thread__jobs_count(eb->jobs))
+    return SVN_NO_ERROR;
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (delivered)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(deliver_job(&delivered, eb, FALSE, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the path of the file at PATH in the edit EB relative to
+ * EB->FETCH_URL.  Files within switched subtrees are taken from the URL
+ * of the closest switched parent.  Allocate the result in RESULT_POOL. */
+static const char *
+get_fetch_path(edit_baton_t *eb,
+               const char *path,
+               apr_pool_t *result_pool)
+{
+  const char *url = eb->sess->parent->client_url->data;
+  const char *relpath = path;
+  const char *parent = path;
+
+  while (apr_hash_count(eb->links))
+    {
+      const char *link_url = svn_hash_gets(eb->links, parent);
+      if (link_url)
+        {
+          url = link_url;
+          relpath = svn_relpath_skip_ancestor(parent, path);
+          break;
+        }
+
+      if (*parent == '\0')
+        break;
+
+      parent = svn_relpath_dirname(parent, result_pool);
+    }
+
+  url = svn_path_url_add_component2(url, relpath, result_pool);
+  return svn_uri_skip_ancestor(eb->fetch_url, url, result_pool);
+}
+
+/* Queue the contents of the file FB for fetching.  Use SCRATCH_POOL for
+ * temporaries. */
+static svn_error_t *
+push_job(file_baton_t *fb,
+         apr_pool_t *scratch_pool)
+{
+  edit_baton_t *eb = fb->eb;
+  apr_pool_t *job_pool;
+  fetch_job_t *job;
+
+  if (!eb->jobs)
+    SVN_ERR(start_fetching(eb, scratch_pool));
+
+  /* Limit the amount of data fetched ahead of the editor drive. */
+  if (svn_thread__jobs_full(eb->jobs))
+    {
+      svn_boolean_t delivered;
+      SVN_ERR(deliver_job(&delivered, eb, TRUE, scratch_pool));
+    }
+
+  job_pool = svn_pool_create(NULL);
+  job = apr_pcalloc(job_pool, sizeof(*job));
+  job->pool = job_pool;
+  job->path = get_fetch_path(eb, fb->path, job_pool);
+  job->revision = eb->revision;
+  job->fb = fb;
+  job->eb = eb;
+
+  return svn_error_trace(svn_thread__jobs_push(eb->jobs, fetch_job, job,
+                                               job_pool));
+}
+
+
+/*** The editor ***/
+
+static svn_error_t *
+set_target_revision(void *edit_baton,
+                    svn_revnum_t target_revision,
+                    apr_pool_t *pool)
+{
+  edit_baton_t *eb = edit_baton;
+
+  eb->revision = target_revision;
+  return eb->wrapped_editor->set_target_revision(eb->wrapped_edit_baton,
+                                                 target_revision, pool);
+}
+
+static svn_error_t *
+open_root(void *edit_baton,
+          svn_revnum_t base_revision,
+          apr_pool_t *pool,
+          void **root_baton)
+{
+  edit_baton_t *eb = edit_baton;
+  dir_baton_t *db = apr_pcalloc(pool, sizeof(*db));
+
+  db->eb = eb;
+  SVN_ERR(eb->wrapped_editor->open_root(eb->wrapped_edit_baton,
+                                        base_revision, pool,
+                                        &db->wrapped_baton));
+
+  *root_baton = db;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+delete_entry(const char *path,
+             svn_revnum_t base_revision,
+             void *parent_baton,
+             apr_pool_t *pool)
+{
+  dir_baton_t *pb = parent_baton;
+
+  return pb->eb->wrapped_editor->delete_entry(path, base_revision,
+                                              pb->wrapped_baton, pool);
+}
+
+static svn_error_t *
+add_directory(const char *path,
+              void *parent_baton,
+              const char *copyfrom_path,
+              svn_revnum_t copyfrom_revision,
+              apr_pool_t *pool,
+              void **child_baton)
+{
+  dir_baton_t *pb = parent_baton;
+  dir_baton_t *db = apr_pcalloc(pool, sizeof(*db));
+
+  db->eb = pb->eb;
+  SVN_ERR(pb->eb->wrapped_editor->add_directory(path, pb->wrapped_baton,
+                                                copyfrom_path,
+                                                copyfrom_revision, pool,
+                                                &db->wrapped_baton));
+
+  *child_baton = db;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+open_directory(const char *path,
+               void *parent_baton,
+               svn_revnum_t base_revision,
+               apr_pool_t *pool,
+               void **child_baton)
+{
+  dir_baton_t *pb = parent_baton;
+  dir_baton_t *db = apr_pcalloc(pool, sizeof(*db));
+
+  db->eb = pb->eb;
+  SVN_ERR(pb->eb->wrapped_editor->open_directory(path, pb->wrapped_baton,
+                                                 base_revision, pool,
+                                                 &db->wrapped_baton));
+
+  *child_baton = db;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+change_dir_prop(void *dir_baton,
+                const char *name,
+                const svn_string_t *value,
+                apr_pool_t *pool)
+{
+  dir_baton_t *db = dir_baton;
+
+  return db->eb->wrapped_editor->change_dir_prop(db->wrapped_baton,
+                                                 name, value, pool);
+}
+
+static svn_error_t *
+close_directory(void *dir_baton,
+                apr_pool_t *pool)
+{
+  dir_baton_t *db = dir_baton;
+
+  SVN_ERR(db->eb->wrapped_editor->close_directory(db->wrapped_baton, pool));
+  return svn_error_trace(deliver_finished_jobs(db->eb, pool));
+}
+
+static svn_error_t *
+absent_directory(const char *path,
+                 void *parent_baton,
+                 apr_pool_t *pool)
+{
+  dir_baton_t *pb = parent_baton;
+
+  return pb->eb->wrapped_editor->absent_directory(path, pb->wrapped_baton,
+                                                  pool);
+}
+
+/* Allocate a new file baton for PATH in EB. */
+static file_baton_t *
+make_file_baton(edit_baton_t *eb,
+                const char *path)
+{
+  apr_pool_t *file_pool = svn_pool_create(eb->pool);
+  file_baton_t *fb = apr_pcalloc(file_pool, sizeof(*fb));
+
+  fb->eb = eb;
+  fb->pool = file_pool;
+  fb->path = apr_pstrdup(file_pool, path);
+
+  return fb;
+}
+
+static svn_error_t *
+add_file(const char *path,
+         void *parent_baton,
+         const char *copyfrom_path,
+         svn_revnum_t copyfrom_revision,
+         apr_pool_t *pool,
+         void **file_baton)
+{
+  dir_baton_t *pb = parent_baton;
+  file_baton_t *fb = make_file_baton(pb->eb, path);
+
+  SVN_ERR(pb->eb->wrapped_editor->add_file(path, pb->wrapped_baton,
+                                           copyfrom_path, copyfrom_revision,
+                                           fb->pool, &fb->wrapped_baton));
+
+  *file_baton = fb;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+open_file(const char *path,
+          void *parent_baton,
+          svn_revnum_t base_revision,
+          apr_pool_t *pool,
+          void **file_baton)
+{
+  dir_baton_t *pb = parent_baton;
+  file_baton_t *fb = make_file_baton(pb->eb, path);
+
+  SVN_ERR(pb->eb->wrapped_editor->open_file(path, pb->wrapped_baton,
+                                            base_revision, fb->pool,
+                                            &fb->wrapped_baton));
+
+  *file_baton = fb;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_window_handler_t for apply_textdelta(). */
+static svn_error_t *
+window_handler(svn_txdelta_window_t *window,
+               void *baton)
+{
+  file_baton_t *fb = baton;
+
+  /* Pass actual deltas through.  Older servers send them regardless of
+     what we asked for. */
+  if (window && !fb->handler)
+    SVN_ERR(fb->eb->wrapped_editor->apply_textdelta(fb->wrapped_baton,
+                                                    fb->base_checksum,
+                                                    fb->pool,
+                                                    &fb->handler,
+                                                    &fb->handler_baton));
+
+  if (fb->handler)
+    return svn_error_trace(fb->handler(window, fb->handler_baton));
+
+  /* The delta was empty, so we have to fetch the contents ourselves. */
+  fb->fetch_contents = TRUE;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+apply_textdelta(void *file_baton,
+                const char *base_checksum,
+                apr_pool_t *pool,
+                svn_txdelta_window_handler_t *handler,
+                void **handler_baton)
+{
+  file_baton_t *fb = file_baton;
+
+  fb->base_checksum = apr_pstrdup(fb->pool, base_checksum);
+  *handler = window_handler;
+  *handler_baton = fb;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+change_file_prop(void *file_baton,
+                 const char *name,
+                 const svn_string_t *value,
+                 apr_pool_t *pool)
+{
+  file_baton_t *fb = file_baton;
+
+  return fb->eb->wrapped_editor->change_file_prop(fb->wrapped_baton,
+                                                  name, value, pool);
+}
+
+static svn_error_t *
+close_file(void *file_baton,
+           const char *text_checksum,
+           apr_pool_t *pool)
+{
+  file_baton_t *fb = file_baton;
+  edit_baton_t *eb = fb->eb;
+
+  if (fb->fetch_contents)
+    {
+      fb->text_checksum = apr_pstrdup(fb->pool, text_checksum);
+      SVN_ERR(push_job(fb, pool));
+    }
+  else
+    {
+      SVN_ERR(eb->wrapped_editor->close_file(fb->wrapped_baton,
+                                             text_checksum, pool));
+      svn_pool_destroy(fb->pool);
+    }
+
+  return svn_error_trace(deliver_finished_jobs(eb, pool));
+}
+
+static svn_error_t *
+absent_file(const char *path,
+            void *parent_baton,
+            apr_pool_t *pool)
+{
+  dir_baton_t *pb = parent_baton;
+
+  return pb->eb->wrapped_editor->absent_file(path, pb->wrapped_baton, pool);
+}
+
+static svn_error_t *
+close_edit(void *edit_baton,
+           apr_pool_t *pool)
+{
+  edit_baton_t *eb = edit_baton;
+
+  if (eb->jobs)
+    {
+      apr_pool_t *iterpool = svn_pool_create(pool);
+
+      while (svn_thread__jobs_count(eb->jobs))
+        {
+          svn_boolean_t delivered;
+
+          svn_pool_clear(iterpool);
+          SVN_ERR(deliver_job(&delivered, eb, TRUE, iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+
+      /* Close the additional connections. */
+      apr_pool_cleanup_run(eb->pool, eb, cleanup_fetching);
+    }
+
+  return eb->wrapped_editor->close_edit(eb->wrapped_edit_baton, pool);
+}
+
+static svn_error_t *
+abort_edit(void *edit_baton,
+           apr_pool_t *pool)
+{
+  edit_baton_t *eb = edit_baton;
+
+  apr_pool_cleanup_run(eb->pool, eb, cleanup_fetching);
+
+  return eb->wrapped_editor->abort_edit(eb->wrapped_edit_baton, pool);
+}
+
+
+/*** The reporter ***/
+
+/* Baton of the reporter wrapping the one of the update. */
+typedef struct report_baton_t
+{
+  /* The reporter/baton we're wrapping. */
+  const svn_ra_reporter3_t *wrapped_reporter;
+  void *wrapped_report_baton;
+
+  /* The fetching editor to tell about switched subtrees. */
+  edit_baton_t *eb;
+} report_baton_t;
+
+static svn_error_t *
+report_set_path(void *report_baton,
+                const char *path,
+                svn_revnum_t revision,
+                svn_depth_t depth,
+                svn_boolean_t start_empty,
+                const char *lock_token,
+                apr_pool_t *pool)
+{
+  report_baton_t *rb = report_baton;
+
+  return rb->wrapped_reporter->set_path(rb->wrapped_report_baton, path,
+                                        revision, depth, start_empty,
+                                        lock_token, pool);
+}
+
+static svn_error_t *
+report_delete_path(void *report_baton,
+                   const char *path,
+                   apr_pool_t *pool)
+{
+  report_baton_t *rb = report_baton;
+
+  return rb->wrapped_reporter->delete_path(rb->wrapped_report_baton, path,
+                                           pool);
+}
+
+/* Record URL as the source of the subtree at PATH before passing the
+ * call on. */
+static svn_error_t *
+report_link_path(void *report_baton,
+                 const char *path,
+                 const char *url,
+                 svn_revnum_t revision,
+                 svn_depth_t depth,
+                 svn_boolean_t start_empty,
+                 const char *lock_token,
+                 apr_pool_t *pool)
+{
+  report_baton_t *rb = report_baton;
+  edit_baton_t *eb = rb->eb;
+
+  svn_hash_sets(eb->links, svn_relpath_join(eb->target, path, eb->pool),
+                apr_pstrdup(eb->pool, url));
+
+  return rb->wrapped_reporter->link_path(rb->wrapped_report_baton, path,
+                                         url, revision, depth, start_empty,
+                                         lock_token, pool);
+}
+
+static svn_error_t *
+report_finish_report(void *report_baton,
+                     apr_pool_t *pool)
+{
+  report_baton_t *rb = report_baton;
+
+  return rb->wrapped_reporter->finish_report(rb->wrapped_report_baton,
+                                             pool);
+}
+
+static svn_error_t *
+report_abort_report(void *report_baton,
+                    apr_pool_t *pool)
+{
+  report_baton_t *rb = report_baton;
+
+  return rb->wrapped_reporter->abort_report(rb->wrapped_report_baton,
+                                            pool);
+}
+
+static const svn_ra_reporter3_t fetch_reporter = {
+  report_set_path,
+  report_delete_path,
+  report_link_path,
+  report_finish_report,
+  report_abort_report
+};
+
+svn_error_t *
+svn_ra_svn__get_fetch_reporter(const svn_ra_reporter3_t **reporter,
+                               void **report_baton,
+                               const svn_ra_reporter3_t *wrapped_reporter,
+                               void *wrapped_baton,
+                               void *fetch_baton,
+                               apr_pool_t *pool)
+{
+  report_baton_t *rb = apr_pcalloc(pool, sizeof(*rb));
+
+  rb->wrapped_reporter = wrapped_reporter;
+  rb->wrapped_report_baton = wrapped_baton;
+  rb->eb = fetch_baton;
+
+  *reporter = &fetch_reporter;
+  *report_baton = rb;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__get_fetch_editor(const svn_delta_editor_t **fetch_editor,
+                             void **fetch_baton,
+                             svn_ra_svn__session_baton_t *sess,
+                             svn_revnum_t revision,
+                             const char *target,
+                             const svn_delta_editor_t *editor,
+                             void *edit_baton,
+                             apr_pool_t *pool)
+{
+  svn_delta_editor_t *new_editor = svn_delta_default_editor(pool);
+  edit_baton_t *eb = apr_pcalloc(pool, sizeof(*eb));
+
+  new_editor->set_target_revision = set_target_revision;
+  new_editor->open_root = open_root;
+  new_editor->delete_entry = delete_entry;
+  new_editor->add_directory = add_directory;
+  new_editor->open_directory = open_directory;
+  new_editor->change_dir_prop = change_dir_prop;
+  new_editor->close_directory = close_directory;
+  new_editor->absent_directory = absent_directory;
+  new_editor->add_file = add_file;
+  new_editor->open_file = open_file;
+  new_editor->apply_textdelta = apply_textdelta;
+  new_editor->change_file_prop = change_file_prop;
+  new_editor->close_file = close_file;
+  new_editor->absent_file = absent_file;
+  new_editor->close_edit = close_edit;
+  new_editor->abort_edit = abort_edit;
+
+  eb->wrapped_editor = editor;
+  eb->wrapped_edit_baton = edit_baton;
+  eb->pool = pool;
+  eb->sess = sess;
+  eb->revision = revision;
+  eb->target = apr_pstrdup(pool, target);
+  eb->links = apr_hash_make(pool);
+
+  *fetch_editor = new_editor;
+  *fetch_baton = eb;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
@@ -215,6 +215,7 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->capabilities = apr_hash_make(result_pool);
   conn->compression_level = compression_level;
   conn->zero_copy_limit = zero_copy_limit;
+  conn->compression = NULL;
   conn->pool = result_pool;
 
   if (sock != NULL)
@@ -330,9 +331,25 @@ svn_ra_svn__set_block_handler(svn_ra_svn_conn_t *conn,
   svn_ra_svn__stream_timeout(conn->stream, get_timeout(conn));
 }
 
+void
+svn_ra_svn__set_read_timeout(svn_ra_svn_conn_t *conn,
+                             apr_interval_time_t timeout)
+{
+  svn_ra_svn__stream_read_timeout(conn->stream, timeout);
+}
+
 svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
                                        svn_boolean_t *data_available)
 {
+  /* Data that has already been received but not been decoded, yet. */
+  svn_ra_svn__compression_t *compression = conn->compression;
+  if (compression && (compression->decoded_pos < compression->decoded->len
+                      || compression->raw_pos < compression->raw->len))
+    {
+      *data_available = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   return svn_ra_svn__stream_data_available(conn->stream, data_available);
 }
 
@@ -363,14 +380,41 @@ check_io_limits(svn_ra_svn_conn_t *conn)
   return SVN_NO_ERROR;
 }
 
-/* Write data to socket or output file as appropriate. */
-static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
-                                    const char *data, apr_size_t len)
+/* Notify the progress callback of CONN's session, if any, that COUNT
+ * more bytes have been written.  Use POOL for temporaries. */
+static void
+report_written(svn_ra_svn_conn_t *conn, apr_size_t count, apr_pool_t *pool)
 {
-  const char *end = data + len;
+  svn_ra_svn__session_baton_t *session = conn->session;
+
+  if (session)
+    {
+      const svn_ra_callbacks2_t *cb = session->callbacks;
+      session->bytes_written += count;
+
+      if (cb && cb->progress_func)
+        (cb->progress_func)(session->bytes_written + session->bytes_read,
+                            -1, cb->progress_baton, pool);
+    }
+}
+
+/* Write the NVEC buffers in VEC to socket or output file as appropriate,
+ * bypassing any stream-level compression.  Sockets will receive as many
+ * buffers as possible in a single scatter-gather write.  The contents of
+ * VEC will be modified. */
+static svn_error_t *writebuf_send_v(svn_ra_svn_conn_t *conn,
+                                    apr_pool_t *pool,
+                                    struct iovec *vec, int nvec)
+{
+  apr_size_t len = 0;
   apr_size_t count;
   apr_pool_t *subpool = NULL;
   svn_ra_svn__session_baton_t *session = conn->session;
+  svn_boolean_t is_socket = svn_ra_svn__stream_is_socket(conn->stream);
+  int i;
+
+  for (i = 0; i < nvec; ++i)
+    len += vec[i].iov_len;
 
   /* Limit the size of the response, if a limit has been configured.
    * This is to limit the server load in case users e.g. accidentally ran
@@ -378,14 +422,29 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   conn->current_out += len;
   SVN_ERR(check_io_limits(conn));
 
-  while (data < end)
+  while (nvec > 0)
     {
-      count = end - data;
+      if (vec->iov_len == 0)
+        {
+          ++vec;
+          --nvec;
+          continue;
+        }
 
       if (session && session->callbacks && session->callbacks->cancel_func)
         SVN_ERR((session->callbacks->cancel_func)(session->callbacks_baton));
 
-      SVN_ERR(svn_ra_svn__stream_write(conn->stream, data, &count));
+      if (is_socket && nvec > 1)
+        {
+          SVN_ERR(svn_ra_svn__stream_sendv(conn->stream, vec, nvec, &count));
+        }
+      else
+        {
+          count = vec->iov_len;
+          SVN_ERR(svn_ra_svn__stream_write(conn->stream, vec->iov_base,
+                                           &count));
+        }
+
       if (count == 0)
         {
           if (!subpool)
@@ -394,16 +453,23 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
             svn_pool_clear(subpool);
           SVN_ERR(conn->block_handler(conn, subpool, conn->block_baton));
         }
-      data += count;
 
-      if (session)
+      report_written(conn, count, subpool);
+
+      /* Skip the data that has been written. */
+      while (count > 0)
         {
-          const svn_ra_callbacks2_t *cb = session->callbacks;
-          session->bytes_written += count;
+          apr_size_t chunk = MIN(count, vec->iov_len);
+
+          vec->iov_base = (char *)vec->iov_base + chunk;
+          vec->iov_len -= chunk;
+          count -= chunk;
 
-          if (cb && cb->progress_func)
-            (cb->progress_func)(session->bytes_written + session->bytes_read,
-                                -1, cb->progress_baton, subpool);
+          if (vec->iov_len == 0)
+            {
+              ++vec;
+              --nvec;
+            }
         }
     }
 
@@ -416,6 +482,176 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   return SVN_NO_ERROR;
 }
 
+/* The steps of the compression ladder of svn_ra_svn__compression_t.
+ * Everything above COMPRESSION_STEP_LZ4 is zlib with increasing levels. */
+#define COMPRESSION_STEP_NONE 0
+#define COMPRESSION_STEP_LZ4  1
+static const int compression_step_levels[] = {
+  SVN__COMPRESSION_NONE,
+  SVN__COMPRESSION_NONE,
+  SVN__COMPRESSION_ZLIB_MIN,
+  SVN__COMPRESSION_ZLIB_DEFAULT,
+  SVN__COMPRESSION_ZLIB_MAX
+};
+
+/* Frames smaller than this will not be compressed. */
+#define COMPRESSION_MIN_FRAME_SIZE 256
+
+/* Small frames are not worth the setup costs of zlib. */
+#define COMPRESSION_MIN_ZLIB_FRAME_SIZE 4096
+
+/* Re-evaluate the compression step after this many frames ... */
+#define COMPRESSION_ADAPT_FRAMES 16
+
+/* ... or after this much uncompressed data, whichever comes first. */
+#define COMPRESSION_ADAPT_BYTES 0x100000
+
+/* Number of frames to send uncompressed after finding the data to be
+ * incompressible, before we try again. */
+#define COMPRESSION_PROBE_FRAMES 64
+
+/* Move COMPRESSION up or down the compression ladder, based on the
+ * statistics gathered since the last call.  Then reset the statistics.
+ *
+ * The idea is that the time spent sending the data indicates how
+ * congested the link is.  As long as we are waiting much longer for the
+ * network than for the compressor, tighter compression will pay off.
+ * If the compressor becomes the bottleneck, we back off again.
+ * Incompressible data, e.g. encrypted files, will not be compressed at
+ * all for a while. */
+static void
+adapt_compression(svn_ra_svn__compression_t *compression)
+{
+  if (compression->step == COMPRESSION_STEP_NONE)
+    {
+      /* Time to see whether the data has become compressible again? */
+      compression->frames_until_probe -= compression->frames;
+      if (compression->frames_until_probe <= 0)
+        compression->step = COMPRESSION_STEP_LZ4;
+    }
+  else if (compression->wire_bytes * 100 > compression->raw_bytes * 97)
+    {
+      compression->step = COMPRESSION_STEP_NONE;
+      compression->frames_until_probe = COMPRESSION_PROBE_FRAMES;
+    }
+  else if (compression->send_time > 2 * compression->compress_time)
+    {
+      if (compression->step < compression->max_step)
+        ++compression->step;
+    }
+  else if (compression->compress_time > compression->send_time)
+    {
+      if (compression->step > COMPRESSION_STEP_LZ4)
+        --compression->step;
+    }
+
+  compression->frames = 0;
+  compression->raw_bytes = 0;
+  compression->wire_bytes = 0;
+  compression->compress_time = 0;
+  compression->send_time = 0;
+}
+
+/* Send the LEN bytes at DATA as a single compressed frame over CONN.
+ * LEN must not exceed SVN_RA_SVN__FRAME_SIZE. */
+static svn_error_t *
+write_frame(svn_ra_svn_conn_t *conn,
+            apr_pool_t *pool,
+            const char *data,
+            apr_size_t len)
+{
+  svn_ra_svn__compression_t *compression = conn->compression;
+  unsigned char header[1 + SVN__MAX_ENCODED_UINT_LEN];
+  struct iovec vec[2];
+  int step = compression->step;
+  apr_time_t start, compressed, sent;
+
+  if (len < COMPRESSION_MIN_FRAME_SIZE)
+    step = COMPRESSION_STEP_NONE;
+  else if (len < COMPRESSION_MIN_ZLIB_FRAME_SIZE)
+    step = MIN(step, COMPRESSION_STEP_LZ4);
+
+  start = apr_time_now();
+  if (step == COMPRESSION_STEP_LZ4)
+    {
+      header[0] = SVN_RA_SVN__CODEC_LZ4;
+      SVN_ERR(svn__compress_lz4(data, len, compression->encoded));
+    }
+  else
+    {
+      header[0] = SVN_RA_SVN__CODEC_ZLIB;
+      SVN_ERR(svn__compress_zlib(data, len, compression->encoded,
+                                 compression_step_levels[step]));
+    }
+  compressed = apr_time_now();
+
+  vec[0].iov_base = header;
+  vec[0].iov_len = svn__encode_uint(header + 1, compression->encoded->len)
+                 - header;
+  vec[1].iov_base = compression->encoded->data;
+  vec[1].iov_len = compression->encoded->len;
+  SVN_ERR(writebuf_send_v(conn, pool, vec, 2));
+  sent = apr_time_now();
+
+  /* Tiny frames tell us nothing about the link or the data. */
+  if (len >= COMPRESSION_MIN_FRAME_SIZE)
+    {
+      ++compression->frames;
+      compression->raw_bytes += len;
+      compression->wire_bytes += compression->encoded->len;
+      compression->compress_time += compressed - start;
+      compression->send_time += sent - compressed;
+
+      if (   compression->frames >= COMPRESSION_ADAPT_FRAMES
+          || compression->raw_bytes >= COMPRESSION_ADAPT_BYTES)
+        adapt_compression(compression);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Write the NVEC buffers in VEC to socket or output file as appropriate,
+ * compressing them if that has been enabled for CONN.  The contents of
+ * VEC will be modified. */
+static svn_error_t *writebuf_output_v(svn_ra_svn_conn_t *conn,
+                                      apr_pool_t *pool,
+                                      struct iovec *vec, int nvec)
+{
+  int i;
+
+  if (!conn->compression)
+    return svn_error_trace(writebuf_send_v(conn, pool, vec, nvec));
+
+  for (i = 0; i < nvec; ++i)
+    {
+      const char *data = vec[i].iov_base;
+      apr_size_t len = vec[i].iov_len;
+
+      while (len > 0)
+        {
+          apr_size_t chunk = MIN(len, SVN_RA_SVN__FRAME_SIZE);
+          SVN_ERR(write_frame(conn, pool, data, chunk));
+
+          data += chunk;
+          len -= chunk;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Write data to socket or output file as appropriate. */
+static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
+                                    const char *data, apr_size_t len)
+{
+  struct iovec vec;
+
+  vec.iov_base = (void *)data;
+  vec.iov_len = len;
+
+  return svn_error_trace(writebuf_output_v(conn, pool, &vec, 1));
+}
+
 /* Write data from the write buffer out to the socket. */
 static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 {
@@ -430,13 +666,20 @@ static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                    const char *data, apr_size_t len)
 {
-  /* data >= 8k is sent immediately */
+  /* data >= 8k is sent immediately, together with whatever is still
+     in the write buffer */
   if (len >= sizeof(conn->write_buf) / 2)
     {
-      if (conn->write_pos > 0)
-        SVN_ERR(writebuf_flush(conn, pool));
+      struct iovec vec[2];
+
+      vec[0].iov_base = conn->write_buf;
+      vec[0].iov_len = conn->write_pos;
+      vec[1].iov_base = (void *)data;
+      vec[1].iov_len = len;
 
-      return writebuf_output(conn, pool, data, len);
+      /* Clear conn->write_pos first in case the block handler does a read. */
+      conn->write_pos = 0;
+      return svn_error_trace(writebuf_output_v(conn, pool, vec, 2));
     }
 
   /* ensure room for the data to add */
@@ -450,6 +693,36 @@ static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_svn__enable_compression(svn_ra_svn_conn_t *conn,
+                               apr_pool_t *pool)
+{
+  svn_ra_svn__compression_t *compression;
+
+  /* Everything up to here must go out uncompressed. */
+  if (conn->write_pos)
+    SVN_ERR(writebuf_flush(conn, pool));
+
+  compression = apr_pcalloc(conn->pool, sizeof(*compression));
+  for (compression->max_step = COMPRESSION_STEP_LZ4;
+       compression->max_step + 1 < (int)(sizeof(compression_step_levels)
+                                         / sizeof(compression_step_levels[0]))
+       && compression_step_levels[compression->max_step + 1]
+            <= conn->compression_level;
+       ++compression->max_step)
+    ;
+
+  /* Start fast and let the link tell us whether we should try harder. */
+  compression->step = COMPRESSION_STEP_LZ4;
+  compression->encoded = svn_stringbuf_create_empty(conn->pool);
+  compression->raw = svn_stringbuf_create_ensure(SVN_RA_SVN__READBUF_SIZE,
+                                                 conn->pool);
+  compression->decoded = svn_stringbuf_create_empty(conn->pool);
+
+  conn->compression = compression;
+  return SVN_NO_ERROR;
+}
+
 /* Write STRING_LITERAL, which is a string literal argument.
 
    Note: The purpose of the empty string "" in the macro definition is to
@@ -490,6 +763,135 @@ static char *readbuf_drain(svn_ra_svn_conn_t *conn, char *data, char *end)
   return data + copylen;
 }
 
+/* If CONN's raw input buffer contains a complete compressed frame,
+ * decode it and set *FOUND.  Otherwise, move the incomplete frame to
+ * the front of the buffer and clear *FOUND. */
+static svn_error_t *decode_frame(svn_ra_svn_conn_t *conn,
+                                 svn_boolean_t *found)
+{
+  svn_ra_svn__compression_t *compression = conn->compression;
+  svn_stringbuf_t *raw = compression->raw;
+  const unsigned char *start = (const unsigned char *)raw->data;
+  const unsigned char *p = start + compression->raw_pos;
+  const unsigned char *end = start + raw->len;
+  const unsigned char *payload = NULL;
+  apr_uint64_t size = 0;
+
+  if (end - p > 1)
+    payload = svn__decode_uint(&size, p + 1, end);
+
+  /* Even incompressible data does not grow by more than a few bytes. */
+  if (   (!payload && end - p > 1 + SVN__MAX_ENCODED_UINT_LEN)
+      || size > 2 * SVN_RA_SVN__FRAME_SIZE)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Invalid compressed frame header"));
+
+  if (payload && (apr_uint64_t)(end - payload) >= size)
+    {
+      if (*p == SVN_RA_SVN__CODEC_ZLIB)
+        SVN_ERR(svn__decompress_zlib(payload, (apr_size_t)size,
+                                     compression->decoded,
+                                     SVN_RA_SVN__FRAME_SIZE));
+      else if (*p == SVN_RA_SVN__CODEC_LZ4)
+        SVN_ERR(svn__decompress_lz4(payload, (apr_size_t)size,
+                                    compression->decoded,
+                                    SVN_RA_SVN__FRAME_SIZE));
+      else
+        return svn_error_createf(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                 _("Unknown compression codec '%c'"),
+                                 *p);
+
+      compression->decoded_pos = 0;
+      compression->raw_pos = payload + size - start;
+      *found = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  /* Incomplete frame.  Move it to the front. */
+  if (compression->raw_pos)
+    {
+      memmove(raw->data, raw->data + compression->raw_pos,
+              raw->len - compression->raw_pos);
+      raw->len -= compression->raw_pos;
+      compression->raw_pos = 0;
+    }
+
+  *found = FALSE;
+  return SVN_NO_ERROR;
+}
+
+/* Append the next chunk of compressed input on CONN to its raw input
+ * buffer.  Set *EOF if the connection got closed. */
+static svn_error_t *read_raw(svn_ra_svn_conn_t *conn,
+                             svn_boolean_t *eof)
+{
+  svn_stringbuf_t *raw = conn->compression->raw;
+  apr_size_t count;
+
+  svn_stringbuf_ensure(raw, raw->len + SVN_RA_SVN__READBUF_SIZE);
+  count = raw->blocksize - raw->len - 1;
+  SVN_ERR(svn_ra_svn__stream_read(conn->stream, raw->data + raw->len,
+                                  &count));
+
+  raw->len += count;
+  raw->data[raw->len] = '\0';
+  *eof = count == 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Decode the next frame of compressed input on CONN.  Set *EOF if the
+ * connection got closed before a complete frame could be read. */
+static svn_error_t *read_frame(svn_ra_svn_conn_t *conn,
+                               svn_boolean_t *eof)
+{
+  svn_boolean_t found;
+
+  *eof = FALSE;
+  while (TRUE)
+    {
+      SVN_ERR(decode_frame(conn, &found));
+      if (found)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(read_raw(conn, eof));
+      if (*eof)
+        return SVN_NO_ERROR;
+    }
+}
+
+/* Read up to *LEN bytes from CONN's stream into DATA, decompressing them
+ * if necessary.  Set *LEN to the number of bytes actually read; 0 means
+ * that the connection got closed. */
+static svn_error_t *readbuf_stream_read(svn_ra_svn_conn_t *conn,
+                                        char *data,
+                                        apr_size_t *len)
+{
+  svn_ra_svn__compression_t *compression = conn->compression;
+  apr_size_t available;
+
+  if (!compression)
+    return svn_error_trace(svn_ra_svn__stream_read(conn->stream, data, len));
+
+  while (compression->decoded_pos == compression->decoded->len)
+    {
+      svn_boolean_t eof;
+      SVN_ERR(read_frame(conn, &eof));
+      if (eof)
+        {
+          *len = 0;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  available = compression->decoded->len - compression->decoded_pos;
+  *len = MIN(*len, available);
+  memcpy(data, compression->decoded->data + compression->decoded_pos, *len);
+  compression->decoded_pos += *len;
+
+  return SVN_NO_ERROR;
+}
+
 /* Read data from socket or input file as appropriate. */
 static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
                                   apr_size_t *len, apr_pool_t *pool)
@@ -505,7 +907,7 @@ static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
   SVN_ERR(check_io_limits(conn));
 
   /* Actually fill the buffer. */
-  SVN_ERR(svn_ra_svn__stream_read(conn->stream, data, len));
+  SVN_ERR(readbuf_stream_read(conn, data, len));
   if (*len == 0)
     return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
   conn->current_in += *len;
@@ -523,6 +925,50 @@ static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
   return SVN_NO_ERROR;
 }
 
+/* Like readbuf_input() but never wait for data to arrive on CONN.
+ * If no data is available, set *LEN to 0. */
+static svn_error_t *readbuf_input_available(svn_ra_svn_conn_t *conn,
+                                            char *data,
+                                            apr_size_t *len,
+                                            apr_pool_t *pool)
+{
+  svn_ra_svn__compression_t *compression = conn->compression;
+  svn_boolean_t available;
+
+  /* Compressed data can only be consumed in whole frames. */
+  while (compression && compression->decoded_pos == compression->decoded->len)
+    {
+      svn_boolean_t found, eof;
+
+      SVN_ERR(decode_frame(conn, &found));
+      if (found)
+        break;
+
+      SVN_ERR(svn_ra_svn__stream_data_available(conn->stream, &available));
+      if (!available)
+        {
+          *len = 0;
+          return SVN_NO_ERROR;
+        }
+
+      SVN_ERR(read_raw(conn, &eof));
+      if (eof)
+        return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
+    }
+
+  if (!compression)
+    {
+      SVN_ERR(svn_ra_svn__stream_data_available(conn->stream, &available));
+      if (!available)
+        {
+          *len = 0;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  return svn_error_trace(readbuf_input(conn, data, len, pool));
+}
+
 /* Treat the next LEN input bytes from CONN as "read" */
 static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
 {
@@ -536,7 +982,7 @@ static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
       break;
 
     buflen = sizeof(conn->read_buf);
-    SVN_ERR(svn_ra_svn__stream_read(conn->stream, conn->read_buf, &buflen));
+    SVN_ERR(readbuf_stream_read(conn, conn->read_buf, &buflen));
     if (buflen == 0)
       return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
 
@@ -1563,6 +2009,232 @@ svn_ra_svn__read_item(svn_ra_svn_conn_t *conn,
   return read_item(conn, pool, *item, c, 0);
 }
 
+/* Context of svn_ra_svn__receive_item(). */
+typedef struct receive_context_t
+{
+  svn_ra_svn_conn_t *conn;
+  const svn_ra_svn__item_receiver_t *receiver;
+  void *baton;
+
+  /* Holds strings that are not contained in the read buffer.  Allocated
+   * upon first use and re-used for all following strings. */
+  svn_stringbuf_t *buffer;
+  apr_pool_t *pool;
+} receive_context_t;
+
+/* Return the error for an item that RECEIVE_ITEM has no callback for. */
+static svn_error_t *
+unexpected_item_error(void)
+{
+  return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                          _("Unexpected item in network data"));
+}
+
+/* Read a string of LEN64 bytes from CTX->CONN and pass it on to the
+ * receiver.  Point into the read buffer if we can. */
+static svn_error_t *
+receive_string(receive_context_t *ctx,
+               apr_uint64_t len64)
+{
+  svn_ra_svn_conn_t *conn = ctx->conn;
+  apr_size_t len = (apr_size_t)len64;
+  const char *data;
+
+  if (len64 > APR_SIZE_MAX)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("String length larger than maximum"));
+  if (!ctx->receiver->string)
+    return svn_error_trace(unexpected_item_error());
+
+  if (len <= (apr_size_t)(conn->read_end - conn->read_ptr))
+    {
+      data = conn->read_ptr;
+      conn->read_ptr += len;
+    }
+  else
+    {
+      apr_size_t remaining = len;
+
+      /* Same limits and allocation strategy as in read_string(). */
+      if (conn->max_in && (conn->max_in < len64))
+        return svn_error_create(SVN_ERR_RA_SVN_REQUEST_SIZE, NULL,
+                                "The client request size exceeds the "
+                                "configured limit");
+
+      if (ctx->buffer)
+        svn_stringbuf_setempty(ctx->buffer);
+      else
+        ctx->buffer = svn_stringbuf_create_empty(ctx->pool);
+
+      while (remaining)
+        {
+          apr_size_t chunk_len
+            = MIN(remaining, SUSPICIOUSLY_HUGE_STRING_SIZE_THRESHOLD);
+
+          svn_stringbuf_ensure(ctx->buffer, ctx->buffer->len + chunk_len);
+          SVN_ERR(readbuf_read(conn, ctx->pool,
+                               ctx->buffer->data + ctx->buffer->len,
+                               chunk_len));
+          ctx->buffer->len += chunk_len;
+          remaining -= chunk_len;
+        }
+
+      ctx->buffer->data[ctx->buffer->len] = '\0';
+      data = ctx->buffer->data;
+    }
+
+  return svn_error_trace(ctx->receiver->string(ctx->baton, data, len));
+}
+
+/* Read a word whose first character FIRST_CHAR has just been read from
+ * CTX->CONN, pass it on to the receiver and return the character
+ * following it in *NEXT_CHAR. */
+static svn_error_t *
+receive_word(receive_context_t *ctx,
+             char first_char,
+             char *next_char)
+{
+  svn_ra_svn_conn_t *conn = ctx->conn;
+  char buffer[MAX_WORD_LENGTH];
+  const char *word;
+  apr_size_t len;
+
+  if (!ctx->receiver->word)
+    return svn_error_trace(unexpected_item_error());
+
+  if (conn->read_ptr + MAX_WORD_LENGTH <= conn->read_end)
+    {
+      /* Fast path: FIRST_CHAR is still in the read buffer, right before
+       * READ_PTR, and so is the rest of the word. */
+      const char *start = conn->read_ptr - 1;
+      const char *end = start + MAX_WORD_LENGTH;
+      const char *p = conn->read_ptr;
+
+      while (p != end && (svn_ctype_isalnum(*p) || *p == '-'))
+        ++p;
+
+      if (p == end)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Word is too long"));
+
+      *next_char = *p;
+      conn->read_ptr = (char *)p + 1;
+      word = start;
+      len = p - start;
+    }
+  else
+    {
+      /* Slow path.  Byte-by-byte copying across buffer refills. */
+      char c;
+
+      buffer[0] = first_char;
+      for (len = 1; ; ++len)
+        {
+          SVN_ERR(readbuf_getchar(conn, ctx->pool, &c));
+          if (!svn_ctype_isalnum(c) && c != '-')
+            break;
+          if (len == MAX_WORD_LENGTH - 1)
+            return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                    _("Word is too long"));
+          buffer[len] = c;
+        }
+
+      *next_char = c;
+      word = buffer;
+    }
+
+  return svn_error_trace(ctx->receiver->word(ctx->baton, word, len));
+}
+
+/* Given the first non-whitespace character FIRST_CHAR, read an item from
+ * CTX->CONN and pass it on to CTX->RECEIVER.  LEVEL is the nesting level
+ * as in read_item(). */
+static svn_error_t *
+receive_item(receive_context_t *ctx,
+             char first_char,
+             int level)
+{
+  svn_ra_svn_conn_t *conn = ctx->conn;
+  char c = first_char;
+
+  if (++level >= ITEM_NESTING_LIMIT)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Items are nested too deeply"));
+
+  if (svn_ctype_isdigit(c))
+    {
+      /* It's a number or a string.  Read the number part, either way. */
+      apr_uint64_t val = c - '0';
+      while (1)
+        {
+          apr_uint64_t prev_val = val;
+          SVN_ERR(readbuf_getchar(conn, ctx->pool, &c));
+          if (!svn_ctype_isdigit(c))
+            break;
+          val = val * 10 + (c - '0');
+          /* val wrapped past maximum value? */
+          if ((prev_val >= (APR_UINT64_MAX / 10))
+              && (val < APR_UINT64_MAX - 10))
+            return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                    _("Number is larger than maximum"));
+        }
+      if (c == ':')
+        {
+          SVN_ERR(receive_string(ctx, val));
+          SVN_ERR(readbuf_getchar(conn, ctx->pool, &c));
+        }
+      else if (ctx->receiver->number)
+        SVN_ERR(ctx->receiver->number(ctx->baton, val));
+      else
+        return svn_error_trace(unexpected_item_error());
+    }
+  else if (svn_ctype_isalpha(c))
+    {
+      SVN_ERR(receive_word(ctx, c, &c));
+    }
+  else if (c == '(')
+    {
+      if (!ctx->receiver->start_list || !ctx->receiver->end_list)
+        return svn_error_trace(unexpected_item_error());
+
+      SVN_ERR(ctx->receiver->start_list(ctx->baton));
+      while (1)
+        {
+          SVN_ERR(readbuf_getchar_skip_whitespace(conn, ctx->pool, &c));
+          if (c == ')')
+            break;
+
+          SVN_ERR(receive_item(ctx, c, level));
+        }
+      SVN_ERR(ctx->receiver->end_list(ctx->baton));
+      SVN_ERR(readbuf_getchar(conn, ctx->pool, &c));
+    }
+
+  if (!svn_iswhitespace(c))
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Malformed network data"));
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__receive_item(svn_ra_svn_conn_t *conn,
+                         const svn_ra_svn__item_receiver_t *receiver,
+                         void *receiver_baton,
+                         apr_pool_t *scratch_pool)
+{
+  receive_context_t ctx;
+  char c;
+
+  ctx.conn = conn;
+  ctx.receiver = receiver;
+  ctx.baton = receiver_baton;
+  ctx.buffer = NULL;
+  ctx.pool = scratch_pool;
+
+  SVN_ERR(readbuf_getchar_skip_whitespace(conn, scratch_pool, &c));
+  return svn_error_trace(receive_item(&ctx, c, 0));
+}
+
 /* Drain existing whitespace from the receive buffer of CONN until either
    there is no data in the underlying receive socket anymore or we found
    a non-whitespace char.  Set *HAS_ITEM to TRUE in the latter case.
@@ -1903,6 +2575,134 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
   return svn_error_trace(err);
 }
 
+/* Return TRUE if the LEN bytes at DATA begin with a complete item,
+ * optionally preceded by whitespace.  This only tracks item boundaries
+ * and does not validate the syntax.  Malformed data counts as complete
+ * such that the actual parser will get to report it. */
+static svn_boolean_t
+has_complete_item(const char *data,
+                  apr_size_t len)
+{
+  const char *p = data;
+  const char *end = data + len;
+  int depth = 0;
+
+  while (p != end)
+    {
+      char c = *p;
+      if (svn_iswhitespace(c))
+        {
+          ++p;
+        }
+      else if (c == '(')
+        {
+          ++depth;
+          ++p;
+        }
+      else if (c == ')')
+        {
+          if (--depth <= 0)
+            return TRUE;
+          ++p;
+        }
+      else if (svn_ctype_isdigit(c))
+        {
+          apr_uint64_t value = 0;
+          for (; p != end && svn_ctype_isdigit(*p); ++p)
+            {
+              value = value * 10 + (*p - '0');
+              if (value > SVN_RA_SVN__READBUF_SIZE)
+                return TRUE;
+            }
+
+          if (p == end)
+            return FALSE;
+
+          /* Skip string contents. */
+          if (*p == ':')
+            {
+              ++p;
+              if (value > (apr_uint64_t)(end - p))
+                return FALSE;
+              p += value;
+            }
+
+          if (depth == 0)
+            return TRUE;
+        }
+      else if (svn_ctype_isalpha(c))
+        {
+          while (p != end && (svn_ctype_isalnum(*p) || *p == '-'))
+            ++p;
+
+          if (p == end)
+            return FALSE;
+          if (depth == 0)
+            return TRUE;
+        }
+      else
+        {
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+svn_error_t *
+svn_ra_svn__buffer_command(svn_boolean_t *complete,
+                           svn_boolean_t *terminated,
+                           svn_ra_svn_conn_t *conn,
+                           apr_pool_t *pool)
+{
+  apr_size_t len;
+  svn_error_t *err;
+
+  *complete = FALSE;
+  *terminated = FALSE;
+
+  /* Don't make whitespace between commands trigger I/O limitations. */
+  svn_ra_svn__reset_command_io_counters(conn);
+
+  if (conn->write_pos)
+    SVN_ERR(writebuf_flush(conn, pool));
+
+  /* Make room for more data behind what has not been processed, yet. */
+  if (conn->read_ptr != conn->read_buf)
+    {
+      len = conn->read_end - conn->read_ptr;
+      memmove(conn->read_buf, conn->read_ptr, len);
+      conn->read_ptr = conn->read_buf;
+      conn->read_end = conn->read_buf + len;
+    }
+
+  while (!has_complete_item(conn->read_ptr, conn->read_end - conn->read_ptr))
+    {
+      /* Commands larger than our buffer will have to be read by the
+       * command handler, i.e. may block. */
+      len = conn->read_buf + sizeof(conn->read_buf) - conn->read_end;
+      if (len == 0)
+        break;
+
+      err = readbuf_input_available(conn, conn->read_end, &len, pool);
+      if (err && err->apr_err == SVN_ERR_RA_SVN_CONNECTION_CLOSED)
+        {
+          svn_error_clear(err);
+          *terminated = TRUE;
+          return SVN_NO_ERROR;
+        }
+      SVN_ERR(err);
+
+      if (len == 0)
+        return SVN_NO_ERROR;
+
+      conn->read_end += len;
+    }
+
+  *complete = TRUE;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__handle_command(svn_boolean_t *terminate,
                            apr_hash_t *cmd_hash,
@@ -2463,7 +3263,8 @@ svn_ra_svn__write_cmd_update(svn_ra_svn_conn_t *conn,
                              svn_boolean_t recurse,
                              svn_depth_t depth,
                              svn_boolean_t send_copyfrom_args,
-                             svn_boolean_t ignore_ancestry)
+                             svn_boolean_t ignore_ancestry,
+                             svn_boolean_t text_deltas)
 {
   SVN_ERR(writebuf_write_literal(conn, pool, "( update ( "));
   SVN_ERR(write_tuple_start_list(conn, pool));
@@ -2474,6 +3275,7 @@ svn_ra_svn__write_cmd_update(svn_ra_svn_conn_t *conn,
   SVN_ERR(write_tuple_depth(conn, pool, depth));
   SVN_ERR(write_tuple_boolean(conn, pool, send_copyfrom_args));
   SVN_ERR(write_tuple_boolean(conn, pool, ignore_ancestry));
+  SVN_ERR(write_tuple_boolean(conn, pool, text_deltas));
   SVN_ERR(writebuf_write_literal(conn, pool, ") ) "));
 
   return SVN_NO_ERROR;
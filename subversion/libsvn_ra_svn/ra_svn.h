@@ -67,6 +67,44 @@ typedef svn_error_t *(*ra_svn_block_handler_t)(svn_ra_svn_conn_t *conn,
 #define SVN_RA_SVN__READBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 #define SVN_RA_SVN__WRITEBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 
+/* Maximum amount of uncompressed data per frame of a compressed stream. */
+#define SVN_RA_SVN__FRAME_SIZE 0x10000
+
+/* Codec IDs of compressed stream frames.  These are part of the protocol. */
+#define SVN_RA_SVN__CODEC_ZLIB 'z'
+#define SVN_RA_SVN__CODEC_LZ4  'l'
+
+/* Upper limit for the "svn-max-connections" setting. */
+#define SVN_RA_SVN__MAX_CONNECTIONS_LIMIT 16
+
+/* Per-connection state of the stream-level compression. */
+typedef struct svn_ra_svn__compression_t
+{
+  /* Outgoing data: the highest step on the compression ladder that we
+     may use, the one currently being used and the number of frames to
+     send uncompressed before probing compressibility again. */
+  int max_step;
+  int step;
+  int frames_until_probe;
+
+  /* Outgoing data: statistics since the last adaptation of STEP. */
+  int frames;
+  apr_uint64_t raw_bytes;
+  apr_uint64_t wire_bytes;
+  apr_interval_time_t compress_time;
+  apr_interval_time_t send_time;
+
+  /* Outgoing data: buffer to compress the current frame into. */
+  svn_stringbuf_t *encoded;
+
+  /* Incoming data: received but not yet decoded data, starting at
+     RAW_POS, and the decoded current frame, starting at DECODED_POS. */
+  svn_stringbuf_t *raw;
+  apr_size_t raw_pos;
+  svn_stringbuf_t *decoded;
+  apr_size_t decoded_pos;
+} svn_ra_svn__compression_t;
+
 /* Create forward reference */
 typedef struct svn_ra_svn__session_baton_t svn_ra_svn__session_baton_t;
 
@@ -115,6 +153,9 @@ struct svn_ra_svn_conn_st {
   int compression_level;
   apr_size_t zero_copy_limit;
 
+  /* stream-level compression; NULL if it has not been enabled */
+  svn_ra_svn__compression_t *compression;
+
   /* who's on the other side of the connection? */
   char *remote_ip;
 
@@ -160,6 +201,10 @@ struct svn_ra_svn__session_baton_t {
   apr_off_t bytes_read, bytes_written; /* apr_off_t's because that's what
                                           the callback interface uses */
   const char *useragent;
+
+  /* Maximum number of connections to use for an update, including
+   * CONN.  Values above 1 make us fetch file contents concurrently. */
+  int max_connections;
 };
 
 /* Set a callback for blocked writes on conn.  This handler may
@@ -235,10 +280,27 @@ svn_error_t *svn_ra_svn__read_command_only(svn_ra_svn_conn_t *conn,
                                            apr_pool_t *pool,
                                            const char **command);
 
+/* Return TRUE if STREAM writes directly to a socket, i.e. if it supports
+ * svn_ra_svn__stream_sendv. */
+svn_boolean_t svn_ra_svn__stream_is_socket(svn_ra_svn__stream_t *stream);
+
+/* Write the NVEC buffers in VEC to the socket of STREAM using a single
+ * scatter-gather write, returning the number of bytes written in *LEN.
+ */
+svn_error_t *svn_ra_svn__stream_sendv(svn_ra_svn__stream_t *stream,
+                                      const struct iovec *vec,
+                                      int nvec,
+                                      apr_size_t *len);
+
 /* Set the timeout for operations on STREAM to INTERVAL. */
 void svn_ra_svn__stream_timeout(svn_ra_svn__stream_t *stream,
                                 apr_interval_time_t interval);
 
+/* Set the timeout for reads from STREAM to INTERVAL.  This is a no-op
+ * unless STREAM is socket based. */
+void svn_ra_svn__stream_read_timeout(svn_ra_svn__stream_t *stream,
+                                     apr_interval_time_t interval);
+
 /* Return whether or not there is data pending on STREAM. */
 svn_error_t *
 svn_ra_svn__stream_data_available(svn_ra_svn__stream_t *stream,
@@ -268,6 +330,13 @@ svn_error_t *svn_ra_svn__auth_response(svn_ra_svn_conn_t *conn,
                                        apr_pool_t *pool,
                                        const char *mech, const char *mech_arg);
 
+/* Respond to an auth request read from SESS's connection, using the
+ * Cyrus SASL library if available and the built-in mechanisms otherwise. */
+svn_error_t *
+svn_ra_svn__do_auth(svn_ra_svn__session_baton_t *sess,
+                    const svn_ra_svn__list_t *mechlist,
+                    const char *realm, apr_pool_t *pool);
+
 /* Looks for MECH as a word in MECHLIST. */
 svn_boolean_t svn_ra_svn__find_mech(const svn_ra_svn__list_t *mechlist,
                                     const char *mech);
@@ -275,6 +344,59 @@ svn_boolean_t svn_ra_svn__find_mech(const svn_ra_svn__list_t *mechlist,
 /* Initialize the SASL library. */
 svn_error_t *svn_ra_svn__sasl_init(void);
 
+/* Read the string chunks of a file's contents, as sent in response to
+ * get-file, from CONN up to and including the terminating empty string.
+ * Write the data to STREAM and, if not NULL, update CHECKSUM_CTX with it.
+ * Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_ra_svn__read_file_contents(svn_ra_svn_conn_t *conn,
+                               svn_stream_t *stream,
+                               svn_checksum_ctx_t *checksum_ctx,
+                               apr_pool_t *scratch_pool);
+
+/* Open another session to URL in *NEW_SESS, using the same tunnel,
+ * configuration, callbacks and credentials as SESS.  Allocate it in
+ * RESULT_POOL and use SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_ra_svn__open_sibling(svn_ra_svn__session_baton_t **new_sess,
+                         svn_ra_svn__session_baton_t *sess,
+                         const char *url,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool);
+
+#if APR_HAS_THREADS
+/* Set *FETCH_EDITOR and *FETCH_BATON to an editor that forwards all calls
+ * to EDITOR and EDIT_BATON.  Files that come without contents, as sent by
+ * an "update" of TARGET with text deltas turned off, get fetched with
+ * "get-file" in REVISION or the target revision of the edit.  Up to
+ * SESS->MAX_CONNECTIONS - 1 additional connections are used for that,
+ * concurrently to the editor drive.  Their contents get delivered to
+ * EDITOR as they become available, at the latest before the edit gets
+ * closed.  Allocate the editor in POOL.  (fetch.c) */
+svn_error_t *
+svn_ra_svn__get_fetch_editor(const svn_delta_editor_t **fetch_editor,
+                             void **fetch_baton,
+                             svn_ra_svn__session_baton_t *sess,
+                             svn_revnum_t revision,
+                             const char *target,
+                             const svn_delta_editor_t *editor,
+                             void *edit_baton,
+                             apr_pool_t *pool);
+
+/* Set *REPORTER and *REPORT_BATON to a reporter that forwards all calls
+ * to WRAPPED_REPORTER and WRAPPED_BATON and tells the editor FETCH_BATON,
+ * created by svn_ra_svn__get_fetch_editor(), about switched subtrees, so
+ * that their files get fetched from the URLs they are linked to.
+ * Allocate the reporter in POOL.  (fetch.c) */
+svn_error_t *
+svn_ra_svn__get_fetch_reporter(const svn_ra_reporter3_t **reporter,
+                               void **report_baton,
+                               const svn_ra_reporter3_t *wrapped_reporter,
+                               void *wrapped_baton,
+                               void *fetch_baton,
+                               apr_pool_t *pool);
+#endif
+
 
 #ifdef __cplusplus
 }
@@ -37,17 +37,27 @@
 
 #include "ra_svn.h"
 
+typedef struct sock_baton_t {
+  apr_socket_t *sock;
+  apr_pool_t *pool;
+
+  /* Timeout for reads.  Negative values block indefinitely. */
+  apr_interval_time_t read_timeout;
+} sock_baton_t;
+
 struct svn_ra_svn__stream_st {
   svn_stream_t *in_stream;
   svn_stream_t *out_stream;
   void *timeout_baton;
   ra_svn_timeout_fn_t timeout_fn;
-};
 
-typedef struct sock_baton_t {
+  /* The socket that OUT_STREAM writes to.  NULL, unless it does so
+     directly, i.e. without any transformation of the data. */
   apr_socket_t *sock;
-  apr_pool_t *pool;
-} sock_baton_t;
+
+  /* Baton of the socket stream, if this is one.  NULL otherwise. */
+  sock_baton_t *sock_baton;
+};
 
 
 /* Returns TRUE if PFD has pending data, FALSE otherwise. */
@@ -109,13 +119,13 @@ sock_read_cb(void *baton, char *buffer, apr_size_t *len)
   if (status)
     return svn_error_wrap_apr(status, _("Can't get socket timeout"));
 
-  /* Always block on read.
+  /* Always block on read, unless a read timeout has been set.
    * During pipelining, we set the timeout to 0 for some write
    * operations so that we can try them without blocking. If APR had
    * separate timeouts for read and write, we would only set the
    * write timeout, but it doesn't. So here, we revert back to blocking.
    */
-  apr_socket_timeout_set(b->sock, -1);
+  apr_socket_timeout_set(b->sock, b->read_timeout);
   status = apr_socket_recv(b->sock, buffer, len);
   apr_socket_timeout_set(b->sock, interval);
 
@@ -167,9 +177,11 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
 {
   sock_baton_t *b = apr_palloc(result_pool, sizeof(*b));
   svn_stream_t *sock_stream;
+  svn_ra_svn__stream_t *stream;
 
   b->sock = sock;
   b->pool = svn_pool_create(result_pool);
+  b->read_timeout = -1;
 
   sock_stream = svn_stream_create(b, result_pool);
 
@@ -177,8 +189,12 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
   svn_stream_set_write(sock_stream, sock_write_cb);
   svn_stream_set_data_available(sock_stream, sock_pending_cb);
 
-  return svn_ra_svn__stream_create(sock_stream, sock_stream,
-                                   b, sock_timeout_cb, result_pool);
+  stream = svn_ra_svn__stream_create(sock_stream, sock_stream,
+                                     b, sock_timeout_cb, result_pool);
+  stream->sock = sock;
+  stream->sock_baton = b;
+
+  return stream;
 }
 
 svn_ra_svn__stream_t *
@@ -193,6 +209,8 @@ svn_ra_svn__stream_create(svn_stream_t *in_stream,
   s->out_stream = out_stream;
   s->timeout_baton = timeout_baton;
   s->timeout_fn = timeout_cb;
+  s->sock = NULL;
+  s->sock_baton = NULL;
   return s;
 }
 
@@ -215,6 +233,28 @@ svn_ra_svn__stream_read(svn_ra_svn__stream_t *stream, char *data,
   return SVN_NO_ERROR;
 }
 
+svn_boolean_t
+svn_ra_svn__stream_is_socket(svn_ra_svn__stream_t *stream)
+{
+  return stream->sock != NULL;
+}
+
+svn_error_t *
+svn_ra_svn__stream_sendv(svn_ra_svn__stream_t *stream,
+                         const struct iovec *vec,
+                         int nvec,
+                         apr_size_t *len)
+{
+  apr_status_t status;
+
+  SVN_ERR_ASSERT(stream->sock);
+  status = apr_socket_sendv(stream->sock, vec, nvec, len);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't write to connection"));
+
+  return SVN_NO_ERROR;
+}
+
 void
 svn_ra_svn__stream_timeout(svn_ra_svn__stream_t *stream,
                            apr_interval_time_t interval)
@@ -222,6 +262,14 @@ svn_ra_svn__stream_timeout(svn_ra_svn__stream_t *stream,
   stream->timeout_fn(stream->timeout_baton, interval);
 }
 
+void
+svn_ra_svn__stream_read_timeout(svn_ra_svn__stream_t *stream,
+                                apr_interval_time_t interval)
+{
+  if (stream->sock_baton)
+    stream->sock_baton->read_timeout = interval;
+}
+
 svn_error_t *
 svn_ra_svn__stream_data_available(svn_ra_svn__stream_t *stream,
                                   svn_boolean_t *data_available)
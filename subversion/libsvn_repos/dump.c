@@ -45,6 +45,8 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_jobs.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -2459,12 +2461,368 @@ report_error(svn_revnum_t revision,
     }
 }
 
+#if APR_HAS_THREADS
+
+/* Number of microseconds that an unused verification thread remains in
+ * the pool before being terminated.  Revisions are queued back-to-back,
+ * so this only needs to bridge short gaps. */
+#define THREADPOOL_THREAD_IDLE_LIMIT 1000000
+
+struct verify_jobs_baton_t;
+
+/* A single revision being verified by one of the worker threads. */
+typedef struct verify_job_t
+{
+  /* Private root pool of this job. */
+  apr_pool_t *pool;
+
+  /* The revision to verify. */
+  svn_revnum_t revision;
+
+  /* Notifications sent while verifying REVISION, in the order they were
+   * sent.  Elements are svn_repos_notify_t *, allocated in POOL. */
+  apr_array_header_t *notifications;
+
+  /* Warnings that the worker's filesystem object reported while
+   * verifying REVISION.  Elements are svn_error_t *.  They get cleared
+   * together with POOL. */
+  apr_array_header_t *warnings;
+
+  /* The context that this job belongs to. */
+  struct verify_jobs_baton_t *vb;
+} verify_job_t;
+
+/* A filesystem object for exclusive use by a single worker thread.
+ * Instances get re-used by later jobs. */
+typedef struct verify_fs_t
+{
+  /* Root pool owning this structure and FS. */
+  apr_pool_t *pool;
+
+  /* The filesystem object.  NULL until opened by the first job. */
+  svn_fs_t *fs;
+
+  /* The job currently using this object.  Receives the warnings. */
+  verify_job_t *job;
+
+  /* Next unused instance. */
+  struct verify_fs_t *next;
+} verify_fs_t;
+
+/* Context of a concurrent verification run. */
+typedef struct verify_jobs_baton_t
+{
+  /* Parameters to open the per-thread filesystem objects with. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
+
+  /* Parameters to pass to verify_one_revision(). */
+  svn_revnum_t start_rev;
+  svn_boolean_t check_normalization;
+  svn_boolean_t notify;
+
+  /* Revisions in verification order. */
+  svn_thread__jobs_t *jobs;
+
+  /* Filesystem objects not currently used by any job.
+   * Protected by the mutex of JOBS. */
+  verify_fs_t *idle_fs;
+} verify_jobs_baton_t;
+
+/* Implements svn_repos_notify_func_t.  Append a copy of NOTIFY to the
+ * notifications of the verify_job_t given by BATON. */
+static void
+buffer_verify_notification(void *baton,
+                           const svn_repos_notify_t *notify,
+                           apr_pool_t *scratch_pool)
+{
+  verify_job_t *job = baton;
+  svn_repos_notify_t *copy = apr_pmemdup(job->pool, notify, sizeof(*notify));
+
+  copy->warning_str = apr_pstrdup(job->pool, notify->warning_str);
+  copy->path = apr_pstrdup(job->pool, notify->path);
+
+  APR_ARRAY_PUSH(job->notifications, svn_repos_notify_t *) = copy;
+}
+
+/* Implements svn_fs_warning_callback_t.  Append a copy of ERR to the
+ * warnings of the job currently using the verify_fs_t given by BATON. */
+static void
+buffer_verify_warning(void *baton,
+                      svn_error_t *err)
+{
+  verify_fs_t *vfs = baton;
+
+  if (vfs->job)
+    APR_ARRAY_PUSH(vfs->job->warnings, svn_error_t *) = svn_error_dup(err);
+}
+
+/* Clear all svn_error_t * in the array DATA.  Implements
+ * apr_pool_cleanup_t for the warnings of a verify_job_t. */
+static apr_status_t
+clear_verify_warnings(void *data)
+{
+  apr_array_header_t *warnings = data;
+  int i;
+
+  for (i = 0; i < warnings->nelts; ++i)
+    svn_error_clear(APR_ARRAY_IDX(warnings, i, svn_error_t *));
+
+  return APR_SUCCESS;
+}
+
+/* Set *VFS_P to an unused filesystem object in VB, creating a new one
+ * if necessary.  The result may still need to be opened. */
+static svn_error_t *
+acquire_verify_fs(verify_fs_t **vfs_p,
+                  verify_jobs_baton_t *vb)
+{
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(vb->jobs);
+  verify_fs_t *vfs;
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  vfs = vb->idle_fs;
+  if (vfs)
+    vb->idle_fs = vfs->next;
+  SVN_ERR(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+
+  if (!vfs)
+    {
+      apr_pool_t *pool = svn_pool_create(NULL);
+      vfs = apr_pcalloc(pool, sizeof(*vfs));
+      vfs->pool = pool;
+    }
+
+  *vfs_p = vfs;
+  return SVN_NO_ERROR;
+}
+
+/* Return VFS to the unused filesystem objects in VB. */
+static svn_error_t *
+release_verify_fs(verify_jobs_baton_t *vb,
+                  verify_fs_t *vfs)
+{
+  svn_mutex__t *mutex = svn_thread__jobs_mutex(vb->jobs);
+
+  SVN_ERR(svn_mutex__lock(mutex));
+  vfs->next = vb->idle_fs;
+  vb->idle_fs = vfs;
+
+  return svn_error_trace(svn_mutex__unlock(mutex, SVN_NO_ERROR));
+}
+
+/* Implements svn_thread__job_func_t:  Verify the revision given by the
+ * verify_job_t BATON using a filesystem object of its own. */
+static svn_error_t *
+verify_job(void *baton,
+           apr_pool_t *pool)
+{
+  verify_job_t *job = baton;
+  verify_jobs_baton_t *vb = job->vb;
+  verify_fs_t *vfs;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_thread__jobs_cancel_func(vb->jobs));
+  SVN_ERR(acquire_verify_fs(&vfs, vb));
+
+  vfs->job = job;
+  if (!vfs->fs)
+    {
+      apr_hash_t *fs_config = vb->fs_config
+                            ? apr_hash_copy(vfs->pool, vb->fs_config)
+                            : NULL;
+      err = svn_fs_open2(&vfs->fs, vb->fs_path, fs_config, vfs->pool, pool);
+      if (err)
+        vfs->fs = NULL;
+      else
+        svn_fs_set_warning_func(vfs->fs, buffer_verify_warning, vfs);
+    }
+
+  if (!err)
+    err = verify_one_revision(vfs->fs, job->revision,
+                              vb->notify ? buffer_verify_notification : NULL,
+                              job, vb->start_rev, vb->check_normalization,
+                              svn_thread__jobs_cancel_func, vb->jobs, pool);
+
+  /* Let the next job use VFS. */
+  vfs->job = NULL;
+  return svn_error_compose_create(err, release_verify_fs(vb, vfs));
+}
+
+/* Wait for the oldest job in VB to finish and report its results just
+ * like the serial code in svn_repos_verify_fs4() would.  Forward warnings
+ * to FS.  Remove the job from VB.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+flush_oldest_verify_job(verify_jobs_baton_t *vb,
+                        svn_fs_t *fs,
+                        svn_repos_notify_func_t notify_func,
+                        void *notify_baton,
+                        svn_repos_notify_t *notify,
+                        svn_repos_verify_callback_t verify_callback,
+                        void *verify_baton,
+                        apr_pool_t *scratch_pool)
+{
+  verify_job_t *job;
+  svn_fs_warning_callback_t warning_func;
+  void *warning_baton;
+  svn_error_t *err;
+  int i;
+
+  SVN_ERR(svn_thread__jobs_pop((void **)&job, &err, vb->jobs, TRUE));
+
+  svn_fs__get_warning_func(&warning_func, &warning_baton, fs);
+  for (i = 0; i < job->warnings->nelts; ++i)
+    {
+      svn_error_t *warning = APR_ARRAY_IDX(job->warnings, i, svn_error_t *);
+      APR_ARRAY_IDX(job->warnings, i, svn_error_t *) = SVN_NO_ERROR;
+
+      warning_func(warning_baton, warning);
+      svn_error_clear(warning);
+    }
+
+  if (notify_func)
+    for (i = 0; i < job->notifications->nelts; ++i)
+      notify_func(notify_baton,
+                  APR_ARRAY_IDX(job->notifications, i, svn_repos_notify_t *),
+                  scratch_pool);
+
+  if (err && err->apr_err != SVN_ERR_CANCELLED)
+    {
+      err = report_error(job->revision, err, verify_callback, verify_baton,
+                         scratch_pool);
+    }
+  else if (!err && notify_func)
+    {
+      /* Tell the caller that we're done with this revision. */
+      notify->revision = job->revision;
+      notify_func(notify_baton, notify, scratch_pool);
+    }
+
+  svn_pool_destroy(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Queue all revisions from START_REV to END_REV in VB and report their
+ * results in order.  The other parameters are the same as for
+ * svn_repos_verify_fs4().  Use POOL for temporaries. */
+static svn_error_t *
+run_verify_jobs(verify_jobs_baton_t *vb,
+                svn_fs_t *fs,
+                svn_revnum_t start_rev,
+                svn_revnum_t end_rev,
+                svn_repos_notify_func_t notify_func,
+                void *notify_baton,
+                svn_repos_notify_t *notify,
+                svn_repos_verify_callback_t verify_callback,
+                void *verify_baton,
+                apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t rev;
+
+  for (rev = start_rev; rev <= end_rev; rev++)
+    {
+      verify_job_t *job;
+      apr_pool_t *job_pool;
+
+      svn_pool_clear(iterpool);
+
+      /* Limit the number of revisions in flight.  This also bounds the
+       * amount of memory used for buffered notifications. */
+      if (svn_thread__jobs_full(vb->jobs))
+        SVN_ERR(flush_oldest_verify_job(vb, fs, notify_func, notify_baton,
+                                        notify, verify_callback,
+                                        verify_baton, iterpool));
+
+      SVN_ERR(svn_thread__jobs_cancel_func(vb->jobs));
+
+      job_pool = svn_pool_create(NULL);
+      job = apr_pcalloc(job_pool, sizeof(*job));
+      job->pool = job_pool;
+      job->revision = rev;
+      job->notifications = apr_array_make(job_pool, 0,
+                                          sizeof(svn_repos_notify_t *));
+      job->warnings = apr_array_make(job_pool, 0, sizeof(svn_error_t *));
+      job->vb = vb;
+      apr_pool_cleanup_register(job_pool, job->warnings,
+                                clear_verify_warnings, apr_pool_cleanup_null);
+
+      SVN_ERR(svn_thread__jobs_push(vb->jobs, verify_job, job, job_pool));
+    }
+
+  while (svn_thread__jobs_count(vb->jobs))
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(flush_oldest_verify_job(vb, fs, notify_func, notify_baton,
+                                      notify, verify_callback, verify_baton,
+                                      iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify revisions START_REV to END_REV in FS using up to JOBS threads.
+ * The other parameters are the same as for svn_repos_verify_fs4().
+ * Use POOL for temporaries. */
+static svn_error_t *
+verify_revisions_concurrently(svn_fs_t *fs,
+                              svn_revnum_t start_rev,
+                              svn_revnum_t end_rev,
+                              svn_boolean_t check_normalization,
+                              int jobs,
+                              svn_repos_notify_func_t notify_func,
+                              void *notify_baton,
+                              svn_repos_notify_t *notify,
+                              svn_repos_verify_callback_t verify_callback,
+                              void *verify_baton,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *pool)
+{
+  verify_jobs_baton_t *vb = apr_pcalloc(pool, sizeof(*vb));
+  svn_error_t *err;
+
+  vb->fs_path = svn_fs_path(fs, pool);
+  vb->fs_config = svn_fs_config(fs, pool);
+  vb->start_rev = start_rev;
+  vb->check_normalization = check_normalization;
+  vb->notify = notify_func != NULL;
+
+  /* Allow for one queued revision per thread such that threads don't run
+   * idle while the main thread reports results. */
+  SVN_ERR(svn_thread__jobs_create(&vb->jobs, 2 * jobs, jobs,
+                                  THREADPOOL_THREAD_IDLE_LIMIT, TRUE,
+                                  cancel_func, cancel_baton, pool));
+
+  err = run_verify_jobs(vb, fs, start_rev, end_rev, notify_func,
+                        notify_baton, notify, verify_callback, verify_baton,
+                        pool);
+
+  /* Don't waste time on revisions whose results we won't report. */
+  svn_thread__jobs_close(vb->jobs);
+
+  while (vb->idle_fs)
+    {
+      verify_fs_t *vfs = vb->idle_fs;
+      vb->idle_fs = vfs->next;
+      svn_pool_destroy(vfs->pool);
+    }
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
 svn_error_t *
-svn_repos_verify_fs3(svn_repos_t *repos,
+svn_repos_verify_fs4(svn_repos_t *repos,
                      svn_revnum_t start_rev,
                      svn_revnum_t end_rev,
                      svn_boolean_t check_normalization,
                      svn_boolean_t metadata_only,
+                     int jobs,
                      svn_repos_notify_func_t notify_func,
                      void *notify_baton,
                      svn_repos_verify_callback_t verify_callback,
@@ -2477,7 +2835,7 @@ svn_repos_verify_fs3(svn_repos_t *repos,
   svn_revnum_t youngest;
   svn_revnum_t rev;
   apr_pool_t *iterpool = svn_pool_create(pool);
-  svn_repos_notify_t *notify;
+  svn_repos_notify_t *notify = NULL;
   svn_fs_progress_notify_func_t verify_notify = NULL;
   struct verify_fs_notify_func_baton_t *verify_notify_baton = NULL;
   svn_error_t *err;
@@ -2537,6 +2895,23 @@ svn_repos_verify_fs3(svn_repos_t *repos,
                            verify_baton, iterpool));
     }
 
+#if APR_HAS_THREADS
+  if (!metadata_only && jobs > 1 && start_rev < end_rev)
+    {
+      /* Don't spawn more threads than there are revisions. */
+      if (jobs > end_rev - start_rev + 1)
+        jobs = (int)(end_rev - start_rev + 1);
+
+      SVN_ERR(verify_revisions_concurrently(fs, start_rev, end_rev,
+                                            check_normalization, jobs,
+                                            notify_func, notify_baton,
+                                            notify,
+                                            verify_callback, verify_baton,
+                                            cancel_func, cancel_baton,
+                                            iterpool));
+    }
+  else
+#endif
   if (!metadata_only)
     for (rev = start_rev; rev <= end_rev; rev++)
       {
@@ -23,6 +23,8 @@
 
 #include <assert.h>
 #include <apr_md5.h>
+#include <apr_global_mutex.h>
+#include <apr_shm.h>
 #include <apr_thread_rwlock.h>
 
 #include "svn_pools.h"
@@ -146,6 +148,29 @@
 #  define USE_SIMPLE_MUTEX 0
 #endif
 
+/* Even with r/w locks, the hottest segments of a large server cache see
+ * heavy contention on the lock itself: every reader modifies the lock
+ * state.  Therefore, readers may look up and copy entries without taking
+ * the segment lock at all ("optimistic reads").  Writers still serialize
+ * through the lock but additionally bump a per-segment sequence counter
+ * before and after modifying the segment.  Readers sample that counter
+ * before and after their lookup and discard their results if it changed
+ * or was odd, i.e. a writer was active.  In that case, they simply retry
+ * under the read lock.  This is the classic seqlock scheme.
+ *
+ * For this to work, we need acquire semantics on the counter reads, which
+ * neither APR nor C90 provide.  Use the compiler's atomic built-ins where
+ * available and the plain read lock otherwise.  The debug tags require
+ * consistent data in all stages of the lookup, so don't use optimistic
+ * reads there either.
+ */
+#if APR_HAS_THREADS && defined(__ATOMIC_ACQUIRE) \
+    && !defined(SVN_DEBUG_CACHE_MEMBUFFER)
+#  define USE_OPTIMISTIC_READS 1
+#else
+#  define USE_OPTIMISTIC_READS 0
+#endif
+
 /* For more efficient copy operations, let's align all data items properly.
  * Since we can't portably align pointers, this is rather the item size
  * granularity which ensures *relative* alignment within the cache - still
@@ -172,6 +197,12 @@
  */
 #define MAX_SEGMENT_COUNT 0x10000
 
+/* Caches shared between processes don't get one lock per segment but
+ * map their segments onto this many inter-process locks.  Every such
+ * lock may need a lock file and a kernel object, so keep this small.
+ */
+#define SHARED_LOCK_COUNT 16
+
 /* As of today, APR won't allocate chunks of 4GB or more. So, limit the
  * segment size to slightly below that.
  */
@@ -813,6 +844,24 @@ struct svn_membuffer_t
   svn_boolean_t allow_blocking_writes;
 #endif
 
+  /* For caches shared between processes, this points to the process-
+   * local handle of the inter-process lock that guards this segment.
+   * LOCK will not be used in that case.  NULL for process-local caches.
+   */
+  apr_global_mutex_t **shared_lock;
+
+#if USE_OPTIMISTIC_READS
+  /* If set, readers don't acquire LOCK but validate their results against
+   * SEQUENCE instead.  Only used when LOCK or SHARED_LOCK is not NULL.
+   */
+  svn_boolean_t optimistic_reads;
+
+  /* Modification counter of this segment.  Odd while a writer is active.
+   * See USE_OPTIMISTIC_READS for details.
+   */
+  volatile svn_atomic_t sequence;
+#endif
+
   /* A write lock counter, must be either 0 or 1.
    * This one is only used in debug assertions to verify that you used
    * the correct multi-threading settings. */
@@ -823,11 +872,28 @@ struct svn_membuffer_t
  */
 #define ALIGN_VALUE(value) (((value) + ITEM_ALIGNMENT-1) & -ITEM_ALIGNMENT)
 
+/* Acquire the inter-process lock of the shared cache segment CACHE.
+ * Shared segments don't support r/w locks, so this is used for readers
+ * and writers alike.
+ */
+static svn_error_t *
+lock_shared_segment(svn_membuffer_t *cache)
+{
+  apr_status_t status = apr_global_mutex_lock(*cache->shared_lock);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
+
+  return SVN_NO_ERROR;
+}
+
 /* If locking is supported for CACHE, acquire a read lock for it.
  */
 static svn_error_t *
 read_lock_cache(svn_membuffer_t *cache)
 {
+  if (cache->shared_lock)
+    return lock_shared_segment(cache);
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -851,6 +917,9 @@ read_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 {
+  if (cache->shared_lock)
+    return lock_shared_segment(cache);
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -888,13 +957,18 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 static svn_error_t *
 force_write_lock_cache(svn_membuffer_t *cache)
 {
+  if (cache->shared_lock)
+    return lock_shared_segment(cache);
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
-  apr_status_t status = apr_thread_rwlock_wrlock(cache->lock);
-  if (status)
-    return svn_error_wrap_apr(status,
-                              _("Can't write-lock cache mutex"));
+  {
+    apr_status_t status = apr_thread_rwlock_wrlock(cache->lock);
+    if (status)
+      return svn_error_wrap_apr(status,
+                                _("Can't write-lock cache mutex"));
+  }
 
   return SVN_NO_ERROR;
 #else
@@ -908,6 +982,18 @@ force_write_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 {
+  if (cache->shared_lock)
+    {
+      apr_status_t status = apr_global_mutex_unlock(*cache->shared_lock);
+      if (err)
+        return err;
+
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't unlock cache mutex"));
+
+      return SVN_NO_ERROR;
+    }
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__unlock(cache->lock, err);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -927,6 +1013,32 @@ unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 #endif
 }
 
+/* Notify optimistic readers of CACHE that we are about to modify it.
+ * The caller must hold the write lock.  Must be paired with
+ * end_modification.
+ */
+static APR_INLINE void
+begin_modification(svn_membuffer_t *cache)
+{
+#if USE_OPTIMISTIC_READS
+  /* The atomic increment is a full memory barrier, i.e. readers will see
+   * the odd counter value before any of our changes. */
+  svn_atomic_inc(&cache->sequence);
+#endif
+}
+
+/* Notify optimistic readers of CACHE that all our modifications have been
+ * completed.  The caller must hold the write lock.  Return ERR.
+ */
+static APR_INLINE svn_error_t *
+end_modification(svn_membuffer_t *cache, svn_error_t *err)
+{
+#if USE_OPTIMISTIC_READS
+  svn_atomic_inc(&cache->sequence);
+#endif
+  return err;
+}
+
 /* If supported, guard the execution of EXPR with a read lock to CACHE.
  * The macro has been modeled after SVN_MUTEX__WITH_LOCK.
  */
@@ -959,7 +1071,9 @@ do {                                                            \
       else                                                      \
         break;                                                  \
     }                                                           \
-  SVN_ERR(unlock_cache(cache, (expr)));                         \
+  begin_modification(cache);                                    \
+  SVN_ERR(unlock_cache(cache,                                   \
+                       end_modification(cache, (expr))));       \
 } while (0)
 
 /* Returns 0 if the entry group identified by GROUP_INDEX in CACHE has not
@@ -1832,17 +1946,55 @@ ensure_data_insertable_l1(svn_membuffer_t *cache, apr_size_t size)
    * right answer. */
 }
 
-svn_error_t *
-svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
-                                  apr_size_t total_size,
-                                  apr_size_t directory_size,
-                                  apr_size_t segment_count,
-                                  svn_boolean_t thread_safe,
-                                  svn_boolean_t allow_blocking_writes,
-                                  apr_pool_t *pool)
+/* Return SIZE bytes of memory for cache buffers.  If *SHM_NEXT is not
+ * NULL, take them from the shared memory block starting at *SHM_NEXT and
+ * advance that pointer accordingly.  Otherwise, allocate them in POOL.
+ * Zero the memory if CLEAR is set.
+ */
+static void *
+cache_alloc(unsigned char **shm_next,
+            apr_size_t size,
+            svn_boolean_t clear,
+            apr_pool_t *pool)
+{
+  void *result;
+  if (*shm_next == NULL)
+    return clear ? apr_pcalloc(pool, size) : apr_palloc(pool, size);
+
+  result = *shm_next;
+  *shm_next += ALIGN_VALUE(size);
+  if (clear)
+    memset(result, 0, size);
+
+  return result;
+}
+
+/* Implement svn_cache__membuffer_cache_create and
+ * svn_cache__membuffer_cache_create_shared.  If SHARED is set, allocate
+ * all cache buffers in a new shared memory block named SHM_FILE and use
+ * inter-process locks based on LOCK_FILE instead of THREAD_SAFE and
+ * ALLOW_BLOCKING_WRITES.  Call LOCK_FUNC with LOCK_BATON for each of
+ * these locks unless LOCK_FUNC is NULL.
+ */
+static svn_error_t *
+membuffer_cache_create(svn_membuffer_t **cache,
+                       apr_size_t total_size,
+                       apr_size_t directory_size,
+                       apr_size_t segment_count,
+                       svn_boolean_t thread_safe,
+                       svn_boolean_t allow_blocking_writes,
+                       svn_boolean_t shared,
+                       const char *shm_file,
+                       const char *lock_file,
+                       svn_cache__shared_lock_func_t lock_func,
+                       void *lock_baton,
+                       apr_pool_t *pool)
 {
   svn_membuffer_t *c;
   prefix_pool_t *prefix_pool;
+  unsigned char *shm_next = NULL;
+  apr_global_mutex_t **shared_locks = NULL;
+  apr_uint32_t shared_lock_count = 0;
 
   apr_uint32_t seg;
   apr_uint32_t group_count;
@@ -1853,9 +2005,11 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   apr_uint64_t max_entry_size;
 
   /* Allocate 1% of the cache capacity to the prefix string pool.
+   * Prefix indexes are process-local, so don't use any for shared caches.
    */
-  SVN_ERR(prefix_pool_create(&prefix_pool, total_size / 100, thread_safe,
-                             pool));
+  SVN_ERR(prefix_pool_create(&prefix_pool,
+                             shared ? 0 : total_size / 100,
+                             thread_safe && !shared, pool));
   total_size -= total_size / 100;
 
   /* Limit the total size (only relevant if we can address > 4GB)
@@ -1910,9 +2064,6 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
          && segment_count < MAX_SEGMENT_COUNT)
     segment_count *= 2;
 
-  /* allocate cache as an array of segments / cache objects */
-  c = apr_palloc(pool, segment_count * sizeof(*c));
-
   /* Split total cache size into segments of equal size
    */
   total_size /= segment_count;
@@ -1963,6 +2114,60 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   assert(spare_group_count > 0 && main_group_count > 0);
 
   group_init_size = 1 + group_count / (8 * GROUP_INIT_GRANULARITY);
+
+  /* For shared caches, get one block of shared memory large enough for
+   * all segments and their buffers.  Everything else stays in POOL. */
+  if (shared)
+    {
+      apr_shm_t *shm;
+      apr_status_t status;
+      apr_size_t shm_size
+        = ALIGN_VALUE(segment_count * sizeof(*c))
+        + segment_count
+          * (  ALIGN_VALUE(group_count * sizeof(entry_group_t))
+             + ALIGN_VALUE(group_init_size)
+             + (apr_size_t)ALIGN_VALUE(data_size));
+
+      /* Reserve extra space to align the start of the block. */
+      status = apr_shm_create(&shm, shm_size + ITEM_ALIGNMENT, shm_file,
+                              pool);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't create shared memory cache"));
+
+      shm_next = apr_shm_baseaddr_get(shm);
+      shm_next += (ITEM_ALIGNMENT
+                   - (apr_uintptr_t)shm_next % ITEM_ALIGNMENT)
+                  % ITEM_ALIGNMENT;
+
+      /* Segments get mapped onto a small set of process-wide locks.
+       * Use the default mechanism because that is what e.g. Apache
+       * uses for its own inter-process locks. */
+      shared_lock_count = MIN((apr_uint32_t)segment_count,
+                              SHARED_LOCK_COUNT);
+      shared_locks = apr_pcalloc(pool,
+                                 shared_lock_count * sizeof(*shared_locks));
+      for (seg = 0; seg < shared_lock_count; ++seg)
+        {
+          const char *fname = lock_file
+                            ? apr_psprintf(pool, "%s.%u", lock_file,
+                                           (unsigned)seg)
+                            : NULL;
+
+          status = apr_global_mutex_create(&shared_locks[seg], fname,
+                                           APR_LOCK_DEFAULT, pool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create cache mutex"));
+
+          if (lock_func)
+            SVN_ERR(lock_func(shared_locks[seg], lock_baton, pool));
+        }
+    }
+
+  /* allocate cache as an array of segments / cache objects */
+  c = cache_alloc(&shm_next, segment_count * sizeof(*c), FALSE, pool);
+
   for (seg = 0; seg < segment_count; ++seg)
     {
       /* allocate buffers and initialize cache members
@@ -1978,12 +2183,14 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       /* Allocate but don't clear / zero the directory because it would add
          significantly to the server start-up time if the caches are large.
          Group initialization will take care of that in stead. */
-      c[seg].directory = apr_palloc(pool,
-                                    group_count * sizeof(entry_group_t));
+      c[seg].directory = cache_alloc(&shm_next,
+                                     group_count * sizeof(entry_group_t),
+                                     FALSE, pool);
 
       /* Allocate and initialize directory entries as "not initialized",
          hence "unused" */
-      c[seg].group_initialized = apr_pcalloc(pool, group_init_size);
+      c[seg].group_initialized = cache_alloc(&shm_next, group_init_size,
+                                             TRUE, pool);
 
       /* Allocate 1/4th of the data buffer to L1
        */
@@ -2004,7 +2211,9 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].l2.current_data = c[seg].l2.start_offset;
 
       /* This cast is safe because DATA_SIZE <= MAX_SEGMENT_SIZE. */
-      c[seg].data = apr_palloc(pool, (apr_size_t)ALIGN_VALUE(data_size));
+      c[seg].data = cache_alloc(&shm_next,
+                                (apr_size_t)ALIGN_VALUE(data_size),
+                                FALSE, pool);
       c[seg].data_used = 0;
       c[seg].max_entry_size = max_entry_size;
 
@@ -2044,6 +2253,20 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
        */
       c[seg].allow_blocking_writes = allow_blocking_writes;
 #endif
+
+      /* Shared caches use process-wide locks instead of LOCK.
+       * Segment SEG uses the same lock as SEG + SHARED_LOCK_COUNT etc. */
+      c[seg].shared_lock = shared
+                         ? &shared_locks[seg % shared_lock_count]
+                         : NULL;
+
+#if USE_OPTIMISTIC_READS
+      /* Without a lock, there are no concurrent writers to detect. */
+      c[seg].optimistic_reads = c[seg].lock != NULL
+                             || c[seg].shared_lock != NULL;
+      c[seg].sequence = 0;
+#endif
+
       /* No writers at the moment. */
       c[seg].write_lock_count = 0;
     }
@@ -2054,6 +2277,73 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
+                                  apr_size_t total_size,
+                                  apr_size_t directory_size,
+                                  apr_size_t segment_count,
+                                  svn_boolean_t thread_safe,
+                                  svn_boolean_t allow_blocking_writes,
+                                  apr_pool_t *pool)
+{
+  return svn_error_trace(membuffer_cache_create(cache, total_size,
+                                                directory_size,
+                                                segment_count,
+                                                thread_safe,
+                                                allow_blocking_writes,
+                                                FALSE, NULL, NULL, NULL,
+                                                NULL, pool));
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         const char *shm_file,
+                                         const char *lock_file,
+                                         svn_cache__shared_lock_func_t lock_func,
+                                         void *lock_baton,
+                                         apr_pool_t *result_pool)
+{
+  return svn_error_trace(membuffer_cache_create(cache, total_size,
+                                                directory_size,
+                                                segment_count,
+                                                FALSE, TRUE, TRUE,
+                                                shm_file, lock_file,
+                                                lock_func, lock_baton,
+                                                result_pool));
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_child_init(svn_membuffer_t *cache,
+                                      apr_pool_t *pool)
+{
+  apr_uint32_t seg;
+  apr_uint32_t lock_count;
+
+  /* Process-local caches don't need any re-initialization. */
+  if (cache->shared_lock == NULL)
+    return SVN_NO_ERROR;
+
+  /* The SHARED_LOCK handles live in process-private memory, so this
+   * does not affect other processes.  The first segments cover all
+   * locks, see membuffer_cache_create(). */
+  lock_count = MIN(cache->segment_count, SHARED_LOCK_COUNT);
+  for (seg = 0; seg < lock_count; ++seg)
+    {
+      apr_global_mutex_t **lock = cache[seg].shared_lock;
+      apr_status_t status
+        = apr_global_mutex_child_init(lock, apr_global_mutex_lockfile(*lock),
+                                      pool);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't re-open cache mutex"));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_cache__membuffer_clear(svn_membuffer_t *cache)
 {
@@ -2078,6 +2368,7 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
     {
       /* Unconditionally acquire the write lock. */
       SVN_ERR(force_write_lock_cache(&cache[seg]));
+      begin_modification(&cache[seg]);
 
       /* Mark all groups as "not initialized", which implies "empty". */
       cache[seg].first_spare_group = NO_INDEX;
@@ -2102,7 +2393,8 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
       cache[seg].used_entries = 0;
 
       /* Segment may be used again. */
-      SVN_ERR(unlock_cache(&cache[seg], SVN_NO_ERROR));
+      SVN_ERR(unlock_cache(&cache[seg], end_modification(&cache[seg],
+                                                         SVN_NO_ERROR)));
     }
 
   /* done here */
@@ -2364,7 +2656,14 @@ increment_hit_counters(svn_membuffer_t *cache, entry_t *entry)
    * hit counters to 32 bits.  These may overflow but we don't really
    * care because at worst, ENTRY will be dropped from cache once every
    * few billion hits. */
+#if USE_OPTIMISTIC_READS
+  /* Lock-free readers may race with writers here.  The counter is only
+   * a heuristic for the eviction strategy, so we don't need any ordering
+   * guarantees and may even lose the odd update. */
+  __atomic_fetch_add(&entry->hit_count, 1, __ATOMIC_RELAXED);
+#else
   svn_atomic_inc(&entry->hit_count);
+#endif
 
   /* That one is for stats only. */
   cache->total_hits++;
@@ -2433,6 +2732,157 @@ membuffer_cache_get_internal(svn_membuffer_t *cache,
   return SVN_NO_ERROR;
 }
 
+#if USE_OPTIMISTIC_READS
+
+/* Return the current value of the modification counter of CACHE.
+ * All reads from CACHE following this call will see data at least
+ * as recent as of that counter value.
+ */
+static APR_INLINE apr_uint32_t
+read_sequence(svn_membuffer_t *cache)
+{
+  return __atomic_load_n(&cache->sequence, __ATOMIC_ACQUIRE);
+}
+
+/* Return TRUE if CACHE has not been modified since read_sequence()
+ * returned SEQUENCE, i.e. all data read from CACHE in between has been
+ * consistent.
+ */
+static APR_INLINE svn_boolean_t
+sequence_unchanged(svn_membuffer_t *cache, apr_uint32_t sequence)
+{
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&cache->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+/* Lock-free variant of find_entry() with FIND_EMPTY set to FALSE.
+ *
+ * Writers may modify CACHE while we are reading from it.  Therefore, we
+ * snapshot the entry's OFFSET and SIZE upon return and range-check every
+ * index and offset that we follow, such that inconsistent data can never
+ * make us access memory outside the CACHE.  The result is only valid if
+ * the caller verifies it using sequence_unchanged().
+ */
+static entry_t *
+find_entry_optimistic(svn_membuffer_t *cache,
+                      apr_uint32_t group_index,
+                      const full_key_t *to_find,
+                      apr_uint64_t *offset,
+                      apr_size_t *size)
+{
+  apr_uint32_t group_limit = cache->group_count + cache->spare_group_count;
+  apr_uint64_t data_size = cache->l2.start_offset + cache->l2.size;
+  apr_size_t key_len = to_find->entry_key.key_len;
+  entry_group_t *group = &cache->directory[group_index];
+  int chain_length;
+
+  /* If the entry group has not been initialized, yet, there is no data.
+   */
+  if (! is_group_initialized(cache, group_index))
+    return NULL;
+
+  for (chain_length = 0;
+       chain_length < MAX_GROUP_CHAIN_LENGTH;
+       ++chain_length)
+    {
+      apr_uint32_t used = group->header.used;
+      apr_uint32_t next = group->header.next;
+      apr_uint32_t i;
+
+      for (i = 0; i < used && i < GROUP_SIZE; ++i)
+        if (entry_keys_match(&group->entries[i].key, &to_find->entry_key))
+          {
+            entry_t *entry = &group->entries[i];
+            *offset = entry->offset;
+            *size = entry->size;
+
+            /* Torn data?  Then the sequence check will fail anyway. */
+            if (   *offset > data_size
+                || ALIGN_VALUE(*size) > data_size - *offset
+                || key_len > *size)
+              return NULL;
+
+            /* Same logic as in find_entry(). */
+            if (!key_len)
+              return entry;
+
+            if (memcmp(to_find->full_key.data, cache->data + *offset,
+                       key_len) == 0)
+              return entry;
+
+            return NULL;
+          }
+
+      /* end of chain? */
+      if (next == NO_INDEX || next >= group_limit)
+        break;
+
+      group = &cache->directory[next];
+    }
+
+  return NULL;
+}
+
+/* Try to look for the cache entry in group GROUP_INDEX of CACHE, identified
+ * by the hash value TO_FIND without acquiring the segment lock.  Set *FOUND
+ * to indicate whether it exists.  If BUFFER is not NULL, return a copy of
+ * the serialized data in *BUFFER, allocated in RESULT_POOL, and its size
+ * in *ITEM_SIZE as membuffer_cache_get_internal() does.
+ *
+ * Return FALSE, if a concurrent modification of CACHE has been detected.
+ * The outputs will be undefined in that case and the caller should repeat
+ * the lookup under the read lock.
+ */
+static svn_boolean_t
+optimistic_cache_get(svn_membuffer_t *cache,
+                     apr_uint32_t group_index,
+                     const full_key_t *to_find,
+                     svn_boolean_t *found,
+                     char **buffer,
+                     apr_size_t *item_size,
+                     apr_pool_t *result_pool)
+{
+  apr_uint32_t sequence = read_sequence(cache);
+  apr_size_t key_len = to_find->entry_key.key_len;
+  apr_uint64_t offset = 0;
+  apr_size_t size = 0;
+  char *data = NULL;
+  entry_t *entry;
+
+  /* Writer active? */
+  if (sequence & 1)
+    return FALSE;
+
+  entry = find_entry_optimistic(cache, group_index, to_find, &offset, &size);
+  if (entry && buffer)
+    {
+      apr_size_t data_len = ALIGN_VALUE(size) - key_len;
+      data = apr_palloc(result_pool, data_len);
+      memcpy(data, cache->data + offset + key_len, data_len);
+    }
+
+  if (!sequence_unchanged(cache, sequence))
+    return FALSE;
+
+  /* The data is consistent.  Update the hit statistics.  The counters
+   * are heuristics only, so it does not matter if a writer replaced ENTRY
+   * in the meantime. */
+  cache->total_reads++;
+  if (entry)
+    increment_hit_counters(cache, entry);
+
+  *found = entry != NULL;
+  if (buffer)
+    {
+      *buffer = data;
+      *item_size = entry ? size - key_len : 0;
+    }
+
+  return TRUE;
+}
+
+#endif /* USE_OPTIMISTIC_READS */
+
 /* Look for the *ITEM identified by KEY. If no item has been stored
  * for KEY, *ITEM will be NULL. Otherwise, the DESERIALIZER is called
  * to re-construct the proper object from the serialized data.
@@ -2453,6 +2903,22 @@ membuffer_cache_get(svn_membuffer_t *cache,
   /* find the entry group that will hold the key.
    */
   group_index = get_group_index(&cache, &key->entry_key);
+
+#if USE_OPTIMISTIC_READS
+  {
+    svn_boolean_t found;
+    if (!cache->optimistic_reads
+        || !optimistic_cache_get(cache, group_index, key, &found,
+                                 &buffer, &size, result_pool))
+      WITH_READ_LOCK(cache,
+                     membuffer_cache_get_internal(cache,
+                                                  group_index,
+                                                  key,
+                                                  &buffer,
+                                                  &size,
+                                                  result_pool));
+  }
+#else
   WITH_READ_LOCK(cache,
                  membuffer_cache_get_internal(cache,
                                               group_index,
@@ -2461,6 +2927,7 @@ membuffer_cache_get(svn_membuffer_t *cache,
                                               &size,
                                               DEBUG_CACHE_MEMBUFFER_TAG
                                               result_pool));
+#endif
 
   /* re-construct the original data object from its serialized form.
    */
@@ -2515,6 +2982,14 @@ membuffer_cache_has_key(svn_membuffer_t *cache,
   /* find the entry group that will hold the key.
    */
   apr_uint32_t group_index = get_group_index(&cache, &key->entry_key);
+
+#if USE_OPTIMISTIC_READS
+  if (cache->optimistic_reads
+      && optimistic_cache_get(cache, group_index, key, found, NULL, NULL,
+                              NULL))
+    return SVN_NO_ERROR;
+#endif
+
   cache->total_reads++;
 
   WITH_READ_LOCK(cache,
@@ -0,0 +1,900 @@
+/*
+ * cache-persistent.c: persistent, file-backed cache tier
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_atomic.h>
+#include <apr_md5.h>
+#include <apr_mmap.h>
+
+#include "svn_pools.h"
+#include "svn_io.h"
+#include "svn_checksum.h"
+#include "svn_sorts.h"
+#include "svn_dirent_uri.h"
+
+#include "svn_private_config.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
+#include "private/svn_mutex.h"
+#include "private/svn_subr_private.h"
+
+#include "cache.h"
+
+/*
+ * The persistent store is a single, memory-mapped file of fixed size that
+ * gets shared by all processes using it.  It consists of three parts:
+ *
+ * - A header page describing the store layout and its "guard" string.
+ *   If the header does not match what the opener expects, the store gets
+ *   reset, i.e. all contents gets discarded.  That takes care of format
+ *   and configuration changes as well as of replaced repositories.
+ *
+ * - A direct-mapped hash index that maps the hash of an entry's full key
+ *   to the first block of that entry in the data area.  Hash collisions
+ *   simply replace older entries.
+ *
+ * - The data area, a ring buffer of BLOCK_SIZE blocks.  New entries get
+ *   appended at the current insertion position, overwriting the oldest
+ *   data, i.e. this is a strict FIFO.  Writers reserve space by atomically
+ *   advancing that position.
+ *
+ * There is no locking: concurrent writers may overwrite data that other
+ * processes are just reading and index entries may point to overwritten
+ * data.  Therefore, each entry in the data area carries its full key and
+ * a checksum over key and contents.  Readers first copy an entry and then
+ * verify the copy.  Any mismatch is simply treated as a cache miss.
+ *
+ * All numbers are stored in native byte order.  The byte order is part
+ * of the header such that a store will be reset when being accessed from
+ * a different platform.
+ *
+ * The file gets fully allocated before being mapped.  A sparse file would
+ * make us crash with SIGBUS as soon as the disk fills up.
+ *
+ * Processes that may not write to the file can still use an existing,
+ * matching store.  They get a read-only mapping and never write to it.
+ */
+
+/* Version number of the store layout.  Bump when changing the layout.
+ */
+#define STORE_FORMAT 3
+
+/* Size of the header page in bytes.
+ */
+#define HEADER_SIZE 4096
+
+/* Allocation granularity within the data area.
+ */
+#define BLOCK_SIZE 64
+
+/* Assumed average number of blocks per entry.  Used to size the index.
+ */
+#define BLOCKS_PER_ENTRY 8
+
+/* Layout of the header page.
+ */
+typedef struct store_header_t
+{
+  /* NUL-terminated text describing the store layout and guard string. */
+  char description[HEADER_SIZE - 2 * sizeof(apr_uint32_t)];
+
+  /* Number of the block in the data area at which the next entry will be
+   * written, modulo the total block count.  Updated atomically. */
+  volatile apr_uint32_t next_block;
+
+  /* Unused.  Keeps the header size a multiple of 8. */
+  apr_uint32_t reserved;
+} store_header_t;
+
+/* A hash index entry.
+ */
+typedef struct index_entry_t
+{
+  /* Hash value of the full key.  0 for unused entries. */
+  apr_uint32_t key_hash;
+
+  /* First block of the entry in the data area. */
+  apr_uint32_t first_block;
+} index_entry_t;
+
+/* Header of each entry in the data area.  The full key and the
+ * serialized data follow directly after it.
+ */
+typedef struct entry_header_t
+{
+  /* MD5 digest over everything following this member, up to the end of
+   * the data. */
+  unsigned char checksum[APR_MD5_DIGESTSIZE];
+
+  /* Length of the full key in bytes. */
+  apr_uint32_t key_len;
+
+  /* Length of the serialized data in bytes. */
+  apr_uint32_t data_len;
+
+  /* Hash value of the full key, same as in the index. */
+  apr_uint32_t key_hash;
+
+  /* Unused.  Keeps the header size a multiple of 8. */
+  apr_uint32_t reserved;
+} entry_header_t;
+
+struct svn_cache__persistent_t
+{
+  /* The file mapping.  Never unmapped. */
+  apr_mmap_t *mmap;
+
+  /* Pointers into the mapped file. */
+  store_header_t *header;
+  index_entry_t *index;
+  unsigned char *data;
+
+  /* Number of entries in INDEX. */
+  apr_uint32_t bucket_count;
+
+  /* Number of blocks in DATA. */
+  apr_uint32_t block_count;
+
+  /* Largest entry that we will store, including its header. */
+  apr_size_t max_entry_size;
+
+  /* If set, the mapping is read-only and we must never write to it. */
+  svn_boolean_t read_only;
+
+  /* The description that we expect in the header, including the guard
+   * string.  Entry checksums cover it as well, so entries written by
+   * users with a different guard will never be accepted. */
+  const char *description;
+};
+
+/* All stores opened by this process, mapping "path:size:guard" to the
+ * svn_cache__persistent_t.  Stores live as long as the process.
+ * Access is serialized by STORES_MUTEX.
+ */
+static apr_hash_t *stores = NULL;
+static svn_mutex__t *stores_mutex = NULL;
+static volatile svn_atomic_t stores_initialized = 0;
+
+/* Implements svn_atomic__init_func_t.  Initialize the STORES registry.
+ */
+static svn_error_t *
+init_stores(void *baton, apr_pool_t *unused_pool)
+{
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  SVN_ERR(svn_mutex__init(&stores_mutex, TRUE, pool));
+  stores = apr_hash_make(pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the hash value to use for the FULL_KEY of FULL_KEY_LEN bytes.
+ * Never returns 0.
+ */
+static apr_uint32_t
+hash_key(const char *full_key,
+         apr_size_t full_key_len)
+{
+  apr_uint32_t hash = svn__fnv1a_32x4(full_key, full_key_len);
+  return hash ? hash : 1;
+}
+
+/* Return the checksum of ENTRY, which is TOTAL_LEN bytes long, in STORE.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static const svn_checksum_t *
+entry_checksum(const svn_cache__persistent_t *store,
+               const entry_header_t *entry,
+               apr_size_t total_len,
+               apr_pool_t *scratch_pool)
+{
+  svn_checksum_ctx_t *ctx = svn_checksum_ctx_create(svn_checksum_md5,
+                                                    scratch_pool);
+  svn_checksum_t *checksum;
+  svn_error_t *err;
+
+  /* Another process may reset the store for a different guard at any
+   * time, while we keep using our mapping.  Make sure that we won't
+   * accept each other's entries. */
+  err = svn_checksum_update(ctx, store->description,
+                            strlen(store->description));
+  if (!err)
+    err = svn_checksum_update(ctx,
+                              (const char *)entry + sizeof(entry->checksum),
+                              total_len - sizeof(entry->checksum));
+  if (!err)
+    err = svn_checksum_final(&checksum, ctx, scratch_pool);
+
+  /* MD5 calculation cannot fail. */
+  SVN_ERR_ASSERT_NO_RETURN(err == SVN_NO_ERROR);
+  return checksum;
+}
+
+/* Extend FILE, currently FILE_SIZE bytes long, to SIZE bytes by writing
+ * zeros to it such that all disk space gets allocated up-front.  On
+ * failure, restore the original FILE_SIZE.  PATH is the path to FILE and
+ * used for error messages only.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+preallocate_file(apr_file_t *file,
+                 const char *path,
+                 apr_off_t file_size,
+                 apr_off_t size,
+                 apr_pool_t *scratch_pool)
+{
+  apr_size_t buffer_size = SVN__STREAM_CHUNK_SIZE;
+  char *buffer = apr_pcalloc(scratch_pool, buffer_size);
+  apr_off_t offset = file_size;
+  svn_error_t *err;
+
+  err = svn_io_file_seek(file, APR_SET, &offset, scratch_pool);
+  while (!err && offset < size)
+    {
+      apr_size_t to_write = (apr_size_t)MIN(size - offset,
+                                            (apr_off_t)buffer_size);
+      err = svn_io_file_write_full(file, buffer, to_write, NULL,
+                                   scratch_pool);
+      offset += to_write;
+    }
+
+  if (!err)
+    err = svn_io_file_flush(file, scratch_pool);
+
+  if (err)
+    {
+      err = svn_error_compose_create(err,
+                                     svn_io_file_trunc(file, file_size,
+                                                       scratch_pool));
+      return svn_error_quick_wrapf(err,
+                                   _("Can't allocate persistent cache '%s'"),
+                                   svn_dirent_local_style(path,
+                                                          scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_cache__persistent_open.  Must be called with STORES_MUTEX
+ * being held.
+ */
+static svn_error_t *
+persistent_open(svn_cache__persistent_t **store_p,
+                const char *path,
+                apr_uint64_t size,
+                const char *guard,
+                apr_pool_t *scratch_pool)
+{
+  svn_cache__persistent_t *store;
+  const char *key;
+  const char *description;
+  apr_pool_t *pool;
+  apr_file_t *file;
+  svn_filesize_t file_size;
+  apr_uint64_t available;
+  apr_size_t index_size;
+  apr_size_t map_size;
+  apr_status_t status;
+  svn_error_t *err;
+
+  key = apr_psprintf(scratch_pool, "%s:%" APR_UINT64_T_FMT ":%s",
+                     path, size, guard);
+  store = apr_hash_get(stores, key, APR_HASH_KEY_STRING);
+  if (store)
+    {
+      *store_p = store;
+      return SVN_NO_ERROR;
+    }
+
+  /* Limit the mapping to what we can reasonably address. */
+  size = MIN(size, (apr_uint64_t)APR_SIZE_MAX / 4);
+  if (size < HEADER_SIZE + 16 * BLOCKS_PER_ENTRY * BLOCK_SIZE)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Persistent cache size %s is too small"),
+                             apr_psprintf(scratch_pool, "%" APR_UINT64_T_FMT,
+                                          size));
+
+  /* Determine the layout. */
+  available = size - HEADER_SIZE;
+  store = apr_pcalloc(apr_hash_pool_get(stores), sizeof(*store));
+  store->bucket_count
+    = (apr_uint32_t)MIN(available / (BLOCKS_PER_ENTRY * BLOCK_SIZE
+                                     + sizeof(index_entry_t)),
+                        APR_UINT32_MAX / BLOCKS_PER_ENTRY);
+  index_size = store->bucket_count * sizeof(index_entry_t);
+  index_size = (index_size + BLOCK_SIZE - 1) & ~(apr_size_t)(BLOCK_SIZE - 1);
+  store->block_count = (apr_uint32_t)((available - index_size) / BLOCK_SIZE);
+  store->max_entry_size = MIN((apr_size_t)store->block_count / 16,
+                              APR_UINT32_MAX / BLOCK_SIZE) * BLOCK_SIZE;
+  map_size = HEADER_SIZE + index_size
+           + (apr_size_t)store->block_count * BLOCK_SIZE;
+
+  description = apr_psprintf(scratch_pool,
+                             "SVN persistent cache\n"
+                             "format %d\n"
+                             "byte order %s\n"
+                             "buckets %u\n"
+                             "blocks %u\n"
+                             "guard %s\n",
+                             STORE_FORMAT,
+                             APR_IS_BIGENDIAN ? "big" : "little",
+                             store->bucket_count, store->block_count,
+                             guard);
+  if (strlen(description) >= sizeof(store->header->description))
+    return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                            _("Persistent cache guard string too long"));
+
+  /* The mapping must live as long as the process.
+   * If we can't write to the store, we may still read an existing one. */
+  pool = svn_pool_create(NULL);
+  err = svn_io_file_open(&file, path,
+                         APR_READ | APR_WRITE | APR_CREATE | APR_BINARY,
+                         APR_OS_DEFAULT, pool);
+  if (err && APR_STATUS_IS_EACCES(err->apr_err))
+    {
+      svn_error_clear(err);
+      store->read_only = TRUE;
+      err = svn_io_file_open(&file, path, APR_READ | APR_BINARY,
+                             APR_OS_DEFAULT, pool);
+    }
+
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  /* Serialize initialization with other processes.  Read-only users
+   * only need to make sure that nobody is initializing the store. */
+  err = svn_io_lock_open_file(file, !store->read_only, FALSE, pool);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  /* Never shrink the file.  Other processes may still have a larger
+   * mapping and would crash upon accessing pages past EOF. */
+  err = svn_io_file_size_get(&file_size, file, pool);
+  if (!err && file_size < map_size)
+    {
+      if (store->read_only)
+        err = svn_error_createf(SVN_ERR_BAD_FILENAME, NULL,
+                                _("Persistent cache '%s' is not usable"),
+                                svn_dirent_local_style(path, pool));
+      else
+        err = preallocate_file(file, path, file_size, map_size, pool);
+    }
+
+  if (!err)
+    {
+      status = apr_mmap_create(&store->mmap, file, 0, map_size,
+                               store->read_only
+                                 ? APR_MMAP_READ
+                                 : APR_MMAP_READ | APR_MMAP_WRITE,
+                               pool);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't map '%s'"),
+                                 svn_dirent_local_style(path, pool));
+    }
+
+  if (!err)
+    {
+      store->header = store->mmap->mm;
+      store->index = (index_entry_t *)((char *)store->mmap->mm
+                                       + HEADER_SIZE);
+      store->data = (unsigned char *)store->mmap->mm
+                  + HEADER_SIZE + index_size;
+
+      /* Reset the store if it is new or has been used differently.
+       * Read-only users can't do that and must not use the store. */
+      if (   store->read_only
+          && strcmp(store->header->description, description))
+        {
+          err = svn_error_createf(SVN_ERR_BAD_FILENAME, NULL,
+                                  _("Persistent cache '%s' is not usable"),
+                                  svn_dirent_local_style(path, pool));
+        }
+      else if (strcmp(store->header->description, description))
+        {
+          memset(store->index, 0, index_size);
+          store->header->next_block = 0;
+          memset(store->header->description, 0,
+                 sizeof(store->header->description));
+          strcpy(store->header->description, description);
+        }
+    }
+
+  err = svn_error_compose_create(err, svn_io_unlock_open_file(file, pool));
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  store->description = apr_pstrdup(apr_hash_pool_get(stores), description);
+  key = apr_pstrdup(apr_hash_pool_get(stores), key);
+  apr_hash_set(stores, key, APR_HASH_KEY_STRING, store);
+
+  *store_p = store;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__persistent_open(svn_cache__persistent_t **store,
+                           const char *path,
+                           apr_uint64_t size,
+                           const char *guard,
+                           apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_atomic__init_once(&stores_initialized, init_stores, NULL,
+                                scratch_pool));
+  SVN_MUTEX__WITH_LOCK(stores_mutex,
+                       persistent_open(store, path, size, guard,
+                                       scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the index entry in STORE to use for KEY_HASH.
+ */
+static index_entry_t *
+get_index_entry(svn_cache__persistent_t *store,
+                apr_uint32_t key_hash)
+{
+  return &store->index[key_hash % store->bucket_count];
+}
+
+/* Look for the entry with the given FULL_KEY of FULL_KEY_LEN bytes in
+ * STORE.  If it exists, return a copy of its data in *DATA and its
+ * size in *DATA_LEN.  Set *DATA to NULL otherwise.  Allocate the result
+ * in RESULT_POOL.
+ */
+static void
+store_get(char **data,
+          apr_size_t *data_len,
+          svn_cache__persistent_t *store,
+          const char *full_key,
+          apr_size_t full_key_len,
+          apr_pool_t *result_pool)
+{
+  apr_uint32_t key_hash = hash_key(full_key, full_key_len);
+  index_entry_t *index_entry = get_index_entry(store, key_hash);
+  apr_uint32_t first_block = index_entry->first_block;
+  const entry_header_t *mapped;
+  entry_header_t *entry;
+  apr_size_t data_size;
+  apr_size_t total_len;
+  apr_size_t available;
+
+  *data = NULL;
+  if (index_entry->key_hash != key_hash || first_block >= store->block_count)
+    return;
+
+  /* Bounds checks against the (potentially inconsistent) header data. */
+  mapped = (const entry_header_t *)(store->data
+                                    + (apr_size_t)first_block * BLOCK_SIZE);
+  available = MIN((apr_size_t)(store->block_count - first_block) * BLOCK_SIZE,
+                  store->max_entry_size);
+  data_size = ((volatile const entry_header_t *)mapped)->data_len;
+  if (   data_size > available
+      || sizeof(*mapped) + full_key_len > available - data_size)
+    return;
+
+  /* Copy and verify the copy.  The mapped data may change any time. */
+  total_len = sizeof(*mapped) + full_key_len + data_size;
+  entry = apr_palloc(result_pool, total_len);
+  memcpy(entry, mapped, total_len);
+
+  if (   total_len != sizeof(*entry) + entry->key_len + entry->data_len
+      || entry->key_hash != key_hash
+      || memcmp(entry->checksum,
+                entry_checksum(store, entry, total_len,
+                               result_pool)->digest,
+                sizeof(entry->checksum))
+      || memcmp(entry + 1, full_key, full_key_len))
+    return;
+
+  *data = (char *)(entry + 1) + full_key_len;
+  *data_len = entry->data_len;
+}
+
+/* Store DATA_LEN bytes of DATA under the FULL_KEY of FULL_KEY_LEN bytes
+ * in STORE.  Silently ignore data that is too large.  Use SCRATCH_POOL
+ * for temporary allocations.
+ */
+static void
+store_set(svn_cache__persistent_t *store,
+          const char *full_key,
+          apr_size_t full_key_len,
+          const void *data,
+          apr_size_t data_len,
+          apr_pool_t *scratch_pool)
+{
+  apr_uint32_t key_hash = hash_key(full_key, full_key_len);
+  apr_size_t total_len = sizeof(entry_header_t) + full_key_len + data_len;
+  apr_uint32_t blocks = (apr_uint32_t)((total_len + BLOCK_SIZE - 1)
+                                       / BLOCK_SIZE);
+  apr_uint32_t first_block;
+  index_entry_t *index_entry;
+  entry_header_t *entry;
+
+  if (store->read_only || total_len > store->max_entry_size)
+    return;
+
+  /* Reserve space in the ring buffer.  If the reserved range would
+   * straddle the end of the data area, the next one will start near
+   * its beginning. */
+  first_block = apr_atomic_add32(&store->header->next_block, blocks)
+              % store->block_count;
+  if (first_block + blocks > store->block_count)
+    first_block = apr_atomic_add32(&store->header->next_block, blocks)
+                % store->block_count;
+  if (first_block + blocks > store->block_count)
+    return;
+
+  /* Construct the entry in memory such that we can write it in one go. */
+  entry = apr_palloc(scratch_pool, total_len);
+  entry->key_len = (apr_uint32_t)full_key_len;
+  entry->data_len = (apr_uint32_t)data_len;
+  entry->key_hash = key_hash;
+  entry->reserved = 0;
+  memcpy(entry + 1, full_key, full_key_len);
+  memcpy((char *)(entry + 1) + full_key_len, data, data_len);
+  memcpy(entry->checksum,
+         entry_checksum(store, entry, total_len, scratch_pool)->digest,
+         sizeof(entry->checksum));
+
+  memcpy(store->data + (apr_size_t)first_block * BLOCK_SIZE, entry,
+         total_len);
+
+  /* Publish the new entry. */
+  index_entry = get_index_entry(store, key_hash);
+  index_entry->first_block = first_block;
+  index_entry->key_hash = key_hash;
+}
+
+/* Remove the entry with the given FULL_KEY of FULL_KEY_LEN bytes from
+ * STORE, if it exists.
+ */
+static void
+store_remove(svn_cache__persistent_t *store,
+             const char *full_key,
+             apr_size_t full_key_len)
+{
+  apr_uint32_t key_hash = hash_key(full_key, full_key_len);
+  index_entry_t *index_entry = get_index_entry(store, key_hash);
+
+  if (!store->read_only && index_entry->key_hash == key_hash)
+    index_entry->key_hash = 0;
+}
+
+
+/* The (internal) cache object. */
+typedef struct persistent_cache_t
+{
+  /* The in-memory cache that we put in front of the STORE. */
+  svn_cache__t *front;
+
+  /* The persistent store shared with other caches and processes. */
+  svn_cache__persistent_t *store;
+
+  /* Prefix to prepend to all keys when accessing STORE. */
+  const char *prefix;
+  apr_size_t prefix_len;
+
+  /* The size of the key: either a fixed number of bytes or
+   * APR_HASH_KEY_STRING. */
+  apr_ssize_t klen;
+
+  /* Used to marshal values in and out of the STORE. */
+  svn_cache__serialize_func_t serialize_func;
+  svn_cache__deserialize_func_t deserialize_func;
+} persistent_cache_t;
+
+/* Set *FULL_KEY and *FULL_KEY_LEN to the STORE key for KEY in CACHE.
+ * Allocate the result in RESULT_POOL.
+ */
+static void
+combine_key(const char **full_key,
+            apr_size_t *full_key_len,
+            persistent_cache_t *cache,
+            const void *key,
+            apr_pool_t *result_pool)
+{
+  apr_size_t key_len = cache->klen == APR_HASH_KEY_STRING
+                     ? strlen(key)
+                     : (apr_size_t)cache->klen;
+  char *result = apr_palloc(result_pool, cache->prefix_len + key_len);
+
+  memcpy(result, cache->prefix, cache->prefix_len);
+  memcpy(result + cache->prefix_len, key, key_len);
+
+  *full_key = result;
+  *full_key_len = cache->prefix_len + key_len;
+}
+
+/* Look for KEY in CACHE's store.  If found, return the serialized data
+ * in *DATA and its size in *DATA_LEN.  Set *DATA to NULL otherwise.
+ * Allocate the result in RESULT_POOL.
+ */
+static void
+persistent_internal_get(char **data,
+                        apr_size_t *data_len,
+                        persistent_cache_t *cache,
+                        const void *key,
+                        apr_pool_t *result_pool)
+{
+  const char *full_key;
+  apr_size_t full_key_len;
+
+  combine_key(&full_key, &full_key_len, cache, key, result_pool);
+  store_get(data, data_len, cache->store, full_key, full_key_len,
+            result_pool);
+}
+
+/* Turn the DATA_LEN bytes of serialized DATA into a value for CACHE and
+ * return it in *VALUE_P.  DATA may get modified.  Allocate the result in
+ * RESULT_POOL.
+ */
+static svn_error_t *
+deserialize(void **value_p,
+            persistent_cache_t *cache,
+            char *data,
+            apr_size_t data_len,
+            apr_pool_t *result_pool)
+{
+  if (cache->deserialize_func)
+    {
+      SVN_ERR((cache->deserialize_func)(value_p, data, data_len,
+                                        result_pool));
+    }
+  else
+    {
+      svn_stringbuf_t *value = svn_stringbuf_create_empty(result_pool);
+      value->data = data;
+      value->blocksize = data_len;
+      value->len = data_len - 1; /* account for trailing NUL */
+      *value_p = value;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_get(void **value_p,
+               svn_boolean_t *found,
+               void *cache_void,
+               const void *key,
+               apr_pool_t *result_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  char *data;
+  apr_size_t data_len;
+
+  SVN_ERR(svn_cache__get(value_p, found, cache->front, key, result_pool));
+  if (*found || key == NULL)
+    return SVN_NO_ERROR;
+
+  persistent_internal_get(&data, &data_len, cache, key, result_pool);
+  if (data == NULL)
+    return SVN_NO_ERROR;
+
+  /* Promote the entry to the in-memory cache. */
+  SVN_ERR(deserialize(value_p, cache, data, data_len, result_pool));
+  SVN_ERR(svn_cache__set(cache->front, key, *value_p, result_pool));
+  *found = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_has_key(svn_boolean_t *found,
+                   void *cache_void,
+                   const void *key,
+                   apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  char *data;
+  apr_size_t data_len;
+
+  SVN_ERR(svn_cache__has_key(found, cache->front, key, scratch_pool));
+  if (*found || key == NULL)
+    return SVN_NO_ERROR;
+
+  persistent_internal_get(&data, &data_len, cache, key, scratch_pool);
+  *found = data != NULL;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_set(void *cache_void,
+               const void *key,
+               void *value,
+               apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+  const char *full_key;
+  apr_size_t full_key_len;
+  void *data;
+  apr_size_t data_len;
+
+  SVN_ERR(svn_cache__set(cache->front, key, value, scratch_pool));
+  if (key == NULL)
+    return SVN_NO_ERROR;
+
+  subpool = svn_pool_create(scratch_pool);
+  if (cache->serialize_func)
+    {
+      SVN_ERR((cache->serialize_func)(&data, &data_len, value, subpool));
+    }
+  else
+    {
+      svn_stringbuf_t *value_str = value;
+      data = value_str->data;
+      data_len = value_str->len + 1; /* copy trailing NUL */
+    }
+
+  combine_key(&full_key, &full_key_len, cache, key, subpool);
+  store_set(cache->store, full_key, full_key_len, data, data_len, subpool);
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_get_partial(void **value_p,
+                       svn_boolean_t *found,
+                       void *cache_void,
+                       const void *key,
+                       svn_cache__partial_getter_func_t func,
+                       void *baton,
+                       apr_pool_t *result_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+  char *data;
+  apr_size_t data_len;
+  void *value;
+
+  SVN_ERR(svn_cache__get_partial(value_p, found, cache->front, key, func,
+                                 baton, result_pool));
+  if (*found || key == NULL)
+    return SVN_NO_ERROR;
+
+  subpool = svn_pool_create(result_pool);
+  persistent_internal_get(&data, &data_len, cache, key, subpool);
+  if (data)
+    {
+      SVN_ERR(func(value_p, data, data_len, baton, result_pool));
+      *found = TRUE;
+
+      /* Promote the entry to the in-memory cache.  FUNC may have
+       * returned references into DATA, so deserialize a copy. */
+      data = apr_pmemdup(subpool, data, data_len);
+      SVN_ERR(deserialize(&value, cache, data, data_len, subpool));
+      SVN_ERR(svn_cache__set(cache->front, key, value, subpool));
+    }
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_set_partial(void *cache_void,
+                       const void *key,
+                       svn_cache__partial_setter_func_t func,
+                       void *baton,
+                       apr_pool_t *scratch_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  const char *full_key;
+  apr_size_t full_key_len;
+
+  SVN_ERR(svn_cache__set_partial(cache->front, key, func, baton,
+                                 scratch_pool));
+
+  /* Modifying the persistent copy in-place is not worth the effort.
+   * Simply drop it as it is now outdated. */
+  if (key != NULL)
+    {
+      combine_key(&full_key, &full_key_len, cache, key, scratch_pool);
+      store_remove(cache->store, full_key, full_key_len);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+persistent_iter(svn_boolean_t *completed,
+                void *cache_void,
+                svn_iter_apr_hash_cb_t user_cb,
+                void *user_baton,
+                apr_pool_t *scratch_pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Can't iterate a persistent cache"));
+}
+
+static svn_boolean_t
+persistent_is_cachable(void *cache_void, apr_size_t size)
+{
+  persistent_cache_t *cache = cache_void;
+  return svn_cache__is_cachable(cache->front, size);
+}
+
+static svn_error_t *
+persistent_get_info(void *cache_void,
+                    svn_cache__info_t *info,
+                    svn_boolean_t reset,
+                    apr_pool_t *result_pool)
+{
+  persistent_cache_t *cache = cache_void;
+  return svn_error_trace(svn_cache__get_info(cache->front, info, reset,
+                                             result_pool));
+}
+
+static svn_cache__vtable_t persistent_cache_vtable = {
+  persistent_get,
+  persistent_has_key,
+  persistent_set,
+  persistent_iter,
+  persistent_is_cachable,
+  persistent_get_partial,
+  persistent_set_partial,
+  persistent_get_info
+};
+
+svn_error_t *
+svn_cache__create_persistent(svn_cache__t **cache_p,
+                             svn_cache__t *front,
+                             svn_cache__persistent_t *store,
+                             svn_cache__serialize_func_t serialize_func,
+                             svn_cache__deserialize_func_t deserialize_func,
+                             apr_ssize_t klen,
+                             const char *prefix,
+                             apr_pool_t *result_pool)
+{
+  svn_cache__t *wrapper = apr_pcalloc(result_pool, sizeof(*wrapper));
+  persistent_cache_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+
+  cache->front = front;
+  cache->store = store;
+  cache->klen = klen;
+  cache->serialize_func = serialize_func;
+  cache->deserialize_func = deserialize_func;
+
+  /* Include the terminating NUL to make the prefix self-delimiting. */
+  cache->prefix_len = strlen(prefix) + 1;
+  cache->prefix = apr_pstrdup(result_pool, prefix);
+
+  wrapper->vtable = &persistent_cache_vtable;
+  wrapper->cache_internal = cache;
+  wrapper->error_handler = 0;
+  wrapper->error_baton = 0;
+  wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
+
+  *cache_p = wrapper;
+  return SVN_NO_ERROR;
+}
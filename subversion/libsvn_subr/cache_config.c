@@ -64,6 +64,22 @@ static svn_cache_config_t cache_settings =
 #endif
 };
 
+/* If set, the process-global membuffer cache will be allocated in shared
+ * memory using SHARED_MEMORY_FILE, SHARED_LOCK_FILE, SHARED_LOCK_FUNC and
+ * SHARED_LOCK_BATON.  See svn_cache__create_shared_global_membuffer_cache().
+ */
+static svn_boolean_t use_shared_memory = FALSE;
+static const char *shared_memory_file = NULL;
+static const char *shared_lock_file = NULL;
+static svn_cache__shared_lock_func_t shared_lock_func = NULL;
+static void *shared_lock_baton = NULL;
+
+/* The process-global (singleton) membuffer cache and its initialization
+ * state.
+ */
+static svn_membuffer_t *global_cache = NULL;
+static svn_atomic_t global_cache_initialized = 0;
+
 /* Get the current FSFS cache configuration. */
 const svn_cache_config_t *
 svn_cache_config_get(void)
@@ -120,14 +136,26 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
         return SVN_NO_ERROR;
       apr_allocator_owner_set(allocator, pool);
 
-      err = svn_cache__membuffer_cache_create(
-          &cache,
-          (apr_size_t)cache_size,
-          (apr_size_t)(cache_size / 5),
-          0,
-          ! svn_cache_config_get()->single_threaded,
-          FALSE,
-          pool);
+      if (use_shared_memory)
+        err = svn_cache__membuffer_cache_create_shared(
+            &cache,
+            (apr_size_t)cache_size,
+            (apr_size_t)(cache_size / 5),
+            0,
+            shared_memory_file,
+            shared_lock_file,
+            shared_lock_func,
+            shared_lock_baton,
+            pool);
+      else
+        err = svn_cache__membuffer_cache_create(
+            &cache,
+            (apr_size_t)cache_size,
+            (apr_size_t)(cache_size / 5),
+            0,
+            ! svn_cache_config_get()->single_threaded,
+            FALSE,
+            pool);
 
       /* Some error occurred. Most likely it's an OOM error but we don't
        * really care. Simply release all cache memory and disable caching
@@ -158,11 +186,9 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
 svn_membuffer_t *
 svn_cache__get_global_membuffer_cache(void)
 {
-  static svn_membuffer_t *cache = NULL;
-  static svn_atomic_t initialized = 0;
-
   svn_error_t *err
-    = svn_atomic__init_once(&initialized, initialize_cache, &cache, NULL);
+    = svn_atomic__init_once(&global_cache_initialized, initialize_cache,
+                            &global_cache, NULL);
   if (err)
     {
       /* no caches today ... */
@@ -170,7 +196,36 @@ svn_cache__get_global_membuffer_cache(void)
       return NULL;
     }
 
-  return cache;
+  return global_cache;
+}
+
+svn_error_t *
+svn_cache__create_shared_global_membuffer_cache(
+  const char *shm_file,
+  const char *lock_file,
+  svn_cache__shared_lock_func_t lock_func,
+  void *lock_baton)
+{
+  /* These are only used by initialize_cache(), i.e. within this call. */
+  use_shared_memory = TRUE;
+  shared_memory_file = shm_file;
+  shared_lock_file = lock_file;
+  shared_lock_func = lock_func;
+  shared_lock_baton = lock_baton;
+
+  return svn_error_trace(svn_atomic__init_once(&global_cache_initialized,
+                                               initialize_cache,
+                                               &global_cache, NULL));
+}
+
+svn_error_t *
+svn_cache__global_membuffer_cache_child_init(apr_pool_t *pool)
+{
+  if (global_cache == NULL)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(svn_cache__membuffer_cache_child_init(global_cache,
+                                                               pool));
 }
 
 void
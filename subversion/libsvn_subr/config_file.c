@@ -1169,6 +1169,27 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###   http-bulk-updates          Whether to request bulk update"    NL
         "###                              responses or to fetch each file"   NL
         "###                              in an individual request. "        NL
+        "###   http-http2                 Whether to use HTTP/2 and send all"
+                                                                             NL
+        "###                              requests over a single connection" NL
+        "###                              (yes/no/auto).  'auto' negotiates" NL
+        "###                              it for https:// URLs only."        NL
+        "###   http-cache-dir             Directory in which to keep the"    NL
+        "###                              contents and properties of files"  NL
+        "###                              fetched at fixed revisions and"    NL
+        "###                              blame data, for reuse by later"    NL
+        "###                              operations.  Read access is"       NL
+        "###                              re-checked before cached data is"  NL
+        "###                              used, but cached blame data does"  NL
+        "###                              not reflect later revprop edits."  NL
+        "###                              Not set by default (no caching)."  NL
+        "###   http-cache-size            Maximum size of http-cache-dir in" NL
+        "###                              megabytes (default: 256)."         NL
+        "###   svn-max-connections        Maximum number of parallel server" NL
+        "###                              connections to use for svn://"     NL
+        "###                              checkouts and updates.  Values"    NL
+        "###                              above 1 fetch file contents"       NL
+        "###                              concurrently."                     NL
         "###   store-passwords            Specifies whether passwords used"  NL
         "###                              to authenticate against a"         NL
         "###                              Subversion server may be cached"   NL
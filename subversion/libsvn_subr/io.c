@@ -51,6 +51,15 @@
 #include <fcntl.h>
 #endif
 
+#ifdef HAVE_LINUX_FS_H
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+#include <errno.h>
+#endif
+
 #include "svn_hash.h"
 #include "svn_types.h"
 #include "svn_dirent_uri.h"
@@ -871,6 +880,80 @@ svn_io_temp_dir(const char **dir,
 
 /*** Creating, copying and appending files. ***/
 
+#if (defined(HAVE_LINUX_FS_H) && defined(FICLONE)) \
+    || defined(HAVE_COPY_FILE_RANGE)
+#define SVN_IO_ZERO_COPY
+#endif
+
+#ifdef SVN_IO_ZERO_COPY
+/* Try to transfer the contents of FROM_FILE to the still empty TO_FILE
+ * without moving the data through user space.  Preferably, share the
+ * underlying extents between both files (reflink, supported e.g. by
+ * Btrfs and XFS).  Otherwise, let the kernel copy the data, which may
+ * be offloaded to the storage (e.g. for NFS 4.2).
+ *
+ * Set *DONE to TRUE if the contents have been transferred.  If neither
+ * method is supported for the given files, set *DONE to FALSE and leave
+ * both files untouched.
+ */
+static apr_status_t
+copy_contents_in_kernel(svn_boolean_t *done,
+                        apr_file_t *from_file,
+                        apr_file_t *to_file)
+{
+  apr_os_file_t from_fd, to_fd;
+
+  *done = FALSE;
+  if (   apr_os_file_get(&from_fd, from_file)
+      || apr_os_file_get(&to_fd, to_file))
+    return APR_SUCCESS;
+
+#if defined(HAVE_LINUX_FS_H) && defined(FICLONE)
+  if (ioctl(to_fd, FICLONE, from_fd) == 0)
+    {
+      *done = TRUE;
+      return APR_SUCCESS;
+    }
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+  {
+    svn_boolean_t copied_any = FALSE;
+    while (1)
+      {
+        ssize_t copied = copy_file_range(from_fd, NULL, to_fd, NULL,
+                                         0x40000000, 0);
+        if (copied > 0)
+          {
+            copied_any = TRUE;
+            continue;
+          }
+
+        if (copied == 0)
+          {
+            *done = TRUE;
+            return APR_SUCCESS;
+          }
+
+        if (errno == EINTR)
+          continue;
+
+        /* Not supported for these files?  Then we fall back to the
+           buffered copy, unless we already moved some data. */
+        if (   !copied_any
+            && (   errno == ENOSYS || errno == EXDEV || errno == EINVAL
+                || errno == EOPNOTSUPP || errno == EBADF))
+          return APR_SUCCESS;
+
+        return apr_get_os_error();
+      }
+  }
+#else
+  return APR_SUCCESS;
+#endif
+}
+#endif /* SVN_IO_ZERO_COPY */
+
 /* Transfer the contents of FROM_FILE to TO_FILE, using POOL for temporary
  * allocations.
  *
@@ -885,6 +968,13 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+#ifdef SVN_IO_ZERO_COPY
+  svn_boolean_t done;
+  apr_status_t status = copy_contents_in_kernel(&done, from_file, to_file);
+  if (status || done)
+    return status;
+#endif
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -4147,6 +4237,19 @@ svn_io_file_aligned_seek(apr_file_t *file,
   return SVN_NO_ERROR;
 }
 
+void
+svn_io__file_prefetch(apr_file_t *file,
+                      apr_off_t offset,
+                      apr_off_t length)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+  apr_os_file_t fd;
+
+  if (length > 0 && apr_os_file_get(&fd, file) == APR_SUCCESS)
+    posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
 
 svn_error_t *
 svn_io_file_write(apr_file_t *file, const void *buf,
@@ -0,0 +1,390 @@
+/*
+ * thread_jobs.c: run jobs in worker threads and collect their results
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_thread_pool.h>
+#include <apr_thread_cond.h>
+
+#include "svn_pools.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_thread_jobs.h"
+
+#include "svn_private_config.h"
+
+/* A single job queued in a svn_thread__jobs_t. */
+typedef struct job_t
+{
+  /* What to run.  Set by the creating thread before queueing the job. */
+  svn_thread__job_func_t func;
+  void *baton;
+
+  /* Root pool of this job.  This structure is allocated in it. */
+  apr_pool_t *pool;
+
+  /* Result of FUNC. */
+  svn_error_t *err;
+
+  /* Set by the worker once ERR is valid.
+   * Protected by the queue's MUTEX. */
+  svn_boolean_t done;
+
+  /* The queue that this job belongs to. */
+  svn_thread__jobs_t *jobs;
+} job_t;
+
+struct svn_thread__jobs_t
+{
+  /* Jobs whose results have not been collected, in the order they were
+   * queued.  There are COUNT entries out of MAX_JOBS in use. */
+  job_t **jobs;
+  int count;
+  int max_jobs;
+
+  /* Whether svn_thread__jobs_pop() must return the jobs in order. */
+  svn_boolean_t in_order;
+
+  /* Parameters of the thread pool. */
+  int max_threads;
+  apr_interval_time_t idle_limit;
+
+  /* Cancellation function provided by the creator.  May be NULL. */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Set to TRUE to make the workers bail out as soon as possible. */
+  volatile svn_atomic_t aborted;
+
+  /* Synchronizes the job completion flags between the threads. */
+  svn_mutex__t *mutex;
+
+#if APR_HAS_THREADS
+  /* Signalled whenever a job has been completed. */
+  apr_thread_cond_t *cond;
+
+  /* Thread pool to run the jobs in.  THREADS_POOL is the thread-safe
+   * root pool owning THREADS.  Both are NULL until the first job gets
+   * queued and after the queue has been closed. */
+  apr_thread_pool_t *threads;
+  apr_pool_t *threads_pool;
+#endif
+};
+
+/* Run JOB and signal its completion to the creator of its queue. */
+static void
+run_job(job_t *job)
+{
+  svn_thread__jobs_t *jobs = job->jobs;
+  svn_error_t *err;
+
+  job->err = job->func(job->baton, job->pool);
+
+  /* Once we signal completion, JOB may get released by the main thread.
+     There is nobody to report locking errors to, so simply clear them.
+     They will also cause the main thread to fail. */
+  err = svn_mutex__lock(jobs->mutex);
+  if (!err)
+    {
+      job->done = TRUE;
+#if APR_HAS_THREADS
+      apr_thread_cond_broadcast(jobs->cond);
+#endif
+      err = svn_mutex__unlock(jobs->mutex, SVN_NO_ERROR);
+    }
+  svn_error_clear(err);
+}
+
+#if APR_HAS_THREADS
+
+/* Thread-pool task:  Run the job_t given by DATA. */
+static void * APR_THREAD_FUNC
+job_task(apr_thread_t *tid,
+         void *data)
+{
+  run_job(data);
+  return NULL;
+}
+
+/* Create the thread pool of JOBS. */
+static svn_error_t *
+create_threads(svn_thread__jobs_t *jobs)
+{
+  apr_status_t status;
+
+  /* The thread-pool must be allocated from a thread-safe pool. */
+  jobs->threads_pool = svn_pool_create(NULL);
+  status = apr_thread_pool_create(&jobs->threads, 0, jobs->max_threads,
+                                  jobs->threads_pool);
+  if (status)
+    {
+      svn_pool_destroy(jobs->threads_pool);
+      jobs->threads_pool = NULL;
+      jobs->threads = NULL;
+
+      return svn_error_wrap_apr(status, _("Can't create thread pool"));
+    }
+
+  if (jobs->idle_limit)
+    apr_thread_pool_idle_wait_set(jobs->threads, jobs->idle_limit);
+
+  /* don't queue requests unless we reached the worker thread limit */
+  apr_thread_pool_threshold_set(jobs->threads, 0);
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
+/* Implements apr_pool_cleanup_t for svn_thread__jobs_t. */
+static apr_status_t
+jobs_cleanup(void *data)
+{
+  svn_thread__jobs_close(data);
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_thread__jobs_create(svn_thread__jobs_t **jobs,
+                        int max_jobs,
+                        int max_threads,
+                        apr_interval_time_t idle_limit,
+                        svn_boolean_t in_order,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *result_pool)
+{
+  svn_thread__jobs_t *result = apr_pcalloc(result_pool, sizeof(*result));
+
+  SVN_ERR_ASSERT(max_jobs > 0 && max_threads > 0);
+
+  result->max_jobs = max_jobs;
+  result->jobs = apr_pcalloc(result_pool, max_jobs * sizeof(*result->jobs));
+  result->in_order = in_order;
+  result->max_threads = max_threads;
+  result->idle_limit = idle_limit;
+  result->cancel_func = cancel_func;
+  result->cancel_baton = cancel_baton;
+
+  SVN_ERR(svn_mutex__init(&result->mutex, TRUE, result_pool));
+#if APR_HAS_THREADS
+  {
+    apr_status_t status = apr_thread_cond_create(&result->cond, result_pool);
+    if (status)
+      return svn_error_wrap_apr(status, _("Can't create condition variable"));
+  }
+#endif
+
+  /* Register this after creating MUTEX and COND, so it gets run before
+   * they get destroyed. */
+  apr_pool_cleanup_register(result_pool, result, jobs_cleanup,
+                            apr_pool_cleanup_null);
+
+  *jobs = result;
+  return SVN_NO_ERROR;
+}
+
+int
+svn_thread__jobs_count(svn_thread__jobs_t *jobs)
+{
+  return jobs->count;
+}
+
+svn_boolean_t
+svn_thread__jobs_full(svn_thread__jobs_t *jobs)
+{
+  return jobs->count == jobs->max_jobs;
+}
+
+svn_error_t *
+svn_thread__jobs_push(svn_thread__jobs_t *jobs,
+                      svn_thread__job_func_t func,
+                      void *baton,
+                      apr_pool_t *pool)
+{
+  job_t *job;
+
+  SVN_ERR_ASSERT(jobs->count < jobs->max_jobs);
+
+#if APR_HAS_THREADS
+  if (!jobs->threads)
+    {
+      svn_error_t *err = create_threads(jobs);
+      if (err)
+        {
+          svn_pool_destroy(pool);
+          return svn_error_trace(err);
+        }
+    }
+#endif
+
+  job = apr_pcalloc(pool, sizeof(*job));
+  job->func = func;
+  job->baton = baton;
+  job->pool = pool;
+  job->jobs = jobs;
+
+  jobs->jobs[jobs->count++] = job;
+
+#if APR_HAS_THREADS
+  if (apr_thread_pool_push(jobs->threads, job_task, job, 0, NULL)
+      == APR_SUCCESS)
+    return SVN_NO_ERROR;
+#endif
+
+  /* Don't fail the whole operation.  Run this job ourselves. */
+  run_job(job);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the index of the job in JOBS that svn_thread__jobs_pop() shall
+ * return next or -1 if there is none.  The caller must hold the MUTEX. */
+static int
+find_finished_job(svn_thread__jobs_t *jobs)
+{
+  int i;
+
+  if (jobs->in_order)
+    return jobs->jobs[0]->done ? 0 : -1;
+
+  for (i = 0; i < jobs->count; ++i)
+    if (jobs->jobs[i]->done)
+      return i;
+
+  return -1;
+}
+
+svn_error_t *
+svn_thread__jobs_pop(void **baton,
+                     svn_error_t **job_err,
+                     svn_thread__jobs_t *jobs,
+                     svn_boolean_t wait)
+{
+  job_t *job;
+  int i;
+
+  *baton = NULL;
+  *job_err = SVN_NO_ERROR;
+
+  if (jobs->count == 0)
+    return SVN_NO_ERROR;
+
+  /* This loop implicitly handles spurious wake-ups. */
+  SVN_ERR(svn_mutex__lock(jobs->mutex));
+  while (TRUE)
+    {
+      i = find_finished_job(jobs);
+      if (i >= 0 || !wait)
+        break;
+
+#if APR_HAS_THREADS
+      {
+        apr_status_t status = apr_thread_cond_wait(jobs->cond,
+                                           svn_mutex__get(jobs->mutex));
+        if (status)
+          return svn_error_trace(
+                   svn_mutex__unlock(jobs->mutex,
+                                     svn_error_wrap_apr(status,
+                                        _("Can't wait for condition variable"))));
+      }
+#else
+      /* Without threads, all jobs are done by the time they got queued. */
+      break;
+#endif
+    }
+  SVN_ERR(svn_mutex__unlock(jobs->mutex, SVN_NO_ERROR));
+
+  if (i < 0)
+    return SVN_NO_ERROR;
+
+  /* Keep the remaining jobs in order. */
+  job = jobs->jobs[i];
+  --jobs->count;
+  memmove(&jobs->jobs[i], &jobs->jobs[i + 1],
+          (jobs->count - i) * sizeof(*jobs->jobs));
+
+  *baton = job->baton;
+  *job_err = job->err;
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_thread__jobs_abort(svn_thread__jobs_t *jobs)
+{
+  svn_atomic_set(&jobs->aborted, TRUE);
+}
+
+svn_boolean_t
+svn_thread__jobs_aborted(svn_thread__jobs_t *jobs)
+{
+  return svn_atomic_read(&jobs->aborted) != 0;
+}
+
+svn_error_t *
+svn_thread__jobs_cancel_func(void *baton)
+{
+  svn_thread__jobs_t *jobs = baton;
+
+  if (svn_thread__jobs_aborted(jobs))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  if (jobs->cancel_func)
+    SVN_ERR(jobs->cancel_func(jobs->cancel_baton));
+
+  return SVN_NO_ERROR;
+}
+
+svn_mutex__t *
+svn_thread__jobs_mutex(svn_thread__jobs_t *jobs)
+{
+  return jobs->mutex;
+}
+
+void
+svn_thread__jobs_close(svn_thread__jobs_t *jobs)
+{
+  int i;
+
+  svn_thread__jobs_abort(jobs);
+
+#if APR_HAS_THREADS
+  /* Wait for all running jobs to finish before we release their pools. */
+  if (jobs->threads_pool)
+    {
+      svn_pool_destroy(jobs->threads_pool);
+      jobs->threads_pool = NULL;
+      jobs->threads = NULL;
+    }
+#endif
+
+  for (i = 0; i < jobs->count; ++i)
+    {
+      job_t *job = jobs->jobs[i];
+      svn_error_clear(job->err);
+      svn_pool_destroy(job->pool);
+    }
+
+  jobs->count = 0;
+}
@@ -35,6 +35,7 @@
 
 #include "private/svn_utf_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_xml_private.h"
 
 #ifdef SVN_HAVE_OLD_EXPAT
 #include <xmlparse.h>
@@ -132,6 +133,22 @@ svn_xml_is_xml_safe(const char *data, apr_size_t len)
 
 /*** XML escaping. ***/
 
+/* Flags for the characters that need to be escaped in character data
+   and in attribute values, respectively.  Looking them up in a table
+   lets us skip over runs of plain characters quickly, which is all that
+   most strings consist of. */
+#define XML_ESCAPE_CDATA 1
+#define XML_ESCAPE_ATTR  2
+
+static const unsigned char xml_escape_chars[256] =
+  {
+    0, 0, 0, 0, 0, 0, 0, 0,  0, 2, 2, 0, 0, 3, 0, 0,  /* \t \n \r */
+    0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 2, 0, 0, 0, 3, 2,  0, 0, 0, 0, 0, 0, 0, 0,  /* " & ' */
+    0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 3, 0, 3, 0,  /* < > */
+    /* All other characters, including the non-ASCII ones, are 0. */
+  };
+
 /* ### ...?
  *
  * If *OUTSTR is @c NULL, set *OUTSTR to a new stringbuf allocated
@@ -147,7 +164,9 @@ xml_escape_cdata(svn_stringbuf_t **outstr,
   const char *p = data, *q;
 
   if (*outstr == NULL)
-    *outstr = svn_stringbuf_create_empty(pool);
+    *outstr = svn_stringbuf_create_ensure(len, pool);
+  else
+    svn_stringbuf_ensure(*outstr, (*outstr)->len + len);
 
   while (1)
     {
@@ -162,7 +181,8 @@ xml_escape_cdata(svn_stringbuf_t **outstr,
          golly, if we say we want to escape a '\r', we want to make
          sure it remains a '\r'!  */
       q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>' && *q != '\r')
+      while (q < end
+             && !(xml_escape_chars[(unsigned char)*q] & XML_ESCAPE_CDATA))
         q++;
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
@@ -197,15 +217,16 @@ xml_escape_attr(svn_stringbuf_t **outstr,
 
   if (*outstr == NULL)
     *outstr = svn_stringbuf_create_ensure(len, pool);
+  else
+    svn_stringbuf_ensure(*outstr, (*outstr)->len + len);
 
   while (1)
     {
       /* Find a character which needs to be quoted and append bytes up
          to that point. */
       q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>'
-             && *q != '"' && *q != '\'' && *q != '\r'
-             && *q != '\n' && *q != '\t')
+      while (q < end
+             && !(xml_escape_chars[(unsigned char)*q] & XML_ESCAPE_ATTR))
         q++;
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
@@ -749,3 +770,136 @@ void svn_xml_make_close_tag(svn_stringbuf_t **str,
   svn_stringbuf_appendcstr(*str, tagname);
   svn_stringbuf_appendcstr(*str, ">\n");
 }
+
+
+
+/*** Buffered XML output ***/
+
+/* Once this many bytes are buffered in a svn_xml__writer_t, they are
+   written to its stream.  Large enough for the data to go down e.g.
+   an httpd filter stack in big pieces. */
+#define XML_WRITER_FLUSH_SIZE (64 * 1024)
+
+struct svn_xml__writer_t
+{
+  /* Where the output goes. */
+  svn_stream_t *out;
+
+  /* The buffered output. */
+  svn_stringbuf_t *buf;
+
+  /* For svn_xml__writer_printf(); cleared whenever we flush. */
+  apr_pool_t *scratch_pool;
+};
+
+/* Flush XW if it has buffered enough data. */
+static svn_error_t *
+xml_writer_maybe_flush(svn_xml__writer_t *xw)
+{
+  if (xw->buf->len >= XML_WRITER_FLUSH_SIZE)
+    return svn_error_trace(svn_xml__writer_flush(xw));
+
+  return SVN_NO_ERROR;
+}
+
+svn_xml__writer_t *
+svn_xml__writer_create(svn_stream_t *out,
+                       apr_pool_t *pool)
+{
+  svn_xml__writer_t *xw = apr_palloc(pool, sizeof(*xw));
+
+  xw->out = out;
+  xw->buf = svn_stringbuf_create_ensure(XML_WRITER_FLUSH_SIZE, pool);
+  xw->scratch_pool = svn_pool_create(pool);
+
+  return xw;
+}
+
+svn_error_t *
+svn_xml__writer_putstrs(svn_xml__writer_t *xw,
+                        ...)
+{
+  va_list ap;
+  const char *str;
+
+  va_start(ap, xw);
+  while ((str = va_arg(ap, const char *)) != NULL)
+    svn_stringbuf_appendcstr(xw->buf, str);
+  va_end(ap);
+
+  return svn_error_trace(xml_writer_maybe_flush(xw));
+}
+
+svn_error_t *
+svn_xml__writer_printf(svn_xml__writer_t *xw,
+                       const char *fmt,
+                       ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  svn_stringbuf_appendcstr(xw->buf, apr_pvsprintf(xw->scratch_pool, fmt, ap));
+  va_end(ap);
+
+  return svn_error_trace(xml_writer_maybe_flush(xw));
+}
+
+svn_error_t *
+svn_xml__writer_cdata(svn_xml__writer_t *xw,
+                      const char *data,
+                      apr_size_t len)
+{
+  svn_string_t str;
+
+  str.data = data;
+  str.len = len;
+  svn_xml_escape_cdata_string(&xw->buf, &str, xw->buf->pool);
+
+  return svn_error_trace(xml_writer_maybe_flush(xw));
+}
+
+svn_error_t *
+svn_xml__writer_attr(svn_xml__writer_t *xw,
+                     const char *str)
+{
+  svn_xml_escape_attr_cstring(&xw->buf, str, xw->buf->pool);
+
+  return svn_error_trace(xml_writer_maybe_flush(xw));
+}
+
+/* Implements svn_write_fn_t for svn_xml__writer_stream(). */
+static svn_error_t *
+xml_writer_write_fn(void *baton,
+                    const char *data,
+                    apr_size_t *len)
+{
+  svn_xml__writer_t *xw = baton;
+
+  svn_stringbuf_appendbytes(xw->buf, data, *len);
+
+  return svn_error_trace(xml_writer_maybe_flush(xw));
+}
+
+svn_stream_t *
+svn_xml__writer_stream(svn_xml__writer_t *xw,
+                       apr_pool_t *pool)
+{
+  svn_stream_t *stream = svn_stream_create(xw, pool);
+
+  svn_stream_set_write(stream, xml_writer_write_fn);
+
+  return stream;
+}
+
+svn_error_t *
+svn_xml__writer_flush(svn_xml__writer_t *xw)
+{
+  if (xw->buf->len)
+    {
+      SVN_ERR(svn_stream_write(xw->out, xw->buf->data, &xw->buf->len));
+      svn_stringbuf_setempty(xw->buf);
+      svn_pool_clear(xw->scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
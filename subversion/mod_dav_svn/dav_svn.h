@@ -38,6 +38,7 @@
 #include "svn_xml.h"
 #include "private/svn_dav_protocol.h"
 #include "private/svn_skel.h"
+#include "private/svn_xml_private.h"
 #include "mod_authz_svn.h"
 
 #ifdef __cplusplus
@@ -327,6 +328,11 @@ svn_boolean_t dav_svn__get_autoversioning_flag(request_rec *r);
 /* for the repository referred to by this request, are bulk updates allowed? */
 dav_svn__bulk_upd_conf dav_svn__get_bulk_updates_flag(request_rec *r);
 
+/* for the repository referred to by this request, may clients fetch the
+   file contents of an update in partitions?  Never TRUE without bulk
+   updates. */
+svn_boolean_t dav_svn__get_update_partitions_flag(request_rec *r);
+
 /* for the repository referred to by this request, are subrequests active? */
 svn_boolean_t dav_svn__get_pathauthz_flag(request_rec *r);
 
@@ -1002,6 +1008,19 @@ svn_error_t *dav_svn__brigade_putstrs(apr_bucket_brigade *bb,
                                       ...) SVN_NEEDS_SENTINEL_NULL;
 
 
+/*** Buffered XML output ***/
+
+/* Return a writer for large XML responses that sends its output to
+   OUTPUT using BB.  See svn_xml__writer_t for how to use it; in
+   particular, call svn_xml__writer_flush() before writing anything to
+   BB directly, and before BB is flushed at the end of the request.
+   Allocate the writer in POOL. */
+svn_xml__writer_t *
+dav_svn__xml_writer_create(apr_bucket_brigade *bb,
+                           dav_svn__output *output,
+                           apr_pool_t *pool);
+
+
 
 
 /* Test PATH for canonicalness (defined as "what won't make the
@@ -27,12 +27,23 @@
 #include <apr_strings.h>
 #include <apr_hash.h>
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>   /* For getpid() */
+#endif
+
+#if APR_HAVE_PROCESS_H
+#include <process.h>
+#endif
+
 #include <httpd.h>
 #include <http_config.h>
 #include <http_request.h>
 #include <http_log.h>
 #include <ap_provider.h>
 #include <mod_dav.h>
+#ifdef AP_NEED_SET_MUTEX_PERMS
+#include <unixd.h>
+#endif
 
 #include "svn_hash.h"
 #include "svn_version.h"
@@ -42,6 +53,7 @@
 #include "svn_dso.h"
 #include "mod_dav_svn.h"
 
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_subr_private.h"
 
@@ -95,6 +107,7 @@ typedef struct dir_conf_t {
   const char *fs_parent_path;        /* path to parent of SVN FS'es  */
   enum conf_flag autoversioning;     /* whether autoversioning is active */
   dav_svn__bulk_upd_conf bulk_updates; /* whether bulk updates are allowed */
+  enum conf_flag update_partitions;  /* whether update partitions are offered */
   enum conf_flag v2_protocol;        /* whether HTTP v2 is advertised */
   enum path_authz_conf path_authz_method; /* how GET subrequests are handled */
   enum conf_flag list_parentpath;    /* whether to allow GET of parentpath */
@@ -120,6 +133,31 @@ extern module AP_MODULE_DECLARE_DATA dav_svn_module;
 /* The authz_svn provider for bypassing path authz. */
 static authz_svn__subreq_bypass_func_t pathauthz_bypass_func = NULL;
 
+/* Whether all child processes shall share a single in-memory cache
+   (see SVNInMemoryCacheShared). */
+static svn_boolean_t shared_memory_cache = FALSE;
+
+/* Implements svn_cache__shared_lock_func_t.  Allow the child processes
+   to use the cache's inter-process MUTEX after they dropped privileges. */
+static svn_error_t *
+set_cache_mutex_perms(apr_global_mutex_t *mutex,
+                      void *baton,
+                      apr_pool_t *pool)
+{
+#ifdef AP_NEED_SET_MUTEX_PERMS
+#if AP_MODULE_MAGIC_AT_LEAST(20081201,0)
+  apr_status_t status = ap_unixd_set_global_mutex_perms(mutex);
+#else
+  apr_status_t status = unixd_set_global_mutex_perms(mutex);
+#endif
+  if (status)
+    return svn_error_wrap_apr(status,
+                              "Can't set permissions on cache mutex");
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 static int
 init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
 {
@@ -146,6 +184,30 @@ init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
       return HTTP_INTERNAL_SERVER_ERROR;
     }
 
+  /* The shared cache must exist before the MPM forks any children.
+     Keep its lock files next to Apache's own, i.e. in the run-time
+     directory, and make them unique to this server instance. */
+  if (shared_memory_cache)
+    {
+      const char *lock_file
+        = ap_server_root_relative(p,
+                                  apr_psprintf(p, "%s/svn-cache.%"
+                                               APR_PID_T_FMT ".lock",
+                                               DEFAULT_REL_RUNTIMEDIR,
+                                               getpid()));
+
+      serr = svn_cache__create_shared_global_membuffer_cache(
+               NULL, lock_file, set_cache_mutex_perms, NULL);
+      if (serr)
+        {
+          ap_log_perror(APLOG_MARK, APLOG_ERR, serr->apr_err, p,
+                        "mod_dav_svn: error creating the shared memory "
+                        "cache: '%s'",
+                        serr->message ? serr->message : "(no more info)");
+          return HTTP_INTERNAL_SERVER_ERROR;
+        }
+    }
+
   /* This returns void, so we can't check for error. */
   conf = ap_get_module_config(s->module_config, &dav_svn_module);
   svn_utf_initialize2(conf->use_utf8, p);
@@ -153,6 +215,21 @@ init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
   return OK;
 }
 
+/* Implements the #child_init hook. */
+static void
+child_init(apr_pool_t *p, server_rec *s)
+{
+  svn_error_t *serr = svn_cache__global_membuffer_cache_child_init(p);
+  if (serr)
+    {
+      ap_log_error(APLOG_MARK, APLOG_ERR, serr->apr_err, s,
+                   "mod_dav_svn: error attaching to the shared memory "
+                   "cache: '%s'",
+                   serr->message ? serr->message : "(no more info)");
+      svn_error_clear(serr);
+    }
+}
+
 static svn_error_t *
 malfunction_handler(svn_boolean_t can_return,
                     const char *file, int line,
@@ -278,6 +355,8 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->fs_parent_path = INHERIT_VALUE(parent, child, fs_parent_path);
   newconf->autoversioning = INHERIT_VALUE(parent, child, autoversioning);
   newconf->bulk_updates = INHERIT_VALUE(parent, child, bulk_updates);
+  newconf->update_partitions = INHERIT_VALUE(parent, child,
+                                             update_partitions);
   newconf->v2_protocol = INHERIT_VALUE(parent, child, v2_protocol);
   newconf->path_authz_method = INHERIT_VALUE(parent, child, path_authz_method);
   newconf->list_parentpath = INHERIT_VALUE(parent, child, list_parentpath);
@@ -426,6 +505,20 @@ SVNAllowBulkUpdates_cmd(cmd_parms *cmd, void *config, const char *arg1)
 }
 
 
+static const char *
+SVNAllowUpdatePartitions_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->update_partitions = CONF_FLAG_ON;
+  else
+    conf->update_partitions = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
+
 static const char *
 SVNAdvertiseV2Protocol_cmd(cmd_parms *cmd, void *config, int arg)
 {
@@ -631,6 +724,14 @@ SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNInMemoryCacheShared_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  shared_memory_cache = arg;
+
+  return NULL;
+}
+
 static const char *
 SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -908,6 +1009,21 @@ dav_svn__get_bulk_updates_flag(request_rec *r)
 }
 
 
+svn_boolean_t
+dav_svn__get_update_partitions_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* Partitions need bulk updates to be allowed. */
+  if (dav_svn__get_bulk_updates_flag(r) == CONF_BULKUPD_OFF)
+    return FALSE;
+
+  return get_conf_flag(conf->update_partitions, FALSE);
+}
+
+
 svn_boolean_t
 dav_svn__check_httpv2_support(request_rec *r)
 {
@@ -1347,6 +1463,13 @@ static const command_rec cmds[] =
                 "per-file downloads (Off). Use Prefer to tell the svn client "
                 "to always use bulk update requests, if supported."),
 
+  /* per directory/location */
+  AP_INIT_FLAG("SVNAllowUpdatePartitions", SVNAllowUpdatePartitions_cmd,
+               NULL, ACCESS_CONF|RSRC_CONF,
+               "enables support for update requests that deliver the file "
+               "contents of a skeletal report in several parallel "
+               "partitions, if bulk updates are allowed (default is Off)."),
+
   /* per directory/location */
   AP_INIT_FLAG("SVNAdvertiseV2Protocol", SVNAdvertiseV2Protocol_cmd, NULL,
                ACCESS_CONF|RSRC_CONF,
@@ -1396,6 +1519,13 @@ static const command_rec cmds[] =
                 "in-memory object cache (default value is 16384; 0 switches "
                 "to dynamically sized caches)."),
   /* per server */
+  AP_INIT_FLAG("SVNInMemoryCacheShared", SVNInMemoryCacheShared_cmd, NULL,
+               RSRC_CONF,
+               "puts the in-memory object cache into shared memory such "
+               "that all server processes use a single cache of "
+               "SVNInMemoryCacheSize instead of one per process "
+               "(default is Off)."),
+  /* per server */
   AP_INIT_TAKE1("SVNCompressionLevel", SVNCompressionLevel_cmd, NULL,
                 RSRC_CONF,
                 "specifies the compression level used before sending file "
@@ -1436,6 +1566,7 @@ register_hooks(apr_pool_t *pconf)
 {
   ap_hook_pre_config(init_dso, NULL, NULL, APR_HOOK_REALLY_FIRST);
   ap_hook_post_config(init, NULL, NULL, APR_HOOK_MIDDLE);
+  ap_hook_child_init(child_init, NULL, NULL, APR_HOOK_MIDDLE);
 
   /* our provider */
   dav_register_provider(pconf, "svn", &provider);
@@ -45,6 +45,9 @@ struct file_rev_baton {
   /* where to deliver the output */
   dav_svn__output *output;
 
+  /* collects the XML we generate before it goes to BB */
+  svn_xml__writer_t *xw;
+
   /* Whether we've written the <S:file-revs-report> header.  Allows for lazy
      writes to support mod_dav-based error handling. */
   svn_boolean_t needs_header;
@@ -70,11 +73,12 @@ maybe_send_header(struct file_rev_baton *frb)
 {
   if (frb->needs_header)
     {
-      SVN_ERR(dav_svn__brigade_puts(frb->bb, frb->output,
-                                    DAV_XML_HEADER DEBUG_CR
-                                    "<S:file-revs-report xmlns:S=\""
-                                    SVN_XML_NAMESPACE "\" "
-                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      SVN_ERR(svn_xml__writer_putstrs(frb->xw,
+                                      DAV_XML_HEADER DEBUG_CR
+                                      "<S:file-revs-report xmlns:S=\""
+                                      SVN_XML_NAMESPACE "\" "
+                                      "xmlns:D=\"DAV:\">" DEBUG_CR,
+                                      SVN_VA_NULL));
       frb->needs_header = FALSE;
     }
   return SVN_NO_ERROR;
@@ -90,27 +94,24 @@ send_prop(struct file_rev_baton *frb,
           const svn_string_t *val,
           apr_pool_t *pool)
 {
-  name = apr_xml_quote_string(pool, name, 1);
+  SVN_ERR(svn_xml__writer_putstrs(frb->xw, "<S:", elem_name, " name=\"",
+                                  SVN_VA_NULL));
+  SVN_ERR(svn_xml__writer_attr(frb->xw, name));
 
   if (svn_xml_is_xml_safe(val->data, val->len))
     {
-      svn_stringbuf_t *tmp = NULL;
-      svn_xml_escape_cdata_string(&tmp, val, pool);
-      val = svn_string_create(tmp->data, pool);
-      SVN_ERR(dav_svn__brigade_printf(frb->bb, frb->output,
-                                      "<S:%s name=\"%s\">%s</S:%s>" DEBUG_CR,
-                                      elem_name, name, val->data, elem_name));
+      SVN_ERR(svn_xml__writer_putstrs(frb->xw, "\">", SVN_VA_NULL));
+      SVN_ERR(svn_xml__writer_cdata(frb->xw, val->data, val->len));
     }
   else
     {
       val = svn_base64_encode_string2(val, TRUE, pool);
-      SVN_ERR(dav_svn__brigade_printf(frb->bb, frb->output,
-                                      "<S:%s name=\"%s\" encoding=\"base64\">"
-                                      "%s</S:%s>" DEBUG_CR,
-                                      elem_name, name, val->data, elem_name));
+      SVN_ERR(svn_xml__writer_putstrs(frb->xw, "\" encoding=\"base64\">",
+                                      val->data, SVN_VA_NULL));
     }
 
-  return SVN_NO_ERROR;
+  return svn_error_trace(svn_xml__writer_putstrs(frb->xw, "</S:", elem_name,
+                                                 ">" DEBUG_CR, SVN_VA_NULL));
 }
 
 
@@ -129,8 +130,9 @@ delta_window_handler(svn_txdelta_window_t *window, void *baton)
     {
       frb->window_handler = NULL;
       frb->window_baton = NULL;
-      SVN_ERR(dav_svn__brigade_puts(frb->bb, frb->output,
-                                    "</S:txdelta></S:file-rev>" DEBUG_CR));
+      SVN_ERR(svn_xml__writer_putstrs(frb->xw,
+                                      "</S:txdelta></S:file-rev>" DEBUG_CR,
+                                      SVN_VA_NULL));
     }
   return SVN_NO_ERROR;
 }
@@ -155,11 +157,11 @@ file_rev_handler(void *baton,
 
   SVN_ERR(maybe_send_header(frb));
 
-  SVN_ERR(dav_svn__brigade_printf(frb->bb, frb->output,
-                                  "<S:file-rev path=\"%s\" rev=\"%ld\">"
-                                  DEBUG_CR,
-                                  apr_xml_quote_string(pool, path, 1),
-                                  revnum));
+  SVN_ERR(svn_xml__writer_putstrs(frb->xw, "<S:file-rev path=\"",
+                                  SVN_VA_NULL));
+  SVN_ERR(svn_xml__writer_attr(frb->xw, path));
+  SVN_ERR(svn_xml__writer_printf(frb->xw, "\" rev=\"%ld\">" DEBUG_CR,
+                                 revnum));
 
   /* Send rev props. */
   for (hi = apr_hash_first(pool, rev_props); hi; hi = apr_hash_next(hi))
@@ -188,27 +190,27 @@ file_rev_handler(void *baton,
       else
         {
           /* Property was removed. */
-          SVN_ERR(dav_svn__brigade_printf(frb->bb, frb->output,
-                                          "<S:remove-prop name=\"%s\"/>"
-                                          DEBUG_CR,
-                                          apr_xml_quote_string(iterpool,
-                                                               prop->name,
-                                                               1)));
+          SVN_ERR(svn_xml__writer_putstrs(frb->xw, "<S:remove-prop name=\"",
+                                          SVN_VA_NULL));
+          SVN_ERR(svn_xml__writer_attr(frb->xw, prop->name));
+          SVN_ERR(svn_xml__writer_putstrs(frb->xw, "\"/>" DEBUG_CR,
+                                          SVN_VA_NULL));
         }
     }
 
   /* Send whether this was the result of a merge or not. */
   if (merged_revision)
-    SVN_ERR(dav_svn__brigade_puts(frb->bb, frb->output,
-                                  "<S:merged-revision/>"));
+    SVN_ERR(svn_xml__writer_putstrs(frb->xw, "<S:merged-revision/>",
+                                    SVN_VA_NULL));
 
   /* Maybe send text delta. */
   if (window_handler)
     {
       svn_stream_t *base64_stream;
 
-      base64_stream = dav_svn__make_base64_output_stream(frb->bb, frb->output,
-                                                         pool);
+      base64_stream = svn_base64_encode2(svn_xml__writer_stream(frb->xw,
+                                                                pool),
+                                         FALSE, pool);
       svn_txdelta_to_svndiff3(&frb->window_handler, &frb->window_baton,
                               base64_stream, frb->svndiff_version,
                               frb->compression_level, pool);
@@ -216,12 +218,12 @@ file_rev_handler(void *baton,
       *window_baton = frb;
       /* Start the txdelta element which will be terminated by the window
          handler together with the file-rev element. */
-      SVN_ERR(dav_svn__brigade_puts(frb->bb, frb->output, "<S:txdelta>"));
+      SVN_ERR(svn_xml__writer_putstrs(frb->xw, "<S:txdelta>", SVN_VA_NULL));
     }
   else
     /* No txdelta, so terminate the element here. */
-    SVN_ERR(dav_svn__brigade_puts(frb->bb, frb->output,
-                                  "</S:file-rev>" DEBUG_CR));
+    SVN_ERR(svn_xml__writer_putstrs(frb->xw, "</S:file-rev>" DEBUG_CR,
+                                    SVN_VA_NULL));
 
   svn_pool_destroy(iterpool);
 
@@ -306,6 +308,7 @@ dav_svn__file_revs_report(const dav_resource *resource,
   frb.bb = apr_brigade_create(resource->pool,
                               dav_svn__output_get_bucket_alloc(output));
   frb.output = output;
+  frb.xw = dav_svn__xml_writer_create(frb.bb, output, resource->pool);
   frb.needs_header = TRUE;
   frb.svndiff_version = resource->info->svndiff_version;
   frb.compression_level = dav_svn__get_compression_level(resource->info->r);
@@ -338,8 +341,9 @@ dav_svn__file_revs_report(const dav_resource *resource,
       goto cleanup;
     }
 
-  if ((serr = dav_svn__brigade_puts(frb.bb, frb.output,
-                                    "</S:file-revs-report>" DEBUG_CR)))
+  if ((serr = svn_xml__writer_putstrs(frb.xw,
+                                      "</S:file-revs-report>" DEBUG_CR,
+                                      SVN_VA_NULL)))
     {
       derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
                                   "Error ending REPORT response",
@@ -349,6 +353,14 @@ dav_svn__file_revs_report(const dav_resource *resource,
 
  cleanup:
 
+  /* Whatever we generated goes out before the error, if any. */
+  if ((serr = svn_xml__writer_flush(frb.xw)) && !derr)
+    derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Error ending REPORT response",
+                                resource->pool);
+  else
+    svn_error_clear(serr);
+
   /* We've detected a 'high level' svn action to log. */
   dav_svn__operational_log(resource->info,
                            svn_log__get_file_revs(abs_path, start, end,
@@ -52,6 +52,9 @@ struct log_receiver_baton
   /* where to deliver the output */
   dav_svn__output *output;
 
+  /* collects the XML we generate before it goes to BB */
+  svn_xml__writer_t *xw;
+
   /* Whether we've written the <S:log-report> header.  Allows for lazy
      writes to support mod_dav-based error handling. */
   svn_boolean_t needs_header;
@@ -86,11 +89,12 @@ maybe_send_header(struct log_receiver_baton *lrb)
 {
   if (lrb->needs_header)
     {
-      SVN_ERR(dav_svn__brigade_puts(lrb->bb, lrb->output,
-                                    DAV_XML_HEADER DEBUG_CR
-                                    "<S:log-report xmlns:S=\""
-                                    SVN_XML_NAMESPACE "\" "
-                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw,
+                                      DAV_XML_HEADER DEBUG_CR
+                                      "<S:log-report xmlns:S=\""
+                                      SVN_XML_NAMESPACE "\" "
+                                      "xmlns:D=\"DAV:\">" DEBUG_CR,
+                                      SVN_VA_NULL));
       lrb->needs_header = FALSE;
     }
 
@@ -104,8 +108,8 @@ maybe_start_log_item(struct log_receiver_baton *lrb)
 {
   if (lrb->needs_log_item)
     {
-      SVN_ERR(dav_svn__brigade_printf(lrb->bb, lrb->output,
-                                      "<S:log-item>" DEBUG_CR));
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<S:log-item>" DEBUG_CR,
+                                      SVN_VA_NULL));
       lrb->needs_log_item = FALSE;
     }
 
@@ -113,15 +117,13 @@ maybe_start_log_item(struct log_receiver_baton *lrb)
 }
 
 /* Utility for log_receiver opening a new XML element in LRB's brigade
-   for LOG_ITEM and return the element's name in *ELEMENT.  Use POOL for
-   temporary allocations.
+   for LOG_ITEM and return the element's name in *ELEMENT.
 
    Call this function for items that may have a copy-from */
 static svn_error_t *
 start_path_with_copy_from(const char **element,
                           struct log_receiver_baton *lrb,
-                          svn_repos_path_change_t *log_item,
-                          apr_pool_t *pool)
+                          svn_repos_path_change_t *log_item)
 {
   switch (log_item->change_kind)
     {
@@ -138,18 +140,17 @@ start_path_with_copy_from(const char **element,
         SVN_ERR_MALFUNCTION();
     }
 
+  SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<", *element, SVN_VA_NULL));
+
   if (log_item->copyfrom_path
       && SVN_IS_VALID_REVNUM(log_item->copyfrom_rev))
-    SVN_ERR(dav_svn__brigade_printf
-            (lrb->bb, lrb->output,
-             "<%s copyfrom-path=\"%s\" copyfrom-rev=\"%ld\"",
-             *element,
-             apr_xml_quote_string(pool,
-                                  log_item->copyfrom_path,
-                                  1), /* escape quotes */
-             log_item->copyfrom_rev));
-  else
-    SVN_ERR(dav_svn__brigade_printf(lrb->bb, lrb->output, "<%s", *element));
+    {
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw, " copyfrom-path=\"",
+                                      SVN_VA_NULL));
+      SVN_ERR(svn_xml__writer_attr(lrb->xw, log_item->copyfrom_path));
+      SVN_ERR(svn_xml__writer_printf(lrb->xw, "\" copyfrom-rev=\"%ld\"",
+                                     log_item->copyfrom_rev));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -180,19 +181,18 @@ log_change_receiver(void *baton,
     {
     case svn_fs_path_change_add:
     case svn_fs_path_change_replace:
-      SVN_ERR(start_path_with_copy_from(&close_element, lrb,
-                                        change, scratch_pool));
+      SVN_ERR(start_path_with_copy_from(&close_element, lrb, change));
       break;
 
     case svn_fs_path_change_delete:
-      SVN_ERR(dav_svn__brigade_puts(lrb->bb, lrb->output,
-                                    "<S:deleted-path"));
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<S:deleted-path",
+                                      SVN_VA_NULL));
       close_element = "S:deleted-path";
       break;
 
     case svn_fs_path_change_modify:
-      SVN_ERR(dav_svn__brigade_puts(lrb->bb, lrb->output,
-                                    "<S:modified-path"));
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<S:modified-path",
+                                      SVN_VA_NULL));
       close_element = "S:modified-path";
       break;
 
@@ -203,16 +203,19 @@ log_change_receiver(void *baton,
   /* If we need to close the element, then send the attributes
       that apply to all changed items and then close the element. */
   if (close_element)
-    SVN_ERR(dav_svn__brigade_printf
-             (lrb->bb, lrb->output,
-              " node-kind=\"%s\""
-              " text-mods=\"%s\""
-              " prop-mods=\"%s\">%s</%s>" DEBUG_CR,
-              svn_node_kind_to_word(change->node_kind),
-              change->text_mod ? "true" : "false",
-              change->prop_mod ? "true" : "false",
-              apr_xml_quote_string(scratch_pool, change->path.data, 0),
-              close_element));
+    {
+      SVN_ERR(svn_xml__writer_putstrs(
+                 lrb->xw,
+                 " node-kind=\"", svn_node_kind_to_word(change->node_kind),
+                 "\" text-mods=\"", change->text_mod ? "true" : "false",
+                 "\" prop-mods=\"", change->prop_mod ? "true" : "false",
+                 "\">",
+                 SVN_VA_NULL));
+      SVN_ERR(svn_xml__writer_cdata(lrb->xw, change->path.data,
+                                    change->path.len));
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "</", close_element,
+                                      ">" DEBUG_CR, SVN_VA_NULL));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -246,10 +249,10 @@ log_revision_receiver(void *baton,
 
   /* Path changes have been processed already.
      Now send the remaining per-revision info. */
-  SVN_ERR(dav_svn__brigade_printf(lrb->bb, lrb->output,
-                                  "<D:version-name>%ld"
-                                  "</D:version-name>" DEBUG_CR,
-                                  log_entry->revision));
+  SVN_ERR(svn_xml__writer_printf(lrb->xw,
+                                 "<D:version-name>%ld"
+                                 "</D:version-name>" DEBUG_CR,
+                                 log_entry->revision));
 
   if (log_entry->revprops)
     {
@@ -263,6 +266,7 @@ log_revision_receiver(void *baton,
           void *val;
           const svn_string_t *value;
           const char *encoding_str = "";
+          const char *element;
 
           svn_pool_clear(iterpool);
           apr_hash_this(hi, (void *)&name, NULL, &val);
@@ -280,31 +284,42 @@ log_revision_receiver(void *baton,
             }
 
           if (strcmp(name, SVN_PROP_REVISION_AUTHOR) == 0)
-            SVN_ERR(dav_svn__brigade_printf
-                    (lrb->bb, lrb->output,
-                     "<D:creator-displayname%s>%s</D:creator-displayname>"
-                     DEBUG_CR, encoding_str,
-                     apr_xml_quote_string(iterpool, value->data, 0)));
+            element = "D:creator-displayname";
           else if (strcmp(name, SVN_PROP_REVISION_DATE) == 0)
             /* ### this should be DAV:creation-date, but we need to format
                ### that date a bit differently */
-            SVN_ERR(dav_svn__brigade_printf
-                    (lrb->bb, lrb->output,
-                     "<S:date%s>%s</S:date>" DEBUG_CR, encoding_str,
-                     apr_xml_quote_string(iterpool, value->data, 0)));
+            element = "S:date";
           else if (strcmp(name, SVN_PROP_REVISION_LOG) == 0)
-            SVN_ERR(dav_svn__brigade_printf
-                    (lrb->bb, lrb->output,
-                     "<D:comment%s>%s</D:comment>" DEBUG_CR, encoding_str,
-                     apr_xml_quote_string(scratch_pool,
-                                          svn_xml_fuzzy_escape(value->data,
-                                                               iterpool), 0)));
+            {
+              element = "D:comment";
+              value = svn_string_create(svn_xml_fuzzy_escape(value->data,
+                                                             iterpool),
+                                        iterpool);
+            }
           else
-            SVN_ERR(dav_svn__brigade_printf
-                    (lrb->bb, lrb->output,
-                     "<S:revprop name=\"%s\"%s>%s</S:revprop>" DEBUG_CR,
-                     apr_xml_quote_string(iterpool, name, 0), encoding_str,
-                     apr_xml_quote_string(iterpool, value->data, 0)));
+            element = NULL;
+
+          if (element)
+            {
+              SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<", element,
+                                              encoding_str, ">", SVN_VA_NULL));
+              SVN_ERR(svn_xml__writer_cdata(lrb->xw, value->data,
+                                            value->len));
+              SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "</", element,
+                                              ">" DEBUG_CR, SVN_VA_NULL));
+            }
+          else
+            {
+              SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<S:revprop name=\"",
+                                              SVN_VA_NULL));
+              SVN_ERR(svn_xml__writer_attr(lrb->xw, name));
+              SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "\"", encoding_str, ">",
+                                              SVN_VA_NULL));
+              SVN_ERR(svn_xml__writer_cdata(lrb->xw, value->data,
+                                            value->len));
+              SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "</S:revprop>" DEBUG_CR,
+                                              SVN_VA_NULL));
+            }
         }
 
       svn_pool_destroy(iterpool);
@@ -312,16 +327,17 @@ log_revision_receiver(void *baton,
 
   if (log_entry->has_children)
     {
-      SVN_ERR(dav_svn__brigade_puts(lrb->bb, lrb->output, "<S:has-children/>"));
+      SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<S:has-children/>",
+                                      SVN_VA_NULL));
       lrb->stack_depth++;
     }
 
   if (log_entry->subtractive_merge)
-    SVN_ERR(dav_svn__brigade_puts(lrb->bb, lrb->output,
-                                  "<S:subtractive-merge/>"));
+    SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "<S:subtractive-merge/>",
+                                    SVN_VA_NULL));
 
-  SVN_ERR(dav_svn__brigade_puts(lrb->bb, lrb->output,
-                                "</S:log-item>" DEBUG_CR));
+  SVN_ERR(svn_xml__writer_putstrs(lrb->xw, "</S:log-item>" DEBUG_CR,
+                                  SVN_VA_NULL));
 
   /* In general APR will flush the brigade every 8000 bytes through the filter
      stack, but log items may not be generated that fast, especially in
@@ -340,6 +356,8 @@ log_revision_receiver(void *baton,
          this adds a flush frame before flushing the brigade, to make output
          filters perform a flush as well */
 
+      SVN_ERR(svn_xml__writer_flush(lrb->xw));
+
       /* No brigade empty check. We want output filters to flush anyway */
       bkt = apr_bucket_flush_create(
                 dav_svn__output_get_bucket_alloc(lrb->output));
@@ -491,6 +509,7 @@ dav_svn__log_report(const dav_resource *resource,
   lrb.bb = apr_brigade_create(resource->pool,  /* not the subpool! */
                               dav_svn__output_get_bucket_alloc(output));
   lrb.output = output;
+  lrb.xw = dav_svn__xml_writer_create(lrb.bb, output, resource->pool);
   lrb.needs_header = TRUE;
   lrb.needs_log_item = TRUE;
   lrb.stack_depth = 0;
@@ -536,8 +555,8 @@ dav_svn__log_report(const dav_resource *resource,
       goto cleanup;
     }
 
-  if ((serr = dav_svn__brigade_puts(lrb.bb, lrb.output,
-                                    "</S:log-report>" DEBUG_CR)))
+  if ((serr = svn_xml__writer_putstrs(lrb.xw, "</S:log-report>" DEBUG_CR,
+                                      SVN_VA_NULL)))
     {
       derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
                                   "Error ending REPORT response.",
@@ -547,6 +566,14 @@ dav_svn__log_report(const dav_resource *resource,
 
  cleanup:
 
+  /* Whatever we generated goes out before the error, if any. */
+  if ((serr = svn_xml__writer_flush(lrb.xw)) && !derr)
+    derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Error ending REPORT response.",
+                                resource->pool);
+  else
+    svn_error_clear(serr);
+
   dav_svn__operational_log(resource->info,
                            svn_log__log(paths, start, end, limit,
                                         discover_changed_paths,
@@ -39,9 +39,11 @@
 #include "svn_path.h"
 #include "svn_dav.h"
 #include "svn_props.h"
+#include "svn_string.h"
 
 #include "private/svn_log.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
 
 #include "../dav_svn.h"
 
@@ -70,6 +72,9 @@ typedef struct update_ctx_t {
   /* where to deliver the output */
   dav_svn__output *output;
 
+  /* collects the XML we generate before it goes to BB */
+  svn_xml__writer_t *xw;
+
   /* where do these editor paths *really* point to? */
   apr_hash_t *pathmap;
 
@@ -96,6 +101,12 @@ typedef struct update_ctx_t {
      resource" and are we advertising support for as much? */
   svn_boolean_t enable_v2_response;
 
+  /* If non-zero, we only send the text deltas of the files in partition
+     PARTITION_INDEX out of PARTITION_COUNT (see
+     SVN_DAV_UPDATE_PARTITION_HEADER) instead of the report itself. */
+  int partition_count;
+  int partition_index;
+
 } update_ctx_t;
 
 
@@ -262,10 +273,10 @@ send_vsn_url(item_baton_t *baton, apr_pool_t *pool)
                                 revision, path, FALSE /* add_href */, pool);
     }
 
-  return dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                 "<D:checked-in><D:href>%s</D:href>"
-                                 "</D:checked-in>" DEBUG_CR,
-                                 apr_xml_quote_string(pool, href, 1));
+  return svn_xml__writer_printf(baton->uc->xw,
+                                "<D:checked-in><D:href>%s</D:href>"
+                                "</D:checked-in>" DEBUG_CR,
+                                apr_xml_quote_string(pool, href, 1));
 }
 
 
@@ -279,8 +290,8 @@ absent_helper(svn_boolean_t is_dir,
 
   if (! uc->resource_walk)
     {
-      SVN_ERR(dav_svn__brigade_printf
-              (uc->bb, uc->output,
+      SVN_ERR(svn_xml__writer_printf
+              (uc->xw,
                "<S:absent-%s name=\"%s\"/>" DEBUG_CR,
                DIR_OR_FILE(is_dir),
                apr_xml_quote_string(pool,
@@ -323,10 +334,10 @@ add_helper(svn_boolean_t is_dir,
 
   if (uc->resource_walk)
     {
-      SVN_ERR(dav_svn__brigade_printf(child->uc->bb, child->uc->output,
-                                      "<S:resource path=\"%s\">" DEBUG_CR,
-                                      apr_xml_quote_string(pool, child->path3,
-                                                           1)));
+      SVN_ERR(svn_xml__writer_printf(child->uc->xw,
+                                     "<S:resource path=\"%s\">" DEBUG_CR,
+                                     apr_xml_quote_string(pool, child->path3,
+                                                          1)));
     }
   else
     {
@@ -398,19 +409,19 @@ add_helper(svn_boolean_t is_dir,
         }
 
       /* Resist the temptation to use 'elt' as a format string (to the
-         likes of dav_svn__brigade_printf).  Because it contains URIs,
+         likes of svn_xml__writer_printf).  Because it contains URIs,
          it might have sequences that look like format string insert
          placeholders.  For example, "this%20dir" is a valid printf()
          format string that means "this[insert an integer of width 20
          here]ir". */
-      SVN_ERR(dav_svn__brigade_puts(child->uc->bb, child->uc->output, elt));
+      SVN_ERR(svn_xml__writer_putstrs(child->uc->xw, elt, SVN_VA_NULL));
     }
 
   SVN_ERR(send_vsn_url(child, pool));
 
   if (uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_puts(child->uc->bb, child->uc->output,
-                                  "</S:resource>" DEBUG_CR));
+    SVN_ERR(svn_xml__writer_putstrs(child->uc->xw, "</S:resource>" DEBUG_CR,
+                                    SVN_VA_NULL));
 
   *child_baton = child;
 
@@ -429,10 +440,10 @@ open_helper(svn_boolean_t is_dir,
   item_baton_t *child = make_child_baton(parent, path, pool);
   const char *qname = apr_xml_quote_string(pool, child->name, 1);
 
-  SVN_ERR(dav_svn__brigade_printf(child->uc->bb, child->uc->output,
-                                  "<S:open-%s name=\"%s\""
-                                  " rev=\"%ld\">" DEBUG_CR,
-                                  DIR_OR_FILE(is_dir), qname, base_revision));
+  SVN_ERR(svn_xml__writer_printf(child->uc->xw,
+                                 "<S:open-%s name=\"%s\""
+                                 " rev=\"%ld\">" DEBUG_CR,
+                                 DIR_OR_FILE(is_dir), qname, base_revision));
   SVN_ERR(send_vsn_url(child, pool));
   *child_baton = child;
   return SVN_NO_ERROR;
@@ -456,21 +467,21 @@ close_helper(svn_boolean_t is_dir, item_baton_t *baton, apr_pool_t *pool)
         {
           qname = APR_ARRAY_IDX(baton->removed_props, i, const char *);
           qname = apr_xml_quote_string(pool, qname, 1);
-          SVN_ERR(dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                          "<S:remove-prop name=\"%s\"/>"
-                                          DEBUG_CR, qname));
+          SVN_ERR(svn_xml__writer_printf(baton->uc->xw,
+                                         "<S:remove-prop name=\"%s\"/>"
+                                         DEBUG_CR, qname));
         }
     }
 
   /* Let's tie it off, nurse. */
   if (baton->added)
-    SVN_ERR(dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                    "</S:add-%s>" DEBUG_CR,
-                                    DIR_OR_FILE(is_dir)));
+    SVN_ERR(svn_xml__writer_printf(baton->uc->xw,
+                                   "</S:add-%s>" DEBUG_CR,
+                                   DIR_OR_FILE(is_dir)));
   else
-    SVN_ERR(dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                    "</S:open-%s>" DEBUG_CR,
-                                    DIR_OR_FILE(is_dir)));
+    SVN_ERR(svn_xml__writer_printf(baton->uc->xw,
+                                   "</S:open-%s>" DEBUG_CR,
+                                   DIR_OR_FILE(is_dir)));
   return SVN_NO_ERROR;
 }
 
@@ -480,10 +491,21 @@ close_helper(svn_boolean_t is_dir, item_baton_t *baton, apr_pool_t *pool)
 static svn_error_t *
 maybe_start_update_report(update_ctx_t *uc)
 {
-  if ((! uc->resource_walk) && (! uc->started_update))
+  if (uc->partition_count && (! uc->started_update))
+    {
+      SVN_ERR(svn_xml__writer_printf(
+                  uc->xw,
+                  DAV_XML_HEADER DEBUG_CR "<S:update-partition xmlns:S=\""
+                  SVN_XML_NAMESPACE "\" index=\"%d\" count=\"%d\">"
+                  DEBUG_CR,
+                  uc->partition_index, uc->partition_count));
+
+      uc->started_update = TRUE;
+    }
+  else if ((! uc->resource_walk) && (! uc->started_update))
     {
-      SVN_ERR(dav_svn__brigade_printf(
-                  uc->bb, uc->output,
+      SVN_ERR(svn_xml__writer_printf(
+                  uc->xw,
                   DAV_XML_HEADER DEBUG_CR "<S:update-report xmlns:S=\""
                   SVN_XML_NAMESPACE "\" xmlns:V=\"" SVN_DAV_PROP_NS_DAV "\" "
                   "xmlns:D=\"DAV:\" %s %s>" DEBUG_CR,
@@ -507,9 +529,9 @@ upd_set_target_revision(void *edit_baton,
   SVN_ERR(maybe_start_update_report(uc));
 
   if (! uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_printf(uc->bb, uc->output,
-                                    "<S:target-revision rev=\"%ld\"/>"
-                                    DEBUG_CR, target_revision));
+    SVN_ERR(svn_xml__writer_printf(uc->xw,
+                                   "<S:target-revision rev=\"%ld\"/>"
+                                   DEBUG_CR, target_revision));
 
   return SVN_NO_ERROR;
 }
@@ -538,13 +560,13 @@ upd_open_root(void *edit_baton,
   SVN_ERR(maybe_start_update_report(uc));
 
   if (uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_printf(uc->bb, uc->output,
-                                    "<S:resource path=\"%s\">" DEBUG_CR,
-                                    apr_xml_quote_string(pool, b->path3, 1)));
+    SVN_ERR(svn_xml__writer_printf(uc->xw,
+                                   "<S:resource path=\"%s\">" DEBUG_CR,
+                                   apr_xml_quote_string(pool, b->path3, 1)));
   else
-    SVN_ERR(dav_svn__brigade_printf(uc->bb, uc->output,
-                                    "<S:open-directory rev=\"%ld\">" DEBUG_CR,
-                                    base_revision));
+    SVN_ERR(svn_xml__writer_printf(uc->xw,
+                                   "<S:open-directory rev=\"%ld\">" DEBUG_CR,
+                                   base_revision));
 
   /* Only transmit the root directory's Version Resource URL if
      there's no target. */
@@ -552,8 +574,8 @@ upd_open_root(void *edit_baton,
     SVN_ERR(send_vsn_url(b, pool));
 
   if (uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_puts(uc->bb, uc->output,
-                                  "</S:resource>" DEBUG_CR));
+    SVN_ERR(svn_xml__writer_putstrs(uc->xw, "</S:resource>" DEBUG_CR,
+                                    SVN_VA_NULL));
 
   return SVN_NO_ERROR;
 }
@@ -569,9 +591,9 @@ upd_delete_entry(const char *path,
   const char *qname = apr_xml_quote_string(pool,
                                            svn_relpath_basename(path, NULL),
                                            1);
-  return dav_svn__brigade_printf(parent->uc->bb, parent->uc->output,
-                                 "<S:delete-entry name=\"%s\" rev=\"%ld\"/>"
-                                   DEBUG_CR, qname, revision);
+  return svn_xml__writer_printf(parent->uc->xw,
+                                "<S:delete-entry name=\"%s\" rev=\"%ld\"/>"
+                                  DEBUG_CR, qname, revision);
 }
 
 
@@ -621,29 +643,29 @@ send_propchange(item_baton_t *b,
           svn_stringbuf_t *tmp = NULL;
           svn_xml_escape_cdata_string(&tmp, value, pool);
           qval = tmp->data;
-          SVN_ERR(dav_svn__brigade_printf(b->uc->bb, b->uc->output,
-                                          "<S:set-prop name=\"%s\">",
-                                          qname));
+          SVN_ERR(svn_xml__writer_printf(b->uc->xw,
+                                         "<S:set-prop name=\"%s\">",
+                                         qname));
         }
       else
         {
           qval = svn_base64_encode_string2(value, TRUE, pool)->data;
-          SVN_ERR(dav_svn__brigade_printf(b->uc->bb, b->uc->output,
-                                          "<S:set-prop name=\"%s\" "
-                                          "encoding=\"base64\">" DEBUG_CR,
-                                          qname));
+          SVN_ERR(svn_xml__writer_printf(b->uc->xw,
+                                         "<S:set-prop name=\"%s\" "
+                                         "encoding=\"base64\">" DEBUG_CR,
+                                         qname));
         }
 
-      SVN_ERR(dav_svn__brigade_puts(b->uc->bb, b->uc->output, qval));
-      SVN_ERR(dav_svn__brigade_puts(b->uc->bb, b->uc->output,
-                                    "</S:set-prop>" DEBUG_CR));
+      SVN_ERR(svn_xml__writer_putstrs(b->uc->xw, qval, SVN_VA_NULL));
+      SVN_ERR(svn_xml__writer_putstrs(b->uc->xw, "</S:set-prop>" DEBUG_CR,
+                                      SVN_VA_NULL));
     }
   else  /* value is null, so this is a prop removal */
     {
-      SVN_ERR(dav_svn__brigade_printf(b->uc->bb, b->uc->output,
-                                      "<S:remove-prop name=\"%s\"/>"
-                                      DEBUG_CR,
-                                      qname));
+      SVN_ERR(svn_xml__writer_printf(b->uc->xw,
+                                     "<S:remove-prop name=\"%s\"/>"
+                                     DEBUG_CR,
+                                     qname));
     }
 
   return SVN_NO_ERROR;
@@ -749,6 +771,17 @@ upd_open_file(const char *path,
 }
 
 
+/* Return TRUE iff FILE belongs to the partition of the update that we
+   are asked to send.  Keep in sync with the client's choice. */
+static svn_boolean_t
+in_partition(const item_baton_t *file)
+{
+  apr_uint32_t hash = svn__fnv1a_32(file->path3, strlen(file->path3));
+
+  return (hash % file->uc->partition_count) == file->uc->partition_index;
+}
+
+
 /* We have our own window handler and baton as a simple wrapper around
    the real handler (which converts txdelta windows to base64-encoded
    svndiff data).  The wrapper is responsible for sending the opening
@@ -760,6 +793,14 @@ struct window_handler_baton
 
   const char *base_checksum; /* For transfer as part of the S:txdelta element */
 
+  /* The file's XML-quoted editor relpath in partition mode, NULL
+     otherwise. */
+  const char *path;
+
+  /* The SHA1 checksum of the file's new contents in partition mode,
+     if readily available, so the client can skip contents it has. */
+  const char *sha1_checksum;
+
   /* The _real_ window handler and baton. */
   svn_txdelta_window_handler_t handler;
   void *handler_baton;
@@ -776,21 +817,35 @@ window_handler(svn_txdelta_window_t *window, void *baton)
     {
       wb->seen_first_window = TRUE;
 
-      if (!wb->base_checksum)
-        SVN_ERR(dav_svn__brigade_puts(wb->uc->bb, wb->uc->output,
-                                      "<S:txdelta>"));
+      if (wb->path)
+        SVN_ERR(svn_xml__writer_printf(wb->uc->xw,
+                                       "<S:txdelta path=\"%s\"%s%s%s%s%s%s>",
+                                       wb->path,
+                                       wb->base_checksum
+                                         ? " base-checksum=\"" : "",
+                                       wb->base_checksum
+                                         ? wb->base_checksum : "",
+                                       wb->base_checksum ? "\"" : "",
+                                       wb->sha1_checksum
+                                         ? " sha1-checksum=\"" : "",
+                                       wb->sha1_checksum
+                                         ? wb->sha1_checksum : "",
+                                       wb->sha1_checksum ? "\"" : ""));
+      else if (!wb->base_checksum)
+        SVN_ERR(svn_xml__writer_putstrs(wb->uc->xw, "<S:txdelta>",
+                                        SVN_VA_NULL));
       else
-        SVN_ERR(dav_svn__brigade_printf(wb->uc->bb, wb->uc->output,
-                                        "<S:txdelta base-checksum=\"%s\">",
-                                        wb->base_checksum));
+        SVN_ERR(svn_xml__writer_printf(wb->uc->xw,
+                                       "<S:txdelta base-checksum=\"%s\">",
+                                       wb->base_checksum));
     }
 
   SVN_ERR(wb->handler(window, wb->handler_baton));
 
   if (window == NULL)
     {
-      SVN_ERR(dav_svn__brigade_puts(wb->uc->bb, wb->uc->output,
-                                    "</S:txdelta>"));
+      SVN_ERR(svn_xml__writer_putstrs(wb->uc->xw, "</S:txdelta>",
+                                      SVN_VA_NULL));
     }
 
   return SVN_NO_ERROR;
@@ -812,8 +867,12 @@ upd_apply_textdelta(void *file_baton,
   file->text_changed = TRUE;
 
   /* If this is a resource walk, or if we're not in "send-all" mode,
-     we don't actually want to transmit text-deltas. */
-  if (file->uc->resource_walk || (! file->uc->send_all))
+     we don't actually want to transmit text-deltas.  The same goes for
+     files outside the partition we are asked for. */
+  if (file->uc->resource_walk
+      || (file->uc->partition_count
+          ? (! in_partition(file))
+          : (! file->uc->send_all)))
     {
       *handler = svn_delta_noop_window_handler;
       *handler_baton = NULL;
@@ -824,9 +883,25 @@ upd_apply_textdelta(void *file_baton,
   wb->seen_first_window = FALSE;
   wb->uc = file->uc;
   wb->base_checksum = file->base_checksum;
-  base64_stream = dav_svn__make_base64_output_stream(wb->uc->bb,
-                                                     wb->uc->output,
-                                                     file->pool);
+  wb->path = NULL;
+  wb->sha1_checksum = NULL;
+  if (file->uc->partition_count)
+    {
+      svn_checksum_t *sha1_checksum;
+
+      wb->path = apr_xml_quote_string(file->pool, file->path3, 1);
+
+      SVN_ERR(svn_fs_file_checksum(&sha1_checksum, svn_checksum_sha1,
+                                   file->uc->rev_root,
+                                   get_real_fs_path(file, pool),
+                                   FALSE, pool));
+      if (sha1_checksum)
+        wb->sha1_checksum = svn_checksum_to_cstring(sha1_checksum,
+                                                    file->pool);
+    }
+  base64_stream = svn_base64_encode2(svn_xml__writer_stream(wb->uc->xw,
+                                                            file->pool),
+                                     FALSE, file->pool);
 
   svn_txdelta_to_svndiff3(&(wb->handler), &(wb->handler_baton),
                           base64_stream, file->uc->svndiff_version,
@@ -860,8 +935,8 @@ upd_close_file(void *file_baton, const char *text_checksum, apr_pool_t *pool)
       if (sha1_checksum)
         sha1_digest = svn_checksum_to_cstring(sha1_checksum, pool);
 
-      SVN_ERR(dav_svn__brigade_printf
-              (file->uc->bb, file->uc->output,
+      SVN_ERR(svn_xml__writer_printf
+              (file->uc->xw,
                "<S:fetch-file%s%s%s%s%s%s/>" DEBUG_CR,
                file->base_checksum ? " base-checksum=\"" : "",
                file->base_checksum ? file->base_checksum : "",
@@ -873,11 +948,11 @@ upd_close_file(void *file_baton, const char *text_checksum, apr_pool_t *pool)
 
   if (text_checksum)
     {
-      SVN_ERR(dav_svn__brigade_printf(file->uc->bb, file->uc->output,
-                                      "<S:prop>"
-                                      "<V:md5-checksum>%s</V:md5-checksum>"
-                                      "</S:prop>",
-                                      text_checksum));
+      SVN_ERR(svn_xml__writer_printf(file->uc->xw,
+                                     "<S:prop>"
+                                     "<V:md5-checksum>%s</V:md5-checksum>"
+                                     "</S:prop>",
+                                     text_checksum));
     }
 
   return close_helper(FALSE /* is_dir */, file, pool);
@@ -895,6 +970,98 @@ upd_close_edit(void *edit_baton, apr_pool_t *pool)
 }
 
 
+/* Partition mode editor callbacks.  These only track the paths of the
+   edit; upd_apply_textdelta() sends the contents in our partition. */
+static svn_error_t *
+part_open_root(void *edit_baton,
+               svn_revnum_t base_revision,
+               apr_pool_t *pool,
+               void **root_baton)
+{
+  update_ctx_t *uc = edit_baton;
+  item_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+
+  b->uc = uc;
+  b->pool = pool;
+  b->path = uc->anchor;
+  b->path2 = uc->dst_path;
+  b->path3 = "";
+
+  *root_baton = b;
+
+  return maybe_start_update_report(uc);
+}
+
+
+static svn_error_t *
+part_add_item(const char *path,
+              void *parent_baton,
+              const char *copyfrom_path,
+              svn_revnum_t copyfrom_revision,
+              apr_pool_t *pool,
+              void **child_baton)
+{
+  *child_baton = make_child_baton(parent_baton, path, pool);
+  return SVN_NO_ERROR;
+}
+
+
+static svn_error_t *
+part_open_item(const char *path,
+               void *parent_baton,
+               svn_revnum_t base_revision,
+               apr_pool_t *pool,
+               void **child_baton)
+{
+  *child_baton = make_child_baton(parent_baton, path, pool);
+  return SVN_NO_ERROR;
+}
+
+
+/* Parse the value VAL of the SVN_DAV_UPDATE_PARTITION_HEADER into UC and
+   *REVNUM.  Use RESOURCE for error reporting. */
+static dav_error *
+parse_partition_header(update_ctx_t *uc,
+                       svn_revnum_t *revnum,
+                       const char *val,
+                       const dav_resource *resource)
+{
+  apr_array_header_t *tokens = svn_cstring_split(val, " ", TRUE,
+                                                 resource->pool);
+  int index = -1;
+  int count = 0;
+  svn_error_t *serr = NULL;
+
+  if (tokens->nelts == 3)
+    {
+      serr = svn_cstring_atoi(&index, APR_ARRAY_IDX(tokens, 0, const char *));
+      if (! serr)
+        serr = svn_cstring_atoi(&count,
+                                APR_ARRAY_IDX(tokens, 1, const char *));
+    }
+
+  if (serr || tokens->nelts != 3
+      || count < 1 || count > 64 || index < 0 || index >= count)
+    {
+      svn_error_clear(serr);
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request's update partition header "
+                                    "is malformed.");
+    }
+
+  *revnum = SVN_STR_TO_REV(APR_ARRAY_IDX(tokens, 2, const char *));
+  if (! SVN_IS_VALID_REVNUM(*revnum))
+    return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                  "The request's update partition header "
+                                  "lacks a valid revision.");
+
+  uc->partition_index = index;
+  uc->partition_count = count;
+
+  return NULL;
+}
+
+
 /* Return a specific error associated with the contents of TAGNAME
    being malformed.  Use pool for allocations.  */
 static dav_error *
@@ -979,6 +1146,7 @@ dav_svn__update_report(const dav_resource *resource,
   svn_boolean_t resource_walk = FALSE;
   svn_boolean_t ignore_ancestry = FALSE;
   svn_boolean_t send_copyfrom_args = FALSE;
+  svn_revnum_t partition_revnum = SVN_INVALID_REVNUM;
   dav_svn__authz_read_baton arb;
   apr_pool_t *subpool = svn_pool_create(resource->pool);
 
@@ -1013,6 +1181,7 @@ dav_svn__update_report(const dav_resource *resource,
       repos->bulk_updates == CONF_BULKUPD_PREFER)
     {
       apr_xml_attr *this_attr;
+      const char *partition_hdr;
 
       for (this_attr = doc->root->attr; this_attr; this_attr = this_attr->next)
         {
@@ -1024,6 +1193,24 @@ dav_svn__update_report(const dav_resource *resource,
               break;
             }
         }
+
+      /* A partition request wants a share of the file contents only;
+         the client gets everything else from a skelta report.  Where we
+         don't offer partitions, we ignore the header and the client
+         falls back to GET requests. */
+      partition_hdr = apr_table_get(resource->info->r->headers_in,
+                                    SVN_DAV_UPDATE_PARTITION_HEADER);
+      if (partition_hdr
+          && dav_svn__get_update_partitions_flag(resource->info->r))
+        {
+          derr = parse_partition_header(&uc, &partition_revnum,
+                                        partition_hdr, resource);
+          if (derr)
+            return derr;
+
+          uc.send_all = FALSE;
+          uc.include_props = FALSE;
+        }
     }
 
   /* Ask the repository about its youngest revision (which we'll need
@@ -1166,6 +1353,14 @@ dav_svn__update_report(const dav_resource *resource,
         }
     }
 
+  /* Partition requests must see the same tree as the report they
+     accompany. */
+  if (uc.partition_count)
+    {
+      revnum = partition_revnum;
+      resource_walk = FALSE;
+    }
+
   /* If a target revision wasn't requested, or the requested target
      revision was invalid, just update to HEAD as of the moment we
      queried the youngest revision.  Otherwise, at least make sure the
@@ -1204,6 +1399,7 @@ dav_svn__update_report(const dav_resource *resource,
   uc.target = target;
   uc.bb = apr_brigade_create(resource->pool,
                              dav_svn__output_get_bucket_alloc(output));
+  uc.xw = dav_svn__xml_writer_create(uc.bb, output, resource->pool);
   uc.pathmap = NULL;
   uc.enable_v2_response = ((resource->info->restype == DAV_SVN_RESTYPE_ME)
                            && (resource->info->repos->v2_protocol));
@@ -1244,8 +1440,9 @@ dav_svn__update_report(const dav_resource *resource,
 
   /* If the client did *not* request 'send-all' mode, then we will be
      sending only a "skelta" of the difference, which will not need to
-     contain actual text deltas. */
-  if (! uc.send_all)
+     contain actual text deltas.  Partitions are all about the text
+     deltas, though. */
+  if (! uc.send_all && ! uc.partition_count)
     text_deltas = FALSE;
 
   /* When we call svn_repos_finish_report, it will ultimately run
@@ -1253,21 +1450,35 @@ dav_svn__update_report(const dav_resource *resource,
      case of an update or status, these paths should be identical.  In
      the case of a switch, they should be different. */
   editor = svn_delta_default_editor(resource->pool);
-  editor->set_target_revision = upd_set_target_revision;
-  editor->open_root = upd_open_root;
-  editor->delete_entry = upd_delete_entry;
-  editor->add_directory = upd_add_directory;
-  editor->open_directory = upd_open_directory;
-  editor->change_dir_prop = upd_change_xxx_prop;
-  editor->close_directory = upd_close_directory;
-  editor->absent_directory = upd_absent_directory;
-  editor->add_file = upd_add_file;
-  editor->open_file = upd_open_file;
-  editor->apply_textdelta = upd_apply_textdelta;
-  editor->change_file_prop = upd_change_xxx_prop;
-  editor->close_file = upd_close_file;
-  editor->absent_file = upd_absent_file;
-  editor->close_edit = upd_close_edit;
+  if (uc.partition_count)
+    {
+      /* Only the text deltas in our partition go out on the wire. */
+      editor->open_root = part_open_root;
+      editor->add_directory = part_add_item;
+      editor->open_directory = part_open_item;
+      editor->add_file = part_add_item;
+      editor->open_file = part_open_item;
+      editor->apply_textdelta = upd_apply_textdelta;
+      editor->close_edit = upd_close_edit;
+    }
+  else
+    {
+      editor->set_target_revision = upd_set_target_revision;
+      editor->open_root = upd_open_root;
+      editor->delete_entry = upd_delete_entry;
+      editor->add_directory = upd_add_directory;
+      editor->open_directory = upd_open_directory;
+      editor->change_dir_prop = upd_change_xxx_prop;
+      editor->close_directory = upd_close_directory;
+      editor->absent_directory = upd_absent_directory;
+      editor->add_file = upd_add_file;
+      editor->open_file = upd_open_file;
+      editor->apply_textdelta = upd_apply_textdelta;
+      editor->change_file_prop = upd_change_xxx_prop;
+      editor->close_file = upd_close_file;
+      editor->absent_file = upd_absent_file;
+      editor->close_edit = upd_close_edit;
+    }
   if ((serr = svn_repos_begin_report3(&rbaton, revnum,
                                       repos->repos,
                                       src_path, target,
@@ -1499,8 +1710,8 @@ dav_svn__update_report(const dav_resource *resource,
           goto cleanup;
         }
 
-      serr = dav_svn__brigade_puts(uc.bb, uc.output,
-                                   "<S:resource-walk>" DEBUG_CR);
+      serr = svn_xml__writer_putstrs(uc.xw, "<S:resource-walk>" DEBUG_CR,
+                                     SVN_VA_NULL);
       if (serr)
         {
           derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
@@ -1533,8 +1744,8 @@ dav_svn__update_report(const dav_resource *resource,
           goto cleanup;
         }
 
-      serr = dav_svn__brigade_puts(uc.bb, uc.output,
-                                   "</S:resource-walk>" DEBUG_CR);
+      serr = svn_xml__writer_putstrs(uc.xw, "</S:resource-walk>" DEBUG_CR,
+                                     SVN_VA_NULL);
       if (serr)
         {
           derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
@@ -1548,8 +1759,11 @@ dav_svn__update_report(const dav_resource *resource,
      started in the first place. */
   if (uc.started_update)
     {
-      if ((serr = dav_svn__brigade_puts(uc.bb, uc.output,
-                                        "</S:update-report>" DEBUG_CR)))
+      if ((serr = svn_xml__writer_putstrs(uc.xw,
+                                          uc.partition_count
+                                            ? "</S:update-partition>" DEBUG_CR
+                                            : "</S:update-report>" DEBUG_CR,
+                                          SVN_VA_NULL)))
         {
           derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
                                       "Unable to complete update report.",
@@ -1560,6 +1774,14 @@ dav_svn__update_report(const dav_resource *resource,
 
  cleanup:
 
+  /* Whatever we generated goes out before the error, if any. */
+  if ((serr = svn_xml__writer_flush(uc.xw)) && !derr)
+    derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Unable to complete update report.",
+                                resource->pool);
+  else
+    svn_error_clear(serr);
+
   /* If an error was produced EITHER by the dir_delta drive or the
      resource-walker, abort the report. */
   if (derr && rbaton)
@@ -692,6 +692,33 @@ dav_svn__make_base64_output_stream(apr_bucket_brigade *bb,
   return svn_base64_encode2(stream, FALSE, pool);
 }
 
+
+/* This implements 'svn_write_fn_t' for dav_svn__xml_writer_create(). */
+static svn_error_t *
+xml_writer_write_fn(void *baton, const char *data, apr_size_t *len)
+{
+  struct brigade_write_baton *wb = baton;
+
+  return svn_error_trace(dav_svn__brigade_write(wb->bb, wb->output,
+                                                data, *len));
+}
+
+
+svn_xml__writer_t *
+dav_svn__xml_writer_create(apr_bucket_brigade *bb,
+                           dav_svn__output *output,
+                           apr_pool_t *pool)
+{
+  struct brigade_write_baton *wb = apr_palloc(pool, sizeof(*wb));
+  svn_stream_t *stream = svn_stream_create(wb, pool);
+
+  wb->bb = bb;
+  wb->output = output;
+  svn_stream_set_write(stream, xml_writer_write_fn);
+
+  return svn_xml__writer_create(stream, pool);
+}
+
 void
 dav_svn__operational_log(struct dav_resource_private *info, const char *line)
 {
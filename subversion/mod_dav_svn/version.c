@@ -336,6 +336,12 @@ get_option(const dav_resource *resource,
                     bulk_upd_conf == CONF_BULKUPD_ON ? "On" :
                       bulk_upd_conf == CONF_BULKUPD_OFF ? "Off" : "Prefer");
 
+      /* Partitioned update REPORTs push file contents in bulk and are
+         opt-in (SVNAllowUpdatePartitions). */
+      if (dav_svn__get_update_partitions_flag(r))
+        apr_table_addn(r->headers_out, "DAV",
+                       SVN_DAV_NS_DAV_SVN_UPDATE_PARTITIONS);
+
       /* Report the supported POST types. */
       for (i = 0; i < sizeof(posts_versions)/sizeof(posts_versions[0]); ++i)
         {
@@ -345,7 +345,8 @@ init_client_context(svn_client_ctx_t **ctx_p,
      ### options in order to get ra_serf to try a bulk-update if the
      ### server will allow it, or at least try to limit all its
      ### auxiliary GETs/PROPFINDs to happening (well-ordered) on a
-     ### single server connection.
+     ### single server connection.  The latter also rules out http/2,
+     ### which multiplexes responses in no particular order.
      ###
      ### See https://issues.apache.org/jira/browse/SVN-4116.
   */
@@ -354,6 +355,8 @@ init_client_context(svn_client_ctx_t **ctx_p,
                       SVN_CONFIG_OPTION_HTTP_BULK_UPDATES, TRUE);
   svn_config_set_int64(cfg_servers, SVN_CONFIG_SECTION_GLOBAL,
                        SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS, 2);
+  svn_config_set_bool(cfg_servers, SVN_CONFIG_SECTION_GLOBAL,
+                      SVN_CONFIG_OPTION_HTTP_HTTP2, FALSE);
   if (cfg_servers)
     {
       apr_status_t status;
@@ -372,6 +375,8 @@ init_client_context(svn_client_ctx_t **ctx_p,
                                   SVN_CONFIG_OPTION_HTTP_BULK_UPDATES, TRUE);
               svn_config_set_int64(cfg_servers, server_group,
                                    SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS, 2);
+              svn_config_set_bool(cfg_servers, server_group,
+                                  SVN_CONFIG_OPTION_HTTP_HTTP2, FALSE);
             }
         }
     }
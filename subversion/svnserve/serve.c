@@ -828,8 +828,12 @@ static svn_error_t *must_have_access(svn_ra_svn_conn_t *conn,
      authentication whether authz will work or not.  We force
      requiring a username because we need one to be able to check
      authz configuration again with a different user credentials than
-     the first time round. */
-  if (b->client_info->user == NULL
+     the first time round.
+
+     Within a batch, the client has already sent the following commands,
+     so it can't take part in an authentication exchange. */
+  if (!b->in_batch
+      && b->client_info->user == NULL
       && b->repository->auth_access >= req
       && (b->client_info->tunnel_user || b->repository->pwdb
           || b->repository->use_sasl))
@@ -1596,7 +1600,7 @@ get_file(svn_ra_svn_conn_t *conn,
   apr_hash_t *props = NULL;
   apr_array_header_t *inherited_props;
   svn_string_t write_str;
-  char buf[4096];
+  char *buf;
   apr_size_t len;
   svn_boolean_t want_props, want_contents;
   apr_uint64_t wants_inherited_props;
@@ -1679,10 +1683,12 @@ get_file(svn_ra_svn_conn_t *conn,
   /* Now send the file's contents. */
   if (want_contents)
     {
+      /* Use chunks large enough to bypass the connection's write buffer. */
+      buf = apr_palloc(pool, SVN__STREAM_CHUNK_SIZE);
       err = SVN_NO_ERROR;
       while (1)
         {
-          len = sizeof(buf);
+          len = SVN__STREAM_CHUNK_SIZE;
           err = svn_stream_read_full(contents, buf, &len);
           if (err)
             break;
@@ -1692,7 +1698,7 @@ get_file(svn_ra_svn_conn_t *conn,
               write_str.len = len;
               SVN_ERR(svn_ra_svn__write_string(conn, pool, &write_str));
             }
-          if (len < sizeof(buf))
+          if (len < SVN__STREAM_CHUNK_SIZE)
             {
               err = svn_stream_close(contents);
               break;
@@ -1956,15 +1962,17 @@ update(svn_ra_svn_conn_t *conn,
   svn_boolean_t recurse;
   svn_tristate_t send_copyfrom_args; /* Optional; default FALSE */
   svn_tristate_t ignore_ancestry; /* Optional; default FALSE */
+  svn_tristate_t text_deltas; /* Optional; default TRUE */
   /* Default to unknown.  Old clients won't send depth, but we'll
      handle that by converting recurse if necessary. */
   svn_depth_t depth = svn_depth_unknown;
   svn_boolean_t is_checkout;
 
   /* Parse the arguments. */
-  SVN_ERR(svn_ra_svn__parse_tuple(params, "(?r)cb?w3?3", &rev, &target,
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "(?r)cb?w3?33", &rev, &target,
                                   &recurse, &depth_word,
-                                  &send_copyfrom_args, &ignore_ancestry));
+                                  &send_copyfrom_args, &ignore_ancestry,
+                                  &text_deltas));
   SVN_ERR(svn_relpath_canonicalize_safe(&canonical_target, NULL, target,
                                         pool, pool));
   target = canonical_target;
@@ -1982,7 +1990,8 @@ update(svn_ra_svn_conn_t *conn,
     SVN_CMD_ERR(svn_fs_youngest_rev(&rev, b->repository->fs, pool));
 
   SVN_ERR(accept_report(&is_checkout, NULL,
-                        conn, pool, b, rev, target, NULL, TRUE,
+                        conn, pool, b, rev, target, NULL,
+                        (text_deltas != svn_tristate_false),
                         depth,
                         (send_copyfrom_args == svn_tristate_true),
                         (ignore_ancestry == svn_tristate_true)));
@@ -3780,6 +3789,103 @@ list(svn_ra_svn_conn_t *conn,
   return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
 }
 
+/* Commands that may be part of a batch.  All of them are read-only
+ * and their responses don't depend on the connection state. */
+static const svn_ra_svn__cmd_entry_t batch_commands[] = {
+  { "rev-proplist",    rev_proplist },
+  { "rev-prop",        rev_prop },
+  { "get-file",        get_file },
+  { "get-dir",         get_dir },
+  { "check-path",      check_path },
+  { "stat",            stat_cmd },
+  { "get-lock",        get_lock },
+  { NULL }
+};
+
+/* Process a list of commands as if the client had sent them one by one,
+ * i.e. send a full response for each of them.  Authentication takes
+ * place once, for the batch as a whole; commands that would require
+ * further authentication fail with an authorization error. */
+static svn_error_t *
+batch(svn_ra_svn_conn_t *conn,
+      apr_pool_t *pool,
+      svn_ra_svn__list_t *params,
+      void *baton)
+{
+  server_baton_t *b = baton;
+  svn_ra_svn__list_t *commands;
+  const svn_ra_svn__cmd_entry_t **handlers;
+  svn_ra_svn__list_t **cmd_params;
+  apr_pool_t *iterpool;
+  int i;
+
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "l", &commands));
+
+  /* Validate the whole batch before we send the first response. */
+  handlers = apr_palloc(pool, commands->nelts * sizeof(*handlers));
+  cmd_params = apr_palloc(pool, commands->nelts * sizeof(*cmd_params));
+  for (i = 0; i < commands->nelts; i++)
+    {
+      svn_ra_svn__item_t *item = &SVN_RA_SVN__LIST_ITEM(commands, i);
+      const char *cmdname;
+      const svn_ra_svn__cmd_entry_t *command;
+
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                "Batch entry is not a list");
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "wl",
+                                      &cmdname, &cmd_params[i]));
+
+      for (command = batch_commands; command->cmdname; command++)
+        if (strcmp(command->cmdname, cmdname) == 0)
+          break;
+
+      if (command->cmdname == NULL)
+        return svn_error_createf(SVN_ERR_RA_SVN_CMD_ERR,
+                                 svn_error_createf(
+                                   SVN_ERR_RA_SVN_UNKNOWN_CMD, NULL,
+                                   "Command '%s' can't be part of a batch",
+                                   cmdname),
+                                 NULL);
+      handlers[i] = command;
+    }
+
+  /* Give the client a chance to authenticate for the batch as a whole. */
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read, NULL, FALSE));
+
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < commands->nelts; i++)
+    {
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      b->in_batch = TRUE;
+      err = handlers[i]->handler(conn, iterpool, cmd_params[i], b);
+      b->in_batch = FALSE;
+
+      /* Command failures only affect the respective response. */
+      if (err && err->apr_err == SVN_ERR_RA_SVN_CMD_ERR)
+        {
+          svn_error_t *cmd_err = err;
+          svn_error_t *write_err;
+
+          while (cmd_err->child
+                 && cmd_err->apr_err == SVN_ERR_RA_SVN_CMD_ERR)
+            cmd_err = cmd_err->child;
+
+          write_err = svn_ra_svn__write_cmd_failure(conn, iterpool, cmd_err);
+          svn_error_clear(err);
+          err = write_err;
+        }
+
+      SVN_ERR(err);
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
 static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "reparent",        reparent },
   { "get-latest-rev",  get_latest_rev },
@@ -3813,6 +3919,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-deleted-rev", get_deleted_rev },
   { "get-iprops",      get_inherited_props },
   { "list",            list },
+  { "batch",           batch },
   { NULL }
 };
 
@@ -4202,44 +4309,40 @@ handle_authz_warning(void *baton,
   SVN_UNUSED(scratch_pool);
 }
 
-/* Construct the server baton for CONN using PARAMS and return it in *BATON.
- * It's lifetime is the same as that of CONN.  SCRATCH_POOL
+/* Send the server greeting for PARAMS over CONN.  Use SCRATCH_POOL for
+ * temporary allocations.
  */
 static svn_error_t *
-construct_server_baton(server_baton_t **baton,
-                       svn_ra_svn_conn_t *conn,
-                       serve_params_t *params,
-                       apr_pool_t *scratch_pool)
+send_greeting(svn_ra_svn_conn_t *conn,
+              serve_params_t *params,
+              apr_pool_t *scratch_pool)
 {
-  svn_error_t *err;
-  apr_uint64_t ver;
-  const char *client_url, *ra_client_string, *client_string, *canonical_url;
-  svn_ra_svn__list_t *caplist;
-  apr_pool_t *conn_pool = svn_ra_svn__get_pool(conn);
-  server_baton_t *b = apr_pcalloc(conn_pool, sizeof(*b));
-  fs_warning_baton_t *warn_baton;
-  svn_stringbuf_t *cap_log = svn_stringbuf_create_empty(scratch_pool);
-
-  b->repository = apr_pcalloc(conn_pool, sizeof(*b->repository));
-  b->repository->username_case = params->username_case;
-  b->repository->base = params->base;
-  b->repository->pwdb = NULL;
-  b->repository->authzdb = NULL;
-  b->repository->realm = NULL;
-  b->repository->use_sasl = FALSE;
-
-  b->read_only = params->read_only;
-  b->pool = conn_pool;
-  b->vhost = params->vhost;
-
-  b->logger = params->logger;
-  b->client_info = get_client_info(conn, params, conn_pool);
-
   /* Send greeting.  We don't support version 1 any more, so we can
-   * send an empty mechlist. */
-  if (params->compression_level > 0)
+   * send an empty mechlist.  Compressing the whole stream is opt-in
+   * because the file deltas, i.e. the bulk of the data, already are. */
+  if (params->compression_level > 0 && params->compress_stream)
+    SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
+                                           "nn()(wwwwwwwwwwwwwww)",
+                                           (apr_uint64_t) 2, (apr_uint64_t) 2,
+                                           SVN_RA_SVN_CAP_EDIT_PIPELINE,
+                                           SVN_RA_SVN_CAP_SVNDIFF1,
+                                           SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                           SVN_RA_SVN_CAP_ABSENT_ENTRIES,
+                                           SVN_RA_SVN_CAP_COMMIT_REVPROPS,
+                                           SVN_RA_SVN_CAP_DEPTH,
+                                           SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                           SVN_RA_SVN_CAP_ATOMIC_REVPROPS,
+                                           SVN_RA_SVN_CAP_PARTIAL_REPLAY,
+                                           SVN_RA_SVN_CAP_INHERITED_PROPS,
+                                           SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
+                                           SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BATCH,
+                                           SVN_RA_SVN_CAP_COMPRESSED_STREAM
+                                           ));
+  else if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -4253,11 +4356,12 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BATCH
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4269,9 +4373,47 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BATCH
                                            ));
 
+  return SVN_NO_ERROR;
+}
+
+/* Construct the server baton for CONN using PARAMS and return it in *BATON.
+ * The greeting must already have been sent using send_greeting().
+ * It's lifetime is the same as that of CONN.  SCRATCH_POOL
+ */
+static svn_error_t *
+construct_server_baton(server_baton_t **baton,
+                       svn_ra_svn_conn_t *conn,
+                       serve_params_t *params,
+                       apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+  apr_uint64_t ver;
+  const char *client_url, *ra_client_string, *client_string, *canonical_url;
+  svn_ra_svn__list_t *caplist;
+  apr_pool_t *conn_pool = svn_ra_svn__get_pool(conn);
+  server_baton_t *b = apr_pcalloc(conn_pool, sizeof(*b));
+  fs_warning_baton_t *warn_baton;
+  svn_stringbuf_t *cap_log = svn_stringbuf_create_empty(scratch_pool);
+
+  b->repository = apr_pcalloc(conn_pool, sizeof(*b->repository));
+  b->repository->username_case = params->username_case;
+  b->repository->base = params->base;
+  b->repository->pwdb = NULL;
+  b->repository->authzdb = NULL;
+  b->repository->realm = NULL;
+  b->repository->use_sasl = FALSE;
+
+  b->read_only = params->read_only;
+  b->pool = conn_pool;
+  b->vhost = params->vhost;
+
+  b->logger = params->logger;
+  b->client_info = get_client_info(conn, params, conn_pool);
+
   /* Read client response, which we assume to be in version 2 format:
    * version, capability list, and client URL; then we do an auth
    * request. */
@@ -4296,6 +4438,12 @@ construct_server_baton(server_baton_t **baton,
     return svn_error_create(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
                             "Missing edit-pipeline capability");
 
+  /* The client only announces this if we did, i.e. if we want to
+   * compress.  It expects everything from now on to be compressed. */
+  if (params->compression_level > 0 && params->compress_stream
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_COMPRESSED_STREAM))
+    SVN_ERR(svn_ra_svn__enable_compression(conn, scratch_pool));
+
   /* find_repos needs the capabilities as a list of words (eventually
      they get handed to the start-commit hook).  While we could add a
      new interface to re-retrieve them from conn and convert the
@@ -4476,12 +4624,29 @@ serve_interruptable(svn_boolean_t *terminate_p,
                                   connection->params->max_request_size,
                                   connection->params->max_response_size,
                                   connection->pool);
+      if (connection->params->read_timeout >= 0)
+        svn_ra_svn__set_read_timeout(connection->conn,
+                                     connection->params->read_timeout);
+
+      err = send_greeting(connection->conn, connection->params, pool);
 
-      /* Construct server baton and open the repository for the first time. */
-      err = construct_server_baton(&connection->baton, connection->conn,
-                                   connection->params, pool);
+      /* Under load, don't wait for the client's response but let the
+       * caller schedule the connection again once it arrived. */
+      if (!err && is_busy && is_busy(connection))
+        {
+          svn_pool_destroy(iterpool);
+          if (terminate_p)
+            *terminate_p = FALSE;
+
+          return SVN_NO_ERROR;
+        }
     }
 
+  /* Construct server baton and open the repository for the first time. */
+  if (!err && !connection->baton)
+    err = construct_server_baton(&connection->baton, connection->conn,
+                                 connection->params, pool);
+
   /* If we can't access the repo for some reason, end this connection. */
   if (err)
     terminate = TRUE;
@@ -4535,6 +4700,7 @@ svn_error_t *serve(svn_ra_svn_conn_t *conn,
 {
   server_baton_t *baton = NULL;
 
+  SVN_ERR(send_greeting(conn, params, pool));
   SVN_ERR(construct_server_baton(&baton, conn, params, pool));
   return svn_ra_svn__handle_commands2(conn, pool, main_commands, baton, FALSE);
 }
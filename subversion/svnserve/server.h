@@ -27,6 +27,7 @@
 #define SERVER_H
 
 #include <apr_network_io.h>
+#include <apr_poll.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -90,6 +91,8 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  svn_boolean_t in_batch;  /* Processing a "batch" command; no auth
+                              exchanges possible. */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -143,6 +146,11 @@ typedef struct serve_params_t {
      Defaults to SVN_DELTA_COMPRESSION_LEVEL_DEFAULT. */
   int compression_level;
 
+  /* If TRUE and COMPRESSION_LEVEL is not 0, offer the compressed-stream
+     capability to clients.  The file deltas are already compressed, so
+     this only pays off for the remaining traffic.  Defaults to FALSE. */
+  svn_boolean_t compress_stream;
+
   /* Item size up to which we use the zero-copy code path to transmit
      them over the network.  0 disables that code path. */
   apr_size_t zero_copy_limit;
@@ -159,6 +167,11 @@ typedef struct serve_params_t {
 
   /* Use virtual-host-based path to repo. */
   svn_boolean_t vhost;
+
+  /* If not negative, reads from the client fail after waiting for that
+     many microseconds.  Event-driven mode uses this to keep stalled
+     clients from occupying worker threads forever. */
+  apr_interval_time_t read_timeout;
 } serve_params_t;
 
 /* This structure contains all data that describes a client / server
@@ -192,6 +205,14 @@ typedef struct connection_t
      released.  */
   svn_atomic_t ref_count;
 
+  /* Poll descriptor used while the connection waits for its next command
+     in event-driven mode. */
+  apr_pollfd_t pollfd;
+
+  /* Next connection in the list of connections waiting to be added to
+     the pollset in event-driven mode. */
+  struct connection_t *next_parked;
+
 } connection_t;
 
 /* Return a client_info_t structure allocated in POOL and initialize it
@@ -55,10 +55,13 @@
 #include "private/svn_dep_compat.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_ra_svn_private.h"
 
 #if APR_HAS_THREADS
+#    include <apr_poll.h>
 #    include <apr_thread_pool.h>
 #endif
 
@@ -145,6 +148,25 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Expected number of concurrent connections in event-driven mode.  This
+ * is just a sizing hint for most pollset implementations.  Where it is a
+ * hard limit, connections beyond it will be polled round-robin by the
+ * worker threads.
+ */
+#define EVENT_POLLSET_SIZE 4096
+
+/* Number of microseconds that a worker thread waits for data from the
+ * client in event-driven mode before giving up on the connection.
+ *
+ * Connections only get handed to a worker once a complete command has
+ * been received.  However, the handshake, authentication and commands
+ * that are too large to be buffered or that span multiple round-trips,
+ * e.g. commits, still read from the connection.  This limit keeps a few
+ * stalled clients from blocking all worker threads.  Keep it high enough
+ * for users to answer password prompts.
+ */
+#define EVENT_READ_TIMEOUT (60 * APR_USEC_PER_SEC)
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -222,6 +244,9 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_CACHE_SHARED    277
+#define SVNSERVE_OPT_EVENT_DRIVEN    278
+#define SVNSERVE_OPT_COMPRESS_STREAM 279
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -287,6 +312,16 @@ static const apr_getopt_option_t svnserve__options[] =
         "[0 .. no compression, 5 .. default, \n"
         "                             "
         " 9 .. maximum compression]")},
+    {"compress-stream", SVNSERVE_OPT_COMPRESS_STREAM, 1,
+     N_("Offer clients to compress the whole network\n"
+        "                             "
+        "stream instead of just the file deltas.  This\n"
+        "                             "
+        "mainly helps with large directory listings and\n"
+        "                             "
+        "logs over slow links.  Ignored if compression is 0.\n"
+        "                             "
+        "Default is no.")},
     {"memory-cache-size", 'M', 1,
      N_("size of the extra in-memory cache in MB used to\n"
         "                             "
@@ -297,6 +332,14 @@ static const apr_getopt_option_t svnserve__options[] =
         "0 switches to dynamically sized caches.\n"
         "                             "
         "[used for FSFS and FSX repositories only]")},
+    {"memory-cache-shared", SVNSERVE_OPT_CACHE_SHARED, 0,
+     N_("share a single in-memory cache between all\n"
+        "                             "
+        "connection processes instead of using one per\n"
+        "                             "
+        "process.  Has no effect with --threads.\n"
+        "                             "
+        "[used for FSFS and FSX repositories only]")},
     {"cache-txdeltas", SVNSERVE_OPT_CACHE_TXDELTAS, 1,
      N_("enable or disable caching of deltas between older\n"
         "                             "
@@ -360,8 +403,20 @@ static const apr_getopt_option_t svnserve__options[] =
         "                             "
         "are more connections.  Minimum value is 1.\n"
         "                             "
-        "Default is " APR_STRINGIFY(THREADPOOL_MAX_SIZE) "."
+        "Default is " APR_STRINGIFY(THREADPOOL_MAX_SIZE) " or the number of\n"
+        "                             "
+        "CPU cores with --event-driven."
         ONLY_AVAILABLE_WITH_THEADS)},
+    {"event-driven",     SVNSERVE_OPT_EVENT_DRIVEN, 0,
+     N_("use threads but don't dedicate one to each\n"
+        "                             "
+        "connection.  Connections waiting for their next\n"
+        "                             "
+        "command are polled by the main thread instead.\n"
+        "                             "
+        "Useful with many mostly idle clients.\n"
+        "                             "
+        "[mode: daemon]")},
 #endif
     {"max-request-size", SVNSERVE_OPT_MAX_REQUEST, 1,
      N_("Maximum acceptable size of a client request in MB.\n"
@@ -614,22 +669,111 @@ static svn_root_pools__t *connection_pools;
 /* The global thread pool serving all connections. */
 static apr_thread_pool_t *threads;
 
+/* Connections waiting for their next command in event-driven mode,
+   together with the listening socket.  NULL in all other modes.
+   Only the main thread may access it. */
+static apr_pollset_t *idle_connections = NULL;
+
+/* Connections that worker threads want to add to IDLE_CONNECTIONS,
+   linked through their NEXT_PARKED member.  Serialized by PARKED_MUTEX.
+   Workers wake up the main thread after adding to this list. */
+static connection_t *parked_connections = NULL;
+static svn_mutex__t *parked_mutex = NULL;
+
 /* Very simple load determination callback for serve_interruptable:
    With less than half the threads in THREADS in use, we can afford to
-   wait in the socket read() function.  Otherwise, poll them round-robin. */
+   wait in the socket read() function.  Otherwise, poll them round-robin.
+   In event-driven mode, never wait in read() but let the connection wait
+   in IDLE_CONNECTIONS instead. */
 static svn_boolean_t
 is_busy(connection_t *connection)
 {
-  return apr_thread_pool_threads_count(threads) * 2
+  return idle_connections
+      || apr_thread_pool_threads_count(threads) * 2
        > apr_thread_pool_thread_max_get(threads);
 }
 
+/* Set *IDLE to TRUE if CONNECTION has no complete command waiting in its
+   receive buffers nor on the socket.  Set *DONE if the client closed the
+   connection.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+check_idle(svn_boolean_t *idle,
+           svn_boolean_t *done,
+           connection_t *connection,
+           apr_pool_t *scratch_pool)
+{
+  svn_boolean_t complete;
+
+  SVN_ERR(svn_ra_svn__buffer_command(&complete, done, connection->conn,
+                                     scratch_pool));
+  *idle = !complete && !*done;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton type for push_parked_connection. */
+typedef struct park_baton_t
+{
+  connection_t *connection;
+} park_baton_t;
+
+/* Implements the svn_mutex__with_lock callback.  Prepend the connection
+   given by BATON to PARKED_CONNECTIONS. */
+static svn_error_t *
+push_parked_connection(void *baton)
+{
+  park_baton_t *park_baton = baton;
+
+  park_baton->connection->next_parked = parked_connections;
+  parked_connections = park_baton->connection;
+
+  return SVN_NO_ERROR;
+}
+
+/* Let CONNECTION wait in IDLE_CONNECTIONS until the client sends its next
+   command.  Return FALSE if that is not possible.  Once parked, the
+   connection may get picked up by another thread at any time. */
+static svn_boolean_t
+park_connection(connection_t *connection)
+{
+  park_baton_t baton;
+  svn_error_t *err;
+
+  baton.connection = connection;
+  err = svn_mutex__with_lock(parked_mutex, push_parked_connection, &baton);
+  if (err)
+    {
+      svn_error_clear(err);
+      return FALSE;
+    }
+
+  /* The main thread picks up the new entry when it wakes up. */
+  apr_pollset_wakeup(idle_connections);
+  return TRUE;
+}
+
+/* Implements the svn_mutex__with_lock callback.  Move all entries of
+   PARKED_CONNECTIONS into the list returned in *BATON. */
+static svn_error_t *
+pop_parked_connections(void *baton)
+{
+  connection_t **list = baton;
+
+  *list = parked_connections;
+  parked_connections = NULL;
+
+  return SVN_NO_ERROR;
+}
+
 /* Serve the connection given by DATA.  Under high load, serve only
    the current command (if any) and then put the connection back into
-   THREAD's task pool. */
+   THREAD's task pool.  In event-driven mode, serve all commands that
+   the client already sent and then let the connection wait in
+   IDLE_CONNECTIONS. */
 static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 {
   svn_boolean_t done;
+  svn_boolean_t idle = FALSE;
   connection_t *connection = data;
   svn_error_t *err;
 
@@ -637,6 +781,9 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 
   /* process the actual request and log errors */
   err = serve_interruptable(&done, connection, is_busy, pool);
+  if (!err && !done && idle_connections)
+    err = check_idle(&idle, &done, connection, pool);
+
   if (err)
     {
       logger__log_error(connection->params->logger, err, NULL,
@@ -647,15 +794,192 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
     }
   svn_root_pools__release_pool(pool, connection_pools);
 
-  /* Close or re-schedule connection. */
+  /* Close, park or re-schedule connection. */
   if (done)
     close_connection(connection);
-  else
+  else if (!idle || !park_connection(connection))
     apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
 
   return NULL;
 }
 
+/* Return the number of CPU cores available to this process or 0 if that
+   cannot be determined. */
+static apr_size_t
+core_count(void)
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (apr_size_t)count : 0;
+#else
+  return 0;
+#endif
+}
+
+/* Add CONNECTION to IDLE_CONNECTIONS.  If the pollset is full, hand the
+   connection back to THREADS, which will then poll it round-robin. */
+static svn_error_t *
+add_idle_connection(connection_t *connection)
+{
+  apr_status_t status;
+
+  connection->pollfd.p = connection->pool;
+  connection->pollfd.desc_type = APR_POLL_SOCKET;
+  connection->pollfd.reqevents = APR_POLLIN;
+  connection->pollfd.rtnevents = 0;
+  connection->pollfd.desc.s = connection->usock;
+  connection->pollfd.client_data = connection;
+
+  if (apr_pollset_add(idle_connections, &connection->pollfd) == APR_SUCCESS)
+    return SVN_NO_ERROR;
+
+  status = apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't push task"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Handle the data that arrived on the waiting CONNECTION.  Once that
+   forms a complete command, remove CONNECTION from IDLE_CONNECTIONS and
+   hand it to THREADS.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+wake_connection(connection_t *connection,
+                apr_pool_t *scratch_pool)
+{
+  svn_boolean_t complete;
+  svn_boolean_t done;
+  apr_status_t status;
+  svn_error_t *err;
+
+  /* Buffering is non-blocking, so slow clients only keep their
+     connection in the pollset and don't tie up a worker thread. */
+  err = svn_ra_svn__buffer_command(&complete, &done, connection->conn,
+                                   scratch_pool);
+  if (err)
+    {
+      logger__log_error(connection->params->logger, err, NULL,
+                        get_client_info(connection->conn, connection->params,
+                                        scratch_pool));
+      svn_error_clear(err);
+      done = TRUE;
+    }
+
+  if (!complete && !done)
+    return SVN_NO_ERROR;
+
+  /* Don't report the connection again while it is being served. */
+  status = apr_pollset_remove(idle_connections, &connection->pollfd);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't remove client connection "
+                                        "from pollset"));
+
+  if (done)
+    {
+      close_connection(connection);
+      return SVN_NO_ERROR;
+    }
+
+  status = apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't push task"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Accept new connections on SOCK with the given PARAMS and hand them to
+   THREADS.  Whenever a connection waiting in IDLE_CONNECTIONS received
+   a complete command, hand it to THREADS as well.  Allocate connections
+   in POOL.
+
+   This only returns in case of an error. */
+static svn_error_t *
+serve_event_driven(apr_socket_t *sock,
+                   serve_params_t *params,
+                   apr_pool_t *pool)
+{
+  apr_pollfd_t listener = { 0 };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_status_t status;
+
+  listener.p = pool;
+  listener.desc_type = APR_POLL_SOCKET;
+  listener.reqevents = APR_POLLIN;
+  listener.desc.s = sock;
+  listener.client_data = NULL;
+
+  status = apr_pollset_add(idle_connections, &listener);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't poll the listening socket"));
+
+  while (1)
+    {
+      connection_t *parked;
+      const apr_pollfd_t *ready;
+      apr_int32_t count = 0;
+      apr_int32_t i;
+
+      svn_pool_clear(iterpool);
+
+      /* Only this thread may modify the pollset. */
+      SVN_ERR(svn_mutex__with_lock(parked_mutex, pop_parked_connections,
+                                   &parked));
+      for (; parked; parked = parked->next_parked)
+        SVN_ERR(add_idle_connection(parked));
+
+      /* Being woken up by a worker thread returns APR_EINTR. */
+      status = apr_pollset_poll(idle_connections, -1, &count, &ready);
+      if (APR_STATUS_IS_EINTR(status))
+        continue;
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't poll client connections"));
+
+      for (i = 0; i < count; ++i)
+        {
+          connection_t *connection = ready[i].client_data;
+
+          if (connection == NULL)
+            {
+              /* The new connection's only reference will be owned by
+                 whichever thread serves it.  The handshake will be
+                 served right away. */
+              SVN_ERR(accept_connection(&connection, sock, params,
+                                        connection_mode_thread, pool));
+              status = apr_thread_pool_push(threads, serve_thread,
+                                            connection, 0, NULL);
+              if (status)
+                return svn_error_wrap_apr(status, _("Can't push task"));
+            }
+          else
+            {
+              SVN_ERR(wake_connection(connection, iterpool));
+            }
+        }
+    }
+
+  /* NOTREACHED */
+}
+
+/* Create IDLE_CONNECTIONS and the list of parked connections for
+   event-driven mode.  Allocate them in POOL. */
+static svn_error_t *
+create_idle_connections(apr_pool_t *pool)
+{
+  apr_status_t status;
+
+  /* Workers never touch the pollset directly but wake up the main
+     thread instead.  So, every pollset implementation will do. */
+  status = apr_pollset_create(&idle_connections, EVENT_POLLSET_SIZE, pool,
+                              APR_POLLSET_WAKEABLE);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create pollset for "
+                                        "event-driven connection handling"));
+
+  SVN_ERR(svn_mutex__init(&parked_mutex, TRUE, pool));
+
+  return SVN_NO_ERROR;
+}
+
 #endif
 
 /* Write the PID of the current process as a decimal number, followed by a
@@ -725,6 +1049,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_boolean_t cache_txdeltas = TRUE;
   svn_boolean_t cache_revprops = FALSE;
   svn_boolean_t use_block_read = FALSE;
+  svn_boolean_t shared_memory_cache = FALSE;
   apr_uint16_t port = SVN_RA_SVN_PORT;
   const char *host = NULL;
   int family = APR_INET;
@@ -741,7 +1066,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   const char *log_filename = NULL;
   svn_node_kind_t kind;
   apr_size_t min_thread_count = THREADPOOL_MIN_SIZE;
-  apr_size_t max_thread_count = THREADPOOL_MAX_SIZE;
+  apr_size_t max_thread_count = 0;
+  svn_boolean_t event_driven = FALSE;
 #ifdef SVN_HAVE_SASL
   SVN_ERR(cyrus_init(pool));
 #endif
@@ -768,12 +1094,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.config_pool = NULL;
   params.fs_config = NULL;
   params.vhost = FALSE;
+  params.compress_stream = FALSE;
   params.username_case = CASE_ASIS;
   params.memory_cache_size = (apr_uint64_t)-1;
   params.zero_copy_limit = 0;
   params.error_check_interval = 4096;
   params.max_request_size = MAX_REQUEST_SIZE * 0x100000;
   params.max_response_size = 0;
+  params.read_timeout = -1;
 
   while (1)
     {
@@ -909,6 +1237,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           }
           break;
 
+        case SVNSERVE_OPT_CACHE_SHARED:
+          shared_memory_cache = TRUE;
+          break;
+
         case SVNSERVE_OPT_CACHE_TXDELTAS:
           cache_txdeltas = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
@@ -929,6 +1261,11 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           use_block_read = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
 
+        case SVNSERVE_OPT_COMPRESS_STREAM:
+          params.compress_stream
+            = svn_tristate__from_word(arg) == svn_tristate_true;
+          break;
+
         case SVNSERVE_OPT_CLIENT_SPEED:
           {
             apr_size_t bandwidth = (apr_size_t)apr_strtoi64(arg, NULL, 0);
@@ -960,6 +1297,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
         case SVNSERVE_OPT_MAX_THREADS:
           max_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
+          if (max_thread_count < 1)
+            max_thread_count = 1;
+          break;
+
+        case SVNSERVE_OPT_EVENT_DRIVEN:
+          event_driven = TRUE;
+          handling_mode = connection_mode_thread;
+          handling_opt_count++;
           break;
 
 #ifdef WIN32
@@ -1029,7 +1374,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   if (handling_opt_count > 1)
     {
       svn_error_clear(svn_cmdline_fputs(
-                      _("You may only specify one of -T or --single-thread\n"),
+                      _("You may only specify one of -T, --event-driven "
+                        "or --single-thread\n"),
                       stderr, pool));
       usage(argv[0], pool);
       *exit_code = EXIT_FAILURE;
@@ -1295,6 +1641,26 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       }
 
     svn_cache_config_set(&settings);
+
+    /* In fork mode, let all connection processes share one cache.
+     * It must be created before forking the first child.  All processes
+     * run as the same user, so the default lock permissions will do. */
+    if (shared_memory_cache && handling_mode == connection_mode_fork)
+      {
+        const char *temp_dir;
+        const char *lock_file;
+
+        SVN_ERR(svn_io_temp_dir(&temp_dir, pool));
+        lock_file = svn_dirent_join(temp_dir,
+                                    apr_psprintf(pool,
+                                                 "svnserve-cache.%"
+                                                 APR_PID_T_FMT ".lock",
+                                                 getpid()),
+                                    pool);
+        SVN_ERR(svn_cache__create_shared_global_membuffer_cache(
+                  NULL, svn_dirent_local_style(lock_file, pool),
+                  NULL, NULL));
+      }
   }
 
 #if APR_HAS_THREADS
@@ -1302,9 +1668,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
   if (handling_mode == connection_mode_thread)
     {
+      /* Idle connections don't occupy threads in event-driven mode,
+         so there is no point in having many more threads than cores. */
+      if (max_thread_count == 0 && event_driven)
+        max_thread_count = core_count();
+      if (max_thread_count == 0)
+        max_thread_count = THREADPOOL_MAX_SIZE;
+
       /* create the thread pool with a valid range of threads */
-      if (max_thread_count < 1)
-        max_thread_count = 1;
       if (min_thread_count > max_thread_count)
         min_thread_count = max_thread_count;
 
@@ -1323,6 +1694,15 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
       /* don't queue requests unless we reached the worker thread limit */
       apr_thread_pool_threshold_set(threads, 0);
+
+      /* Only the daemon's accept loop multiplexes connections. */
+      if (event_driven && run_mode != run_mode_listen_once)
+        {
+          SVN_ERR(create_idle_connections(pool));
+          params.read_timeout = EVENT_READ_TIMEOUT;
+
+          return svn_error_trace(serve_event_driven(sock, &params, pool));
+        }
     }
   else
     {
@@ -1352,6 +1732,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
               /* the child wouldn't listen to the main server's socket */
               apr_socket_close(sock);
 
+              err = svn_cache__global_membuffer_cache_child_init(pool);
+              if (err)
+                {
+                  logger__log_error(params.logger, err, NULL, NULL);
+                  svn_error_clear(err);
+                }
+
               /* serve_socket() logs any error it returns, so ignore it. */
               svn_error_clear(serve_socket(connection, connection->pool));
               close_connection(connection);
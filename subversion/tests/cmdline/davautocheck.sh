@@ -72,10 +72,16 @@
 #
 #  make davautocheck BLOCK_READ=1           # sets SVNBlockRead on
 #
+#  make davautocheck UPDATE_PARTITIONS=1    # sets SVNAllowUpdatePartitions on
+#
 #  make davautocheck USE_SSL=1              # run over https
 #
 #  make davautocheck USE_HTTPV1=1           # sets SVNAdvertiseV2Protocol off
 #
+#  make davautocheck USE_HTTP2=1            # loads mod_http2 and makes the
+#                                           # client use http/2 (needs the
+#                                           # event or worker MPM)
+#
 #  make davautocheck APACHE_MPM=event       # specifies the 2.4 MPM
 #
 #  make davautocheck SVN_PATH_AUTHZ=short_circuit  # SVNPathAuthz short_circuit
@@ -229,6 +235,11 @@ if [ ${BLOCK_READ:+set} ]; then
   BLOCK_READ_SETTING=on
 fi
 
+UPDATE_PARTITIONS_SETTING=off
+if [ ${UPDATE_PARTITIONS:+set} ]; then
+  UPDATE_PARTITIONS_SETTING=on
+fi
+
 if [ ${MODULE_PATH:+set} ]; then
     MOD_DAV_SVN="$MODULE_PATH/mod_dav_svn.so"
     MOD_AUTHZ_SVN="$MODULE_PATH/mod_authz_svn.so"
@@ -330,6 +341,16 @@ if [ ${USE_SSL:+set} ]; then
     LOAD_MOD_SSL=$(get_loadmodule_config mod_ssl) \
       || fail "SSL module not found"
 fi
+if [ ${USE_HTTP2:+set} ]; then
+    if [ x"$APACHE_MPM" = x"prefork" ]; then
+      fail "USE_HTTP2 does not work with APACHE_MPM=prefork"
+    fi
+    LOAD_MOD_HTTP2=$(get_loadmodule_config mod_http2) \
+      || fail "HTTP2 module not found"
+    HTTP2_PROTOCOLS="Protocols           h2 h2c http/1.1"
+    HTTP2_MAKE_VAR="HTTP2=1"
+    HTTP2_TEST_ARG="--http2"
+fi
 
 # Stop any previous instances, os we can re-use the port.
 if [ -x $STOPSCRIPT ]; then $STOPSCRIPT ; sleep 1; fi
@@ -445,6 +466,8 @@ __EOF__
 cat > "$HTTPD_CFG" <<__EOF__
 $LOAD_MOD_MPM
 $LOAD_MOD_SSL
+$LOAD_MOD_HTTP2
+$HTTP2_PROTOCOLS
 $LOAD_MOD_LOG_CONFIG
 $LOAD_MOD_MIME
 $LOAD_MOD_ALIAS
@@ -558,6 +581,7 @@ cat >> "$HTTPD_CFG" <<__EOF__
   SVNCacheRevProps  ${CACHE_REVPROPS_SETTING}
   SVNListParentPath On
   SVNBlockRead      ${BLOCK_READ_SETTING}
+  SVNAllowUpdatePartitions ${UPDATE_PARTITIONS_SETTING}
 __EOF__
 }
 location_common
@@ -800,13 +824,13 @@ else
 fi
 
 if [ $# = 0 ]; then
-  TIME_CMD "$MAKE" check "BASE_URL=$BASE_URL" "HTTPD_VERSION=$HTTPD_VERSION" $SSL_MAKE_VAR
+  TIME_CMD "$MAKE" check "BASE_URL=$BASE_URL" "HTTPD_VERSION=$HTTPD_VERSION" $SSL_MAKE_VAR $HTTP2_MAKE_VAR
   r=$?
 else
   (cd "$ABS_BUILDDIR/subversion/tests/cmdline/"
   TEST="$1"
   shift
-  TIME_CMD "$ABS_SRCDIR/subversion/tests/cmdline/${TEST}_tests.py" "--url=$BASE_URL" "--httpd-version=$HTTPD_VERSION" $SSL_TEST_ARG "$@")
+  TIME_CMD "$ABS_SRCDIR/subversion/tests/cmdline/${TEST}_tests.py" "--url=$BASE_URL" "--httpd-version=$HTTPD_VERSION" $SSL_TEST_ARG $HTTP2_TEST_ARG "$@")
   r=$?
 fi
 
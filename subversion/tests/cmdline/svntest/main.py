@@ -702,6 +702,8 @@ exclusive-locking = true
     http_library_str = ""
     if options.http_library:
       http_library_str = "http-library=%s" % (options.http_library)
+    if options.http2:
+      http_library_str += "\nhttp-http2=yes"
     http_proxy_str = ""
     http_proxy_username_str = ""
     http_proxy_password_str = ""
@@ -1763,6 +1765,8 @@ class TestSpawningThread(threading.Thread):
       args.append('--enable-sasl')
     if options.http_library:
       args.append('--http-library=' + options.http_library)
+    if options.http2:
+      args.append('--http2')
     if options.server_minor_version:
       args.append('--server-minor-version=' + str(options.server_minor_version))
     if options.mode_filter:
@@ -2179,6 +2183,9 @@ def _create_parser(usage=None):
                     help="Make svn use this DAV library (neon or serf) if " +
                          "it supports both, else assume it's using this " +
                          "one; the default is " + _default_http_library)
+  parser.add_option('--http2', action='store_true',
+                    help="Make svn multiplex its requests over http/2, " +
+                         "using prior knowledge for http:// URLs")
   parser.add_option('--server-minor-version', type='int', action='store',
                     help="Set the minor version for the server ('3'..'%d')."
                     % SVN_VER_MINOR)
@@ -22,6 +22,7 @@
  */
 
 #include "svn_delta.h"
+#include "private/svn_delta_private.h"
 #include "../svn_test.h"
 
 static svn_error_t *
@@ -66,6 +67,91 @@ test_txdelta_to_svndiff_stream_small_reads(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Fill BUF of LEN bytes with pseudo-random but compressible data. */
+static void
+fill_buffer(char *buf, apr_size_t len, apr_uint32_t seed)
+{
+  apr_size_t i;
+  for (i = 0; i < len; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      buf[i] = "abcdefgh\n"[(seed >> 16) % 9];
+    }
+}
+
+/* Write the svndiff data of the delta between SOURCE and TARGET to a new
+ * string in *RESULT, using MAX_THREADS to encode with SVNDIFF_VERSION.
+ * Allocate everything in POOL. */
+static svn_error_t *
+encode_delta(svn_stringbuf_t **result,
+             const svn_string_t *source,
+             const svn_string_t *target,
+             int svndiff_version,
+             int max_threads,
+             apr_pool_t *pool)
+{
+  svn_txdelta_stream_t *txstream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  *result = svn_stringbuf_create_empty(pool);
+  svn_txdelta2(&txstream,
+               svn_stream_from_string(source, pool),
+               svn_stream_from_string(target, pool),
+               FALSE, pool);
+  svn_txdelta__to_svndiff_concurrent(&handler, &handler_baton,
+                                     svn_stream_from_stringbuf(*result, pool),
+                                     svndiff_version,
+                                     SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
+                                     max_threads, pool);
+
+  return svn_error_trace(svn_txdelta_send_txstream(txstream, handler,
+                                                   handler_baton, pool));
+}
+
+static svn_error_t *
+test_concurrent_svndiff_encoder(apr_pool_t *pool)
+{
+  apr_size_t len = 2 * 1024 * 1024 + 12345;
+  char *source_data = apr_palloc(pool, len);
+  char *target_data = apr_palloc(pool, len);
+  svn_string_t source;
+  svn_string_t target;
+  int version;
+  apr_size_t i;
+
+  /* Make the target differ from the source in every delta window. */
+  fill_buffer(source_data, len, 1);
+  memcpy(target_data, source_data, len);
+  for (i = 0; i < len; i += 50000)
+    fill_buffer(target_data + i, 200, (apr_uint32_t)i);
+
+  source.data = source_data;
+  source.len = len;
+  target.data = target_data;
+  target.len = len;
+
+  for (version = 0; version <= 2; ++version)
+    {
+      svn_stringbuf_t *expected;
+      svn_stringbuf_t *actual;
+      int threads;
+
+      SVN_ERR(encode_delta(&expected, &source, &target, version, 1, pool));
+
+      /* The concurrent encoder must produce the exact same svndiff data,
+       * regardless of the number of windows in flight. */
+      for (threads = 2; threads <= 8; threads *= 2)
+        {
+          SVN_ERR(encode_delta(&actual, &source, &target, version, threads,
+                               pool));
+          SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = -1;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -73,6 +159,8 @@ static struct svn_test_descriptor_t test_funcs[] =
   SVN_TEST_NULL,
   SVN_TEST_PASS2(test_txdelta_to_svndiff_stream_small_reads,
                  "test svn_txdelta_to_svndiff_stream() small reads"),
+  SVN_TEST_PASS2(test_concurrent_svndiff_encoder,
+                 "test concurrent svndiff encoder output"),
   SVN_TEST_NULL
 };
 
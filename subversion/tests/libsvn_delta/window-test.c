@@ -28,6 +28,7 @@
 #include "svn_types.h"
 #include "svn_error.h"
 #include "svn_delta.h"
+#include "svn_pools.h"
 
 #include "private/svn_subr_private.h"
 
@@ -96,6 +97,130 @@ stream_window_test(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Return a byte value that differs from both A and B. */
+static char
+pick_other_byte(char a, char b)
+{
+  char result = 0;
+  while (result == a || result == b)
+    ++result;
+
+  return result;
+}
+
+/* Run the delta generator on SOURCE and TARGET, which must both fit into
+ * a single delta window, and return that window in *WINDOW.
+ * Verify that applying the window reproduces TARGET. */
+static svn_error_t *
+get_single_window(svn_txdelta_window_t **window,
+                  const svn_string_t *source,
+                  const svn_string_t *target,
+                  apr_pool_t *pool)
+{
+  svn_txdelta_stream_t *txstream;
+  svn_txdelta_window_t *next;
+  char *buffer = apr_palloc(pool, target->len + 1);
+  apr_size_t len = target->len;
+
+  svn_txdelta2(&txstream,
+               svn_stream_from_string(source, pool),
+               svn_stream_from_string(target, pool),
+               FALSE, pool);
+
+  SVN_ERR(svn_txdelta_next_window(window, txstream, pool));
+  SVN_TEST_ASSERT(*window != NULL);
+  SVN_ERR(svn_txdelta_next_window(&next, txstream, pool));
+  SVN_TEST_ASSERT(next == NULL);
+
+  svn_txdelta_apply_instructions(*window, source->data, buffer, &len);
+  SVN_TEST_INT_ASSERT(len, target->len);
+  SVN_TEST_ASSERT(memcmp(buffer, target->data, len) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+xdelta_match_extension_test(apr_pool_t *pool)
+{
+  enum { SOURCE_SIZE = 60000, COPY_START = 1001, GAP_START = 30000,
+         RESUME_START = 30123, MAX_PREFIX = 2 * 64 + 1, GAP_SIZE = 5 };
+
+  /* Note: put these in data segment, not the stack */
+  static char source[SOURCE_SIZE];
+  static char target[MAX_PREFIX + SOURCE_SIZE];
+
+  svn_string_t source_str;
+  svn_string_t target_str;
+  apr_uint32_t seed = 0x4711;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i, k;
+
+  /* Deterministic pseudo-random source contents. */
+  for (i = 0; i < SOURCE_SIZE; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      source[i] = (char)(seed >> 16);
+    }
+
+  source_str.data = source;
+  source_str.len = SOURCE_SIZE;
+
+  /* Prefix the copied source data with K bytes of new data and put a
+   * short gap of new data in the middle.  Those bytes are chosen such that
+   * neither the forward nor the backward match extension can accidentally
+   * grow into them.  Varying K makes the backward extension cover every
+   * possible distance to the next block boundary in SOURCE.
+   *
+   * The resulting delta must be minimal, i.e. the new data must be exactly
+   * the bytes that don't occur in SOURCE. */
+  for (k = 1; k <= MAX_PREFIX; ++k)
+    {
+      svn_txdelta_window_t *window;
+      const svn_txdelta_op_t *ops;
+      char *p = target;
+
+      svn_pool_clear(iterpool);
+
+      for (i = 0; i < k; ++i)
+        *p++ = pick_other_byte(source[COPY_START - k + i], source[i]);
+
+      memcpy(p, source + COPY_START, GAP_START - COPY_START);
+      p += GAP_START - COPY_START;
+
+      for (i = 0; i < GAP_SIZE; ++i)
+        *p++ = pick_other_byte(source[GAP_START + i],
+                               source[RESUME_START - GAP_SIZE + i]);
+
+      memcpy(p, source + RESUME_START, SOURCE_SIZE - RESUME_START);
+      p += SOURCE_SIZE - RESUME_START;
+
+      target_str.data = target;
+      target_str.len = p - target;
+
+      SVN_ERR(get_single_window(&window, &source_str, &target_str,
+                                iterpool));
+
+      ops = window->ops;
+      SVN_TEST_INT_ASSERT(window->num_ops, 4);
+      SVN_TEST_INT_ASSERT(window->new_data->len, k + GAP_SIZE);
+
+      SVN_TEST_ASSERT(ops[0].action_code == svn_txdelta_new);
+      SVN_TEST_INT_ASSERT(ops[0].length, k);
+      SVN_TEST_ASSERT(ops[1].action_code == svn_txdelta_source);
+      SVN_TEST_INT_ASSERT(ops[1].offset, COPY_START);
+      SVN_TEST_INT_ASSERT(ops[1].length, GAP_START - COPY_START);
+      SVN_TEST_ASSERT(ops[2].action_code == svn_txdelta_new);
+      SVN_TEST_INT_ASSERT(ops[2].length, GAP_SIZE);
+      SVN_TEST_ASSERT(ops[3].action_code == svn_txdelta_source);
+      SVN_TEST_INT_ASSERT(ops[3].offset, RESUME_START);
+      SVN_TEST_INT_ASSERT(ops[3].length, SOURCE_SIZE - RESUME_START);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* The test table.  */
@@ -107,6 +232,8 @@ static struct svn_test_descriptor_t test_funcs[] =
     SVN_TEST_NULL,
     SVN_TEST_PASS2(stream_window_test,
                    "txdelta stream and windows test"),
+    SVN_TEST_PASS2(xdelta_match_extension_test,
+                   "xdelta forward and backward match extension"),
     SVN_TEST_NULL
   };
 
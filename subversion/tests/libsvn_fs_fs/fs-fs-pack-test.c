@@ -30,12 +30,15 @@
 #include "../../libsvn_fs_fs/fs_fs.h"
 #include "../../libsvn_fs_fs/low_level.h"
 #include "../../libsvn_fs_fs/pack.h"
+#include "../../libsvn_fs_fs/rep-cache.h"
+#include "../../libsvn_fs_fs/rev_file.h"
 #include "../../libsvn_fs_fs/util.h"
 
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "private/svn_fspath.h"
 #include "private/svn_string_private.h"
 
 #include "../svn_test_fs.h"
@@ -1563,6 +1566,130 @@ rep_sharing_effectiveness(const svn_test_opts_t *opts,
 
 /* ------------------------------------------------------------------------ */
 
+#define REPO_NAME "test-repo-rep_sharing_with_filter"
+
+/* In FS, add FILE with CONTENTS (multiplied) on top of the youngest
+   revision and return the new revision in *REV. */
+static svn_error_t *
+commit_file(svn_revnum_t *rev,
+            svn_fs_t *fs,
+            const char *file,
+            const char *contents,
+            apr_pool_t *pool)
+{
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+
+  SVN_ERR(svn_fs_youngest_rev(rev, fs, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, *rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_file(root, file, pool));
+  SVN_ERR(svn_test__set_file_contents(root, file,
+                                      multiply_string(contents, pool),
+                                      pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, rev, txn, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+rep_sharing_with_filter(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_revnum_t rev;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  ffd->rep_sharing_allowed = TRUE;
+  ffd->use_rep_cache_filter = FALSE;
+
+  /* Revision 1: fill the rep-cache without the filter. */
+  SVN_ERR(commit_file(&rev, fs, "foo", "Hello, ", pool));
+
+  /* Revision 2: the filter gets built from the rep-cache database and must
+                 allow sharing the r1 contents. */
+  ffd->use_rep_cache_filter = TRUE;
+  SVN_ERR(commit_file(&rev, fs, "bar", "Hello, ", pool));
+  SVN_TEST_ASSERT(ffd->shared->rep_cache_filter != NULL);
+
+  /* Revision 3: new contents, which must be known to the filter
+                 after the commit. */
+  SVN_ERR(commit_file(&rev, fs, "baz", "World!", pool));
+
+  /* Revision 4: share the r3 contents. */
+  SVN_ERR(commit_file(&rev, fs, "qux", "World!", pool));
+
+  /* Revision 5: new contents committed as if from another process, i.e.
+                 bypassing the filter. */
+  ffd->use_rep_cache_filter = FALSE;
+  SVN_ERR(commit_file(&rev, fs, "quux", "Goodbye!", pool));
+
+  /* Revision 6: the filter does not cover r5, so sharing its contents
+                 must still work. */
+  ffd->use_rep_cache_filter = TRUE;
+  SVN_ERR(commit_file(&rev, fs, "corge", "Goodbye!", pool));
+
+  /* The filter must have picked up the r5 keys from the database and cover
+     all revisions again instead of leaving every lookup to the database.
+     Tell that by a key that got added behind the filter's back for an old
+     revision: only the database knows it. */
+  {
+    representation_t *rep = apr_pcalloc(pool, sizeof(*rep));
+    representation_t *found;
+    svn_checksum_t *checksum;
+
+    SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, "unknown", 7, pool));
+    svn_fs_fs__id_txn_reset(&rep->txn_id);
+    memcpy(rep->sha1_digest, checksum->digest, sizeof(rep->sha1_digest));
+    rep->has_sha1 = TRUE;
+    rep->revision = 1;
+    rep->item_index = 1;
+    rep->size = 7;
+    rep->expanded_size = 7;
+
+    ffd->use_rep_cache_filter = FALSE;
+    SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, pool));
+    SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, checksum, pool));
+    SVN_TEST_ASSERT(found != NULL);
+
+    ffd->use_rep_cache_filter = TRUE;
+    SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, checksum, pool));
+    SVN_TEST_ASSERT(found == NULL);
+  }
+
+  /* Verify that rep sharing eliminated the duplicates. */
+  {
+    /* Number of expected representations (including the root directory). */
+    const int expected[] = { 1, 2, 1, 2, 1, 2, 1 } ;
+
+    svn_revnum_t i;
+    apr_pool_t *iterpool = svn_pool_create(pool);
+    for (i = 0; i <= rev; ++i)
+      {
+        int count;
+        SVN_ERR(count_representations(&count, fs, i, iterpool));
+        SVN_TEST_ASSERT(count == expected[i]);
+      }
+
+    svn_pool_destroy(iterpool);
+  }
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
 #define REPO_NAME "test-repo-delta_chain_with_plain"
 
 static svn_error_t *
@@ -1812,6 +1939,400 @@ pack_with_limited_memory(const svn_test_opts_t *opts,
 #undef MAX_REV
 #undef SHARD_SIZE
 
+/* ------------------------------------------------------------------------ */
+/* Pack several shards concurrently and check that the notifications still
+   arrive in order and that the result is a valid repository. */
+#define REPO_NAME "test-repo-pack-concurrently"
+#define SHARD_SIZE 3
+#define MAX_REV (5 * SHARD_SIZE + 1)
+static svn_error_t *
+pack_concurrently(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  struct pack_notify_baton pnb;
+  svn_revnum_t rev;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (opts->server_minor_version && (opts->server_minor_version < 15))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.15 SVN doesn't support concurrent packing");
+
+  SVN_ERR(create_non_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                       pool));
+
+  /* Pack with more threads than there are shards. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  ffd = fs->fsap_data;
+  ffd->pack_threads = 8;
+
+  pnb.expected_shard = 0;
+  pnb.expected_action = svn_fs_pack_notify_start;
+  SVN_ERR(svn_fs_fs__pack(fs, 0, pack_notify, &pnb, NULL, NULL, pool));
+  SVN_TEST_ASSERT(pnb.expected_shard == MAX_REV / SHARD_SIZE);
+  SVN_TEST_ASSERT(pnb.expected_action == svn_fs_pack_notify_start);
+
+  /* All shards must have been switched over to their pack files. */
+  for (rev = 0; rev < (MAX_REV / SHARD_SIZE) * SHARD_SIZE; ++rev)
+    {
+      svn_node_kind_t kind;
+      const char *path
+        = svn_dirent_join_many(pool, REPO_NAME, PATH_REVS_DIR,
+                               apr_psprintf(pool, "%ld.pack",
+                                            rev / SHARD_SIZE),
+                               "pack", SVN_VA_NULL);
+      SVN_ERR(svn_io_check_path(path, &kind, pool));
+      SVN_TEST_ASSERT(kind == svn_node_file);
+    }
+
+  /* To be sure: Verify that we didn't break the repo. */
+  SVN_ERR(svn_fs_verify(REPO_NAME, NULL, 0, MAX_REV, NULL, NULL, NULL, NULL,
+                        pool));
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+/* Hotcopy packed and non-packed shards concurrently, both as a full and
+   as an incremental hotcopy. */
+#define REPO_NAME "test-repo-hotcopy-concurrently"
+#define SHARD_SIZE 3
+#define MAX_REV (4 * SHARD_SIZE + 1)
+static svn_error_t *
+hotcopy_concurrently(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  const char *dst = REPO_NAME "-copy";
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (opts->server_minor_version && (opts->server_minor_version < 15))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.15 SVN doesn't support concurrent hotcopy");
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_io_file_create(svn_dirent_join(REPO_NAME, PATH_CONFIG, pool),
+                             "[" CONFIG_SECTION_IO "]\n"
+                             CONFIG_OPTION_HOTCOPY_THREADS " = 4\n",
+                             pool));
+
+  SVN_ERR(svn_fs_hotcopy3(REPO_NAME, dst, TRUE, FALSE, NULL, NULL,
+                          NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify(dst, NULL, 0, MAX_REV, NULL, NULL, NULL, NULL,
+                        pool));
+
+  /* Add a few revisions to the source, spanning a new shard. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  for (rev = MAX_REV; rev < MAX_REV + SHARD_SIZE + 1; )
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+      SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+      SVN_ERR(svn_test__set_file_contents(root, "iota",
+                                          get_rev_contents(rev + 1, pool),
+                                          pool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+    }
+  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_fs_hotcopy3(REPO_NAME, dst, TRUE, TRUE, NULL, NULL,
+                          NULL, NULL, pool));
+  SVN_ERR(svn_fs_open2(&fs, dst, NULL, pool, pool));
+  SVN_ERR(svn_fs_youngest_rev(&rev, fs, pool));
+  SVN_TEST_ASSERT(rev == MAX_REV + SHARD_SIZE + 1);
+  SVN_ERR(svn_fs_verify(dst, NULL, 0, rev, NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+/* Read packed and non-packed revisions with pack files being mapped into
+   memory and compare the results with regular reads. */
+
+/* Compare the sub-tree at PATH in the revision roots EXPECTED and ACTUAL,
+   i.e. directory entries, node kinds, file contents and properties.
+   Use POOL for temporary allocations. */
+static svn_error_t *
+compare_trees(svn_fs_root_t *expected,
+              svn_fs_root_t *actual,
+              const char *path,
+              apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_hash_t *expected_props, *actual_props;
+  apr_array_header_t *prop_diffs;
+  svn_node_kind_t kind;
+
+  SVN_ERR(svn_fs_node_proplist(&expected_props, expected, path, pool));
+  SVN_ERR(svn_fs_node_proplist(&actual_props, actual, path, pool));
+  SVN_ERR(svn_prop_diffs(&prop_diffs, actual_props, expected_props, pool));
+  SVN_TEST_ASSERT(prop_diffs->nelts == 0);
+
+  SVN_ERR(svn_fs_check_path(&kind, expected, path, pool));
+  if (kind == svn_node_file)
+    {
+      svn_stringbuf_t *expected_contents, *actual_contents;
+
+      SVN_ERR(svn_test__get_file_contents(expected, path,
+                                          &expected_contents, pool));
+      SVN_ERR(svn_test__get_file_contents(actual, path,
+                                          &actual_contents, pool));
+      SVN_TEST_ASSERT(svn_stringbuf_compare(expected_contents,
+                                            actual_contents));
+    }
+  else
+    {
+      apr_hash_t *expected_entries, *actual_entries;
+      apr_hash_index_t *hi;
+
+      SVN_ERR(svn_fs_dir_entries(&expected_entries, expected, path, pool));
+      SVN_ERR(svn_fs_dir_entries(&actual_entries, actual, path, pool));
+      SVN_TEST_ASSERT(apr_hash_count(expected_entries)
+                      == apr_hash_count(actual_entries));
+
+      for (hi = apr_hash_first(pool, expected_entries);
+           hi;
+           hi = apr_hash_next(hi))
+        {
+          const char *name = apr_hash_this_key(hi);
+          svn_fs_dirent_t *expected_entry = apr_hash_this_val(hi);
+          svn_fs_dirent_t *actual_entry = svn_hash_gets(actual_entries,
+                                                        name);
+
+          svn_pool_clear(iterpool);
+
+          SVN_TEST_ASSERT(actual_entry);
+          SVN_TEST_ASSERT(expected_entry->kind == actual_entry->kind);
+          SVN_ERR(compare_trees(expected, actual,
+                                svn_fspath__join(path, name, iterpool),
+                                iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Compare the changed paths lists of the revision roots EXPECTED and
+   ACTUAL.  Use POOL for temporary allocations. */
+static svn_error_t *
+compare_changes(svn_fs_root_t *expected,
+                svn_fs_root_t *actual,
+                apr_pool_t *pool)
+{
+  svn_fs_path_change_iterator_t *expected_iterator, *actual_iterator;
+  svn_fs_path_change3_t *expected_change, *actual_change;
+  int count = 0;
+
+  SVN_ERR(svn_fs_paths_changed3(&expected_iterator, expected, pool, pool));
+  SVN_ERR(svn_fs_paths_changed3(&actual_iterator, actual, pool, pool));
+
+  do
+    {
+      SVN_ERR(svn_fs_path_change_get(&expected_change, expected_iterator));
+      SVN_ERR(svn_fs_path_change_get(&actual_change, actual_iterator));
+      if (!expected_change)
+        break;
+
+      SVN_TEST_ASSERT(actual_change);
+      SVN_TEST_STRING_ASSERT(actual_change->path.data,
+                             expected_change->path.data);
+      SVN_TEST_ASSERT(actual_change->change_kind
+                      == expected_change->change_kind);
+      SVN_TEST_ASSERT(actual_change->node_kind
+                      == expected_change->node_kind);
+      SVN_TEST_ASSERT(actual_change->text_mod == expected_change->text_mod);
+      SVN_TEST_ASSERT(actual_change->prop_mod == expected_change->prop_mod);
+      ++count;
+    }
+  while (TRUE);
+
+  SVN_TEST_ASSERT(actual_change == NULL);
+  SVN_TEST_ASSERT(count > 0);
+
+  return SVN_NO_ERROR;
+}
+
+#define REPO_NAME "test-repo-read-mapped-packed-fs"
+#define SHARD_SIZE 5
+#define MAX_REV 11
+static svn_error_t *
+read_mapped_packed_fs(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *plain_fs, *mapped_fs;
+  svn_revnum_t i;
+  apr_hash_t *plain_config, *mapped_config;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (opts->server_minor_version && (opts->server_minor_version < 15))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.15 SVN doesn't support mapped pack files");
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+
+  /* Use new FS instances with disjoint caches to actually read from the
+   * pack files.  Only the second one gets to see the option. */
+  plain_config = apr_hash_make(pool);
+  svn_hash_sets(plain_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&plain_fs, REPO_NAME, plain_config, pool, pool));
+  SVN_TEST_ASSERT(!((fs_fs_data_t *)plain_fs->fsap_data)->mmap_pack_files);
+
+  SVN_ERR(svn_io_file_create(svn_dirent_join(REPO_NAME, PATH_CONFIG, pool),
+                             "[" CONFIG_SECTION_IO "]\n"
+                             CONFIG_OPTION_MMAP_PACK_FILES " = true\n",
+                             pool));
+
+  mapped_config = apr_hash_make(pool);
+  svn_hash_sets(mapped_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&mapped_fs, REPO_NAME, mapped_config, pool, pool));
+  SVN_TEST_ASSERT(((fs_fs_data_t *)mapped_fs->fsap_data)->mmap_pack_files);
+
+#if APR_HAS_MMAP
+  {
+    /* Revision files of the same shard share one mapping. */
+    svn_fs_fs__revision_file_t *first, *second;
+
+    SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&first, mapped_fs, 1, pool,
+                                             pool));
+    SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&second, mapped_fs, 2, pool,
+                                             pool));
+    SVN_TEST_ASSERT(first->mapped_data != NULL);
+    SVN_TEST_ASSERT(first->mapped_data == second->mapped_data);
+    SVN_ERR(svn_fs_fs__close_revision_file(first));
+    SVN_ERR(svn_fs_fs__close_revision_file(second));
+
+    /* ... and it survives closing them. */
+    SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&second, mapped_fs, 3, pool,
+                                             pool));
+    SVN_TEST_ASSERT(second->mapped_data == first->mapped_data);
+    SVN_ERR(svn_fs_fs__close_revision_file(second));
+  }
+#endif
+
+  for (i = 1; i <= MAX_REV; i++)
+    {
+      svn_fs_root_t *plain_root, *mapped_root;
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&plain_root, plain_fs, i, iterpool));
+      SVN_ERR(svn_fs_revision_root(&mapped_root, mapped_fs, i, iterpool));
+
+      SVN_ERR(svn_test__get_file_contents(mapped_root, "iota", &contents,
+                                          iterpool));
+      if (i == 1)
+        SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'iota'.\n");
+      else
+        SVN_TEST_STRING_ASSERT(contents->data, get_rev_contents(i, iterpool));
+
+      SVN_ERR(compare_trees(plain_root, mapped_root, "/", iterpool));
+      SVN_ERR(compare_changes(plain_root, mapped_root, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs_verify(REPO_NAME, mapped_config, 0, MAX_REV, NULL, NULL,
+                        NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+/* Read delta chains spanning packed and non-packed revisions with and
+   without asking the OS to read them ahead. */
+#define REPO_NAME "test-repo-read-prefetched-delta-chains"
+#define SHARD_SIZE 7
+#define MAX_REV 20
+static svn_error_t *
+read_prefetched_delta_chains(const svn_test_opts_t *opts,
+                             apr_pool_t *pool)
+{
+  svn_boolean_t prefetch;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (opts->server_minor_version && (opts->server_minor_version < 15))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.15 SVN doesn't prefetch delta chains");
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+
+  for (prefetch = FALSE; prefetch <= TRUE; prefetch++)
+    {
+      svn_fs_t *fs;
+      svn_revnum_t i;
+      apr_hash_t *fs_config;
+
+      SVN_ERR(svn_io_file_create(svn_dirent_join(REPO_NAME, PATH_CONFIG,
+                                                 pool),
+                                 prefetch
+                                   ? "[" CONFIG_SECTION_IO "]\n"
+                                     CONFIG_OPTION_PREFETCH_DELTA_CHAINS
+                                     " = true\n"
+                                   : "[" CONFIG_SECTION_IO "]\n"
+                                     CONFIG_OPTION_PREFETCH_DELTA_CHAINS
+                                     " = false\n",
+                                 pool));
+
+      /* Use a new FS instance with disjoint caches to actually read from
+       * the rev and pack files. */
+      fs_config = apr_hash_make(pool);
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                    svn_uuid_generate(pool));
+      SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+      SVN_TEST_ASSERT(((fs_fs_data_t *)fs->fsap_data)->prefetch_delta_chains
+                      == prefetch);
+
+      /* Read the latest revisions first, so that the whole chains need
+       * to be reconstructed from disk. */
+      for (i = MAX_REV; i > 0; i--)
+        {
+          svn_fs_root_t *rev_root;
+          svn_stringbuf_t *contents;
+
+          svn_pool_clear(iterpool);
+
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, iterpool));
+          SVN_ERR(svn_test__get_file_contents(rev_root, "iota", &contents,
+                                              iterpool));
+          if (i == 1)
+            SVN_TEST_STRING_ASSERT(contents->data,
+                                   "This is the file 'iota'.\n");
+          else
+            SVN_TEST_STRING_ASSERT(contents->data,
+                                   get_rev_contents(i, iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
 /* ------------------------------------------------------------------------ */
 
 #define REPO_NAME "test-repo-large_delta_against_plain"
@@ -1943,6 +2464,16 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(pack_concurrently,
+                       "pack several shards concurrently"),
+    SVN_TEST_OPTS_PASS(hotcopy_concurrently,
+                       "hotcopy several shards concurrently"),
+    SVN_TEST_OPTS_PASS(read_mapped_packed_fs,
+                       "compare memory mapped and regular pack file reads"),
+    SVN_TEST_OPTS_PASS(read_prefetched_delta_chains,
+                       "read delta chains with prefetching"),
+    SVN_TEST_OPTS_PASS(rep_sharing_with_filter,
+                       "rep-sharing with rep-cache filter"),
     SVN_TEST_NULL
   };
 
@@ -34,8 +34,11 @@
 #include "private/svn_fs_fs_private.h"
 #include "private/svn_subr_private.h"
 
+#include "../../libsvn_fs_fs/id.h"
 #include "../../libsvn_fs_fs/index.h"
 #include "../../libsvn_fs_fs/rep-cache.h"
+#include "../../libsvn_fs_fs/temp_serializer.h"
+#include "../../libsvn_fs_fs/tree.h"
 #include "../../libsvn_fs/fs-loader.h"
 
 #include "../svn_test_fs.h"
@@ -424,8 +427,8 @@ load_index(const svn_test_opts_t *opts, apr_pool_t *pool)
   SVN_ERR(svn_fs_ioctl(svn_repos_fs(repos), SVN_FS_FS__IOCTL_LOAD_INDEX,
                        &load_input, NULL, NULL, NULL, pool, pool));
 
-  SVN_TEST_ASSERT_ERROR(svn_repos_verify_fs3(repos, rev, rev, FALSE, FALSE,
-                                             NULL, NULL, NULL, NULL, NULL,
+  SVN_TEST_ASSERT_ERROR(svn_repos_verify_fs4(repos, rev, rev, FALSE, FALSE,
+                                             1, NULL, NULL, NULL, NULL, NULL,
                                              NULL, pool),
                         SVN_ERR_FS_INDEX_CORRUPTION);
 
@@ -434,7 +437,7 @@ load_index(const svn_test_opts_t *opts, apr_pool_t *pool)
   load_input.entries = entries;
   SVN_ERR(svn_fs_ioctl(svn_repos_fs(repos), SVN_FS_FS__IOCTL_LOAD_INDEX,
                        &load_input, NULL, NULL, NULL, pool, pool));
-  SVN_ERR(svn_repos_verify_fs3(repos, rev, rev, FALSE, FALSE, NULL, NULL,
+  SVN_ERR(svn_repos_verify_fs4(repos, rev, rev, FALSE, FALSE, 1, NULL, NULL,
                                NULL, NULL, NULL, NULL, pool));
 
   return SVN_NO_ERROR;
@@ -499,6 +502,429 @@ build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* Progress baton for build_rep_cache_incrementally(). */
+typedef struct build_progress_t
+{
+  svn_revnum_t first;
+  svn_revnum_t last;
+  int count;
+  svn_boolean_t ordered;
+} build_progress_t;
+
+/* Implements svn_fs_progress_notify_func_t for build_progress_t. */
+static void
+build_progress(svn_revnum_t revision,
+               void *baton,
+               apr_pool_t *pool)
+{
+  build_progress_t *b = baton;
+
+  if (!SVN_IS_VALID_REVNUM(b->first))
+    b->first = revision;
+  else if (revision != b->last + 1)
+    b->ordered = FALSE;
+
+  b->last = revision;
+  ++b->count;
+}
+
+/* Implements the walker of svn_fs_fs__walk_rep_reference() counting the
+ * entries in the int BATON. */
+static svn_error_t *
+count_rep_reference(representation_t *rep,
+                    void *baton,
+                    svn_fs_t *fs,
+                    apr_pool_t *pool)
+{
+  ++*(int *)baton;
+  return SVN_NO_ERROR;
+}
+
+/* Set *COUNT to the number of entries in the rep-cache of FS. */
+static svn_error_t *
+count_rep_references(int *count,
+                     svn_fs_t *fs,
+                     apr_pool_t *pool)
+{
+  svn_revnum_t youngest;
+
+  *count = 0;
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+  SVN_ERR(svn_fs_fs__walk_rep_reference(fs, 0, youngest,
+                                        count_rep_reference, count,
+                                        NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Commit COUNT revisions to FS that each change the contents of iota. */
+static svn_error_t *
+commit_iota_changes(svn_fs_t *fs,
+                    int count,
+                    apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < count; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+      svn_revnum_t rev;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_youngest_rev(&rev, fs, iterpool));
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool,
+                                                       "iota in r%ld\n",
+                                                       rev + 1),
+                                          iterpool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+build_rep_cache_incrementally(const svn_test_opts_t *opts,
+                              apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  svn_revnum_t built_rev;
+  int count;
+  const char *fs_path = "test-repo-build-rep-cache-incrementally";
+  svn_fs_fs__ioctl_build_rep_cache_input_t input = {0};
+  build_progress_t progress;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 15))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.15 SVN doesn't build the rep-cache "
+                            "incrementally");
+
+  /* Create a filesystem with 100 revisions without any rep-cache. */
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  ffd->rep_sharing_allowed = FALSE;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_ERR(commit_iota_changes(fs, 99, pool));
+
+  /* Build the rep-cache for all of them using several threads.
+   * The 12 files of the Greek tree plus 99 iota changes. */
+  ffd->rep_sharing_allowed = TRUE;
+
+  progress.first = SVN_INVALID_REVNUM;
+  progress.last = SVN_INVALID_REVNUM;
+  progress.count = 0;
+  progress.ordered = TRUE;
+
+  input.start_rev = SVN_INVALID_REVNUM;
+  input.end_rev = SVN_INVALID_REVNUM;
+  input.progress_func = build_progress;
+  input.progress_baton = &progress;
+  input.jobs = 4;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE,
+                       &input, NULL, NULL, NULL, pool, pool));
+
+  SVN_TEST_INT_ASSERT(progress.first, 1);
+  SVN_TEST_INT_ASSERT(progress.last, 100);
+  SVN_TEST_INT_ASSERT(progress.count, 100);
+  SVN_TEST_ASSERT(progress.ordered);
+
+  SVN_ERR(svn_fs_fs__get_rep_cache_built_rev(&built_rev, fs, pool));
+  SVN_TEST_INT_ASSERT(built_rev, 100);
+  SVN_ERR(count_rep_references(&count, fs, pool));
+  SVN_TEST_INT_ASSERT(count, 12 + 99);
+
+  /* Add revisions bypassing the rep-cache.  A re-run must only process
+   * those. */
+  ffd->rep_sharing_allowed = FALSE;
+  SVN_ERR(commit_iota_changes(fs, 10, pool));
+  ffd->rep_sharing_allowed = TRUE;
+
+  progress.first = SVN_INVALID_REVNUM;
+  progress.count = 0;
+  input.jobs = 1;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE,
+                       &input, NULL, NULL, NULL, pool, pool));
+
+  SVN_TEST_INT_ASSERT(progress.first, 101);
+  SVN_TEST_INT_ASSERT(progress.last, 110);
+  SVN_TEST_INT_ASSERT(progress.count, 10);
+  SVN_TEST_ASSERT(progress.ordered);
+
+  SVN_ERR(svn_fs_fs__get_rep_cache_built_rev(&built_rev, fs, pool));
+  SVN_TEST_INT_ASSERT(built_rev, 110);
+  SVN_ERR(count_rep_references(&count, fs, pool));
+  SVN_TEST_INT_ASSERT(count, 12 + 99 + 10);
+
+  /* Removing entries lowers the mark as well. */
+  SVN_ERR(svn_fs_fs__del_rep_reference(fs, 105, pool));
+  SVN_ERR(svn_fs_fs__get_rep_cache_built_rev(&built_rev, fs, pool));
+  SVN_TEST_INT_ASSERT(built_rev, 105);
+  SVN_ERR(count_rep_references(&count, fs, pool));
+  SVN_TEST_INT_ASSERT(count, 12 + 99 + 5);
+
+  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM,
+                        NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* ------------------------------------------------------------------------ */
+
+static svn_error_t *
+dag_node_cache_stats(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  static const char *paths[] = { "/A/B/E/alpha", "/A/B/E/beta", "/A/B/lambda",
+                                 "/A/D/G/pi", "/A/D/G/rho", "/A/D/G/tau",
+                                 "/A/D/H/chi", "/A/D/H/omega", "/A/D/H/psi",
+                                 "/A/D/gamma", "/A/mu", "/iota" };
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  svn_cache__info_t info;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int pass;
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  SVN_ERR(svn_test__create_fs2(&fs, "test-repo-dag-node-cache-stats", opts,
+                               NULL, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Walk all files several times.  Once the nodes made it into the 2nd
+   * level cache, they will be served from the 1st level cache. */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  for (pass = 0; pass < 3; ++pass)
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i)
+      {
+        svn_node_kind_t kind;
+
+        svn_pool_clear(iterpool);
+        SVN_ERR(svn_fs_check_path(&kind, rev_root, paths[i], iterpool));
+        SVN_TEST_ASSERT(kind == svn_node_file);
+      }
+
+  svn_pool_destroy(iterpool);
+
+  svn_fs_fs__get_dag_cache_info(&info, ((fs_fs_data_t *)fs->fsap_data)
+                                         ->dag_node_cache);
+  SVN_TEST_ASSERT(info.gets > 0);
+  SVN_TEST_ASSERT(info.hits > 0);
+  SVN_TEST_ASSERT(info.hits <= info.gets);
+  SVN_TEST_ASSERT(info.sets > 0);
+  SVN_TEST_ASSERT(info.used_entries > 0);
+  SVN_TEST_ASSERT(info.used_entries <= info.total_entries);
+
+  return SVN_NO_ERROR;
+}
+
+/* ------------------------------------------------------------------------ */
+
+/* Look up NAME in the serialized directory DATA of DATA_LEN bytes and
+ * verify that the result matches EXPECT_FOUND.  Use POOL for allocations.
+ */
+static svn_error_t *
+check_dir_entry_lookup(void *data,
+                       apr_size_t data_len,
+                       const char *name,
+                       svn_boolean_t expect_found,
+                       apr_pool_t *pool)
+{
+  extract_dir_entry_baton_t baton;
+  svn_fs_dirent_t *entry;
+
+  baton.name = name;
+  baton.txn_filesize = SVN_INVALID_FILESIZE;
+  baton.out_of_date = FALSE;
+  SVN_ERR(svn_fs_fs__extract_dir_entry((void **)&entry, data, data_len,
+                                       &baton, pool));
+
+  SVN_TEST_ASSERT(!baton.out_of_date);
+  if (expect_found)
+    {
+      SVN_TEST_ASSERT(entry);
+      SVN_TEST_STRING_ASSERT(entry->name, name);
+    }
+  else
+    {
+      SVN_TEST_ASSERT(entry == NULL);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Time LOOKUPS name lookups among the COUNT NAMES in the serialized
+ * directory DATA of DATA_LEN bytes and return the duration in *DURATION.
+ * Use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+time_dir_entry_lookups(apr_time_t *duration,
+                       void *data,
+                       apr_size_t data_len,
+                       const char **names,
+                       int count,
+                       int lookups,
+                       apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_time_t start = apr_time_now();
+  int i;
+
+  for (i = 0; i < lookups; ++i)
+    {
+      if (i % 1000 == 0)
+        svn_pool_clear(iterpool);
+
+      SVN_ERR(check_dir_entry_lookup(data, data_len,
+                                     names[(i * 7919) % count], TRUE,
+                                     iterpool));
+    }
+
+  *duration = apr_time_now() - start;
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+dir_entry_lookup_benchmark(const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  /* Directories with 1M entries take several 100 MB.
+   * Only include them when running with --verbose. */
+  static const int sizes[] = { 10, 100, 1000, 10000, 100000, 1000000 };
+  enum { LOOKUPS = 100000 };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_fs_fs__id_part_t node_id = { 0, 1 };
+  svn_fs_fs__id_part_t copy_id = { 0, 0 };
+  svn_fs_fs__id_part_t rev_item = { 1, 42 };
+  svn_fs_id_t *id = svn_fs_fs__id_rev_create(&node_id, &copy_id, &rev_item,
+                                             pool);
+  int size_count = sizeof(sizes) / sizeof(sizes[0]) - (opts->verbose ? 0 : 1);
+  int s;
+
+  for (s = 0; s < size_count; ++s)
+    {
+      int count = sizes[s];
+      svn_fs_fs__dir_data_t dir;
+      const char **names;
+      void *indexed;
+      apr_size_t indexed_len;
+      void *plain;
+      apr_size_t plain_len;
+      replace_baton_t replace_baton;
+      svn_fs_dirent_t *last;
+      apr_time_t indexed_duration;
+      apr_time_t plain_duration;
+      int i;
+
+      svn_pool_clear(iterpool);
+
+      /* Create a directory with COUNT entries, sorted by name. */
+      names = apr_palloc(iterpool, count * sizeof(*names));
+      dir.entries = apr_array_make(iterpool, count,
+                                   sizeof(svn_fs_dirent_t *));
+      dir.txn_filesize = SVN_INVALID_FILESIZE;
+      for (i = 0; i < count; ++i)
+        {
+          svn_fs_dirent_t *entry = apr_pcalloc(iterpool, sizeof(*entry));
+
+          entry->name = apr_psprintf(iterpool, "entry-%07d", i);
+          entry->id = id;
+          entry->kind = svn_node_file;
+
+          names[i] = entry->name;
+          APR_ARRAY_PUSH(dir.entries, svn_fs_dirent_t *) = entry;
+        }
+
+      /* Committed directories get a name index, if large enough. */
+      SVN_ERR(svn_fs_fs__serialize_dir_entries(&indexed, &indexed_len, &dir,
+                                               iterpool));
+
+      /* In-txn directories lose it once entries got removed or added in
+       * place.  Remove and re-add the last entry to get the same contents
+       * without index. */
+      SVN_ERR(svn_fs_fs__serialize_txndir_entries(&plain, &plain_len, &dir,
+                                                  iterpool));
+      last = APR_ARRAY_IDX(dir.entries, count - 1, svn_fs_dirent_t *);
+      replace_baton.name = last->name;
+      replace_baton.new_entry = NULL;
+      replace_baton.txn_filesize = SVN_INVALID_FILESIZE;
+      SVN_ERR(svn_fs_fs__replace_dir_entry(&plain, &plain_len,
+                                           &replace_baton, iterpool));
+      SVN_ERR(check_dir_entry_lookup(plain, plain_len, last->name, FALSE,
+                                     iterpool));
+      replace_baton.new_entry = last;
+      SVN_ERR(svn_fs_fs__replace_dir_entry(&plain, &plain_len,
+                                           &replace_baton, iterpool));
+
+      /* Only the committed variant of large directories has an index.
+       * The threshold is 128 entries. */
+      SVN_TEST_ASSERT(svn_fs_fs__dir_entries_indexed(indexed)
+                      == (count >= 1000));
+      SVN_TEST_ASSERT(!svn_fs_fs__dir_entries_indexed(plain));
+
+      /* Both must find all existing entries and nothing else. */
+      SVN_ERR(check_dir_entry_lookup(indexed, indexed_len, "entry-",
+                                     FALSE, iterpool));
+      SVN_ERR(check_dir_entry_lookup(indexed, indexed_len, "entry-9999999",
+                                     FALSE, iterpool));
+      SVN_ERR(check_dir_entry_lookup(plain, plain_len, "entry-", FALSE,
+                                     iterpool));
+      SVN_ERR(check_dir_entry_lookup(plain, plain_len, "entry-9999999",
+                                     FALSE, iterpool));
+
+      SVN_ERR(time_dir_entry_lookups(&indexed_duration, indexed,
+                                     indexed_len, names, count, LOOKUPS,
+                                     iterpool));
+      SVN_ERR(time_dir_entry_lookups(&plain_duration, plain, plain_len,
+                                     names, count, LOOKUPS, iterpool));
+
+      if (opts->verbose)
+        printf("%7d entries: %d lookups indexed %" APR_TIME_T_FMT " usec, "
+               "binary search %" APR_TIME_T_FMT " usec\n",
+               count, LOOKUPS, indexed_duration, plain_duration);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* The test table.  */
@@ -516,6 +942,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(build_rep_cache_incrementally,
+                       "build the representation cache incrementally"),
+    SVN_TEST_OPTS_PASS(dag_node_cache_stats,
+                       "DAG node cache statistics"),
+    SVN_TEST_OPTS_PASS(dir_entry_lookup_benchmark,
+                       "look up entries in large directories"),
     SVN_TEST_NULL
   };
 
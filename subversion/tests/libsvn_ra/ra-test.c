@@ -35,7 +35,11 @@
 #include "svn_pools.h"
 #include "svn_cmdline.h"
 #include "svn_dirent_uri.h"
+#include "svn_path.h"
 #include "svn_hash.h"
+#include "svn_checksum.h"
+
+#include "private/svn_ra_private.h"
 
 #include "../svn_test.h"
 #include "../svn_test_fs.h"
@@ -656,6 +660,59 @@ get_dir_test(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Check svn_ra__stat_many() in SESSION, which must contain the tree
+   created by commit_tree() in r1 and nothing else. */
+static svn_error_t *
+check_stat_many(svn_ra_session_t *session,
+                apr_pool_t *pool)
+{
+  apr_array_header_t *paths = apr_array_make(pool, 4, sizeof(const char *));
+  apr_hash_t *dirents;
+  svn_dirent_t *ent;
+
+  APR_ARRAY_PUSH(paths, const char *) = "A/B";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/g";
+  APR_ARRAY_PUSH(paths, const char *) = "A/C";
+  APR_ARRAY_PUSH(paths, const char *) = "";
+
+  SVN_ERR(svn_ra__stat_many(session, &dirents, paths, 1, pool, pool));
+
+  /* Missing paths are simply absent from the result. */
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 3);
+  SVN_TEST_ASSERT(svn_hash_gets(dirents, "A/C") == NULL);
+
+  ent = svn_hash_gets(dirents, "A/B");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_dir);
+  ent = svn_hash_gets(dirents, "A/BB/g");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_file);
+  SVN_TEST_INT_ASSERT(ent->created_rev, 1);
+  ent = svn_hash_gets(dirents, "");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_dir);
+
+  /* An invalid revision fails the whole request. */
+  SVN_TEST_ASSERT_ANY_ERROR(svn_ra__stat_many(session, &dirents, paths, 5,
+                                              pool, pool));
+
+  /* The session remains usable afterwards. */
+  SVN_ERR(svn_ra__stat_many(session, &dirents, paths, 1, pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 3);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test svn_ra__stat_many(). */
+static svn_error_t *
+stat_many_test(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+
+  SVN_ERR(make_and_open_repos(&session, "test-stat-many", opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  return svn_error_trace(check_stat_many(session, pool));
+}
+
 /* Implements svn_commit_callback2_t for commit_callback_failure() */
 static svn_error_t *
 commit_callback_with_failure(const svn_commit_info_t *info,
@@ -1612,6 +1669,398 @@ tunnel_run_checkout(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Test svn_ra_get_file() over a tunnel with contents large enough to be
+   sent in many strings, each of them bypassing the write buffer.  The
+   contents are stored as a self-delta in r1 and as a delta in r2. */
+static svn_error_t *
+tunnel_get_file(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  tunnel_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char tunnel_repos_name[] = "test-repo-tunnel-get-file";
+  const char *url;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  svn_stringbuf_t *text1;
+  svn_stringbuf_t *text2;
+  svn_stringbuf_t *contents;
+  svn_ra_session_t *session;
+  svn_ra_callbacks2_t *cbtable;
+  int i;
+
+  b->magic = TUNNEL_MAGIC;
+
+  SVN_ERR(svn_test__create_repos(NULL, tunnel_repos_name, opts, scratch_pool));
+  svn_pool_clear(scratch_pool);
+
+  text1 = svn_stringbuf_create_empty(pool);
+  for (i = 0; i < 100000; ++i)
+    svn_stringbuf_appendcstr(text1, apr_psprintf(scratch_pool, "line %d\n",
+                                                 i));
+  text2 = svn_stringbuf_dup(text1, pool);
+  svn_stringbuf_appendcstr(text2, "one more line\n");
+
+  SVN_ERR(svn_repos_open3(&repos, tunnel_repos_name, NULL, scratch_pool,
+                          scratch_pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "text", scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "text", text1->data,
+                                      scratch_pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, scratch_pool));
+  SVN_TEST_ASSERT(rev == 1);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "text", text2->data,
+                                      scratch_pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, scratch_pool));
+  SVN_TEST_ASSERT(rev == 2);
+
+  /* Close the repository before svnserve opens it. */
+  svn_pool_clear(scratch_pool);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = b;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+                                         TRUE  /* non_interactive */,
+                                         "jrandom", "rayjandom",
+                                         NULL,
+                                         TRUE  /* no_auth_cache */,
+                                         FALSE /* trust_server_cert */,
+                                         FALSE, FALSE, FALSE, FALSE,
+                                         NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL, url, NULL, cbtable,
+                       NULL, NULL, scratch_pool));
+
+  contents = svn_stringbuf_create_empty(scratch_pool);
+  SVN_ERR(svn_ra_get_file(session, "text", 1,
+                          svn_stream_from_stringbuf(contents, scratch_pool),
+                          NULL, NULL, scratch_pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(contents, text1));
+
+  contents = svn_stringbuf_create_empty(scratch_pool);
+  SVN_ERR(svn_ra_get_file(session, "text", 2,
+                          svn_stream_from_stringbuf(contents, scratch_pool),
+                          NULL, NULL, scratch_pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(contents, text2));
+
+  svn_pool_destroy(scratch_pool);
+  SVN_TEST_ASSERT(b->open_count == 0);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the editor that collects file contents in
+   tunnel_parallel_checkout() and tunnel_switched_parallel_update(). */
+typedef struct collect_baton_t
+{
+  apr_hash_t *contents;
+  apr_pool_t *pool;
+} collect_baton_t;
+
+/* Implements svn_delta_editor_t.add_file for collect_baton_t. */
+static svn_error_t *
+collect_add_file(const char *path,
+                 void *parent_baton,
+                 const char *copyfrom_path,
+                 svn_revnum_t copyfrom_revision,
+                 apr_pool_t *pool,
+                 void **file_baton)
+{
+  collect_baton_t *b = parent_baton;
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(b->pool);
+
+  svn_hash_sets(b->contents, apr_pstrdup(b->pool, path), buf);
+  *file_baton = buf;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_delta_editor_t.apply_textdelta for collect_baton_t. */
+static svn_error_t *
+collect_apply_textdelta(void *file_baton,
+                        const char *base_checksum,
+                        apr_pool_t *pool,
+                        svn_txdelta_window_handler_t *handler,
+                        void **handler_baton)
+{
+  svn_stringbuf_t *buf = file_baton;
+
+  svn_txdelta_apply(svn_stream_empty(pool),
+                    svn_stream_from_stringbuf(buf, pool),
+                    NULL, NULL, pool, handler, handler_baton);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_delta_editor_t.open_root for collect_baton_t. */
+static svn_error_t *
+collect_open_root(void *edit_baton,
+                  svn_revnum_t base_revision,
+                  apr_pool_t *pool,
+                  void **root_baton)
+{
+  *root_baton = edit_baton;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_delta_editor_t.open_directory for collect_baton_t. */
+static svn_error_t *
+collect_open_directory(const char *path,
+                       void *parent_baton,
+                       svn_revnum_t base_revision,
+                       apr_pool_t *pool,
+                       void **child_baton)
+{
+  *child_baton = parent_baton;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_delta_editor_t.add_directory for collect_baton_t. */
+static svn_error_t *
+collect_add_directory(const char *path,
+                      void *parent_baton,
+                      const char *copyfrom_path,
+                      svn_revnum_t copyfrom_revision,
+                      apr_pool_t *pool,
+                      void **child_baton)
+{
+  *child_baton = parent_baton;
+  return SVN_NO_ERROR;
+}
+
+/* Check out over a tunnel with file contents being fetched concurrently
+   over additional connections. */
+static svn_error_t *
+tunnel_parallel_checkout(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  tunnel_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char *url;
+  svn_ra_callbacks2_t *cbtable;
+  svn_ra_session_t *session;
+  const char tunnel_repos_name[] = "test-parallel_checkout";
+  const svn_ra_reporter3_t *reporter;
+  void *report_baton;
+  apr_hash_t *config = apr_hash_make(pool);
+  svn_config_t *servers;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *root_baton, *file_baton;
+  svn_delta_editor_t *collect_editor;
+  collect_baton_t *cb = apr_pcalloc(pool, sizeof(*cb));
+  int i;
+
+  b->magic = TUNNEL_MAGIC;
+
+  SVN_ERR(svn_test__create_repos(NULL, tunnel_repos_name, opts, scratch_pool));
+
+  /* Immediately close the repository to avoid race condition with svnserve
+  (and then the cleanup code) with BDB when our pool is cleared. */
+  svn_pool_clear(scratch_pool);
+
+  SVN_ERR(svn_config_create2(&servers, FALSE, FALSE, pool));
+  svn_config_set(servers, SVN_CONFIG_SECTION_GLOBAL,
+                 SVN_CONFIG_OPTION_SVN_MAX_CONNECTIONS, "3");
+  svn_hash_sets(config, SVN_CONFIG_CATEGORY_SERVERS, servers);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = b;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+    TRUE  /* non_interactive */,
+    "jrandom", "rayjandom",
+    NULL,
+    TRUE  /* no_auth_cache */,
+    FALSE /* trust_server_cert */,
+    FALSE, FALSE, FALSE, FALSE,
+    NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL, url, NULL, cbtable, NULL,
+                       config, pool));
+
+  /* Commit a few files with contents. */
+  SVN_ERR(svn_ra_get_commit_editor3(session, &editor, &edit_baton,
+                                    apr_hash_make(pool),
+                                    NULL, NULL, NULL, TRUE, pool));
+  SVN_ERR(editor->open_root(edit_baton, SVN_INVALID_REVNUM,
+                            pool, &root_baton));
+  for (i = 0; i < 50; i++)
+    {
+      svn_txdelta_window_handler_t handler;
+      void *handler_baton;
+      const char *name = apr_psprintf(pool, "f%d", i);
+
+      SVN_ERR(editor->add_file(name, root_baton, NULL, SVN_INVALID_REVNUM,
+                               pool, &file_baton));
+      SVN_ERR(editor->apply_textdelta(file_baton, NULL, pool,
+                                      &handler, &handler_baton));
+      SVN_ERR(svn_txdelta_send_string(svn_string_createf(pool,
+                                                         "contents of %s\n",
+                                                         name),
+                                      handler, handler_baton, pool));
+      SVN_ERR(editor->close_file(file_baton, NULL, pool));
+    }
+  SVN_ERR(editor->close_directory(root_baton, pool));
+  SVN_ERR(editor->close_edit(edit_baton, pool));
+
+  /* Check them out again. */
+  cb->contents = apr_hash_make(pool);
+  cb->pool = pool;
+  collect_editor = svn_delta_default_editor(pool);
+  collect_editor->open_root = collect_open_root;
+  collect_editor->add_file = collect_add_file;
+  collect_editor->apply_textdelta = collect_apply_textdelta;
+
+  SVN_ERR(svn_ra_do_update3(session, &reporter, &report_baton,
+                            1, "", svn_depth_infinity, FALSE, FALSE,
+                            collect_editor, cb, pool, pool));
+  SVN_ERR(reporter->set_path(report_baton, "", 0, svn_depth_infinity, TRUE,
+                             NULL, pool));
+  SVN_ERR(reporter->finish_report(report_baton, pool));
+
+  SVN_TEST_INT_ASSERT(apr_hash_count(cb->contents), 50);
+  for (i = 0; i < 50; i++)
+    {
+      const char *name = apr_psprintf(pool, "f%d", i);
+      svn_stringbuf_t *buf = svn_hash_gets(cb->contents, name);
+
+      SVN_TEST_ASSERT(buf != NULL);
+      SVN_TEST_STRING_ASSERT(buf->data,
+                             apr_psprintf(pool, "contents of %s\n", name));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Update a working copy with a switched subdirectory over a tunnel with
+   file contents being fetched concurrently over additional connections. */
+static svn_error_t *
+tunnel_switched_parallel_update(const svn_test_opts_t *opts,
+                                apr_pool_t *pool)
+{
+  tunnel_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char tunnel_repos_name[] = "test-switched-parallel-update";
+  const char *url;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  svn_ra_callbacks2_t *cbtable;
+  svn_ra_session_t *session;
+  const svn_ra_reporter3_t *reporter;
+  void *report_baton;
+  apr_hash_t *config = apr_hash_make(pool);
+  svn_config_t *servers;
+  svn_delta_editor_t *collect_editor;
+  collect_baton_t *cb = apr_pcalloc(pool, sizeof(*cb));
+  svn_stringbuf_t *buf;
+
+  b->magic = TUNNEL_MAGIC;
+
+  SVN_ERR(svn_test__create_repos(NULL, tunnel_repos_name, opts, scratch_pool));
+  svn_pool_clear(scratch_pool);
+
+  /* Create /trunk and a branch that differs in its "sub" directory. */
+  SVN_ERR(svn_repos_open3(&repos, tunnel_repos_name, NULL, scratch_pool,
+                          scratch_pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "trunk", scratch_pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "trunk/top", scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "trunk/top",
+                                      "top on trunk\n", scratch_pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "trunk/sub", scratch_pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "trunk/sub/f", scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "trunk/sub/f",
+                                      "f on trunk\n", scratch_pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "branches", scratch_pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "branches/b", scratch_pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "branches/b/sub", scratch_pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "branches/b/sub/f", scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "branches/b/sub/f",
+                                      "f on branch\n", scratch_pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, scratch_pool));
+  SVN_TEST_ASSERT(rev == 1);
+
+  /* Close the repository before the server opens it. */
+  svn_pool_clear(scratch_pool);
+
+  SVN_ERR(svn_config_create2(&servers, FALSE, FALSE, pool));
+  svn_config_set(servers, SVN_CONFIG_SECTION_GLOBAL,
+                 SVN_CONFIG_OPTION_SVN_MAX_CONNECTIONS, "3");
+  svn_hash_sets(config, SVN_CONFIG_CATEGORY_SERVERS, servers);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = b;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+    TRUE  /* non_interactive */,
+    "jrandom", "rayjandom",
+    NULL,
+    TRUE  /* no_auth_cache */,
+    FALSE /* trust_server_cert */,
+    FALSE, FALSE, FALSE, FALSE,
+    NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL,
+                       svn_path_url_add_component2(url, "trunk", pool),
+                       NULL, cbtable, NULL, config, pool));
+
+  /* Report a working copy of /trunk with "sub" switched to the branch. */
+  cb->contents = apr_hash_make(pool);
+  cb->pool = pool;
+  collect_editor = svn_delta_default_editor(pool);
+  collect_editor->open_root = collect_open_root;
+  collect_editor->open_directory = collect_open_directory;
+  collect_editor->add_directory = collect_add_directory;
+  collect_editor->add_file = collect_add_file;
+  collect_editor->apply_textdelta = collect_apply_textdelta;
+
+  SVN_ERR(svn_ra_do_update3(session, &reporter, &report_baton,
+                            1, "", svn_depth_infinity, FALSE, FALSE,
+                            collect_editor, cb, pool, pool));
+  SVN_ERR(reporter->set_path(report_baton, "", 1, svn_depth_infinity, TRUE,
+                             NULL, pool));
+  SVN_ERR(reporter->link_path(report_baton, "sub",
+                              svn_path_url_add_component2(url,
+                                                          "branches/b/sub",
+                                                          pool),
+                              1, svn_depth_infinity, TRUE, NULL, pool));
+  SVN_ERR(reporter->finish_report(report_baton, pool));
+
+  /* Files below "sub" must come from the branch. */
+  SVN_TEST_INT_ASSERT(apr_hash_count(cb->contents), 2);
+  buf = svn_hash_gets(cb->contents, "top");
+  SVN_TEST_ASSERT(buf != NULL);
+  SVN_TEST_STRING_ASSERT(buf->data, "top on trunk\n");
+  buf = svn_hash_gets(cb->contents, "sub/f");
+  SVN_TEST_ASSERT(buf != NULL);
+  SVN_TEST_STRING_ASSERT(buf->data, "f on branch\n");
+
+  return SVN_NO_ERROR;
+}
+
 /* Implements svn_log_entry_receiver_t for commit_empty_last_change */
 static svn_error_t *
 AA_receiver(void *baton,
@@ -1878,6 +2327,333 @@ test_get_deleted_rev_errors(const svn_test_opts_t *opts,
 }
 
 
+/* Set *SESSION to a new session to URL that uses CACHE_DIR as its
+   http-cache-dir, holding at most CACHE_SIZE megabytes. */
+static svn_error_t *
+open_http_cache_session(svn_ra_session_t **session,
+                        const char *url,
+                        const char *cache_dir,
+                        int cache_size,
+                        apr_pool_t *pool)
+{
+  svn_ra_callbacks2_t *cbtable;
+  apr_hash_t *config = apr_hash_make(pool);
+  svn_config_t *servers;
+
+  SVN_ERR(svn_config_create2(&servers, FALSE, FALSE, pool));
+  svn_config_set(servers, SVN_CONFIG_SECTION_GLOBAL,
+                 SVN_CONFIG_OPTION_HTTP_CACHE_DIR, cache_dir);
+  svn_config_set(servers, SVN_CONFIG_SECTION_GLOBAL,
+                 SVN_CONFIG_OPTION_HTTP_CACHE_SIZE,
+                 apr_itoa(pool, cache_size));
+  svn_hash_sets(config, SVN_CONFIG_CATEGORY_SERVERS, servers);
+
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  SVN_ERR(svn_test__init_auth_baton(&cbtable->auth_baton, pool));
+
+  SVN_ERR(svn_ra_open5(session, NULL, NULL, url, NULL, cbtable, NULL,
+                       config, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *PATH to the first entry in the http cache directory CACHE_DIR whose
+   key starts with PREFIX, or to NULL if there is none.  Set *COUNT to the
+   number of such entries and *TOTAL_SIZE to the size of all entries. */
+static svn_error_t *
+find_http_cache_entry(const char **path,
+                      int *count,
+                      apr_int64_t *total_size,
+                      const char *cache_dir,
+                      const char *prefix,
+                      apr_pool_t *pool)
+{
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+
+  *path = NULL;
+  *count = 0;
+  *total_size = 0;
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache_dir, FALSE, pool, pool));
+  for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+      const char *entry_path;
+      svn_stringbuf_t *contents;
+
+      if (dirent->kind != svn_node_file)
+        continue;
+
+      entry_path = svn_dirent_join(cache_dir, apr_hash_this_key(hi), pool);
+      SVN_ERR(svn_stringbuf_from_file2(&contents, entry_path, pool));
+
+      *total_size += dirent->filesize;
+      if (strncmp(contents->data, prefix, strlen(prefix)) == 0)
+        {
+          if (!*path)
+            *path = entry_path;
+          ++*count;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Split the http cache entry at PATH into its KEY line, CHECKSUM line and
+   DATA. */
+static svn_error_t *
+read_http_cache_entry(const char **key,
+                      const char **checksum,
+                      const char **data,
+                      const char *path,
+                      apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents;
+  char *eol;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, path, pool));
+
+  *key = contents->data;
+  eol = strchr(contents->data, '\n');
+  SVN_TEST_ASSERT(eol);
+  *eol = '\0';
+
+  *checksum = eol + 1;
+  eol = strchr(eol + 1, '\n');
+  SVN_TEST_ASSERT(eol);
+  *eol = '\0';
+
+  *data = eol + 1;
+
+  return SVN_NO_ERROR;
+}
+
+/* Replace the http cache entry at PATH by one with KEY, claiming that
+   the SHA-1 of its DATA is that of CHECKSUM_OF. */
+static svn_error_t *
+write_http_cache_entry(const char *path,
+                       const char *key,
+                       const char *data,
+                       const char *checksum_of,
+                       apr_pool_t *pool)
+{
+  svn_checksum_t *checksum;
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, checksum_of,
+                       strlen(checksum_of), pool));
+  SVN_ERR(svn_io_file_create(path,
+                             apr_psprintf(pool, "%s\n%s\n%s", key,
+                                          svn_checksum_to_cstring_display(
+                                                        checksum, pool),
+                                          data),
+                             pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_file_rev_handler_t, counting the revisions in the
+   int that BATON points to. */
+static svn_error_t *
+count_file_rev_handler(void *baton,
+                       const char *path,
+                       svn_revnum_t rev,
+                       apr_hash_t *rev_props,
+                       svn_boolean_t result_of_merge,
+                       svn_txdelta_window_handler_t *delta_handler,
+                       void **delta_baton,
+                       apr_array_header_t *prop_diffs,
+                       apr_pool_t *pool)
+{
+  int *count = baton;
+
+  ++*count;
+  if (delta_handler)
+    *delta_handler = svn_delta_noop_window_handler;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+http_cache_test(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  static const char original[] = "original contents\n";
+  static const char cached[] = "cached contents\n";
+  svn_ra_session_t *session;
+  svn_repos_t *repos;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  const char *url;
+  const char *cache_dir;
+  const char *entry;
+  const char *key, *checksum, *data;
+  svn_stringbuf_t *contents;
+  apr_hash_t *props;
+  apr_int64_t total_size;
+  int count;
+  int revs;
+
+  /* The cache is specific to ra_serf. */
+  if (!opts->repos_url || strncmp(opts->repos_url, "http", 4) != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this test requires an http:// repository");
+
+  SVN_ERR(svn_test__create_repos2(&repos, &url, NULL, "test-http-cache",
+                                  opts, scratch_pool, scratch_pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, svn_repos_fs(repos), 0, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "f", scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "f", original,
+                                      scratch_pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, scratch_pool));
+  SVN_TEST_ASSERT(rev == 1);
+
+  /* Close the repository before the server opens it. */
+  url = apr_pstrdup(pool, url);
+  svn_pool_clear(scratch_pool);
+
+  SVN_ERR(svn_test_make_sandbox_dir(&cache_dir, "ra-http-cache", pool));
+  SVN_ERR(open_http_cache_session(&session, url, cache_dir, 16, pool));
+
+  /* Miss: the server's response gets into the cache. */
+  contents = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_ra_get_file(session, "f", 1,
+                          svn_stream_from_stringbuf(contents, pool),
+                          NULL, &props, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, original);
+
+  SVN_ERR(find_http_cache_entry(&entry, &count, &total_size, cache_dir,
+                                "props 1 ", pool));
+  SVN_TEST_INT_ASSERT(count, 1);
+  SVN_ERR(find_http_cache_entry(&entry, &count, &total_size, cache_dir,
+                                "text 1 ", pool));
+  SVN_TEST_INT_ASSERT(count, 1);
+  SVN_ERR(read_http_cache_entry(&key, &checksum, &data, entry, pool));
+  SVN_TEST_STRING_ASSERT(data, original);
+
+  /* Hit: a valid entry is used instead of asking the server. */
+  SVN_ERR(write_http_cache_entry(entry, key, cached, cached, pool));
+  contents = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_ra_get_file(session, "f", 1,
+                          svn_stream_from_stringbuf(contents, pool),
+                          NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, cached);
+
+  /* Corrupt entry: gets ignored and replaced by the server's data. */
+  SVN_ERR(write_http_cache_entry(entry, key, "corrupt contents\n", cached,
+                                 pool));
+  contents = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_ra_get_file(session, "f", 1,
+                          svn_stream_from_stringbuf(contents, pool),
+                          NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, original);
+
+  SVN_ERR(read_http_cache_entry(&key, &checksum, &data, entry, pool));
+  SVN_TEST_STRING_ASSERT(data, original);
+
+  /* Blame reports get cached and replayed as well. */
+  revs = 0;
+  SVN_ERR(svn_ra_get_file_revs2(session, "f", 1, 1, FALSE,
+                                count_file_rev_handler, &revs, pool));
+  SVN_TEST_INT_ASSERT(revs, 1);
+
+  SVN_ERR(find_http_cache_entry(&entry, &count, &total_size, cache_dir,
+                                "file-revs 1 0 ", pool));
+  SVN_TEST_INT_ASSERT(count, 1);
+
+  revs = 0;
+  SVN_ERR(svn_ra_get_file_revs2(session, "f", 1, 1, FALSE,
+                                count_file_rev_handler, &revs, pool));
+  SVN_TEST_INT_ASSERT(revs, 1);
+
+  svn_pool_destroy(scratch_pool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+http_cache_eviction_test(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  svn_ra_session_t *session;
+  svn_repos_t *repos;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  const char *url;
+  const char *cache_dir;
+  const char *entry;
+  svn_stringbuf_t *text;
+  apr_int64_t total_size;
+  int count;
+  int i;
+
+  /* The cache is specific to ra_serf. */
+  if (!opts->repos_url || strncmp(opts->repos_url, "http", 4) != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this test requires an http:// repository");
+
+  /* 5 files of about 300kB each, i.e. more than fits into 1MB. */
+  text = svn_stringbuf_create_empty(pool);
+  for (i = 0; i < 30000; ++i)
+    svn_stringbuf_appendcstr(text, apr_psprintf(scratch_pool,
+                                                "line %8d\n", i));
+
+  SVN_ERR(svn_test__create_repos2(&repos, &url, NULL,
+                                  "test-http-cache-eviction",
+                                  opts, scratch_pool, scratch_pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, svn_repos_fs(repos), 0, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  for (i = 0; i < 5; ++i)
+    {
+      const char *name = apr_psprintf(scratch_pool, "f%d", i);
+
+      SVN_ERR(svn_fs_make_file(txn_root, name, scratch_pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, name,
+                                          apr_psprintf(scratch_pool, "%s%s",
+                                                       name, text->data),
+                                          scratch_pool));
+    }
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, scratch_pool));
+  SVN_TEST_ASSERT(rev == 1);
+
+  /* Close the repository before the server opens it. */
+  url = apr_pstrdup(pool, url);
+  svn_pool_clear(scratch_pool);
+
+  SVN_ERR(svn_test_make_sandbox_dir(&cache_dir, "ra-http-cache-eviction",
+                                    pool));
+  SVN_ERR(open_http_cache_session(&session, url, cache_dir, 1, pool));
+
+  for (i = 0; i < 5; ++i)
+    {
+      svn_stringbuf_t *contents = svn_stringbuf_create_empty(scratch_pool);
+      const char *name = apr_psprintf(scratch_pool, "f%d", i);
+
+      SVN_ERR(svn_ra_get_file(session, name, 1,
+                              svn_stream_from_stringbuf(contents,
+                                                        scratch_pool),
+                              NULL, NULL, scratch_pool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             apr_psprintf(scratch_pool, "%s%s", name,
+                                          text->data));
+      svn_pool_clear(scratch_pool);
+    }
+
+  /* Older entries made room for the newer ones. */
+  SVN_ERR(find_http_cache_entry(&entry, &count, &total_size, cache_dir,
+                                "text 1 ", pool));
+  SVN_TEST_ASSERT(count > 0 && count < 5);
+  SVN_TEST_ASSERT(total_size <= 1024 * 1024);
+
+  svn_pool_destroy(scratch_pool);
+  return SVN_NO_ERROR;
+}
+
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -1895,6 +2671,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "lock multiple paths"),
     SVN_TEST_OPTS_PASS(get_dir_test,
                        "test ra_get_dir2"),
+    SVN_TEST_OPTS_PASS(stat_many_test,
+                       "test svn_ra__stat_many"),
     SVN_TEST_OPTS_PASS(commit_callback_failure,
                        "commit callback failure"),
     SVN_TEST_OPTS_PASS(base_revision_above_youngest,
@@ -1909,6 +2687,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "check list has_props performance"),
     SVN_TEST_OPTS_PASS(tunnel_run_checkout,
                        "verify checkout over a tunnel"),
+    SVN_TEST_OPTS_PASS(tunnel_parallel_checkout,
+                       "checkout over a tunnel fetching files in parallel"),
+    SVN_TEST_OPTS_PASS(tunnel_switched_parallel_update,
+                       "update a switched subtree fetching files in parallel"),
+    SVN_TEST_OPTS_PASS(tunnel_get_file,
+                       "get-file of large contents over a tunnel"),
+    SVN_TEST_OPTS_PASS(tunnel_stat_many,
+                       "batched stat over a tunnel with an unreadable path"),
     SVN_TEST_OPTS_PASS(commit_empty_last_change,
                        "check how last change applies to empty commit"),
     SVN_TEST_OPTS_PASS(commit_locked_file,
@@ -1917,6 +2703,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test get-deleted-rev no delete"),
     SVN_TEST_OPTS_PASS(test_get_deleted_rev_errors,
                        "test get-deleted-rev errors"),
+    SVN_TEST_OPTS_PASS(http_cache_test,
+                       "http cache hits, misses and corrupt entries"),
+    SVN_TEST_OPTS_PASS(http_cache_eviction_test,
+                       "http cache eviction by http-cache-size"),
     SVN_TEST_NULL
   };
 
@@ -0,0 +1,430 @@
+/*
+ * ra-svn-test.c :  tests for the ra_svn marshaling layer
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <apr_general.h>
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_time.h>
+
+#include "svn_error.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+#include "svn_ra_svn.h"
+
+#include "private/svn_ra_svn_private.h"
+
+#include "../svn_test.h"
+
+/*-------------------------------------------------------------------*/
+
+/** Helper routines. **/
+
+/* Return a connection that reads INPUT and discards all output.
+ * Allocate it in POOL. */
+static svn_ra_svn_conn_t *
+create_conn(const char *input,
+            apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create(input, pool);
+
+  return svn_ra_svn_create_conn5(NULL,
+                                 svn_stream_from_stringbuf(buffer, pool),
+                                 svn_stream_empty(pool),
+                                 0, 0, 0, 0, 0, pool);
+}
+
+/* Receiver baton that logs all items in a textual form that happens to
+ * be very close to the wire format. */
+typedef struct log_baton_t
+{
+  svn_stringbuf_t *log;
+  int items;
+} log_baton_t;
+
+static svn_error_t *
+log_number(void *baton,
+           apr_uint64_t value)
+{
+  log_baton_t *b = baton;
+
+  svn_stringbuf_appendcstr(b->log,
+                           apr_psprintf(b->log->pool,
+                                        "%" APR_UINT64_T_FMT " ", value));
+  ++b->items;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+log_string(void *baton,
+           const char *data,
+           apr_size_t len)
+{
+  log_baton_t *b = baton;
+
+  svn_stringbuf_appendcstr(b->log,
+                           apr_psprintf(b->log->pool, "%" APR_SIZE_T_FMT ":",
+                                        len));
+  svn_stringbuf_appendbytes(b->log, data, len);
+  svn_stringbuf_appendbyte(b->log, ' ');
+  ++b->items;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+log_word(void *baton,
+         const char *data,
+         apr_size_t len)
+{
+  log_baton_t *b = baton;
+
+  svn_stringbuf_appendbytes(b->log, data, len);
+  svn_stringbuf_appendbyte(b->log, ' ');
+  ++b->items;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+log_start_list(void *baton)
+{
+  log_baton_t *b = baton;
+
+  svn_stringbuf_appendcstr(b->log, "( ");
+  ++b->items;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+log_end_list(void *baton)
+{
+  log_baton_t *b = baton;
+
+  svn_stringbuf_appendcstr(b->log, ") ");
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_ra_svn__item_receiver_t log_receiver =
+  { log_number, log_string, log_word, log_start_list, log_end_list };
+
+/* Receiver callbacks that only count the items in the int BATON. */
+static svn_error_t *
+count_number(void *baton,
+             apr_uint64_t value)
+{
+  ++*(int *)baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_data(void *baton,
+           const char *data,
+           apr_size_t len)
+{
+  ++*(int *)baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_start_list(void *baton)
+{
+  ++*(int *)baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_end_list(void *baton)
+{
+  return SVN_NO_ERROR;
+}
+
+static const svn_ra_svn__item_receiver_t count_receiver =
+  { count_number, count_data, count_data, count_start_list, count_end_list };
+
+/* Return the number of items in ITEM, including ITEM itself. */
+static int
+count_items(const svn_ra_svn__item_t *item)
+{
+  int count = 1;
+  int i;
+
+  if (item->kind == SVN_RA_SVN_LIST)
+    for (i = 0; i < item->u.list.nelts; ++i)
+      count += count_items(&SVN_RA_SVN__LIST_ITEM(&item->u.list, i));
+
+  return count;
+}
+
+/* Return a get-dir style response with COUNT dirents in it. */
+static const char *
+create_dirent_list(int count,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+  int i;
+
+  svn_stringbuf_appendcstr(buffer, "( success ( 42 ( ) ( ");
+  for (i = 0; i < count; ++i)
+    {
+      const char *name = apr_psprintf(pool, "file-name-%d.c", i);
+      const char *date = "2019-09-30T12:34:56.123456Z";
+
+      svn_stringbuf_appendcstr(buffer,
+                               apr_psprintf(pool,
+                                            "( %d:%s file %d false %d "
+                                            "( %d:%s ) ( 6:author ) ) ",
+                                            (int)strlen(name), name,
+                                            i * 17 % 100000, i,
+                                            (int)strlen(date), date));
+    }
+  svn_stringbuf_appendcstr(buffer, ") ) ) ");
+
+  return buffer->data;
+}
+
+/*-------------------------------------------------------------------*/
+
+/** The tests **/
+
+static svn_error_t *
+test_receive_item(apr_pool_t *pool)
+{
+  log_baton_t baton;
+  svn_ra_svn_conn_t *conn;
+  svn_stringbuf_t *input;
+  svn_stringbuf_t *expected;
+  svn_stringbuf_t *large = svn_stringbuf_create_empty(pool);
+  int i;
+
+  /* A string much larger than the connection's read buffer. */
+  for (i = 0; i < 10000; ++i)
+    svn_stringbuf_appendcstr(large, "0123456789");
+
+  input = svn_stringbuf_create("( success ( 18446744073709551615 "
+                               "( word a-b-c 0: 3:x y ) ) ) ",
+                               pool);
+  svn_stringbuf_appendcstr(input,
+                           apr_psprintf(pool, "%" APR_SIZE_T_FMT ":",
+                                        large->len));
+  svn_stringbuf_appendstr(input, large);
+  svn_stringbuf_appendcstr(input, "\n( ) ");
+
+  expected = svn_stringbuf_dup(input, pool);
+  conn = create_conn(input->data, pool);
+
+  baton.log = svn_stringbuf_create_empty(pool);
+  baton.items = 0;
+  for (i = 0; i < 3; ++i)
+    SVN_ERR(svn_ra_svn__receive_item(conn, &log_receiver, &baton, pool));
+
+  /* The log uses blanks where the input has a newline. */
+  expected->data[expected->len - 5] = ' ';
+  SVN_TEST_STRING_ASSERT(baton.log->data, expected->data);
+  SVN_TEST_INT_ASSERT(baton.items, 12);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_receive_item_errors(apr_pool_t *pool)
+{
+  static const svn_ra_svn__item_receiver_t strings_only =
+    { NULL, log_string, NULL, NULL, NULL };
+  log_baton_t baton;
+  char too_deep[2 * 100 + 2];
+  int i;
+
+  baton.log = svn_stringbuf_create_empty(pool);
+  baton.items = 0;
+
+  /* Bad item terminator. */
+  SVN_TEST_ASSERT_ERROR(svn_ra_svn__receive_item(create_conn("42x ", pool),
+                                                 &log_receiver, &baton,
+                                                 pool),
+                        SVN_ERR_RA_SVN_MALFORMED_DATA);
+
+  /* Word of more than 24 chars. */
+  SVN_TEST_ASSERT_ERROR(
+    svn_ra_svn__receive_item(create_conn("abcdefghijklmnopqrstuvwxyz ",
+                                         pool),
+                             &log_receiver, &baton, pool),
+    SVN_ERR_RA_SVN_MALFORMED_DATA);
+
+  /* Number overflow. */
+  SVN_TEST_ASSERT_ERROR(
+    svn_ra_svn__receive_item(create_conn("18446744073709551616 ", pool),
+                             &log_receiver, &baton, pool),
+    SVN_ERR_RA_SVN_MALFORMED_DATA);
+
+  /* Truncated string. */
+  SVN_TEST_ASSERT_ERROR(svn_ra_svn__receive_item(create_conn("10:abc", pool),
+                                                 &log_receiver, &baton,
+                                                 pool),
+                        SVN_ERR_RA_SVN_CONNECTION_CLOSED);
+
+  /* Nesting limit. */
+  for (i = 0; i < 100; ++i)
+    {
+      too_deep[i] = '(';
+      too_deep[200 - i - 1] = ')';
+    }
+  too_deep[200] = ' ';
+  too_deep[201] = '\0';
+  SVN_TEST_ASSERT_ERROR(svn_ra_svn__receive_item(create_conn(too_deep, pool),
+                                                 &log_receiver, &baton,
+                                                 pool),
+                        SVN_ERR_RA_SVN_MALFORMED_DATA);
+
+  /* Unexpected item kind. */
+  SVN_ERR(svn_ra_svn__receive_item(create_conn("3:abc ", pool),
+                                   &strings_only, &baton, pool));
+  SVN_TEST_ASSERT_ERROR(svn_ra_svn__receive_item(create_conn("( ) ", pool),
+                                                 &strings_only, &baton,
+                                                 pool),
+                        SVN_ERR_RA_SVN_MALFORMED_DATA);
+
+  return SVN_NO_ERROR;
+}
+
+/* Assert that buffering INPUT as a command reports COMPLETE and
+ * TERMINATED.  Use POOL for allocations. */
+static svn_error_t *
+check_buffer_command(const char *input,
+                     svn_boolean_t complete,
+                     svn_boolean_t terminated,
+                     apr_pool_t *pool)
+{
+  svn_boolean_t is_complete;
+  svn_boolean_t is_terminated;
+
+  SVN_ERR(svn_ra_svn__buffer_command(&is_complete, &is_terminated,
+                                     create_conn(input, pool), pool));
+  SVN_TEST_ASSERT(is_complete == complete);
+  SVN_TEST_ASSERT(is_terminated == terminated);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_buffer_command(apr_pool_t *pool)
+{
+  SVN_ERR(check_buffer_command("( get-latest-rev ( ) ) ", TRUE, FALSE, pool));
+  SVN_ERR(check_buffer_command("  ( stat ( 0: ( 1 ) ) ) ", TRUE, FALSE,
+                               pool));
+
+  /* Incomplete lists, words and strings. */
+  SVN_ERR(check_buffer_command("( get-latest-rev ( ", FALSE, FALSE, pool));
+  SVN_ERR(check_buffer_command("( get-lat", FALSE, FALSE, pool));
+  SVN_ERR(check_buffer_command("( stat ( 10:abc", FALSE, FALSE, pool));
+
+  /* Parens within strings don't count. */
+  SVN_ERR(check_buffer_command("( stat ( 2:)) ", FALSE, FALSE, pool));
+  SVN_ERR(check_buffer_command("( stat ( 2:)) ) ) ", TRUE, FALSE, pool));
+
+  /* Malformed data gets passed on to the actual parser. */
+  SVN_ERR(check_buffer_command("( ! ", TRUE, FALSE, pool));
+
+  /* Nothing received yet. */
+  SVN_ERR(check_buffer_command("", FALSE, FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+marshal_benchmark(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  enum { DIRENT_COUNT = 20000, REPEAT = 5 };
+  const char *input = create_dirent_list(DIRENT_COUNT, pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t start;
+  apr_time_t tree_duration;
+  apr_time_t receiver_duration;
+  int tree_items = 0;
+  int received_items = 0;
+  int i;
+
+  /* Parse into an item tree. */
+  start = apr_time_now();
+  for (i = 0; i < REPEAT; ++i)
+    {
+      svn_ra_svn__item_t *item;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__read_item(create_conn(input, iterpool), iterpool,
+                                    &item));
+      tree_items = count_items(item);
+    }
+  tree_duration = apr_time_now() - start;
+
+  /* Stream the items to a receiver that does little more than that. */
+  start = apr_time_now();
+  for (i = 0; i < REPEAT; ++i)
+    {
+      svn_pool_clear(iterpool);
+      received_items = 0;
+      SVN_ERR(svn_ra_svn__receive_item(create_conn(input, iterpool),
+                                       &count_receiver, &received_items,
+                                       iterpool));
+    }
+  receiver_duration = apr_time_now() - start;
+
+  svn_pool_destroy(iterpool);
+
+  if (opts->verbose)
+    printf("%d dirents: item tree %" APR_TIME_T_FMT " usec, "
+           "receiver %" APR_TIME_T_FMT " usec\n",
+           DIRENT_COUNT, tree_duration / REPEAT, receiver_duration / REPEAT);
+
+  SVN_TEST_INT_ASSERT(tree_items, 6 + DIRENT_COUNT * 10);
+  SVN_TEST_INT_ASSERT(received_items, tree_items);
+
+  return SVN_NO_ERROR;
+}
+
+/* The test table.  */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_receive_item,
+                   "stream items to a receiver"),
+    SVN_TEST_PASS2(test_receive_item_errors,
+                   "stream malformed items to a receiver"),
+    SVN_TEST_PASS2(test_buffer_command,
+                   "buffer complete commands without blocking"),
+    SVN_TEST_OPTS_PASS(marshal_benchmark,
+                       "compare item tree and receiver parsing"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
@@ -4468,6 +4468,73 @@ test_list(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Notification receiver for verify_concurrently(). */
+static void
+verify_notify_receiver(void *baton,
+                       const svn_repos_notify_t *notify,
+                       apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *revisions = baton;
+
+  if (notify->action == svn_repos_notify_verify_rev_end)
+    APR_ARRAY_PUSH(revisions, svn_revnum_t) = notify->revision;
+  else if (notify->action == svn_repos_notify_verify_end)
+    APR_ARRAY_PUSH(revisions, svn_revnum_t) = SVN_INVALID_REVNUM;
+}
+
+static svn_error_t *
+verify_concurrently(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_array_header_t *revisions = apr_array_make(pool, 16,
+                                                 sizeof(svn_revnum_t));
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Create a repository with a few revisions worth verifying. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-verify-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, iterpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, iterpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                  iterpool));
+
+  for (i = 0; i < 10; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool, "%d", i),
+                                          iterpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Results must be reported in revision order. */
+  SVN_ERR(svn_repos_verify_fs4(repos, 0, youngest_rev, FALSE, FALSE, 4,
+                               verify_notify_receiver, revisions,
+                               NULL, NULL, NULL, NULL, pool));
+
+  SVN_TEST_INT_ASSERT(revisions->nelts, youngest_rev + 2);
+  for (i = 0; i <= youngest_rev; ++i)
+    SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revisions, i, svn_revnum_t), i);
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(revisions, i, svn_revnum_t)
+                  == SVN_INVALID_REVNUM);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -4539,6 +4606,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "optional authz wildcard performance test"),
     SVN_TEST_OPTS_PASS(test_list,
                        "test svn_repos_list"),
+    SVN_TEST_OPTS_PASS(verify_concurrently,
+                       "test svn_repos_verify_fs4 with multiple jobs"),
     SVN_TEST_NULL
   };
 
@@ -22,12 +22,15 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <apr_general.h>
 #include <apr_lib.h>
 #include <apr_time.h>
+#include <apr_thread_proc.h>
 
 #include "svn_pools.h"
+#include "svn_dirent_uri.h"
 
 #include "private/svn_cache.h"
 #include "svn_private_config.h"
@@ -444,6 +447,181 @@ test_membuffer_cache_clearing(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_cache__shared_lock_func_t.  Count the locks in BATON. */
+static svn_error_t *
+count_shared_locks(apr_global_mutex_t *mutex,
+                   void *baton,
+                   apr_pool_t *pool)
+{
+  int *count = baton;
+
+  SVN_TEST_ASSERT(mutex != NULL);
+  ++*count;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_membuffer_cache_shared(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_error_t *err;
+  const char *sandbox_dir;
+  int lock_count = 0;
+#if APR_HAS_FORK
+  apr_proc_t proc;
+  apr_status_t status;
+  svn_revnum_t *value;
+  svn_boolean_t found;
+#endif
+
+  SVN_ERR(svn_test_make_sandbox_dir(&sandbox_dir, "cache-shared", pool));
+
+  /* Request more segments than there are locks.  Segments must then
+   * share a small number of locks. */
+  err = svn_cache__membuffer_cache_create_shared(
+          &membuffer, 4 * 1024 * 1024, 0, 32, NULL,
+          svn_dirent_join(sandbox_dir, "lock", pool),
+          count_shared_locks, &lock_count, pool);
+  if (err && APR_STATUS_IS_ENOTIMPL(err->apr_err))
+    {
+      svn_error_clear(err);
+      return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                              "anonymous shared memory not supported");
+    }
+  SVN_ERR(err);
+  SVN_TEST_ASSERT(lock_count > 0 && lock_count < 32);
+
+  SVN_ERR(svn_cache__create_membuffer_cache(&cache,
+                                            membuffer,
+                                            serialize_revnum,
+                                            deserialize_revnum,
+                                            APR_HASH_KEY_STRING,
+                                            "cache:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE,
+                                            FALSE,
+                                            pool, pool));
+
+  SVN_ERR(basic_cache_test(cache, FALSE, pool));
+
+#if APR_HAS_FORK
+  /* Data written by a child process must be visible to the parent. */
+  status = apr_proc_fork(&proc, pool);
+  if (status == APR_INCHILD)
+    {
+      svn_revnum_t answer = 42;
+
+      err = svn_cache__membuffer_cache_child_init(membuffer, pool);
+      if (!err)
+        err = svn_cache__set(cache, "from child", &answer, pool);
+
+      exit(err ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+  else if (status == APR_INPARENT)
+    {
+      int exit_code;
+      apr_exit_why_e exit_why;
+
+      status = apr_proc_wait(&proc, &exit_code, &exit_why, APR_WAIT);
+      if (!APR_STATUS_IS_CHILD_DONE(status))
+        return svn_error_wrap_apr(status, NULL);
+
+      SVN_TEST_ASSERT(APR_PROC_CHECK_EXIT(exit_why));
+      SVN_TEST_ASSERT(exit_code == EXIT_SUCCESS);
+    }
+  else
+    {
+      return svn_error_wrap_apr(status, NULL);
+    }
+
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "from child",
+                         pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*value == 42);
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Create an in-process cache for revnums in *CACHE_P and put STORE
+ * behind it as its persistent tier.  Allocate everything in POOL.
+ */
+static svn_error_t *
+create_persistent_revnum_cache(svn_cache__t **cache_p,
+                               svn_cache__persistent_t *store,
+                               apr_pool_t *pool)
+{
+  svn_cache__t *front;
+
+  SVN_ERR(svn_cache__create_inprocess(&front,
+                                      serialize_revnum,
+                                      deserialize_revnum,
+                                      APR_HASH_KEY_STRING,
+                                      1, 1, FALSE, "", pool));
+  SVN_ERR(svn_cache__create_persistent(cache_p, front, store,
+                                       serialize_revnum,
+                                       deserialize_revnum,
+                                       APR_HASH_KEY_STRING,
+                                       "revnum", pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_persistent_cache(apr_pool_t *pool)
+{
+  svn_cache__persistent_t *store, *other_store;
+  svn_cache__t *cache;
+  const char *sandbox_dir;
+  const char *path;
+  svn_revnum_t *value;
+  svn_revnum_t twenty;
+  svn_boolean_t found;
+
+  SVN_ERR(svn_test_make_sandbox_dir(&sandbox_dir, "cache-persistent", pool));
+  path = svn_dirent_join(sandbox_dir, "store", pool);
+
+  SVN_ERR(svn_cache__persistent_open(&store, path, 1024 * 1024, "guard 1",
+                                     pool));
+  SVN_ERR(create_persistent_revnum_cache(&cache, store, pool));
+  SVN_ERR(basic_cache_test(cache, FALSE, pool));
+
+  /* A fresh front cache must get its data from the store. */
+  SVN_ERR(create_persistent_revnum_cache(&cache, store, pool));
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "twenty", pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*value == 20);
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "thirty", pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*value == 30);
+
+  /* Using the file with a different guard must discard all data. */
+  SVN_ERR(svn_cache__persistent_open(&other_store, path, 1024 * 1024,
+                                     "guard 2", pool));
+  SVN_ERR(create_persistent_revnum_cache(&cache, other_store, pool));
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "twenty", pool));
+  SVN_TEST_ASSERT(!found);
+
+  /* Users that opened the file with the old guard may still be around,
+   * e.g. other server processes of a different build.  They must not
+   * accept data written with the new guard and vice versa. */
+  twenty = 21;
+  SVN_ERR(svn_cache__set(cache, "twenty", &twenty, pool));
+  SVN_ERR(create_persistent_revnum_cache(&cache, store, pool));
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "twenty", pool));
+  SVN_TEST_ASSERT(!found);
+
+  twenty = 22;
+  SVN_ERR(svn_cache__set(cache, "twenty", &twenty, pool));
+  SVN_ERR(create_persistent_revnum_cache(&cache, other_store, pool));
+  SVN_ERR(svn_cache__get((void **) &value, &found, cache, "twenty", pool));
+  SVN_TEST_ASSERT(!found);
+
+  return SVN_NO_ERROR;
+}
+
 /* Implements svn_iter_apr_hash_cb_t. */
 static svn_error_t *
 null_cache_iter_func(void *baton,
@@ -590,6 +768,204 @@ test_membuffer_unaligned_fixed_keys(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* Number of distinct keys used by the concurrency test.  Chosen such that
+ * the data will not fit into the cache, i.e. we get a steady stream of
+ * evictions while readers look up entries. */
+#define CONCURRENCY_TEST_KEYS 1000
+
+/* Parameters and results of a single cache access thread. */
+typedef struct concurrency_baton_t
+{
+  /* The cache shared between all threads. */
+  svn_membuffer_t *membuffer;
+
+  /* Random number seed. */
+  apr_uint32_t seed;
+
+  /* Number of cache lookups to do.  Every 4th access will be a write. */
+  int iterations;
+
+  /* Number of lookups that found data. */
+  int hits;
+
+  /* Error returned by the thread. */
+  svn_error_t *err;
+} concurrency_baton_t;
+
+/* Return the value to store under KEY in the concurrency test.  The values
+ * have a different length per key, such that we will get garbage results
+ * and not just slightly wrong values when reading torn data. */
+static svn_stringbuf_t *
+concurrency_test_value(const char *key,
+                       apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *value = svn_stringbuf_create(key, result_pool);
+  apr_size_t repeat = strlen(key) + (apr_size_t)atoi(key + 4) % 37;
+  apr_size_t i;
+
+  for (i = 0; i < repeat; ++i)
+    svn_stringbuf_appendcstr(value, key);
+
+  return value;
+}
+
+/* Access the cache as described by the concurrency_baton_t in BATON. */
+static svn_error_t *
+concurrency_test_access(concurrency_baton_t *baton,
+                        apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Front-end cache instances are cheap and not shared between threads,
+   * just like with e.g. per-session FSFS instances. */
+  SVN_ERR(svn_cache__create_membuffer_cache(&cache,
+                                            baton->membuffer,
+                                            NULL, NULL,
+                                            APR_HASH_KEY_STRING,
+                                            "cache:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE,
+                                            FALSE,
+                                            pool, pool));
+
+  for (i = 0; i < baton->iterations; ++i)
+    {
+      const char *key;
+      svn_stringbuf_t *expected;
+      svn_stringbuf_t *value;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+      key = apr_psprintf(iterpool, "key-%d",
+                         (int)(svn_test_rand(&baton->seed)
+                               % CONCURRENCY_TEST_KEYS));
+      expected = concurrency_test_value(key, iterpool);
+
+      if (i % 4 == 0)
+        {
+          SVN_ERR(svn_cache__set(cache, key, expected, iterpool));
+        }
+      else if (i % 4 == 1)
+        {
+          SVN_ERR(svn_cache__has_key(&found, cache, key, iterpool));
+          if (found)
+            baton->hits++;
+        }
+      else
+        {
+          SVN_ERR(svn_cache__get((void **)&value, &found, cache, key,
+                                 iterpool));
+          if (found)
+            {
+              baton->hits++;
+              if (!svn_stringbuf_compare(value, expected))
+                return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                         "wrong value for '%s'", key);
+            }
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static void *
+APR_THREAD_FUNC concurrency_test_thread(apr_thread_t *tid, void *data)
+{
+  concurrency_baton_t *baton = data;
+
+  /* Pools are not thread-safe.  Give each thread its own root pool. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  /* give all threads a good chance to get started by the scheduler */
+  apr_thread_yield();
+
+  baton->err = concurrency_test_access(baton, pool);
+  svn_pool_destroy(pool);
+  apr_thread_exit(tid, APR_SUCCESS);
+
+  return NULL;
+}
+
+#endif
+
+#define APR_ERR(expr)                           \
+  do {                                          \
+    apr_status_t status = (expr);               \
+    if (status)                                 \
+      return svn_error_wrap_apr(status, NULL);  \
+  } while (0)
+
+static svn_error_t *
+test_membuffer_cache_concurrency(const svn_test_opts_t *opts,
+                                 apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  /* Many readers and writers hammer a small cache that has only a single
+     segment.  Lookups must never return torn or mismatched data.
+     In verbose mode, report the throughput for various thread counts as
+     a simple benchmark of lock contention within the cache.
+   */
+  enum { MAX_THREAD_COUNT = 16, ITERATIONS = 20000 };
+  svn_membuffer_t *membuffer;
+  apr_thread_t *threads[MAX_THREAD_COUNT];
+  concurrency_baton_t batons[MAX_THREAD_COUNT];
+  int thread_count;
+  int i;
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 256*1024, 1, 1,
+                                            TRUE, TRUE, pool));
+
+  for (thread_count = 1; thread_count <= MAX_THREAD_COUNT; thread_count *= 2)
+    {
+      apr_time_t start = apr_time_now();
+      int hits = 0;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      for (i = 0; i < thread_count; ++i)
+        {
+          batons[i].membuffer = membuffer;
+          batons[i].seed = (apr_uint32_t)(i * 1234567 + thread_count);
+          batons[i].iterations = ITERATIONS;
+          batons[i].hits = 0;
+          batons[i].err = SVN_NO_ERROR;
+
+          APR_ERR(apr_thread_create(&threads[i], NULL,
+                                    concurrency_test_thread, &batons[i],
+                                    pool));
+        }
+
+      /* wait for the threads to finish */
+      for (i = 0; i < thread_count; ++i)
+        {
+          apr_status_t retval;
+          APR_ERR(apr_thread_join(&retval, threads[i]));
+          APR_ERR(retval);
+
+          hits += batons[i].hits;
+          err = svn_error_compose_create(err, batons[i].err);
+        }
+
+      SVN_ERR(err);
+
+      if (opts->verbose)
+        {
+          apr_time_t duration = apr_time_now() - start;
+          printf("%2d threads: %d accesses (%d hits) in %" APR_TIME_T_FMT
+                 " usec\n", thread_count, thread_count * ITERATIONS, hits,
+                 duration);
+        }
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -610,12 +986,19 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test for error handling in membuffer svn_cache"),
     SVN_TEST_PASS2(test_membuffer_cache_clearing,
                    "test clearing a membuffer svn_cache"),
+    SVN_TEST_PASS2(test_membuffer_cache_shared,
+                   "test membuffer svn_cache in shared memory"),
+    SVN_TEST_PASS2(test_persistent_cache,
+                   "persistent cache tier"),
     SVN_TEST_PASS2(test_null_cache,
                    "basic null svn_cache test"),
     SVN_TEST_PASS2(test_membuffer_unaligned_string_keys,
                    "test membuffer cache with unaligned string keys"),
     SVN_TEST_PASS2(test_membuffer_unaligned_fixed_keys,
                    "test membuffer cache with unaligned fixed keys"),
+    SVN_TEST_OPTS_SKIP(test_membuffer_cache_concurrency,
+                       ! APR_HAS_THREADS,
+                       "test concurrent membuffer cache access"),
     SVN_TEST_NULL
   };
 
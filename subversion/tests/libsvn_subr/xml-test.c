@@ -20,12 +20,19 @@
  * ====================================================================
  */
 
+#include <stdio.h>
+
 #include <apr.h>
+#include <apr_strings.h>
+#include <apr_time.h>
 
+#include "svn_io.h"
 #include "svn_pools.h"
 #include "svn_string.h"
 #include "svn_xml.h"
 
+#include "private/svn_xml_private.h"
+
 #include "../svn_test.h"
 
 typedef struct xml_callbacks_baton_t
@@ -332,6 +339,161 @@ test_xml_doctype_declaration(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_xml_escape(apr_pool_t *pool)
+{
+  const char *special = "a&b<c>d\"e'f\rg\nh\ti";
+  svn_stringbuf_t *buf = NULL;
+
+  svn_xml_escape_cdata_cstring(&buf, special, pool);
+  SVN_TEST_STRING_ASSERT(buf->data,
+                         "a&amp;b&lt;c&gt;d\"e'f&#13;g\nh\ti");
+
+  /* Escaping appends to an existing buffer. */
+  svn_xml_escape_attr_cstring(&buf, special, pool);
+  SVN_TEST_STRING_ASSERT(buf->data,
+                         "a&amp;b&lt;c&gt;d\"e'f&#13;g\nh\ti"
+                         "a&amp;b&lt;c&gt;d&quot;e&apos;f&#13;g&#10;h&#9;i");
+
+  /* Non-ASCII and plain strings are taken as they are. */
+  buf = NULL;
+  svn_xml_escape_attr_cstring(&buf, "plain/path/\xc3\xa4.c", pool);
+  SVN_TEST_STRING_ASSERT(buf->data, "plain/path/\xc3\xa4.c");
+
+  return SVN_NO_ERROR;
+}
+
+/* Write a log-report-like document with COUNT items to OUT, formatting
+   every element separately and writing it to OUT right away, the way
+   a naive report generator would.  Use POOL for allocations. */
+static svn_error_t *
+write_log_per_element(svn_stream_t *out,
+                      int count,
+                      apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      svn_stringbuf_t *path = NULL;
+      svn_stringbuf_t *msg = NULL;
+      const char *data;
+      apr_size_t len;
+
+      svn_pool_clear(iterpool);
+
+      svn_xml_escape_cdata_cstring(&path,
+                                   apr_psprintf(iterpool,
+                                                "trunk/src/module-%d/file.c",
+                                                i),
+                                   iterpool);
+      svn_xml_escape_cdata_cstring(&msg, "Fix the <frobnicator> & more",
+                                   iterpool);
+
+      data = apr_psprintf(iterpool,
+                          "<S:log-item><S:modified-path node-kind=\"file\""
+                          " text-mods=\"true\" prop-mods=\"false\">"
+                          "%s</S:modified-path>", path->data);
+      len = strlen(data);
+      SVN_ERR(svn_stream_write(out, data, &len));
+
+      data = apr_psprintf(iterpool, "<D:version-name>%d</D:version-name>",
+                          i);
+      len = strlen(data);
+      SVN_ERR(svn_stream_write(out, data, &len));
+
+      data = apr_psprintf(iterpool, "<D:comment>%s</D:comment>", msg->data);
+      len = strlen(data);
+      SVN_ERR(svn_stream_write(out, data, &len));
+
+      len = strlen("</S:log-item>");
+      SVN_ERR(svn_stream_write(out, "</S:log-item>", &len));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Like write_log_per_element() but use a svn_xml__writer_t, i.e.
+   escape everything into a single buffer and only write that to OUT in
+   large chunks. */
+static svn_error_t *
+write_log_buffered(svn_stream_t *out,
+                   int count,
+                   apr_pool_t *pool)
+{
+  svn_xml__writer_t *xw = svn_xml__writer_create(out, pool);
+  const char *msg = "Fix the <frobnicator> & more";
+  char path[64];
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      apr_snprintf(path, sizeof(path), "trunk/src/module-%d/file.c", i);
+
+      SVN_ERR(svn_xml__writer_putstrs(xw,
+                                      "<S:log-item><S:modified-path"
+                                      " node-kind=\"file\" text-mods=\"true\""
+                                      " prop-mods=\"false\">",
+                                      SVN_VA_NULL));
+      SVN_ERR(svn_xml__writer_cdata(xw, path, strlen(path)));
+      SVN_ERR(svn_xml__writer_printf(xw,
+                                     "</S:modified-path>"
+                                     "<D:version-name>%d</D:version-name>"
+                                     "<D:comment>", i));
+      SVN_ERR(svn_xml__writer_cdata(xw, msg, strlen(msg)));
+      SVN_ERR(svn_xml__writer_putstrs(xw, "</D:comment></S:log-item>",
+                                      SVN_VA_NULL));
+    }
+
+  return svn_error_trace(svn_xml__writer_flush(xw));
+}
+
+static svn_error_t *
+log_report_benchmark(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  enum { ITEM_COUNT = 50000 };
+  svn_stringbuf_t *per_element = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *buffered = svn_stringbuf_create_empty(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t start;
+  apr_time_t per_element_duration;
+  apr_time_t buffered_duration;
+
+  /* Both ways must produce the same document. */
+  SVN_ERR(write_log_per_element(svn_stream_from_stringbuf(per_element,
+                                                          pool),
+                                100, iterpool));
+  SVN_ERR(write_log_buffered(svn_stream_from_stringbuf(buffered, pool),
+                             100, iterpool));
+  SVN_TEST_STRING_ASSERT(buffered->data, per_element->data);
+
+  /* Now time them, writing to the equivalent of a null output filter. */
+  svn_pool_clear(iterpool);
+  start = apr_time_now();
+  SVN_ERR(write_log_per_element(svn_stream_empty(iterpool), ITEM_COUNT,
+                                iterpool));
+  per_element_duration = apr_time_now() - start;
+
+  svn_pool_clear(iterpool);
+  start = apr_time_now();
+  SVN_ERR(write_log_buffered(svn_stream_empty(iterpool), ITEM_COUNT,
+                             iterpool));
+  buffered_duration = apr_time_now() - start;
+
+  svn_pool_destroy(iterpool);
+
+  if (opts->verbose)
+    printf("%d log items: per element %" APR_TIME_T_FMT " usec, "
+           "buffered %" APR_TIME_T_FMT " usec\n",
+           ITEM_COUNT, per_element_duration, buffered_duration);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 static int max_threads = 1;
 
@@ -354,6 +516,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test XML custom entity expansion"),
     SVN_TEST_PASS2(test_xml_doctype_declaration,
                    "test XML doctype declaration"),
+    SVN_TEST_PASS2(test_xml_escape,
+                   "test XML escaping"),
+    SVN_TEST_OPTS_PASS(log_report_benchmark,
+                       "compare per-element and buffered XML output"),
     SVN_TEST_NULL
   };
 